@@ -24,62 +24,75 @@
 /*! @file */
 #include "HT16K33_Simple.h"
 #include <climits>
+#include "rlic_section.h"
 
-HT16K33_Simple::HT16K33_Simple() {
-
+HT16K33_Simple::HT16K33_Simple(LPI2C_Type *bus, uint8_t addr) {
+	ledBus = bus;
+	ledAddr = addr;
 }
 
 HT16K33_Simple::~HT16K33_Simple() {
 
 }
 
-/* Init LED interface */
-void HT16K33_Simple::initHT16K33(void) {
+/* reset one matrix: oscillator on, RAM cleared, lowest dimming, display on */
+void HT16K33_Simple::resetDevice(LPI2C_Type *bus, uint8_t addr) {
 	uint8_t ledData = 0;
+	uint8_t ledRam[HT16K33_COL_MAX] = { 0 };
 
 	/* Reset */
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_DAYLIGHT_LED_I2C_ADDR,
-	HT16K33_SYSTEM_SETUP_REG, 1, &ledData, 1);
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_RLIC_LED_I2C_ADDR,
-	HT16K33_SYSTEM_SETUP_REG, 1, &ledData, 1);
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_DAYLIGHT_LED_I2C_ADDR,
-	HT16K33_DISPLAY_SETUP_REG, 1, &ledData, 1);
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_RLIC_LED_I2C_ADDR,
-	HT16K33_DISPLAY_SETUP_REG, 1, &ledData, 1);
+	BOARD_LPI2C_Send(bus, addr, HT16K33_SYSTEM_SETUP_REG, 1, &ledData, 1);
+	BOARD_LPI2C_Send(bus, addr, HT16K33_DISPLAY_SETUP_REG, 1, &ledData, 1);
 	/* Reset Done */
 
 	/* OSC ON */
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_DAYLIGHT_LED_I2C_ADDR,
-	HT16K33_SYSTEM_SETUP_REG | HT16K33_SYSTEM_SETUP_S_BIT_POS, 1, &ledData, 1);
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_RLIC_LED_I2C_ADDR,
+	BOARD_LPI2C_Send(bus, addr,
 	HT16K33_SYSTEM_SETUP_REG | HT16K33_SYSTEM_SETUP_S_BIT_POS, 1, &ledData, 1);
 
-	/* Reset RAM */
-	for (int i = 0; i < HT16K33_COL_MAX; i++) {
-		ledMatrix[i] = 0;
-		BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR,
-				HT16K33_DAYLIGHT_LED_I2C_ADDR, i, 1, &ledData, 1);
-		BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_RLIC_LED_I2C_ADDR, i,
-				1, &ledData, 1);
-	}
+	/* Reset RAM, one burst, the address auto increments */
+	BOARD_LPI2C_Send(bus, addr, 0, 1, ledRam, HT16K33_COL_MAX);
 
 	/* Lowest Dimming */
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_DAYLIGHT_LED_I2C_ADDR,
-			HT16K33_DIMMING_REG, 1, &ledData, 1);
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_RLIC_LED_I2C_ADDR,
-			HT16K33_DIMMING_REG, 1, &ledData, 1);
+	BOARD_LPI2C_Send(bus, addr, HT16K33_DIMMING_REG, 1, &ledData, 1);
 
 	/* Display ON */
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_DAYLIGHT_LED_I2C_ADDR,
+	BOARD_LPI2C_Send(bus, addr,
 	HT16K33_DISPLAY_SETUP_REG | HT16K33_DISPLAY_SETUP_D_BIT_POS, 1, &ledData,
 			1);
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_RLIC_LED_I2C_ADDR,
+}
+
+/* Init LED interface, day light matrix; the zones reset their own */
+void HT16K33_Simple::initHT16K33(void) {
+	for (int i = 0; i < HT16K33_COL_MAX; i++)
+		ledMatrix[i] = 0;
+
+	resetDevice(BOARD_CODEC_I2C_BASEADDR, HT16K33_DAYLIGHT_LED_I2C_ADDR);
+}
+
+/* Init the controlled matrix only */
+void HT16K33_Simple::initLed(void) {
+	resetDevice(ledBus, ledAddr);
+}
+
+/*
+ * Controlled matrix straight to a known action, for the restore at boot:
+ * oscillator on, frame and dimming, display on. The frame covers all of
+ * the display RAM, so nothing is cleared first and a matrix still showing
+ * it does not blink.
+ */
+void HT16K33_Simple::restoreLed(uint8_t numOnLed, uint8_t duty) {
+	uint8_t ledData = 0;
+
+	BOARD_LPI2C_Send(ledBus, ledAddr,
+	HT16K33_SYSTEM_SETUP_REG | HT16K33_SYSTEM_SETUP_S_BIT_POS, 1, &ledData, 1);
+	setLedBrightness(numOnLed, duty);
+	BOARD_LPI2C_Send(ledBus, ledAddr,
 	HT16K33_DISPLAY_SETUP_REG | HT16K33_DISPLAY_SETUP_D_BIT_POS, 1, &ledData,
 			1);
 }
 
 /* cycle day light logic */
-bool HT16K33_Simple::cycleDayLight(void) {
+RLIC_HOT_CODE bool HT16K33_Simple::cycleDayLight(void) {
 	uint8_t ledData = 0;
 	bool dayReset = false;
 
@@ -146,7 +159,8 @@ bool HT16K33_Simple::cycleDayLight(void) {
 }
 
 /* set specific brightness */
-void HT16K33_Simple::setLedBrightness(uint8_t numOnLed, uint8_t duty) {
+RLIC_HOT_CODE void HT16K33_Simple::setLedBrightness(uint8_t numOnLed,
+		uint8_t duty) {
 	uint8_t ledMatrixLocal[HT16K33_COL_MAX];
 
 	bzero(ledMatrixLocal, sizeof(ledMatrixLocal[0]) * HT16K33_COL_MAX);
@@ -174,10 +188,9 @@ void HT16K33_Simple::setLedBrightness(uint8_t numOnLed, uint8_t duty) {
 
 	uint32_t primask = DisableGlobalIRQ();
 
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_RLIC_LED_I2C_ADDR, 0, 1,
-			ledMatrixLocal, HT16K33_COL_MAX);
-	BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, HT16K33_RLIC_LED_I2C_ADDR,
-	HT16K33_DIMMING_REG | duty, 1, ledMatrixLocal, 1);
+	BOARD_LPI2C_Send(ledBus, ledAddr, 0, 1, ledMatrixLocal, HT16K33_COL_MAX);
+	BOARD_LPI2C_Send(ledBus, ledAddr, HT16K33_DIMMING_REG | duty, 1,
+			ledMatrixLocal, 1);
 
 	EnableGlobalIRQ(primask);
 }
@@ -50,15 +50,22 @@
 #define HT16K33_MID_DIMMING_ROW			4
 #define HT16K33_SAT_CTR_MAX				56U
 
+/* one controlled matrix, the day light one is driven by the default instance */
 class HT16K33_Simple {
 private:
 	uint8_t col = 0, row = 0, sunRise = 1, dimCtr = 0;
 	uint32_t saturationCtr = HT16K33_SAT_CTR_MAX;
 	uint8_t ledMatrix[HT16K33_COL_MAX];
+	LPI2C_Type *ledBus;
+	uint8_t ledAddr;
+	void resetDevice(LPI2C_Type*, uint8_t);
 public:
-	HT16K33_Simple();
+	HT16K33_Simple(LPI2C_Type* = BOARD_CODEC_I2C_BASEADDR, uint8_t =
+	HT16K33_RLIC_LED_I2C_ADDR);
 	virtual ~HT16K33_Simple();
 	void initHT16K33(void);
+	void initLed(void);
+	void restoreLed(uint8_t, uint8_t);
 	bool cycleDayLight(void);
 	void setLedBrightness(uint8_t, uint8_t);
 };
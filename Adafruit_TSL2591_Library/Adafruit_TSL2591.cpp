@@ -48,18 +48,78 @@
 #include "Adafruit_TSL2591.h"
 #include <stdlib.h>
 
+/// Auto ranging settings, least sensitive first. Gain is free, integration
+/// time is latency, so all gains at 100 ms come before longer integrations.
+static const struct {
+  tsl2591Gain_t gain;
+  tsl2591IntegrationTime_t integration;
+} tsl2591AutoLadder[] = {
+    {TSL2591_GAIN_LOW, TSL2591_INTEGRATIONTIME_100MS},
+    {TSL2591_GAIN_MED, TSL2591_INTEGRATIONTIME_100MS},
+    {TSL2591_GAIN_HIGH, TSL2591_INTEGRATIONTIME_100MS},
+    {TSL2591_GAIN_MAX, TSL2591_INTEGRATIONTIME_100MS},
+    {TSL2591_GAIN_MAX, TSL2591_INTEGRATIONTIME_200MS},
+    {TSL2591_GAIN_MAX, TSL2591_INTEGRATIONTIME_300MS},
+    {TSL2591_GAIN_MAX, TSL2591_INTEGRATIONTIME_400MS},
+    {TSL2591_GAIN_MAX, TSL2591_INTEGRATIONTIME_500MS},
+    {TSL2591_GAIN_MAX, TSL2591_INTEGRATIONTIME_600MS},
+};
+#define TSL2591_AUTO_FAST_STEPS (4) ///< entries at 100 ms
+#define TSL2591_AUTO_STEPS                                                     \
+  (TSL2591_AUTO_FAST_STEPS + TSL2591_AUTO_ATIME_MAX)
+#define TSL2591_AUTO_START_STEP (1) ///< medium gain, 100 ms
+
+/// Nominal gain multiplier, same numbers as calculateLux()
+static uint32_t tsl2591GainX(tsl2591Gain_t gain) {
+  switch (gain) {
+  case TSL2591_GAIN_MED:
+    return 25;
+  case TSL2591_GAIN_HIGH:
+    return 428;
+  case TSL2591_GAIN_MAX:
+    return 9876;
+  default:
+    return 1;
+  }
+}
+
+/// Counts per unit of light relative to low gain at 100 ms
+static uint32_t tsl2591Sensitivity(tsl2591Gain_t gain,
+                                   tsl2591IntegrationTime_t integration) {
+  return tsl2591GainX(gain) * (integration + 1);
+}
+
+/// ADC full scale, 100 ms integration tops out early (datasheet)
+static uint32_t tsl2591FullScale(tsl2591IntegrationTime_t integration) {
+  return (integration == TSL2591_INTEGRATIONTIME_100MS) ? 37888 : 65535;
+}
+
+/// Time getFullLuminosity() waits for one conversion
+static int32_t tsl2591WaitMS(tsl2591IntegrationTime_t integration) {
+  return (integration + 1) * 110;
+}
+
 /**************************************************************************/
 /*!
     @brief  Instantiates a new Adafruit TSL2591 class
     @param  sensorID An optional ID # so you can track this sensor, it will tag
    sensorEvents you create.
+    @param  bus Board I2C bus the sensor is on, BOARD_TSL2591_BUS_*
 */
 /**************************************************************************/
-Adafruit_TSL2591::Adafruit_TSL2591(int32_t sensorID) {
+Adafruit_TSL2591::Adafruit_TSL2591(int32_t sensorID, uint8_t bus) {
   _initialized = false;
   _integration = TSL2591_INTEGRATIONTIME_100MS;
   _gain = TSL2591_GAIN_MED;
   _sensorID = sensorID;
+  _bus = bus;
+  _autoStep = TSL2591_AUTO_START_STEP;
+  _autoTries = 0;
+  _autoWaitMS = 0;
+  _autoSavedMS = 0;
+  _shadowValid = 0;
+  _lastStatus = 0;
+  _transactions = 0;
 
   // we cant do wire initialization till later, because we havent loaded Wire
   // yet
@@ -76,6 +136,8 @@ Adafruit_TSL2591::Adafruit_TSL2591(int32_t sensorID) {
 bool Adafruit_TSL2591::begin(uint8_t addr) {
 	Adafruit_Print Serial;
   _addr = addr;
+  // Nothing known about the registers until written
+  _shadowValid = 0;
 
   /*
   for (uint8_t i=0; i<0x20; i++)
@@ -117,9 +179,9 @@ void Adafruit_TSL2591::enable(void) {
   }
 
   // Enable the device by setting the control bit to 0x01
-  write8(TSL2591_COMMAND_BIT | TSL2591_REGISTER_ENABLE,
-         TSL2591_ENABLE_POWERON | TSL2591_ENABLE_AEN | TSL2591_ENABLE_AIEN |
-             TSL2591_ENABLE_NPIEN);
+  writeReg(TSL2591_REGISTER_ENABLE,
+           TSL2591_ENABLE_POWERON | TSL2591_ENABLE_AEN | TSL2591_ENABLE_AIEN |
+               TSL2591_ENABLE_NPIEN);
 }
 
 /**************************************************************************/
@@ -135,8 +197,7 @@ void Adafruit_TSL2591::disable(void) {
   }
 
   // Disable the device by setting the control bit to 0x00
-  write8(TSL2591_COMMAND_BIT | TSL2591_REGISTER_ENABLE,
-         TSL2591_ENABLE_POWEROFF);
+  writeReg(TSL2591_REGISTER_ENABLE, TSL2591_ENABLE_POWEROFF);
 }
 
 /************************************************************************/
@@ -152,9 +213,13 @@ void Adafruit_TSL2591::setGain(tsl2591Gain_t gain) {
     }
   }
 
-  enable();
   _gain = gain;
-  write8(TSL2591_COMMAND_BIT | TSL2591_REGISTER_CONTROL, _integration | _gain);
+  if (shadowed(TSL2591_REGISTER_CONTROL, _integration | _gain)) {
+    return;
+  }
+
+  enable();
+  writeReg(TSL2591_REGISTER_CONTROL, _integration | _gain);
   disable();
 }
 
@@ -179,9 +244,13 @@ void Adafruit_TSL2591::setTiming(tsl2591IntegrationTime_t integration) {
     }
   }
 
-  enable();
   _integration = integration;
-  write8(TSL2591_COMMAND_BIT | TSL2591_REGISTER_CONTROL, _integration | _gain);
+  if (shadowed(TSL2591_REGISTER_CONTROL, _integration | _gain)) {
+    return;
+  }
+
+  enable();
+  writeReg(TSL2591_REGISTER_CONTROL, _integration | _gain);
   disable();
 }
 
@@ -289,20 +358,68 @@ uint32_t Adafruit_TSL2591::getFullLuminosity(void) {
     }
   }
 
-  // Enable the device
-  enable();
+  startFullLuminosity();
+  waitConversion();
+  return readFullLuminosity();
+}
+
+/************************************************************************/
+/*!
+    @brief  Starts a sample, enables the device if it is not running. A
+   full conversion is ready getWaitMS() later, readFullLuminosity() picks
+   it up. Lets the caller do other work instead of waiting.
+*/
+/**************************************************************************/
+void Adafruit_TSL2591::startFullLuminosity(void) { enable(); }
 
+/************************************************************************/
+/*!
+    @brief  Time from startFullLuminosity() until a conversion done entirely
+   at the current setting is available
+    @returns Milliseconds
+*/
+/**************************************************************************/
+uint32_t Adafruit_TSL2591::getWaitMS(void) {
+  return tsl2591WaitMS(_integration);
+}
+
+/// Blocks (asleep) for getWaitMS()
+void Adafruit_TSL2591::waitConversion(void) {
   // Wait x ms for ADC to complete
   for (uint8_t d = 0; d <= _integration; d++) {
-	  SysTick_DelayTicksMS(110);
+	  SysTick_IdleMS(110);
+  }
+}
+
+/************************************************************************/
+/*!
+    @brief  Reads the channels of a sample started by startFullLuminosity()
+    @returns 32-bit raw count where high word is IR, low word is IR+Visible
+*/
+/**************************************************************************/
+uint32_t Adafruit_TSL2591::readFullLuminosity(void) {
+  if (!_initialized) {
+    if (!begin()) {
+      return 0;
+    }
   }
 
   // CHAN0 must be read before CHAN1
   // See: https://forums.adafruit.com/viewtopic.php?f=19&t=124176
   uint32_t x;
   uint16_t y;
+#if TSL2591_REGMAP
+  // One auto increment read: STATUS, CHAN0 low/high, CHAN1 low/high
+  uint8_t block[TSL2591_DATA_BLOCK_SZ] = {0};
+  readBlock(TSL2591_COMMAND_BIT | TSL2591_REGISTER_DEVICE_STATUS, block,
+            sizeof(block));
+  _lastStatus = block[0];
+  y = block[1] | (block[2] << 8);
+  x = block[3] | (block[4] << 8);
+#else
   y = read16(TSL2591_COMMAND_BIT | TSL2591_REGISTER_CHAN0_LOW);
   x = read16(TSL2591_COMMAND_BIT | TSL2591_REGISTER_CHAN1_LOW);
+#endif
   x <<= 16;
   x |= y;
 
@@ -336,6 +453,175 @@ uint16_t Adafruit_TSL2591::getLuminosity(uint8_t channel) {
   return 0;
 }
 
+/************************************************************************/
+/*!
+    @brief  Reads a channel with gain and integration picked automatically.
+   The setting comes from the previous sample: the shortest integration
+   time, with the highest gain that keeps channel 0 below
+   TSL2591_AUTO_HEADROOM_PCT of full scale. A saturated sample steps down
+   and is taken again instead of being returned.
+    @param  channel Can be 0 (IR+Visible, 1 (IR) or 2 (Visible only)
+    @returns Counts normalised to TSL2591_AUTO_REF_GAIN and
+   TSL2591_AUTO_REF_TIME, so values keep their meaning whatever the setting.
+   May exceed 16 bits in bright light.
+*/
+/**************************************************************************/
+uint32_t Adafruit_TSL2591::getAutoLuminosity(uint8_t channel) {
+  uint32_t value = 0;
+
+  startAutoLuminosity();
+  do {
+    waitConversion();
+  } while (!readAutoLuminosity(channel, &value));
+
+  return value;
+}
+
+/************************************************************************/
+/*!
+    @brief  Starts an auto ranged sample at the setting picked by the
+   previous one, see getAutoLuminosity()
+*/
+/**************************************************************************/
+void Adafruit_TSL2591::startAutoLuminosity(void) {
+  _autoTries = 0;
+  _autoWaitMS = 0;
+  applyAutoStep();
+  startFullLuminosity();
+}
+
+/// Control register to the current auto range ladder step
+void Adafruit_TSL2591::applyAutoStep(void) {
+  if ((_gain != tsl2591AutoLadder[_autoStep].gain) ||
+      (_integration != tsl2591AutoLadder[_autoStep].integration)) {
+    setControl(tsl2591AutoLadder[_autoStep].gain,
+               tsl2591AutoLadder[_autoStep].integration);
+  }
+}
+
+/************************************************************************/
+/*!
+    @brief  Reads a sample started by startAutoLuminosity(), getWaitMS()
+   after the start
+    @param  channel Can be 0 (IR+Visible, 1 (IR) or 2 (Visible only)
+    @param  value Normalised counts as getAutoLuminosity() returns them
+    @returns False if the sample saturated and was started again one step
+   down, or no integration had completed yet (AVALID clear): read again
+   getWaitMS() later. True with value set otherwise.
+*/
+/**************************************************************************/
+bool Adafruit_TSL2591::readAutoLuminosity(uint8_t channel, uint32_t *value) {
+  uint32_t x, ch0, ch1, fs, sens, refSens;
+
+  x = readFullLuminosity();
+  _autoWaitMS += tsl2591WaitMS(_integration);
+#if TSL2591_REGMAP
+  if (!(_lastStatus & TSL2591_STATUS_AVALID) &&
+      (_autoTries < TSL2591_AUTO_STEPS)) {
+    // Counts of no integration at this setting, still running
+    _autoTries++;
+    return false;
+  }
+#endif
+  ch0 = x & 0xFFFF;
+  ch1 = x >> 16;
+  fs = tsl2591FullScale(_integration);
+
+  if (!(((ch0 < fs) && (ch1 < fs)) || (_autoStep == 0) ||
+        (_autoTries >= TSL2591_AUTO_STEPS))) {
+    // Saturated, the count says nothing about the level: one step down
+    _autoTries++;
+    _autoStep--;
+    applyAutoStep();
+    startFullLuminosity();
+    return false;
+  }
+
+  _autoSavedMS = tsl2591WaitMS(TSL2591_AUTO_REF_TIME) - _autoWaitMS;
+
+  // Next setting, predicted from this sample
+  sens = tsl2591Sensitivity(_gain, _integration);
+  uint8_t next = 0;
+  for (uint8_t step = 0; step < TSL2591_AUTO_STEPS; step++) {
+    uint32_t stepSens = tsl2591Sensitivity(tsl2591AutoLadder[step].gain,
+                                           tsl2591AutoLadder[step].integration);
+    uint64_t predicted = (uint64_t)ch0 * stepSens / sens;
+    uint64_t limit = (uint64_t)tsl2591FullScale(
+                         tsl2591AutoLadder[step].integration) *
+                     TSL2591_AUTO_HEADROOM_PCT / 100;
+
+    if (predicted > limit) {
+      break;
+    }
+    next = step;
+    // Longer integration only when the fastest one is too coarse
+    if ((step >= (TSL2591_AUTO_FAST_STEPS - 1)) &&
+        (predicted >= TSL2591_AUTO_MIN_COUNTS)) {
+      break;
+    }
+  }
+  _autoStep = next;
+
+  // Normalise to the reference setting
+  refSens = tsl2591Sensitivity(TSL2591_AUTO_REF_GAIN, TSL2591_AUTO_REF_TIME);
+  ch0 = (uint64_t)ch0 * refSens / sens;
+  ch1 = (uint64_t)ch1 * refSens / sens;
+
+  if (channel == TSL2591_FULLSPECTRUM) {
+    *value = ch0;
+  } else if (channel == TSL2591_INFRARED) {
+    *value = ch1;
+  } else if (channel == TSL2591_VISIBLE) {
+    *value = (ch0 > ch1) ? (ch0 - ch1) : 0;
+  } else {
+    // unknown channel!
+    *value = 0;
+  }
+  return true;
+}
+
+/************************************************************************/
+/*!
+    @brief  Latency saved by the last getAutoLuminosity() call
+    @returns Wait time of the fixed TSL2591_AUTO_REF_TIME setting minus the
+   time actually waited, negative if a saturated sample had to be retaken
+*/
+/**************************************************************************/
+int32_t Adafruit_TSL2591::getAutoSavedMS(void) { return _autoSavedMS; }
+
+/************************************************************************/
+/*!
+    @brief  Writes gain and integration time in one go
+    @param  gain {@link tsl2591Gain_t} gain value
+    @param  integration {@link tsl2591IntegrationTime_t} integration time
+*/
+/**************************************************************************/
+void Adafruit_TSL2591::setControl(tsl2591Gain_t gain,
+                                  tsl2591IntegrationTime_t integration) {
+  if (!_initialized) {
+    if (!begin()) {
+      return;
+    }
+  }
+
+  _gain = gain;
+  _integration = integration;
+  if (shadowed(TSL2591_REGISTER_CONTROL, _integration | _gain)) {
+    return;
+  }
+
+  // A running device would finish the integration in progress at the old
+  // setting: AEN off and on again starts a fresh one at the new setting
+  bool wasEnabled = isEnabled();
+  writeReg(TSL2591_REGISTER_ENABLE, TSL2591_ENABLE_POWERON);
+  writeReg(TSL2591_REGISTER_CONTROL, _integration | _gain);
+  if (wasEnabled) {
+    enable();
+  } else {
+    disable();
+  }
+}
+
 /************************************************************************/
 /*!
     @brief  Set up the interrupt to go off when light level is outside the
@@ -357,17 +643,25 @@ void Adafruit_TSL2591::registerInterrupt(
     }
   }
 
+  if (shadowed(TSL2591_REGISTER_PERSIST_FILTER, persist) &&
+      shadowed(TSL2591_REGISTER_THRESHOLD_AILTL, lowerThreshold & 0xFF) &&
+      shadowed(TSL2591_REGISTER_THRESHOLD_AILTH, lowerThreshold >> 8) &&
+      shadowed(TSL2591_REGISTER_THRESHOLD_AIHTL, upperThreshold & 0xFF) &&
+      shadowed(TSL2591_REGISTER_THRESHOLD_AIHTH, upperThreshold >> 8)) {
+    return;
+  }
+
+  // Leave a running device running
+  bool wasEnabled = isEnabled();
   enable();
-  write8(TSL2591_COMMAND_BIT | TSL2591_REGISTER_PERSIST_FILTER, persist);
-  write8(TSL2591_COMMAND_BIT | TSL2591_REGISTER_THRESHOLD_AILTL,
-         lowerThreshold);
-  write8(TSL2591_COMMAND_BIT | TSL2591_REGISTER_THRESHOLD_AILTH,
-         lowerThreshold >> 8);
-  write8(TSL2591_COMMAND_BIT | TSL2591_REGISTER_THRESHOLD_AIHTL,
-         upperThreshold);
-  write8(TSL2591_COMMAND_BIT | TSL2591_REGISTER_THRESHOLD_AIHTH,
-         upperThreshold >> 8);
-  disable();
+  writeReg(TSL2591_REGISTER_PERSIST_FILTER, persist);
+  writeReg(TSL2591_REGISTER_THRESHOLD_AILTL, lowerThreshold & 0xFF);
+  writeReg(TSL2591_REGISTER_THRESHOLD_AILTH, lowerThreshold >> 8);
+  writeReg(TSL2591_REGISTER_THRESHOLD_AIHTL, upperThreshold & 0xFF);
+  writeReg(TSL2591_REGISTER_THRESHOLD_AIHTH, upperThreshold >> 8);
+  if (!wasEnabled) {
+    disable();
+  }
 }
 
 /************************************************************************/
@@ -382,9 +676,12 @@ void Adafruit_TSL2591::clearInterrupt() {
     }
   }
 
+  bool wasEnabled = isEnabled();
   enable();
   write8(TSL2591_CLEAR_INT);
-  disable();
+  if (!wasEnabled) {
+    disable();
+  }
 }
 
 /************************************************************************/
@@ -402,13 +699,33 @@ uint8_t Adafruit_TSL2591::getStatus(void) {
   }
 
   // Enable the device
+  bool wasEnabled = isEnabled();
   enable();
   uint8_t x;
   x = read8(TSL2591_COMMAND_BIT | TSL2591_REGISTER_DEVICE_STATUS);
-  disable();
+  if (!wasEnabled) {
+    disable();
+  }
+  _lastStatus = x;
   return x;
 }
 
+/************************************************************************/
+/*!
+    @brief  Status byte fetched along with the last channel read, no I2C
+    @return Sensor status as a byte, see getStatus()
+*/
+/**************************************************************************/
+uint8_t Adafruit_TSL2591::getLastStatus(void) { return _lastStatus; }
+
+/************************************************************************/
+/*!
+    @brief  I2C transactions issued so far, for per sample accounting
+    @return Transaction count since construction
+*/
+/**************************************************************************/
+uint32_t Adafruit_TSL2591::getTransactions(void) { return _transactions; }
+
 /************************************************************************/
 /*!
     @brief  Gets the most recent sensor event
@@ -469,24 +786,79 @@ void Adafruit_TSL2591::getSensor(sensor_t *sensor) {
 uint8_t Adafruit_TSL2591::read8(uint8_t reg) {
   uint8_t x = 0;
 
-  BOARD_TSL2591_I2C_Receive(_addr, reg, 1, &x, 1);
+  _transactions++;
+  BOARD_TSL2591_I2C_Receive(_bus, _addr, reg, 1, &x, 1);
   return x;
 }
 
 uint16_t Adafruit_TSL2591::read16(uint8_t reg) {
   uint16_t x;
 
-  BOARD_TSL2591_I2C_Receive(_addr, reg, 1, (uint8_t *)&x, 2);
+  _transactions++;
+  BOARD_TSL2591_I2C_Receive(_bus, _addr, reg, 1, (uint8_t *)&x, 2);
   return x;
 }
 
-void Adafruit_TSL2591::write8(uint8_t reg, uint8_t value) {
+status_t Adafruit_TSL2591::readBlock(uint8_t reg, uint8_t *buf, uint8_t len) {
+  _transactions++;
+  return BOARD_TSL2591_I2C_Receive(_bus, _addr, reg, 1, buf, len);
+}
+
+status_t Adafruit_TSL2591::write8(uint8_t reg, uint8_t value) {
+
+  _transactions++;
+  return BOARD_TSL2591_I2C_Send(_bus, _addr, reg, 1, value);
+}
+
+status_t Adafruit_TSL2591::write8(uint8_t reg) {
+  _transactions++;
+  return BOARD_TSL2591_I2C_Send_Clear(_bus, _addr, reg, 1);
+}
+
+/*
+ * Configuration register write through the shadow: skipped when the device
+ * already holds the value, the shadow is only trusted after a good write.
+ */
+void Adafruit_TSL2591::writeReg(uint8_t reg, uint8_t value) {
+  if (shadowed(reg, value)) {
+    return;
+  }
+
+  status_t status = write8(TSL2591_COMMAND_BIT | reg, value);
+#if TSL2591_REGMAP
+  if (reg < TSL2591_SHADOW_REGS) {
+    _shadow[reg] = value;
+    if (status == kStatus_Success) {
+      _shadowValid |= (1U << reg);
+    } else {
+      _shadowValid &= ~(1U << reg);
+    }
+  }
+#else
+  (void)status;
+#endif
+}
 
-  BOARD_TSL2591_I2C_Send(_addr, reg, 1, value);
+/// True when the device is known to hold value in reg
+bool Adafruit_TSL2591::shadowed(uint8_t reg, uint8_t value) {
+#if TSL2591_REGMAP
+  return (reg < TSL2591_SHADOW_REGS) && (_shadowValid & (1U << reg)) &&
+         (_shadow[reg] == value);
+#else
+  (void)reg;
+  (void)value;
+  return false;
+#endif
 }
 
-void Adafruit_TSL2591::write8(uint8_t reg) {
-	BOARD_TSL2591_I2C_Send_Clear(_addr, reg, 1);
+/// Powered and integrating as far as the shadow knows
+bool Adafruit_TSL2591::isEnabled(void) {
+#if TSL2591_REGMAP
+  return (_shadowValid & (1U << TSL2591_REGISTER_ENABLE)) &&
+         (_shadow[TSL2591_REGISTER_ENABLE] & TSL2591_ENABLE_POWERON);
+#else
+  return false;
+#endif
 }
 
 /**************************************************************************/
@@ -533,6 +905,9 @@ void Adafruit_TSL2591::configureSensor(void)
   Serial.print  (F("Timing:       "));
   Serial.print((getTiming() + 1) * 100);
   Serial.println(F(" ms"));
+#if TSL2591_AUTO_RANGE
+  Serial.println(F("Auto ranging: on, counts in units of the above"));
+#endif
   Serial.println(F("------------------------------------"));
   Serial.println(F(""));
 }
@@ -58,6 +58,28 @@
 #define TSL2591_LUX_COEFC (0.59F) ///< CH1 coefficient A
 #define TSL2591_LUX_COEFD (0.86F) ///< CH2 coefficient B
 
+/// Shadowed configuration registers and block channel reads
+#ifndef TSL2591_REGMAP
+#define TSL2591_REGMAP (1)
+#endif
+#define TSL2591_SHADOW_REGS (TSL2591_REGISTER_PERSIST_FILTER + 1)
+#define TSL2591_STATUS_AVALID (0x01) ///< ALS data valid
+#define TSL2591_DATA_BLOCK_SZ (5)    ///< STATUS, C0DATAL..C1DATAH
+
+/// Auto ranging, see getAutoLuminosity()
+#ifndef TSL2591_AUTO_RANGE
+#define TSL2591_AUTO_RANGE (1)
+#endif
+/// Longest integration the auto ranging may pick (dark rooms)
+#ifndef TSL2591_AUTO_ATIME_MAX
+#define TSL2591_AUTO_ATIME_MAX TSL2591_INTEGRATIONTIME_200MS
+#endif
+#define TSL2591_AUTO_HEADROOM_PCT (70) ///< keep ch0 below this % of full scale
+#define TSL2591_AUTO_MIN_COUNTS (200)  ///< below this, integrate longer
+/// Normalised counts are in units of this setting (the old fixed one)
+#define TSL2591_AUTO_REF_GAIN TSL2591_GAIN_MED
+#define TSL2591_AUTO_REF_TIME TSL2591_INTEGRATIONTIME_200MS
+
 /// TSL2591 Register map
 enum {
   TSL2591_REGISTER_ENABLE = 0x00,          // Enable register
@@ -131,7 +153,8 @@ typedef enum {
 /**************************************************************************/
 class Adafruit_TSL2591 : public Adafruit_Sensor {
 public:
-  Adafruit_TSL2591(int32_t sensorID = -1);
+  Adafruit_TSL2591(int32_t sensorID = -1,
+                   uint8_t bus = BOARD_TSL2591_BUS_ACCEL);
 
   bool begin(uint8_t addr = TSL2591_ADDR);
   void enable(void);
@@ -143,6 +166,11 @@ public:
   uint16_t getLuminosity(uint8_t channel);
   uint32_t getFullLuminosity();
 
+  // Split sample: start, do something else for getWaitMS(), then read
+  void startFullLuminosity(void);
+  uint32_t readFullLuminosity(void);
+  uint32_t getWaitMS(void);
+
   tsl2591IntegrationTime_t getTiming();
   tsl2591Gain_t getGain();
 
@@ -151,6 +179,8 @@ public:
   void registerInterrupt(uint16_t lowerThreshold, uint16_t upperThreshold,
                          tsl2591Persist_t persist);
   uint8_t getStatus();
+  uint8_t getLastStatus(void);
+  uint32_t getTransactions(void);
 
   /* Unified Sensor API Functions */
   bool getEvent(sensors_event_t *);
@@ -158,17 +188,39 @@ public:
   void configureSensor(void);
   void simpleRead(void);
 
+  // Auto ranging
+  uint32_t getAutoLuminosity(uint8_t channel);
+  int32_t getAutoSavedMS(void);
+  void startAutoLuminosity(void);
+  bool readAutoLuminosity(uint8_t channel, uint32_t *value);
+
 private:
 
-  void write8(uint8_t r);
-  void write8(uint8_t r, uint8_t v);
+  status_t write8(uint8_t r);
+  status_t write8(uint8_t r, uint8_t v);
   uint16_t read16(uint8_t reg);
   uint8_t read8(uint8_t reg);
+  status_t readBlock(uint8_t reg, uint8_t *buf, uint8_t len);
+  void writeReg(uint8_t reg, uint8_t value);
+  bool shadowed(uint8_t reg, uint8_t value);
+  bool isEnabled(void);
+  void setControl(tsl2591Gain_t gain, tsl2591IntegrationTime_t integration);
+  void waitConversion(void);
+  void applyAutoStep(void);
 
   tsl2591IntegrationTime_t _integration;
   tsl2591Gain_t _gain;
   int32_t _sensorID;
   uint8_t _addr;
+  uint8_t _bus; ///< board I2C bus, BOARD_TSL2591_BUS_*
+  uint8_t _autoStep;
+  uint8_t _autoTries;  ///< retakes of the sample in progress
+  int32_t _autoWaitMS; ///< waited for the sample in progress
+  int32_t _autoSavedMS;
+  uint8_t _shadow[TSL2591_SHADOW_REGS];
+  uint16_t _shadowValid; ///< bit per register, set once written
+  uint8_t _lastStatus;
+  uint32_t _transactions;
 
   bool _initialized;
 };
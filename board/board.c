@@ -10,11 +10,19 @@
 #include "board.h"
 #if defined(SDK_I2C_BASED_COMPONENT_USED) && SDK_I2C_BASED_COMPONENT_USED
 #include "fsl_lpi2c.h"
+#include "fsl_gpio.h"
+#include "rlic_i2c_bus.h"
+#include "systick_delay.h"
+#if RLIC_I2C_BENCHMARK
+#include "rlic_cycles.h"
+#endif
 #endif /* SDK_I2C_BASED_COMPONENT_USED */
 #if defined(SDK_SPI_BASED_COMPONENT_USED) && SDK_SPI_BASED_COMPONENT_USED
 #include "fsl_lpspi.h"
 #endif /* SDK_SPI_BASED_COMPONENT_USED */
 #include "fsl_iomuxc.h"
+#include "rlic_section.h"
+#include "rlic_dmabuf.h"
 
 /*******************************************************************************
  * Variables
@@ -186,7 +194,10 @@ void BOARD_ConfigMPU(void)
         /* Region 9 setting: Memory with Normal type, not shareable, non-cacheable */
         MPU->RBAR = ARM_MPU_RBAR(9, nonCacheStart);
         MPU->RASR = ARM_MPU_RASR(0, ARM_MPU_AP_FULL, 1, 0, 0, 0, 0, i - 1);
+        RLIC_DmaBuf_AddRegion(nonCacheStart, size);
     }
+    /* DTCM (region 6) is never cached whatever its attributes, DMA to it needs no maintenance */
+    RLIC_DmaBuf_AddRegion(0x20000000U, 64U * 1024U);
 
     /* Region 10 setting: Memory with Device type, not shareable, non-cacheable */
     MPU->RBAR = ARM_MPU_RBAR(10, 0x40000000);
@@ -262,7 +273,339 @@ void BOARD_LPI2C_Init(LPI2C_Type *base, uint32_t clkSrc_Hz)
     LPI2C_MasterInit(base, &lpi2cConfig, clkSrc_Hz);
 }
 
-status_t BOARD_LPI2C_Send(LPI2C_Type *base,
+/* LPI2C root clock as actually programmed, PLL3 / 8 or OSC, then the divider */
+uint32_t BOARD_LPI2C_SrcFreq(void)
+{
+    uint32_t freq;
+
+    if (CLOCK_GetMux(kCLOCK_Lpi2cMux) == 0)
+    {
+        freq = (CLOCK_GetPllFreq(kCLOCK_PllUsb1) / 8U) / (CLOCK_GetDiv(kCLOCK_Lpi2cDiv) + 1U);
+    }
+    else
+    {
+        freq = CLOCK_GetOscFreq() / (CLOCK_GetDiv(kCLOCK_Lpi2cDiv) + 1U);
+    }
+
+    return freq;
+}
+
+/*
+ * Bus layer: both buses run at the fastest rate their devices take, a stuck
+ * bus is cleared by hand from GPIO mode and errors are counted per device.
+ */
+typedef struct
+{
+    LPI2C_Type *base;
+    GPIO_Type *gpio;
+    uint32_t sclPin;
+    uint32_t sdaPin;
+} board_i2c_pins_t;
+
+static const board_i2c_pins_t s_codecI2cPins = {BOARD_CODEC_I2C_BASEADDR, GPIO1, 30U, 31U};
+static const board_i2c_pins_t s_accelI2cPins = {BOARD_ACCEL_I2C_BASEADDR, GPIO3, 22U, 23U};
+
+static rlic_i2c_bus_t s_codecI2cBus;
+static rlic_i2c_bus_t s_accelI2cBus;
+
+/*
+ * Every device of every zone, by bus. Zone 0 has its LEDs at 0x70 and its
+ * sensor on LPI2C4, zone 1 (RLIC_ZONES 2) its LEDs at 0x71 and its sensor
+ * on LPI2C1; the daylight matrix at 0x72 is shared. Keep in step with the
+ * zone wiring in RLIC_Zone.cpp.
+ */
+static rlic_i2c_device_t s_codecI2cDev[] = {
+    {.name = "HT16K33", .address = 0x70U, .maxBaudHz = RLIC_I2C_BAUD_FAST},
+    {.name = "HT16K33", .address = 0x72U, .maxBaudHz = RLIC_I2C_BAUD_FAST},
+#if defined(RLIC_ZONES) && (RLIC_ZONES > 1)
+    {.name = "HT16K33", .address = 0x71U, .maxBaudHz = RLIC_I2C_BAUD_FAST},
+    {.name = "TSL2591", .address = 0x29U, .maxBaudHz = RLIC_I2C_BAUD_FAST},
+#endif
+};
+static rlic_i2c_device_t s_accelI2cDev[] = {
+    {.name = "TSL2591", .address = 0x29U, .maxBaudHz = RLIC_I2C_BAUD_FAST},
+};
+
+static void BOARD_I2C_MasterSetup(LPI2C_Type *base, uint32_t baudHz)
+{
+    lpi2c_master_config_t lpi2cConfig = {0};
+
+    LPI2C_MasterGetDefaultConfig(&lpi2cConfig);
+    lpi2cConfig.baudRate_Hz      = baudHz;
+    lpi2cConfig.pinLowTimeout_ns = BOARD_I2C_PIN_LOW_TIMEOUT_NS;
+    LPI2C_MasterInit(base, &lpi2cConfig, BOARD_LPI2C_SrcFreq());
+}
+
+static void BOARD_I2C_GpioOpenDrain(const board_i2c_pins_t *pins)
+{
+    /* output register 1 releases the open drain pad, pad keeps SION */
+    gpio_pin_config_t config = {kGPIO_DigitalOutput, 1U, kGPIO_NoIntmode};
+
+    LPI2C_MasterDeinit(pins->base);
+    GPIO_PinInit(pins->gpio, pins->sclPin, &config);
+    GPIO_PinInit(pins->gpio, pins->sdaPin, &config);
+}
+
+static void BOARD_I2C_CodecEnterGpio(void *ctx)
+{
+    BOARD_I2C_GpioOpenDrain((const board_i2c_pins_t *)ctx);
+    IOMUXC_SetPinMux(IOMUXC_GPIO_AD_B1_14_GPIO1_IO30, 1U);
+    IOMUXC_SetPinMux(IOMUXC_GPIO_AD_B1_15_GPIO1_IO31, 1U);
+}
+
+static void BOARD_I2C_CodecLeaveGpio(void *ctx, uint32_t baudHz)
+{
+    IOMUXC_SetPinMux(IOMUXC_GPIO_AD_B1_14_LPI2C1_SCL, 1U);
+    IOMUXC_SetPinMux(IOMUXC_GPIO_AD_B1_15_LPI2C1_SDA, 1U);
+    BOARD_I2C_MasterSetup(((const board_i2c_pins_t *)ctx)->base, baudHz);
+}
+
+static void BOARD_I2C_AccelEnterGpio(void *ctx)
+{
+    BOARD_I2C_GpioOpenDrain((const board_i2c_pins_t *)ctx);
+    IOMUXC_SetPinMux(IOMUXC_GPIO_SD_B1_02_GPIO3_IO22, 1U);
+    IOMUXC_SetPinMux(IOMUXC_GPIO_SD_B1_03_GPIO3_IO23, 1U);
+}
+
+static void BOARD_I2C_AccelLeaveGpio(void *ctx, uint32_t baudHz)
+{
+    IOMUXC_SetPinMux(IOMUXC_GPIO_SD_B1_02_LPI2C4_SCL, 1U);
+    IOMUXC_SetPinMux(IOMUXC_GPIO_SD_B1_03_LPI2C4_SDA, 1U);
+    BOARD_I2C_MasterSetup(((const board_i2c_pins_t *)ctx)->base, baudHz);
+}
+
+static void BOARD_I2C_SetScl(void *ctx, bool high)
+{
+    const board_i2c_pins_t *pins = (const board_i2c_pins_t *)ctx;
+
+    GPIO_PinWrite(pins->gpio, pins->sclPin, high ? 1U : 0U);
+}
+
+static void BOARD_I2C_SetSda(void *ctx, bool high)
+{
+    const board_i2c_pins_t *pins = (const board_i2c_pins_t *)ctx;
+
+    GPIO_PinWrite(pins->gpio, pins->sdaPin, high ? 1U : 0U);
+}
+
+/* pad level, not the output register */
+static bool BOARD_I2C_GetScl(void *ctx)
+{
+    const board_i2c_pins_t *pins = (const board_i2c_pins_t *)ctx;
+
+    return GPIO_PinReadPadStatus(pins->gpio, pins->sclPin) != 0U;
+}
+
+static bool BOARD_I2C_GetSda(void *ctx)
+{
+    const board_i2c_pins_t *pins = (const board_i2c_pins_t *)ctx;
+
+    return GPIO_PinReadPadStatus(pins->gpio, pins->sdaPin) != 0U;
+}
+
+static void BOARD_I2C_DelayUs(void *ctx, uint32_t us)
+{
+    (void)ctx;
+    SDK_DelayAtLeastUs(us, SystemCoreClock);
+}
+
+static const rlic_i2c_pin_ops_t s_codecI2cOps = {
+    BOARD_I2C_CodecEnterGpio, BOARD_I2C_CodecLeaveGpio, BOARD_I2C_SetScl, BOARD_I2C_SetSda,
+    BOARD_I2C_GetScl,         BOARD_I2C_GetSda,         BOARD_I2C_DelayUs,
+};
+
+static const rlic_i2c_pin_ops_t s_accelI2cOps = {
+    BOARD_I2C_AccelEnterGpio, BOARD_I2C_AccelLeaveGpio, BOARD_I2C_SetScl, BOARD_I2C_SetSda,
+    BOARD_I2C_GetScl,         BOARD_I2C_GetSda,         BOARD_I2C_DelayUs,
+};
+
+static rlic_i2c_bus_t *BOARD_I2C_Bus(LPI2C_Type *base)
+{
+    rlic_i2c_bus_t *bus = NULL;
+
+    if (base == BOARD_CODEC_I2C_BASEADDR)
+    {
+        bus = &s_codecI2cBus;
+    }
+    else if (base == BOARD_ACCEL_I2C_BASEADDR)
+    {
+        bus = &s_accelI2cBus;
+    }
+
+    /* not set up yet, transfers go straight through */
+    return ((bus != NULL) && (bus->ops != NULL)) ? bus : NULL;
+}
+
+static enum rlic_i2c_result_t BOARD_I2C_Result(status_t status)
+{
+    switch (status)
+    {
+        case kStatus_Success:
+            return RLIC_I2C_OK;
+        case kStatus_LPI2C_Nak:
+            return RLIC_I2C_NAK;
+        case kStatus_LPI2C_ArbitrationLost:
+            return RLIC_I2C_ARB_LOST;
+        case kStatus_LPI2C_PinLowTimeout:
+            return RLIC_I2C_PIN_LOW;
+        case kStatus_LPI2C_Busy:
+            return RLIC_I2C_BUSY;
+        default:
+            return RLIC_I2C_OTHER;
+    }
+}
+
+/*
+ * Call once the LPI2C root clock is final. The generated peripheral init
+ * assumes a 60 MHz root, after main divides it down the buses ran slower
+ * than configured; this sets them up again against the real clock.
+ */
+void BOARD_I2C_BusInit(void)
+{
+    RLIC_I2C_BusInit(&s_codecI2cBus, "LPI2C1", &s_codecI2cOps, (void *)&s_codecI2cPins);
+    for (uint32_t i = 0U; i < ARRAY_SIZE(s_codecI2cDev); i++)
+    {
+        RLIC_I2C_BusAddDevice(&s_codecI2cBus, &s_codecI2cDev[i]);
+    }
+    BOARD_I2C_MasterSetup(BOARD_CODEC_I2C_BASEADDR, RLIC_I2C_BusSelectBaud(&s_codecI2cBus));
+
+    RLIC_I2C_BusInit(&s_accelI2cBus, "LPI2C4", &s_accelI2cOps, (void *)&s_accelI2cPins);
+    for (uint32_t i = 0U; i < ARRAY_SIZE(s_accelI2cDev); i++)
+    {
+        RLIC_I2C_BusAddDevice(&s_accelI2cBus, &s_accelI2cDev[i]);
+    }
+    BOARD_I2C_MasterSetup(BOARD_ACCEL_I2C_BASEADDR, RLIC_I2C_BusSelectBaud(&s_accelI2cBus));
+}
+
+/* the rates BOARD_I2C_BusInit() picked, it runs before the console is up */
+void BOARD_I2C_PrintBuses(void)
+{
+    PRINTF("I2C root %d Hz, LPI2C1 %d kHz, LPI2C4 %d kHz\r\n", BOARD_LPI2C_SrcFreq(),
+           s_codecI2cBus.baudHz / 1000U, s_accelI2cBus.baudHz / 1000U);
+}
+
+void BOARD_I2C_PrintStats(void)
+{
+    RLIC_I2C_BusPrintStats(&s_codecI2cBus);
+    RLIC_I2C_BusPrintStats(&s_accelI2cBus);
+}
+
+#if RLIC_IDLE
+#ifndef BOARD_I2C_XFER_TIMEOUT_US
+#define BOARD_I2C_XFER_TIMEOUT_US (20000U)
+#endif
+
+typedef struct
+{
+    lpi2c_master_handle_t handle;
+    volatile bool done;
+    volatile status_t status;
+} board_i2c_xfer_t;
+
+static board_i2c_xfer_t s_codecI2cXfer;
+static board_i2c_xfer_t s_accelI2cXfer;
+
+RLIC_HOT_CODE static void BOARD_I2C_XferCallback(LPI2C_Type *base,
+                                                 lpi2c_master_handle_t *handle,
+                                                 status_t completionStatus,
+                                                 void *userData)
+{
+    board_i2c_xfer_t *xfer = (board_i2c_xfer_t *)userData;
+
+    xfer->status = completionStatus;
+    xfer->done   = true;
+}
+
+/*
+ * Interrupt driven transfer, the core sleeps until the LPI2C interrupt (or
+ * the next tick) instead of polling the status flags. The handle is made on
+ * first use so the bus setup done before it stays untouched. Callers with
+ * interrupts masked (LED frames) or in an ISR (day light) poll as before,
+ * the completion interrupt could not run for them.
+ */
+RLIC_HOT_CODE static status_t BOARD_LPI2C_Transfer(LPI2C_Type *base, lpi2c_master_transfer_t *xfer)
+{
+    board_i2c_xfer_t *state;
+    uint32_t startUS, regPrimask;
+    status_t status;
+
+    if ((__get_PRIMASK() != 0U) || (__get_IPSR() != 0U))
+    {
+        return LPI2C_MasterTransferBlocking(base, xfer);
+    }
+
+    if (base == BOARD_CODEC_I2C_BASEADDR)
+    {
+        state = &s_codecI2cXfer;
+    }
+    else if (base == BOARD_ACCEL_I2C_BASEADDR)
+    {
+        state = &s_accelI2cXfer;
+    }
+    else
+    {
+        return LPI2C_MasterTransferBlocking(base, xfer);
+    }
+
+    if (state->handle.completionCallback == NULL)
+    {
+        LPI2C_MasterTransferCreateHandle(base, &state->handle, BOARD_I2C_XferCallback, state);
+    }
+
+    state->done = false;
+    status      = LPI2C_MasterTransferNonBlocking(base, &state->handle, xfer);
+    if (status != kStatus_Success)
+    {
+        return status;
+    }
+
+    startUS = SysTick_ReferenceUS();
+    while (true)
+    {
+        /* a completion between the check and the sleep still wakes the core */
+        regPrimask = DisableGlobalIRQ();
+        if (state->done)
+        {
+            EnableGlobalIRQ(regPrimask);
+            break;
+        }
+        if ((SysTick_ReferenceUS() - startUS) >= BOARD_I2C_XFER_TIMEOUT_US)
+        {
+            LPI2C_MasterTransferAbort(base, &state->handle);
+            EnableGlobalIRQ(regPrimask);
+            return kStatus_LPI2C_Timeout;
+        }
+        SysTick_IdleWait(RLIC_IDLE_I2C);
+        EnableGlobalIRQ(regPrimask);
+    }
+
+    return state->status;
+}
+#else
+#define BOARD_LPI2C_Transfer LPI2C_MasterTransferBlocking
+#endif /* RLIC_IDLE */
+
+RLIC_HOT_CODE static status_t BOARD_LPI2C_Xfer(LPI2C_Type *base, lpi2c_master_transfer_t *xfer)
+{
+    rlic_i2c_bus_t *bus = BOARD_I2C_Bus(base);
+    status_t status     = BOARD_LPI2C_Transfer(base, xfer);
+
+    if (bus == NULL)
+    {
+        return status;
+    }
+
+    /* a cleared bus gets the transfer once more */
+    if (RLIC_I2C_BusComplete(bus, RLIC_I2C_BusFindDevice(bus, xfer->slaveAddress), BOARD_I2C_Result(status)))
+    {
+        status = BOARD_LPI2C_Transfer(base, xfer);
+        (void)RLIC_I2C_BusComplete(bus, RLIC_I2C_BusFindDevice(bus, xfer->slaveAddress), BOARD_I2C_Result(status));
+    }
+
+    return status;
+}
+
+RLIC_HOT_CODE status_t BOARD_LPI2C_Send(LPI2C_Type *base,
                           uint8_t deviceAddress,
                           uint32_t subAddress,
                           uint8_t subAddressSize,
@@ -279,10 +622,10 @@ status_t BOARD_LPI2C_Send(LPI2C_Type *base,
     xfer.data           = txBuff;
     xfer.dataSize       = txBuffSize;
 
-    return LPI2C_MasterTransferBlocking(base, &xfer);
+    return BOARD_LPI2C_Xfer(base, &xfer);
 }
 
-status_t BOARD_LPI2C_Receive(LPI2C_Type *base,
+RLIC_HOT_CODE status_t BOARD_LPI2C_Receive(LPI2C_Type *base,
                              uint8_t deviceAddress,
                              uint32_t subAddress,
                              uint8_t subAddressSize,
@@ -299,27 +642,65 @@ status_t BOARD_LPI2C_Receive(LPI2C_Type *base,
     xfer.data           = rxBuff;
     xfer.dataSize       = rxBuffSize;
 
-    return LPI2C_MasterTransferBlocking(base, &xfer);
+    return BOARD_LPI2C_Xfer(base, &xfer);
 }
 
-status_t BOARD_TSL2591_I2C_Send(uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize, uint32_t txBuff)
+/*
+ * LPI2C1 is also driven by the day light timer interrupt, transfers to a
+ * sensor on it are kept whole the same way HT16K33_Simple does.
+ */
+static status_t BOARD_TSL2591_I2C_Xfer(uint8_t bus,
+                                       uint8_t deviceAddress,
+                                       uint32_t subAddress,
+                                       uint8_t subaddressSize,
+                                       uint8_t *buff,
+                                       uint8_t buffSize,
+                                       bool read)
+{
+    status_t status;
+    uint32_t primask;
+
+    if (bus != BOARD_TSL2591_BUS_CODEC)
+    {
+        return read ? BOARD_LPI2C_Receive(BOARD_ACCEL_I2C_BASEADDR, deviceAddress, subAddress, subaddressSize, buff,
+                                          buffSize) :
+                      BOARD_LPI2C_Send(BOARD_ACCEL_I2C_BASEADDR, deviceAddress, subAddress, subaddressSize, buff,
+                                       buffSize);
+    }
+
+    primask = DisableGlobalIRQ();
+    status  = read ? BOARD_LPI2C_Receive(BOARD_CODEC_I2C_BASEADDR, deviceAddress, subAddress, subaddressSize, buff,
+                                        buffSize) :
+                    BOARD_LPI2C_Send(BOARD_CODEC_I2C_BASEADDR, deviceAddress, subAddress, subaddressSize, buff,
+                                     buffSize);
+    EnableGlobalIRQ(primask);
+
+    return status;
+}
+
+status_t BOARD_TSL2591_I2C_Send(
+    uint8_t bus, uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize, uint32_t txBuff)
 {
     uint8_t data = (uint8_t)txBuff;
 
-    return BOARD_LPI2C_Send(BOARD_ACCEL_I2C_BASEADDR, deviceAddress, subAddress, subaddressSize, &data, 1);
+    return BOARD_TSL2591_I2C_Xfer(bus, deviceAddress, subAddress, subaddressSize, &data, 1, false);
 }
 
-status_t BOARD_TSL2591_I2C_Send_Clear(uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize)
+status_t BOARD_TSL2591_I2C_Send_Clear(uint8_t bus, uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize)
 {
     uint8_t data = (uint8_t)0;
 
-    return BOARD_LPI2C_Send(BOARD_ACCEL_I2C_BASEADDR, deviceAddress, subAddress, subaddressSize, &data, 0);
+    return BOARD_TSL2591_I2C_Xfer(bus, deviceAddress, subAddress, subaddressSize, &data, 0, false);
 }
 
-status_t BOARD_TSL2591_I2C_Receive(
-    uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize, uint8_t *rxBuff, uint8_t rxBuffSize)
+status_t BOARD_TSL2591_I2C_Receive(uint8_t bus,
+                                   uint8_t deviceAddress,
+                                   uint32_t subAddress,
+                                   uint8_t subaddressSize,
+                                   uint8_t *rxBuff,
+                                   uint8_t rxBuffSize)
 {
-    return BOARD_LPI2C_Receive(BOARD_ACCEL_I2C_BASEADDR, deviceAddress, subAddress, subaddressSize, rxBuff, rxBuffSize);
+    return BOARD_TSL2591_I2C_Xfer(bus, deviceAddress, subAddress, subaddressSize, rxBuff, rxBuffSize, true);
 }
 
 void BOARD_Codec_I2C_Init(void)
@@ -339,4 +720,46 @@ status_t BOARD_Codec_I2C_Receive(
 {
     return BOARD_LPI2C_Receive(BOARD_CODEC_I2C_BASEADDR, deviceAddress, subAddress, subAddressSize, rxBuff, rxBuffSize);
 }
+
+#if RLIC_I2C_BENCHMARK
+/*
+ * Time a TSL2591 status and channel block read (command 0xB3, 5 bytes, the
+ * per sample read) at each rate up to the one selected for the bus.
+ */
+void BOARD_I2C_Benchmark(void)
+{
+    static const uint32_t bauds[] = {RLIC_I2C_BAUD_STANDARD, RLIC_I2C_BAUD_FAST, RLIC_I2C_BAUD_FAST_PLUS};
+    uint32_t selected             = s_accelI2cBus.baudHz;
+    uint8_t buf[5];
+
+    RLIC_CyclesInit();
+    for (uint32_t i = 0; i < ARRAY_SIZE(bauds); i++)
+    {
+        rlic_cycle_stat_t st;
+        uint32_t errors = 0;
+
+        if (bauds[i] > selected)
+        {
+            break;
+        }
+
+        BOARD_I2C_MasterSetup(BOARD_ACCEL_I2C_BASEADDR, bauds[i]);
+        RLIC_CycleStatReset(&st);
+        for (uint32_t n = 0; n < 100U; n++)
+        {
+            uint32_t start = RLIC_CyclesGet();
+
+            if (BOARD_TSL2591_I2C_Receive(BOARD_TSL2591_BUS_ACCEL, 0x29U, 0xB3U, 1U, buf, sizeof(buf)) !=
+                kStatus_Success)
+            {
+                errors++;
+            }
+            RLIC_CycleStatAdd(&st, RLIC_CyclesGet() - start);
+        }
+        PRINTF("I2C bench %d kHz: read 5B avg %d us max %d us, %d errors\r\n", bauds[i] / 1000U,
+               RLIC_CyclesToUS(RLIC_CycleStatAvg(&st)), RLIC_CyclesToUS(st.max), errors);
+    }
+    BOARD_I2C_MasterSetup(BOARD_ACCEL_I2C_BASEADDR, selected);
+}
+#endif /* RLIC_I2C_BENCHMARK */
 #endif /* SDK_I2C_BASED_COMPONENT_USED */
@@ -55,6 +55,13 @@
 #define BOARD_CODEC_I2C_CLOCK_SOURCE_DIVIDER (5U)
 #define BOARD_CODEC_I2C_CLOCK_FREQ           (10000000U)
 
+/* @Brief TSL2591 has one fixed address, so at most one sensor per bus */
+#define BOARD_TSL2591_BUS_ACCEL              (0U) /* LPI2C4 */
+#define BOARD_TSL2591_BUS_CODEC              (1U) /* LPI2C1, shared with the HT16K33s */
+
+/* @Brief SCL or SDA held low this long fails the transfer, bus gets cleared */
+#define BOARD_I2C_PIN_LOW_TIMEOUT_NS         (1000000U)
+
 /*! @brief The USER_LED used for board */
 #define LOGIC_LED_ON  (0U)
 #define LOGIC_LED_OFF (1U)
@@ -167,10 +174,20 @@ status_t BOARD_LPI2C_Receive(LPI2C_Type *base,
                              uint8_t *rxBuff,
                              uint8_t rxBuffSize);
 void BOARD_TSL2591_I2C_Init(void);
-status_t BOARD_TSL2591_I2C_Send(uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize, uint32_t txBuff);
-status_t BOARD_TSL2591_I2C_Send_Clear(uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize);
-status_t BOARD_TSL2591_I2C_Receive(
-    uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize, uint8_t *rxBuff, uint8_t rxBuffSize);
+status_t BOARD_TSL2591_I2C_Send(
+    uint8_t bus, uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize, uint32_t txBuff);
+status_t BOARD_TSL2591_I2C_Send_Clear(uint8_t bus, uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize);
+status_t BOARD_TSL2591_I2C_Receive(uint8_t bus,
+                                   uint8_t deviceAddress,
+                                   uint32_t subAddress,
+                                   uint8_t subaddressSize,
+                                   uint8_t *rxBuff,
+                                   uint8_t rxBuffSize);
+uint32_t BOARD_LPI2C_SrcFreq(void);
+void BOARD_I2C_BusInit(void);
+void BOARD_I2C_PrintBuses(void);
+void BOARD_I2C_PrintStats(void);
+void BOARD_I2C_Benchmark(void);
 void BOARD_Codec_I2C_Init(void);
 status_t BOARD_Codec_I2C_Send(
     uint8_t deviceAddress, uint32_t subAddress, uint8_t subAddressSize, const uint8_t *txBuff, uint8_t txBuffSize);
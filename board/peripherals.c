@@ -17,6 +17,10 @@ functionalGroups:
   UUID: 6d394465-bc9b-47f2-9a1f-3ca61f76d27b
   called_from_default_init: true
   selectedCore: core0
+- name: BOARD_InitLatePeripherals
+  UUID: 4bf2d36b-8786-485b-af91-dcbd5f6167d7
+  called_from_default_init: false
+  selectedCore: core0
  * BE CAREFUL MODIFYING THIS COMMENT - IT IS YAML SETTINGS FOR TOOLS **********/
 
 /* TEXT BELOW IS USED AS SETTING FOR TOOLS *************************************
@@ -156,64 +160,6 @@ static void LPI2C4_init(void) {
   LPI2C_MasterTransferCreateHandle(LPI2C4_PERIPHERAL, &LPI2C4_masterHandle, NULL, NULL);
 }
 
-/***********************************************************************************************************************
- * LPUART1 initialization code
- **********************************************************************************************************************/
-/* clang-format off */
-/* TEXT BELOW IS USED AS SETTING FOR TOOLS *************************************
-instance:
-- name: 'LPUART1'
-- type: 'lpuart'
-- mode: 'polling'
-- custom_name_enabled: 'false'
-- type_id: 'lpuart_54a65a580e3462acdbacefd5299e0cac'
-- functional_group: 'BOARD_InitPeripherals'
-- peripheral: 'LPUART1'
-- config_sets:
-  - lpuartConfig_t:
-    - lpuartConfig:
-      - clockSource: 'LpuartClock'
-      - lpuartSrcClkFreq: 'BOARD_BootClockRUN'
-      - baudRate_Bps: '115200'
-      - parityMode: 'kLPUART_ParityDisabled'
-      - dataBitsCount: 'kLPUART_EightDataBits'
-      - isMsb: 'false'
-      - stopBitCount: 'kLPUART_OneStopBit'
-      - txFifoWatermark: '0'
-      - rxFifoWatermark: '1'
-      - enableRxRTS: 'false'
-      - enableTxCTS: 'false'
-      - txCtsSource: 'kLPUART_CtsSourcePin'
-      - txCtsConfig: 'kLPUART_CtsSampleAtStart'
-      - rxIdleType: 'kLPUART_IdleTypeStartBit'
-      - rxIdleConfig: 'kLPUART_IdleCharacter1'
-      - enableTx: 'true'
-      - enableRx: 'true'
-    - quick_selection: 'QuickSelection1'
- * BE CAREFUL MODIFYING THIS COMMENT - IT IS YAML SETTINGS FOR TOOLS **********/
-/* clang-format on */
-const lpuart_config_t LPUART1_config = {
-  .baudRate_Bps = 115200UL,
-  .parityMode = kLPUART_ParityDisabled,
-  .dataBitsCount = kLPUART_EightDataBits,
-  .isMsb = false,
-  .stopBitCount = kLPUART_OneStopBit,
-  .txFifoWatermark = 0U,
-  .rxFifoWatermark = 1U,
-  .enableRxRTS = false,
-  .enableTxCTS = false,
-  .txCtsSource = kLPUART_CtsSourcePin,
-  .txCtsConfig = kLPUART_CtsSampleAtStart,
-  .rxIdleType = kLPUART_IdleTypeStartBit,
-  .rxIdleConfig = kLPUART_IdleCharacter1,
-  .enableTx = true,
-  .enableRx = true
-};
-
-static void LPUART1_init(void) {
-  LPUART_Init(LPUART1_PERIPHERAL, &LPUART1_config, LPUART1_CLOCK_SOURCE);
-}
-
 /***********************************************************************************************************************
  * SEMC initialization code
  **********************************************************************************************************************/
@@ -593,105 +539,6 @@ static void LPI2C1_init(void) {
   LPI2C_MasterTransferCreateHandle(LPI2C1_PERIPHERAL, &LPI2C1_masterHandle, NULL, NULL);
 }
 
-/***********************************************************************************************************************
- * TMR2 initialization code
- **********************************************************************************************************************/
-/* clang-format off */
-/* TEXT BELOW IS USED AS SETTING FOR TOOLS *************************************
-instance:
-- name: 'TMR2'
-- type: 'qtmr'
-- mode: 'general'
-- custom_name_enabled: 'false'
-- type_id: 'qtmr_460dd7aa3f3371843c2548acd54252b0'
-- functional_group: 'BOARD_InitPeripherals'
-- peripheral: 'TMR2'
-- config_sets:
-  - fsl_qtmr:
-    - clockSource: 'BusInterfaceClock'
-    - clockSourceFreq: 'BOARD_BootClockRUN'
-    - qtmr_channels:
-      - 0:
-        - channel_prefix_id: 'Channel_0'
-        - channel: 'kQTMR_Channel_0'
-        - primarySource: 'kQTMR_ClockDivide_128'
-        - secondarySource: 'kQTMR_Counter0InputPin'
-        - countingMode: 'kQTMR_PriSrcRiseEdge'
-        - enableMasterMode: 'true'
-        - enableExternalForce: 'false'
-        - faultFilterCount: '3'
-        - faultFilterPeriod: '0'
-        - debugMode: 'kQTMR_RunNormalInDebug'
-        - timerModeInit: 'timer'
-        - timerMode:
-          - freq_value_str: '65535'
-        - dmaIntMode: 'interrupt'
-        - interrupts: ''
-      - 1:
-        - channel_prefix_id: 'Channel_1'
-        - channel: 'kQTMR_Channel_1'
-        - primarySource: 'kQTMR_ClockCounter0Output'
-        - primarySourceFreq: '15'
-        - secondarySource: 'kQTMR_Counter0InputPin'
-        - countingMode: 'kQTMR_CascadeCount'
-        - enableMasterMode: 'false'
-        - enableExternalForce: 'false'
-        - faultFilterCount: '3'
-        - faultFilterPeriod: '0'
-        - debugMode: 'kQTMR_RunNormalInDebug'
-        - timerModeInit: 'timer'
-        - timerMode:
-          - freq_value_str: '15'
-        - dmaIntMode: 'interrupt'
-        - interrupts: 'kQTMR_CompareInterruptEnable'
-    - interruptVector:
-      - enable_irq: 'true'
-      - interrupt:
-        - IRQn: 'TMR2_IRQn'
-        - enable_interrrupt: 'noInit'
-        - enable_priority: 'false'
-        - priority: '0'
-        - enable_custom_name: 'false'
- * BE CAREFUL MODIFYING THIS COMMENT - IT IS YAML SETTINGS FOR TOOLS **********/
-/* clang-format on */
-const qtmr_config_t TMR2_Channel_0_config = {
-  .primarySource = kQTMR_ClockDivide_128,
-  .secondarySource = kQTMR_Counter0InputPin,
-  .enableMasterMode = true,
-  .enableExternalForce = false,
-  .faultFilterCount = 0,
-  .faultFilterPeriod = 0,
-  .debugMode = kQTMR_RunNormalInDebug
-};
-const qtmr_config_t TMR2_Channel_1_config = {
-  .primarySource = kQTMR_ClockCounter0Output,
-  .secondarySource = kQTMR_Counter0InputPin,
-  .enableMasterMode = false,
-  .enableExternalForce = false,
-  .faultFilterCount = 0,
-  .faultFilterPeriod = 0,
-  .debugMode = kQTMR_RunNormalInDebug
-};
-
-static void TMR2_init(void) {
-  /* Quad timer channel Channel_0 peripheral initialization */
-  QTMR_Init(TMR2_PERIPHERAL, TMR2_CHANNEL_0_CHANNEL, &TMR2_Channel_0_config);
-  /* Setup the timer period of the channel */
-  QTMR_SetTimerPeriod(TMR2_PERIPHERAL, TMR2_CHANNEL_0_CHANNEL, 65535U);
-  /* Quad timer channel Channel_1 peripheral initialization */
-  QTMR_Init(TMR2_PERIPHERAL, TMR2_CHANNEL_1_CHANNEL, &TMR2_Channel_1_config);
-  /* Setup the timer period of the channel */
-  QTMR_SetTimerPeriod(TMR2_PERIPHERAL, TMR2_CHANNEL_1_CHANNEL, 15U);
-  /* Enable interrupt requests of the timer channel */
-  QTMR_EnableInterrupts(TMR2_PERIPHERAL, TMR2_CHANNEL_1_CHANNEL, kQTMR_CompareInterruptEnable);
-  /* Interrupt TMR2_IRQn request in the NVIC is not initialized (disabled by default). */
-  /* It can be enabled later by EnableIRQ(TMR2_IRQN);  function call. */
-  /* Start the timer - select the timer counting mode */
-  QTMR_StartTimer(TMR2_PERIPHERAL, TMR2_CHANNEL_0_CHANNEL, kQTMR_PriSrcRiseEdge);
-  /* Start the timer - select the timer counting mode */
-  QTMR_StartTimer(TMR2_PERIPHERAL, TMR2_CHANNEL_1_CHANNEL, kQTMR_CascadeCount);
-}
-
 /***********************************************************************************************************************
  * GPIO5 initialization code
  **********************************************************************************************************************/
@@ -839,6 +686,166 @@ static void TRNG_init(void) {
   TRNG_Init(TRNG_PERIPHERAL, &TRNG_config);
 }
 
+/***********************************************************************************************************************
+ * BOARD_InitLatePeripherals functional group
+ **********************************************************************************************************************/
+/***********************************************************************************************************************
+ * LPUART1 initialization code
+ **********************************************************************************************************************/
+/* clang-format off */
+/* TEXT BELOW IS USED AS SETTING FOR TOOLS *************************************
+instance:
+- name: 'LPUART1'
+- type: 'lpuart'
+- mode: 'polling'
+- custom_name_enabled: 'false'
+- type_id: 'lpuart_54a65a580e3462acdbacefd5299e0cac'
+- functional_group: 'BOARD_InitLatePeripherals'
+- peripheral: 'LPUART1'
+- config_sets:
+  - lpuartConfig_t:
+    - lpuartConfig:
+      - clockSource: 'LpuartClock'
+      - lpuartSrcClkFreq: 'BOARD_BootClockRUN'
+      - baudRate_Bps: '115200'
+      - parityMode: 'kLPUART_ParityDisabled'
+      - dataBitsCount: 'kLPUART_EightDataBits'
+      - isMsb: 'false'
+      - stopBitCount: 'kLPUART_OneStopBit'
+      - txFifoWatermark: '0'
+      - rxFifoWatermark: '1'
+      - enableRxRTS: 'false'
+      - enableTxCTS: 'false'
+      - txCtsSource: 'kLPUART_CtsSourcePin'
+      - txCtsConfig: 'kLPUART_CtsSampleAtStart'
+      - rxIdleType: 'kLPUART_IdleTypeStartBit'
+      - rxIdleConfig: 'kLPUART_IdleCharacter1'
+      - enableTx: 'true'
+      - enableRx: 'true'
+    - quick_selection: 'QuickSelection1'
+ * BE CAREFUL MODIFYING THIS COMMENT - IT IS YAML SETTINGS FOR TOOLS **********/
+/* clang-format on */
+const lpuart_config_t LPUART1_config = {
+  .baudRate_Bps = 115200UL,
+  .parityMode = kLPUART_ParityDisabled,
+  .dataBitsCount = kLPUART_EightDataBits,
+  .isMsb = false,
+  .stopBitCount = kLPUART_OneStopBit,
+  .txFifoWatermark = 0U,
+  .rxFifoWatermark = 1U,
+  .enableRxRTS = false,
+  .enableTxCTS = false,
+  .txCtsSource = kLPUART_CtsSourcePin,
+  .txCtsConfig = kLPUART_CtsSampleAtStart,
+  .rxIdleType = kLPUART_IdleTypeStartBit,
+  .rxIdleConfig = kLPUART_IdleCharacter1,
+  .enableTx = true,
+  .enableRx = true
+};
+
+static void LPUART1_init(void) {
+  LPUART_Init(LPUART1_PERIPHERAL, &LPUART1_config, LPUART1_CLOCK_SOURCE);
+}
+
+/***********************************************************************************************************************
+ * TMR2 initialization code
+ **********************************************************************************************************************/
+/* clang-format off */
+/* TEXT BELOW IS USED AS SETTING FOR TOOLS *************************************
+instance:
+- name: 'TMR2'
+- type: 'qtmr'
+- mode: 'general'
+- custom_name_enabled: 'false'
+- type_id: 'qtmr_460dd7aa3f3371843c2548acd54252b0'
+- functional_group: 'BOARD_InitLatePeripherals'
+- peripheral: 'TMR2'
+- config_sets:
+  - fsl_qtmr:
+    - clockSource: 'BusInterfaceClock'
+    - clockSourceFreq: 'BOARD_BootClockRUN'
+    - qtmr_channels:
+      - 0:
+        - channel_prefix_id: 'Channel_0'
+        - channel: 'kQTMR_Channel_0'
+        - primarySource: 'kQTMR_ClockDivide_128'
+        - secondarySource: 'kQTMR_Counter0InputPin'
+        - countingMode: 'kQTMR_PriSrcRiseEdge'
+        - enableMasterMode: 'true'
+        - enableExternalForce: 'false'
+        - faultFilterCount: '3'
+        - faultFilterPeriod: '0'
+        - debugMode: 'kQTMR_RunNormalInDebug'
+        - timerModeInit: 'timer'
+        - timerMode:
+          - freq_value_str: '65535'
+        - dmaIntMode: 'interrupt'
+        - interrupts: ''
+      - 1:
+        - channel_prefix_id: 'Channel_1'
+        - channel: 'kQTMR_Channel_1'
+        - primarySource: 'kQTMR_ClockCounter0Output'
+        - primarySourceFreq: '15'
+        - secondarySource: 'kQTMR_Counter0InputPin'
+        - countingMode: 'kQTMR_CascadeCount'
+        - enableMasterMode: 'false'
+        - enableExternalForce: 'false'
+        - faultFilterCount: '3'
+        - faultFilterPeriod: '0'
+        - debugMode: 'kQTMR_RunNormalInDebug'
+        - timerModeInit: 'timer'
+        - timerMode:
+          - freq_value_str: '15'
+        - dmaIntMode: 'interrupt'
+        - interrupts: 'kQTMR_CompareInterruptEnable'
+    - interruptVector:
+      - enable_irq: 'true'
+      - interrupt:
+        - IRQn: 'TMR2_IRQn'
+        - enable_interrrupt: 'noInit'
+        - enable_priority: 'false'
+        - priority: '0'
+        - enable_custom_name: 'false'
+ * BE CAREFUL MODIFYING THIS COMMENT - IT IS YAML SETTINGS FOR TOOLS **********/
+/* clang-format on */
+const qtmr_config_t TMR2_Channel_0_config = {
+  .primarySource = kQTMR_ClockDivide_128,
+  .secondarySource = kQTMR_Counter0InputPin,
+  .enableMasterMode = true,
+  .enableExternalForce = false,
+  .faultFilterCount = 0,
+  .faultFilterPeriod = 0,
+  .debugMode = kQTMR_RunNormalInDebug
+};
+const qtmr_config_t TMR2_Channel_1_config = {
+  .primarySource = kQTMR_ClockCounter0Output,
+  .secondarySource = kQTMR_Counter0InputPin,
+  .enableMasterMode = false,
+  .enableExternalForce = false,
+  .faultFilterCount = 0,
+  .faultFilterPeriod = 0,
+  .debugMode = kQTMR_RunNormalInDebug
+};
+
+static void TMR2_init(void) {
+  /* Quad timer channel Channel_0 peripheral initialization */
+  QTMR_Init(TMR2_PERIPHERAL, TMR2_CHANNEL_0_CHANNEL, &TMR2_Channel_0_config);
+  /* Setup the timer period of the channel */
+  QTMR_SetTimerPeriod(TMR2_PERIPHERAL, TMR2_CHANNEL_0_CHANNEL, 65535U);
+  /* Quad timer channel Channel_1 peripheral initialization */
+  QTMR_Init(TMR2_PERIPHERAL, TMR2_CHANNEL_1_CHANNEL, &TMR2_Channel_1_config);
+  /* Setup the timer period of the channel */
+  QTMR_SetTimerPeriod(TMR2_PERIPHERAL, TMR2_CHANNEL_1_CHANNEL, 15U);
+  /* Enable interrupt requests of the timer channel */
+  QTMR_EnableInterrupts(TMR2_PERIPHERAL, TMR2_CHANNEL_1_CHANNEL, kQTMR_CompareInterruptEnable);
+  /* Interrupt TMR2_IRQn request in the NVIC is not initialized (disabled by default). */
+  /* It can be enabled later by EnableIRQ(TMR2_IRQN);  function call. */
+  /* Start the timer - select the timer counting mode */
+  QTMR_StartTimer(TMR2_PERIPHERAL, TMR2_CHANNEL_0_CHANNEL, kQTMR_PriSrcRiseEdge);
+  /* Start the timer - select the timer counting mode */
+  QTMR_StartTimer(TMR2_PERIPHERAL, TMR2_CHANNEL_1_CHANNEL, kQTMR_CascadeCount);
+}
+
 /***********************************************************************************************************************
  * Initialization functions
  **********************************************************************************************************************/
@@ -846,16 +853,21 @@ void BOARD_InitPeripherals(void)
 {
   /* Initialize components */
   LPI2C4_init();
-  LPUART1_init();
   SEMC_init();
   GPIO1_init();
   GPT1_init();
   LPI2C1_init();
-  TMR2_init();
   GPIO5_init();
   TRNG_init();
 }
 
+void BOARD_InitLatePeripherals(void)
+{
+  /* Initialize components */
+  LPUART1_init();
+  TMR2_init();
+}
+
 /***********************************************************************************************************************
  * BOARD_InitBootPeripherals function
  **********************************************************************************************************************/
@@ -36,10 +36,6 @@ extern "C" {
 #define LPI2C4_MASTER_BUFFER_SIZE 1
 /* Definition of slave address */
 #define LPI2C4_MASTER_SLAVE_ADDRESS 0
-/* Definition of peripheral ID */
-#define LPUART1_PERIPHERAL LPUART1
-/* Definition of the clock source frequency */
-#define LPUART1_CLOCK_SOURCE 80000000UL
 /* BOARD_InitPeripherals defines for SEMC */
 /* Definition of peripheral ID. */
 #define SEMC_PERIPHERAL SEMC
@@ -65,6 +61,13 @@ extern "C" {
 /* Definition of slave address */
 #define LPI2C1_MASTER_SLAVE_ADDRESS 0
 /* Definition of peripheral ID */
+#define TRNG_PERIPHERAL TRNG
+/* Definitions for BOARD_InitLatePeripherals functional group */
+/* Definition of peripheral ID */
+#define LPUART1_PERIPHERAL LPUART1
+/* Definition of the clock source frequency */
+#define LPUART1_CLOCK_SOURCE 80000000UL
+/* Definition of peripheral ID */
 #define TMR2_PERIPHERAL TMR2
 /* Definition of the timer channel Channel_0. */
 #define TMR2_CHANNEL_0_CHANNEL kQTMR_Channel_0
@@ -78,8 +81,6 @@ extern "C" {
 #define TMR2_IRQN TMR2_IRQn
 /* TMR2 interrupt handler identifier. */
 #define TMR2_IRQHANDLER TMR2_IRQHandler
-/* Definition of peripheral ID */
-#define TRNG_PERIPHERAL TRNG
 
 /***********************************************************************************************************************
  * Global variables
@@ -88,7 +89,6 @@ extern const lpi2c_master_config_t LPI2C4_masterConfig;
 extern lpi2c_master_transfer_t LPI2C4_masterTransfer;
 extern uint8_t LPI2C4_masterBuffer[LPI2C4_MASTER_BUFFER_SIZE];
 extern lpi2c_master_handle_t LPI2C4_masterHandle;
-extern const lpuart_config_t LPUART1_config;
 extern semc_config_t SEMC_config;
 extern semc_sdram_config_t SEMC_sdram_struct;
 extern const gpt_config_t GPT1_config;
@@ -96,15 +96,17 @@ extern const lpi2c_master_config_t LPI2C1_masterConfig;
 extern lpi2c_master_transfer_t LPI2C1_masterTransfer;
 extern uint8_t LPI2C1_masterBuffer[LPI2C1_MASTER_BUFFER_SIZE];
 extern lpi2c_master_handle_t LPI2C1_masterHandle;
+extern const trng_config_t TRNG_config;
+extern const lpuart_config_t LPUART1_config;
 extern const qtmr_config_t TMR2_Channel_0_config;
 extern const qtmr_config_t TMR2_Channel_1_config;
-extern const trng_config_t TRNG_config;
 
 /***********************************************************************************************************************
  * Initialization functions
  **********************************************************************************************************************/
 
 void BOARD_InitPeripherals(void);
+void BOARD_InitLatePeripherals(void);
 
 /***********************************************************************************************************************
  * BOARD_InitBootPeripherals function
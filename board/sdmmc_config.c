@@ -7,6 +7,7 @@
 
 #include "sdmmc_config.h"
 #include "fsl_iomuxc.h"
+#include "rlic_dmabuf.h"
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
@@ -23,9 +24,10 @@ void BOARD_SDCardPowerControl(bool enable);
 AT_NONCACHEABLE_SECTION_ALIGN(static uint32_t s_sdmmcHostDmaBuffer[BOARD_SDMMC_HOST_DMA_DESCRIPTOR_BUFFER_SIZE],
                               SDMMCHOST_DMA_DESCRIPTOR_BUFFER_ALIGN_SIZE);
 #if defined SDMMCHOST_ENABLE_CACHE_LINE_ALIGN_TRANSFER && SDMMCHOST_ENABLE_CACHE_LINE_ALIGN_TRANSFER
-/* two cache line length for sdmmc host driver maintain unalign transfer */
-SDK_ALIGN(static uint8_t s_sdmmcCacheLineAlignBuffer[BOARD_SDMMC_DATA_BUFFER_ALIGN_SIZE * 2U],
-          BOARD_SDMMC_DATA_BUFFER_ALIGN_SIZE);
+/* two cache line length for sdmmc host driver maintain unalign transfer,
+ * DMA bounce buffer so keep it next to the descriptors in non-cacheable RAM */
+AT_NONCACHEABLE_SECTION_ALIGN(static uint8_t s_sdmmcCacheLineAlignBuffer[BOARD_SDMMC_DATA_BUFFER_ALIGN_SIZE * 2U],
+                              BOARD_SDMMC_DATA_BUFFER_ALIGN_SIZE);
 #endif
 #if defined(SDIO_ENABLED) || defined(SD_ENABLED)
 static sd_detect_card_t s_cd;
@@ -301,3 +303,9 @@ void BOARD_MMC_Config(void *card, uint32_t hostIRQPriority)
     NVIC_SetPriority(BOARD_SDMMC_MMC_HOST_IRQ, hostIRQPriority);
 }
 #endif
+
+/* DMA pool buffers and TCM skip the host driver's cache maintenance, see rlic_dmabuf.h */
+bool SDMMCHOST_IsCacheCoherent(const void *buffer, uint32_t size, bool receive)
+{
+    return RLIC_DmaBuf_Transfer(buffer, size, receive);
+}
@@ -17,6 +17,7 @@
 #include "fsl_os_abstraction.h"
 #include "fsl_os_abstraction_bm.h"
 #include <string.h>
+#include "rlic_mempool.h"
 
 /*! *********************************************************************************
 *************************************************************************************
@@ -180,7 +181,11 @@ static osa_state_t s_osaState;
  *END**************************************************************************/
 void *OSA_MemoryAllocate(uint32_t length)
 {
+#if RLIC_MEMPOOL_ENABLE
+    void *p = RLIC_MemPool_AllocAny(length);
+#else
     void *p = (void *)malloc(length);
+#endif
 
     if (NULL != p)
     {
@@ -198,7 +203,11 @@ void *OSA_MemoryAllocate(uint32_t length)
  *END**************************************************************************/
 void OSA_MemoryFree(void *p)
 {
+#if RLIC_MEMPOOL_ENABLE
+    RLIC_MemPool_FreeAny(p);
+#else
     free(p);
+#endif
 }
 
 void OSA_EnterCritical(uint32_t *sr)
@@ -11,6 +11,8 @@
 
 #ifdef FSL_RTOS_FREE_RTOS
 #include "FreeRTOS.h"
+#else
+#include "rlic_mempool.h"
 #endif
 
 /*------------------------------------------------------------------------*/
@@ -23,6 +25,8 @@ void* ff_memalloc (	/* Returns pointer to the allocated memory block (null if no
 {
 #ifdef FSL_RTOS_FREE_RTOS
     return pvPortMalloc(msize);
+#elif RLIC_MEMPOOL_ENABLE
+	return RLIC_MemPool_AllocAny(msize);	/* Size-class pool, then the heap */
 #else
 	return malloc(msize);	/* Allocate a new memory block with POSIX API */
 #endif
@@ -39,6 +43,8 @@ void ff_memfree (
 {
 #ifdef FSL_RTOS_FREE_RTOS
     vPortFree(mblock);
+#elif RLIC_MEMPOOL_ENABLE
+	RLIC_MemPool_FreeAny(mblock);
 #else
 	free(mblock);	/* Free the memory block with POSIX API */
 #endif
@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "fsl_sd_disk.h"
+#include "sdmmc_config.h"
 
 /*******************************************************************************
  * Definitons
@@ -24,6 +25,9 @@
 /*******************************************************************************
  * Prototypes
  ******************************************************************************/
+static status_t sd_bus_init(void *ctx, const rlic_sd_bus_limit_t *limit);
+static void sd_bus_get_info(void *ctx, rlic_sd_bus_info_t *info);
+static bool sd_bus_present(void *ctx);
 
 /*******************************************************************************
  * Variables
@@ -32,17 +36,87 @@
 /*! @brief Card descriptor */
 sd_card_t g_sd;
 
+/*! @brief Bus mode ladder of g_sd */
+rlic_sd_bus_t g_sdBus;
+
+static const rlic_sd_bus_ops_t s_sdBusOps = {
+    .init    = sd_bus_init,
+    .getInfo = sd_bus_get_info,
+    .present = sd_bus_present,
+};
+
+/* board IO voltage switch, replaced by s_sdIoVoltage330 in 3.3 V modes */
+static sd_io_voltage_t *s_sdIoVoltage;
+static uint32_t s_sdMaxFreq;
+static sd_io_voltage_t s_sdIoVoltage330 = {
+    .type = kSD_IOVoltageCtrlNotSupport,
+    .func = NULL,
+};
+
 /*******************************************************************************
  * Code
  ******************************************************************************/
+/*!
+ * @brief Identify the card within the limits of one bus mode.
+ *
+ * SD_CardInit() starts its UHS-I timing search at currentTiming and caps
+ * the clock at usrParam.maxFreq; without an IO voltage switch it stays at
+ * 3.3 V. A card left in 1.8 V signalling is powered off and the pads put
+ * back to 3.3 V first, SD_Init() powers it up again.
+ */
+static status_t sd_bus_init(void *ctx, const rlic_sd_bus_limit_t *limit)
+{
+    sd_card_t *card = (sd_card_t *)ctx;
+
+    if (!limit->allow1V8 && (card->operationVoltage == kSDMMC_OperationVoltage180V))
+    {
+        SD_SetCardPower(card, false);
+        if (s_sdIoVoltage->type == kSD_IOVoltageCtrlByHost)
+        {
+            SDMMCHOST_SwitchToVoltage(card->host, (uint32_t)kSDMMC_OperationVoltage330V);
+        }
+        else if ((s_sdIoVoltage->type == kSD_IOVoltageCtrlByGpio) && (s_sdIoVoltage->func != NULL))
+        {
+            s_sdIoVoltage->func(kSDMMC_OperationVoltage330V);
+        }
+    }
+
+    card->currentTiming      = (sd_timing_mode_t)limit->timing;
+    card->usrParam.maxFreq   = limit->maxHz;
+    card->usrParam.ioVoltage = limit->allow1V8 ? s_sdIoVoltage : &s_sdIoVoltage330;
+
+    return SD_Init(card);
+}
+
+static void sd_bus_get_info(void *ctx, rlic_sd_bus_info_t *info)
+{
+    sd_card_t *card = (sd_card_t *)ctx;
+
+    info->timing  = (uint32_t)card->currentTiming;
+    info->clockHz = card->busClock_Hz;
+    info->width   = ((card->flags & (uint32_t)kSD_Support4BitWidthFlag) != 0U) ? 4U : 1U;
+    info->is1V8   = (card->operationVoltage == kSDMMC_OperationVoltage180V);
+}
+
+static bool sd_bus_present(void *ctx)
+{
+    return SD_IsCardPresent((sd_card_t *)ctx);
+}
+
 DRESULT sd_disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count)
 {
+    status_t status;
+
     if (pdrv != SDDISK)
     {
         return RES_PARERR;
     }
 
-    if (kStatus_Success != SD_WriteBlocks(&g_sd, buff, sector, count))
+    do
+    {
+        status = SD_WriteBlocks(&g_sd, buff, sector, count);
+    } while (RLIC_SdBus_Retry(&g_sdBus, status));
+    if (kStatus_Success != status)
     {
         return RES_ERROR;
     }
@@ -52,12 +126,18 @@ DRESULT sd_disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count)
 
 DRESULT sd_disk_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count)
 {
+    status_t status;
+
     if (pdrv != SDDISK)
     {
         return RES_PARERR;
     }
 
-    if (kStatus_Success != SD_ReadBlocks(&g_sd, buff, sector, count))
+    do
+    {
+        status = SD_ReadBlocks(&g_sd, buff, sector, count);
+    } while (RLIC_SdBus_Retry(&g_sdBus, status));
+    if (kStatus_Success != status)
     {
         return RES_ERROR;
     }
@@ -129,12 +209,30 @@ DSTATUS sd_disk_status(BYTE pdrv)
 
 DSTATUS sd_disk_initialize(BYTE pdrv)
 {
+    uint32_t top = RLIC_SD_BUS_TOP;
+
     if (pdrv != SDDISK)
     {
         return STA_NOINIT;
     }
 
-    if (kStatus_Success != SD_Init(&g_sd))
+    /* board limits, as BOARD_SD_Config() left them */
+    if (s_sdIoVoltage == NULL)
+    {
+        s_sdIoVoltage = (g_sd.usrParam.ioVoltage != NULL) ? g_sd.usrParam.ioVoltage : &s_sdIoVoltage330;
+        s_sdMaxFreq   = g_sd.usrParam.maxFreq;
+    }
+    /* UHS-I needs the IO voltage switch */
+    if ((s_sdIoVoltage->type == kSD_IOVoltageCtrlNotSupport) || (SDMMCHOST_INSTANCE_SUPPORT_1V8_SIGNAL(g_sd.host) == 0U))
+    {
+        top = (top > RLIC_SD_BUS_HIGH_SPEED) ? top : RLIC_SD_BUS_HIGH_SPEED;
+    }
+#if !SDMMCHOST_SUPPORT_SDR104
+    top = (top > RLIC_SD_BUS_SDR50) ? top : RLIC_SD_BUS_SDR50;
+#endif
+    RLIC_SdBus_Init(&g_sdBus, &s_sdBusOps, &g_sd, top, s_sdMaxFreq);
+
+    if (kStatus_Success != RLIC_SdBus_Start(&g_sdBus))
     {
         SD_Deinit(&g_sd);
         memset(&g_sd, 0U, sizeof(g_sd));
@@ -14,6 +14,7 @@
 #include "ff.h"
 #include "diskio.h"
 #include "fsl_sd.h"
+#include "rlic_sd_bus.h"
 
 /*!
  * @addtogroup SD Disk
@@ -30,6 +31,7 @@
  * Variables
  ******************************************************************************/
 extern sd_card_t g_sd; /* sd card descriptor */
+extern rlic_sd_bus_t g_sdBus; /* bus mode of g_sd */
 
 /*************************************************************************************************
  * API
@@ -313,11 +313,20 @@ void SDMMCHOST_InstallCacheAlignBuffer(sdmmchost_t *host, void *cacheAlignBuffer
 }
 #endif
 
+/*!
+ * brief Whether a data buffer needs no cache maintenance, default no.
+ */
+__WEAK bool SDMMCHOST_IsCacheCoherent(const void *buffer, uint32_t size, bool receive)
+{
+    return false;
+}
+
 status_t SDMMCHOST_TransferFunction(sdmmchost_t *host, sdmmchost_transfer_t *content)
 {
     status_t error = kStatus_Success;
     uint32_t event = 0U;
     usdhc_adma_config_t dmaConfig;
+    bool coherent = false;
 
 #if SDMMCHOST_ENABLE_CACHE_LINE_ALIGN_TRANSFER
     usdhc_scatter_gather_data_list_t sgDataList0;
@@ -338,6 +347,11 @@ status_t SDMMCHOST_TransferFunction(sdmmchost_t *host, sdmmchost_transfer_t *con
         dmaConfig.admaTable      = host->dmaDesBuffer;
         dmaConfig.admaTableWords = host->dmaDesBufferWordsNum;
 
+        /* buffers the D-cache never holds need neither maintenance nor the unaligned split */
+        coherent = SDMMCHOST_IsCacheCoherent(
+            content->data->txData == NULL ? (const void *)content->data->rxData : (const void *)content->data->txData,
+            (content->data->blockSize) * (content->data->blockCount), content->data->rxData != NULL);
+
 #if SDMMCHOST_ENABLE_CACHE_LINE_ALIGN_TRANSFER
 
         if ((host->cacheAlignBuffer == NULL) || ((host->cacheAlignBufferSize == 0U)))
@@ -391,7 +405,7 @@ status_t SDMMCHOST_TransferFunction(sdmmchost_t *host, sdmmchost_transfer_t *con
          *
          * At last, cache line unalign transfer done
          */
-        if ((content->data->rxData != NULL) &&
+        if ((content->data->rxData != NULL) && !coherent &&
             (((uint32_t)content->data->rxData % SDMMC_DATA_BUFFER_ALIGN_CACHE) != 0U))
         {
             unAlignSize          = ((uint32_t)content->data->rxData -
@@ -415,7 +429,7 @@ status_t SDMMCHOST_TransferFunction(sdmmchost_t *host, sdmmchost_transfer_t *con
 
 #if ((defined __DCACHE_PRESENT) && __DCACHE_PRESENT) || (defined FSL_FEATURE_HAS_L1CACHE && FSL_FEATURE_HAS_L1CACHE)
 #if !(defined(FSL_SDK_ENABLE_DRIVER_CACHE_CONTROL) && FSL_SDK_ENABLE_DRIVER_CACHE_CONTROL)
-        if (host->enableCacheControl == kSDMMCHOST_CacheControlRWBuffer)
+        if ((host->enableCacheControl == kSDMMCHOST_CacheControlRWBuffer) && !coherent)
         {
             /* no matter read or write transfer, clean the cache line anyway to avoid data miss */
             DCACHE_CleanByRange(
@@ -472,7 +486,7 @@ status_t SDMMCHOST_TransferFunction(sdmmchost_t *host, sdmmchost_transfer_t *con
         if ((content->data != NULL) && (content->data->rxData != NULL))
         {
 #if SDMMCHOST_ENABLE_CACHE_LINE_ALIGN_TRANSFER
-            if (((uint32_t)content->data->rxData % SDMMC_DATA_BUFFER_ALIGN_CACHE) != 0U)
+            if (!coherent && (((uint32_t)content->data->rxData % SDMMC_DATA_BUFFER_ALIGN_CACHE) != 0U))
             {
 #if ((defined __DCACHE_PRESENT) && __DCACHE_PRESENT) || (defined FSL_FEATURE_HAS_L1CACHE && FSL_FEATURE_HAS_L1CACHE)
 #if !(defined(FSL_SDK_ENABLE_DRIVER_CACHE_CONTROL) && FSL_SDK_ENABLE_DRIVER_CACHE_CONTROL)
@@ -498,7 +512,7 @@ status_t SDMMCHOST_TransferFunction(sdmmchost_t *host, sdmmchost_transfer_t *con
 #if ((defined __DCACHE_PRESENT) && __DCACHE_PRESENT) || (defined FSL_FEATURE_HAS_L1CACHE && FSL_FEATURE_HAS_L1CACHE)
 #if !(defined(FSL_SDK_ENABLE_DRIVER_CACHE_CONTROL) && FSL_SDK_ENABLE_DRIVER_CACHE_CONTROL)
                 /* invalidate the cache for read */
-                if (host->enableCacheControl == kSDMMCHOST_CacheControlRWBuffer)
+                if ((host->enableCacheControl == kSDMMCHOST_CacheControlRWBuffer) && !coherent)
                 {
                     DCACHE_InvalidateByRange((uint32_t)content->data->rxData,
                                              (content->data->blockSize) * (content->data->blockCount));
@@ -419,6 +419,17 @@ void SDMMCHOST_Deinit(sdmmchost_t *host);
  */
 void SDMMCHOST_SetCardPower(sdmmchost_t *host, bool enable);
 
+/*!
+ * @brief Whether a data buffer needs no cache maintenance.
+ * Asked before every data transfer; a true answer skips the clean/invalidate
+ * by range and the unaligned split. The application overrides it for
+ * buffers in memory the D-cache does not hold, the default says false.
+ * @param buffer transfer data buffer.
+ * @param size transfer size in bytes.
+ * @param receive true for a read from the card.
+ */
+bool SDMMCHOST_IsCacheCoherent(const void *buffer, uint32_t size, bool receive);
+
 #if SDMMCHOST_ENABLE_CACHE_LINE_ALIGN_TRANSFER
 /*!
  * @brief Install cache line size align buffer for the transfer require cache line size align.
@@ -30,6 +30,14 @@ void SDMMC_OSAInit(void)
     /* Intentional empty */
 }
 
+/*!
+ * brief Idle while an event is pending, default does nothing.
+ */
+__WEAK void SDMMC_OSAIdle(void)
+{
+    /* Intentional empty */
+}
+
 /*!
  * brief OSA Create event.
  * param event handle.
@@ -66,7 +74,14 @@ status_t SDMMC_OSAEventWait(void *eventHandle, uint32_t eventType, uint32_t time
 #if defined(SDMMC_OSA_POLLING_EVENT_BY_SEMPHORE) && SDMMC_OSA_POLLING_EVENT_BY_SEMPHORE
     while (true)
     {
+        /* interrupts held off so a completion between the poll and the idle hook still wakes it */
+        uint32_t regPrimask = DisableGlobalIRQ();
         status = OSA_SemaphoreWait(&(((sdmmc_osa_event_t *)eventHandle)->handle), timeoutMilliseconds);
+        if (KOSA_StatusIdle == status)
+        {
+            SDMMC_OSAIdle();
+        }
+        EnableGlobalIRQ(regPrimask);
         if (KOSA_StatusTimeout == status)
         {
             break;
@@ -85,7 +100,13 @@ status_t SDMMC_OSAEventWait(void *eventHandle, uint32_t eventType, uint32_t time
 #else
     while (true)
     {
+        uint32_t regPrimask = DisableGlobalIRQ();
         status = OSA_EventWait(&(((sdmmc_osa_event_t *)eventHandle)->handle), eventType, 0, timeoutMilliseconds, event);
+        if (KOSA_StatusIdle == status)
+        {
+            SDMMC_OSAIdle();
+        }
+        EnableGlobalIRQ(regPrimask);
         if ((KOSA_StatusSuccess == status) || (KOSA_StatusTimeout == status))
         {
             break;
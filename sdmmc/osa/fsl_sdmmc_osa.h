@@ -61,6 +61,13 @@ extern "C" {
  */
 void SDMMC_OSAInit(void);
 
+/*!
+ * @brief Idle while an event is pending.
+ * Called with interrupts disabled, may WFI (a pending interrupt still wakes
+ * the core); the application overrides it, the default does nothing.
+ */
+void SDMMC_OSAIdle(void);
+
 /*!
  * @brief OSA Create event.
  * @param eventHandle event handle.
@@ -39,15 +39,20 @@
 #include "Adafruit_TSL2591.h"
 #include "HT16K33_Simple.h"
 #include "QLearning.h"
+#include "RLIC_Zone.h"
 #include "fsl_wdog.h"
+#include "rlic_section.h"
+#include "rlic_cycles.h"
+#include "rlic_i2c_bus.h"
+#include "rlic_dmabuf.h"
+#include "rlic_mempool.h"
+#include "rlic_boot.h"
 
 #define RLIC_LED_GPIO			BOARD_USER_LED_GPIO
 #define RLIC_LED_GPIO_PIN		BOARD_USER_LED_GPIO_PIN
 #define RLIC_WDOG_BASE			WDOG1
 #define RLIC_APP_EXIT_GPIO		BOARD_INITPINS_USER_BUTTON_GPIO
 #define RLIC_APP_EXIT_GPIO_PIN	BOARD_INITPINS_USER_BUTTON_GPIO_PIN
-#define RLIC_EXPLORE_STRING		"[EXPLORE]"
-#define RLIC_EXPLOIT_STRING		"[EXPLOIT]"
 
 #define QTMR_CLOCK_SOURCE_DIVIDER (128U)
 /* The frequency of the source clock after divided. */
@@ -56,16 +61,14 @@
 /* The PIN status */
 static uint8_t g_pinSet = false;
 
-/* Adafruit light sensor init */
-static Adafruit_TSL2591 tsl = Adafruit_TSL2591(2591);
-/* Adafruit LEDs init */
+/* Adafruit LEDs init, day light; the zones own their sensor and LEDs */
 static HT16K33_Simple ledControl;
 static volatile bool dayReset = true;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
-void TMR2_IRQHANDLER(void) {
+RLIC_HOT_CODE void TMR2_IRQHANDLER(void) {
 
 	/* Clear interrupt flag.*/
 	QTMR_ClearStatusFlags(TMR2_PERIPHERAL, TMR2_CHANNEL_1_CHANNEL,
@@ -84,49 +87,104 @@ void TMR2_IRQHANDLER(void) {
  * @brief   Application entry point.
  */
 int main(void) {
-	QLearning qlearn;
-	Brightness brightness = { 0, 0 };
+	/* reset handler to here: SystemInit, RAM init, static constructors */
+	RLIC_Boot_Mark("startup");
+
+	RLIC_Zone zones[RLIC_ZONES] = RLIC_ZONE_TABLE;
+	rlic_zone_sched_t sched;
 	uint32_t dayStartOffset = 0;
 	uint32_t dayTimeMS = 0;
-	uint16_t luxT = 0;
-	uint32_t idx = 0;
-	uint8_t reward = 0;
+	uint32_t waitMS = 0;
+	bool storageReady = false;
+	bool restored = false;
+
+	RLIC_Boot_Mark("learners");
 
 	/* Init board hardware. */
 	BOARD_ConfigMPU();
 	BOARD_InitBootPins();
 	BOARD_InitBootClocks();
+	RLIC_Boot_Mark("clocks");
+	/* what the restore needs; GPT1 too, SysTick_Init() takes it over */
 	BOARD_InitBootPeripherals();
-
-#ifndef BOARD_INIT_DEBUG_CONSOLE_PERIPHERAL
-	/* Init FSL debug console. */
-	BOARD_InitDebugConsole();
-#endif
+	RLIC_Boot_Mark("peripherals");
 
 	/*Clock setting for LPI2C*/
 	CLOCK_SetMux(kCLOCK_Lpi2cMux, BOARD_ACCEL_I2C_CLOCK_SOURCE_SELECT);
 	CLOCK_SetDiv(kCLOCK_Lpi2cDiv, BOARD_ACCEL_I2C_CLOCK_SOURCE_DIVIDER);
+	/* buses again at their real root clock, with recovery */
+	BOARD_I2C_BusInit();
 
 	SysTick_Init();
+	RLIC_Boot_Mark("i2c, tick");
+
+	/* the LEDs back as they were before anything that prints or waits */
+	for (uint32_t z = 0; z < RLIC_ZONES; z++)
+		restored |= zones[z].restoreAction();
+	if (restored)
+		RLIC_Boot_Action(RLIC_BOOT_RESTORED);
+	RLIC_Boot_Mark("restore");
+
+	/* the rest can come up behind the restored action */
+	BOARD_InitLatePeripherals(); /* LPUART1, TMR2 day cycle */
+	RLIC_Boot_Mark("uart, day timer");
+#ifndef BOARD_INIT_DEBUG_CONSOLE_PERIPHERAL
+	/* Init FSL debug console. */
+	BOARD_InitDebugConsole();
+#endif
+#if RLIC_PROFILE_STEP
+	RLIC_CyclesInit();
+#endif
 
 	PRINTF("Reinforcement Learning Based Illumination Controller\n");
-	tsl.printSensorDetails();
-	tsl.configureSensor();
+	BOARD_I2C_PrintBuses();
+	RLIC_Boot_Mark("console");
 
-	/* HT16K33 Init */
+	/* HT16K33 Init, before the sensors first see the day light */
 	ledControl.initHT16K33();
+	RLIC_Boot_Mark("day light");
+
+	RLIC_ZoneSched_Init(&sched, RLIC_ZONE_MODE, SysTick_UptimeMS);
+	for (uint32_t z = 0; z < RLIC_ZONES; z++) {
+		zones[z].init();
+		if (zones[z].schedule(&sched) != kStatus_Success)
+			goto FAILED;
+	}
+	RLIC_Boot_Mark("zones");
+#if RLIC_I2C_BENCHMARK
+	BOARD_I2C_Benchmark();
+#endif
 
+#if RLIC_SD_BENCHMARK
+	/* user button held at boot: measure the card before running */
+	if (0 == GPIO_PinRead(RLIC_APP_EXIT_GPIO, RLIC_APP_EXIT_GPIO_PIN)) {
+		if (!zones[0].initStorage())
+			goto FAILED;
+		storageReady = true;
+		if (RLIC_Zone::benchStorage() != kStatus_Success)
+			PRINTF("SD benchmark failed\n");
+		/* released, or it would read as the exit request */
+		while (0 == GPIO_PinRead(RLIC_APP_EXIT_GPIO, RLIC_APP_EXIT_GPIO_PIN))
+			SysTick_DelayTicksMS(50);
+	}
+#endif
+#if RLIC_I2C_BENCHMARK || RLIC_SD_BENCHMARK
+	RLIC_Boot_Mark("benchmarks");
+#endif
+
+#if !RLIC_STORAGE_BACKGROUND
 	/* mount SDCard */
-	if (!qlearn.initQStorage())
+	if (!storageReady && !zones[0].initStorage())
 		goto FAILED;
+	storageReady = true;
+	PRINTF("[boot] RLIC.dat ready at %d ms\n", SysTick_UptimeMS());
+	RLIC_Boot_Mark("storage");
+#endif
 
 	/* Enable Day cycle Timer */
 	EnableIRQ(TMR2_IRQN);
 
 	while (1) {
-		bool exep = false;
-		const char *exepstr = RLIC_EXPLOIT_STRING;
-
 		if (dayReset) {
 			dayStartOffset = SysTick_UptimeMS();
 			dayTimeMS = 0;
@@ -134,38 +192,41 @@ int main(void) {
 		} else {
 			dayTimeMS = SysTick_UptimeMS() - dayStartOffset;
 		}
+		RLIC_Zone::setDayTimeMS(dayTimeMS);
 
-		/* Explore or Exploit */
-		exep = qlearn.runExploreExploit();
-
-		/* get LED and Dimm values */
-		idx = qlearn.getQBrightness(brightness, dayTimeMS, exep, true);
-		if (idx > QTABLE_ENTRIES_MAX)
+		/* finish due steps, start new ones */
+		if (RLIC_ZoneSched_Run(&sched, &waitMS) != kStatus_Success)
 			goto FAILED;
 
-		/* set LEDs and Dimm */
-		ledControl.setLedBrightness(brightness.numOnLeds, brightness.duty);
-
-		/* Sence the brightness */
-		luxT = tsl.getLuminosity(TSL2591_VISIBLE);
-		/* twice gives better accuracy */
-		luxT = tsl.getLuminosity(TSL2591_VISIBLE);
-
-		/* Calculate reward */
-		reward = qlearn.getReward(luxT);
-
-		if (exep)
-			exepstr = RLIC_EXPLORE_STRING;
-
-		PRINTF("[%ld ms] [%ld] numOnLeds: %d duty; %d Lum: %d reward: %d %s\n",
-				dayTimeMS, idx, brightness.numOnLeds, brightness.duty, luxT,
-				reward, exepstr);
+#if RLIC_ZONE_REPORT_STEPS
+		if (sched.steps >= RLIC_ZONE_REPORT_STEPS) {
+			RLIC_ZoneSched_PrintStats(&sched);
+			RLIC_ZoneSched_ResetStats(&sched);
+		}
+#endif
 
-		/* update learned data */
-		if (!qlearn.updateQTable(brightness, reward, idx))
-			goto FAILED;
+		/* bring the card up in the sensor waits, a step at least per pass */
+		while (!storageReady) {
+			uint32_t startMS = SysTick_UptimeMS();
+			uint32_t elapsedMS;
+
+			if (RLIC_Zone::pollStorage(&storageReady) != kStatus_Success)
+				goto FAILED;
+			if (storageReady)
+				PRINTF("[boot] RLIC.dat ready at %d ms\n", SysTick_UptimeMS());
+
+			elapsedMS = SysTick_UptimeMS() - startMS;
+			if (elapsedMS >= waitMS) {
+				waitMS = 0;
+				break;
+			}
+			waitMS -= elapsedMS;
+		}
 
-		//qlearn.__printQTable(idx);
+		/* all zones sensing, sleep until the first is due */
+		if (waitMS)
+			SysTick_IdleMS(waitMS);
+		SysTick_IdleReport();
 
 		g_pinSet ^= 1;
 		GPIO_PinWrite(RLIC_LED_GPIO, RLIC_LED_GPIO_PIN, g_pinSet);
@@ -178,12 +239,22 @@ int main(void) {
 FAILED:
 	PRINTF("Board Runtime Failed. Resetting..\n");
 	/* close storage to avoid corrupting the file */
-	qlearn.closeQStorage();
+	zones[0].closeStorage();
+	BOARD_I2C_PrintStats();
+	RLIC_ZoneSched_PrintStats(&sched);
+	SysTick_IdlePrintStats();
+	RLIC_DmaBuf_PrintStats();
+	RLIC_MemPool_PrintStats();
 	WDOG_TriggerSystemSoftwareReset(RLIC_WDOG_BASE);
 
 	/* graceful exit */
 APPEXIT:
-	qlearn.closeQStorage();
+	zones[0].closeStorage();
+	BOARD_I2C_PrintStats();
+	RLIC_ZoneSched_PrintStats(&sched);
+	SysTick_IdlePrintStats();
+	RLIC_DmaBuf_PrintStats();
+	RLIC_MemPool_PrintStats();
 	while (1) {
 		g_pinSet ^= 1;
 		GPIO_PinWrite(RLIC_LED_GPIO, RLIC_LED_GPIO_PIN, g_pinSet);
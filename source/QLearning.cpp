@@ -24,9 +24,17 @@
 /*! @file */
 #include <QLearning.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include "fsl_debug_console.h"
 #include "fsl_trng.h"
+#include "rlic_section.h"
+#include "rlic_crc32.h"
+#include "rlic_argmax.h"
+#include "rlic_tiles.h"
+#include "rlic_queue.h"
+#include "rlic_dmabuf.h"
+#include "rlic_mempool.h"
 
 #define QLEARN_EXPLORE_MIN	(0) /* percent explore */
 #define QLEARN_EXPLORE_MAX	(100)
@@ -41,19 +49,191 @@
 #define QLEARN_FAST_LEARN	(false)
 #define QLEARN_PRUNECTR_MAX	(3)
 
+/*
+ * Warm start: a slot with few learned actions has its untried ones filled
+ * from the last slot the zone learned, if that is close enough in day time.
+ * The neighbour is the table still in RAM, so it costs no card access.
+ * Seeded values only steer the slot while it is in RAM: they are taken out
+ * of what goes back to the card, and a cell is learned once it is tried.
+ */
+#define QLEARN_WARM_SLOTS	(60) /* 30 s of day time either side */
+#define QLEARN_WARM_CELLS	(8) /* learned actions for a slot to stand alone */
+#define QLEARN_NO_SLOT		(QTABLE_ENTRIES_MAX + 1)
+
+/*
+ * Until RLIC.dat is up, see startQStorage(), a zone is driven by a hill
+ * climb of the LED count on the reward at full duty. Its steps are kept
+ * and learned from the card afterwards, a few per control step so the
+ * card reads and writes stay within what one step costs anyway.
+ */
+#define QLEARN_DEFAULT_LEDS	(32) /* half the matrix */
+#define QLEARN_DEFAULT_STEP	(4)
+#define QLEARN_REPLAY_STEPS	(8)
+
+static_assert((QLEARN_BACKLOG_MAX & (QLEARN_BACKLOG_MAX - 1)) == 0,
+		"QLEARN_BACKLOG_MAX must be a power of 2");
+
+typedef struct {
+	uint16_t idx;
+	uint8_t numOnLeds;
+	uint8_t duty :4;
+	uint8_t reward :4;
+} qlearn_step_t;
+
+static Ring_SPSC<qlearn_step_t, QLEARN_BACKLOG_MAX> s_backlog[QLEARN_ZONES_MAX];
+static uint32_t s_backlogDropped[QLEARN_ZONES_MAX];
+static uint8_t s_defaultLeds[QLEARN_ZONES_MAX];
+static int8_t s_defaultDir[QLEARN_ZONES_MAX];
+static uint8_t s_defaultReward[QLEARN_ZONES_MAX];
+
+/*
+ * Exploration draws come from a xorshift32 stream per zone, not rand(): the
+ * C library's generator differs between newlib and a host, and a shared
+ * stream depends on how zone steps interleave. With its own generator a
+ * learner makes the same draws for the same seed wherever it runs, so a
+ * recorded step trace (rlic_trace.h) replays exactly.
+ */
+#define QLEARN_RAND_MIX		(0x9E3779B9U) /* zone streams apart */
+static uint32_t s_randSeed;
+static uint32_t s_rand[QLEARN_ZONES_MAX];
+
+#if QLEARN_TILE_CODING
+/*
+ * Tile coding: all weights start at the top reward, so actions not tried
+ * yet look best and get tried, the job the prune counters do for the
+ * table. Weights go to the first entries of the zone in RLIC.dat, a card
+ * from a Q table build starts over in those two slots.
+ */
+#define QLEARN_TILE_INIT		(10) /* getReward() maximum */
+#define QLEARN_TILE_SAVE_STEPS	(1024)
+#define QLEARN_TILE_CHUNKS		(2)
+#define QLEARN_TILE_CHUNK_SZ	(sizeof(rlic_tiles_weights_t) / QLEARN_TILE_CHUNKS)
+
+static_assert((sizeof(rlic_tiles_weights_t) % QLEARN_TILE_CHUNKS) == 0,
+		"weights must split evenly");
+static_assert(QLEARN_TILE_CHUNK_SZ <= (4 * 1024 - 16),
+		"weights chunk must fit one RLIC.dat entry");
+static_assert((RLIC_TILES_LED_VALUES == (QTABLE_ONLED_MAX + 1))
+		&& (RLIC_TILES_DUTY_VALUES == (QTABLE_DIMM_MAX + 1))
+		&& (RLIC_TILES_TIME_VALUES == (QTABLE_ENTRIES_MAX + 1)),
+		"tiles must cover the Q table actions and slots");
+
+/* hot data: DTCM, see rlic_section.h. Weights and action values per zone */
+RLIC_HOT_DATA SDK_ALIGN(static rlic_tiles_t s_tiles[QLEARN_ZONES_MAX],
+		BOARD_SDMMC_DATA_BUFFER_ALIGN_SIZE);
+static uint32_t s_tileSteps[QLEARN_ZONES_MAX];
+#else
 /* main and pruned Q table */
 enum qtable_idx_t {
 	QTABLE_IDX = 0, QTABLE_PRUNED_IDX,
 };
 
-SDK_ALIGN(static uint8_t qtable[2][QTABLE_ONLED_MAX + 1][QTABLE_DIMM_MAX + 1],
+/* hot data: DTCM, see rlic_section.h. One working table per zone */
+RLIC_HOT_DATA SDK_ALIGN(static uint8_t qtable[QLEARN_ZONES_MAX][2][QTABLE_ONLED_MAX + 1][QTABLE_DIMM_MAX + 1],
 		BOARD_SDMMC_DATA_BUFFER_ALIGN_SIZE);
+#endif
+
+#if QLEARN_WARM_START
+/* slots with enough learned actions, read as they are */
+static uint32_t s_visited[QLEARN_ZONES_MAX][(QTABLE_ENTRIES_MAX + 32) / 32];
+/* Q values of a recently learned slot, per zone */
+static uint8_t s_seed[QLEARN_ZONES_MAX][QTABLE_ONLED_MAX + 1][QTABLE_DIMM_MAX
+		+ 1];
+static uint32_t s_seedIdx[QLEARN_ZONES_MAX];
+/* slot the working table was last learned for */
+static uint32_t s_learnIdx[QLEARN_ZONES_MAX];
+/* cells of the working table that hold a seed, not a learned value */
+static uint32_t s_warmCells[QLEARN_ZONES_MAX][(QTABLE_TABLE_SZ + 31) / 32];
+#endif
+
+#if QLEARN_TRACES
+/*
+ * Q(lambda), Watkins style: a reward moves the action taken towards it by
+ * alpha, and the last QLEARN_TRACE_MAX (slot, action) pairs by alpha times
+ * their eligibility, which decays by lambda every step. An explored action
+ * cuts the traces. Traces reach the current slot and the one before it, whose
+ * table is kept here and written back once when it falls out of reach,
+ * so the card sees at most one extra write per slot change.
+ * Fixed point, 1/256 units.
+ */
+#ifndef QLEARN_TRACE_ALPHA
+#define QLEARN_TRACE_ALPHA	(192) /* learning rate */
+#endif
+#ifndef QLEARN_TRACE_LAMBDA
+#define QLEARN_TRACE_LAMBDA	(230) /* decay per step */
+#endif
+#define QLEARN_TRACE_MAX	(8) /* pairs updated per step, at most */
+#define QLEARN_TRACE_MIN	(16) /* eligibility dropped below this */
+#define QLEARN_TRACE_ONE	(256)
+
+typedef struct {
+	uint16_t idx; /* slot */
+	uint8_t numOnLeds;
+	uint8_t duty;
+	uint16_t e; /* eligibility */
+} qlearn_trace_t;
+
+static qlearn_trace_t s_trace[QLEARN_ZONES_MAX][QLEARN_TRACE_MAX];
+static uint32_t s_traceCount[QLEARN_ZONES_MAX];
+static bool s_explored[QLEARN_ZONES_MAX];
+/* slot held in qtable[zone], and the one before it */
+static uint32_t s_tableIdx[QLEARN_ZONES_MAX];
+SDK_ALIGN(static uint8_t s_prevTable[QLEARN_ZONES_MAX][2][QTABLE_ONLED_MAX + 1][QTABLE_DIMM_MAX + 1],
+		BOARD_SDMMC_DATA_BUFFER_ALIGN_SIZE);
+static uint32_t s_prevIdx[QLEARN_ZONES_MAX];
+static bool s_prevDirty[QLEARN_ZONES_MAX];
+
+/*
+ * q moved towards target by weight/256, rounded half up: with a weight of
+ * one half this is the (q + target + 1) / 2 of the plain update
+ */
+static inline uint8_t qlearnMove(uint8_t q, uint8_t target, uint32_t weight) {
+	int32_t delta = ((int32_t) target - q) * (int32_t) weight;
+
+	return uint8_t(q + ((delta + (QLEARN_TRACE_ONE / 2)) >> 8));
+}
+
+#endif
+
+/* RLIC.dat, one file for all zones */
+static SDMMC_Simple sdcard;
+static bool s_storageOpen = false;
+static bool s_seeded = false;
 
-QLearning::QLearning(void) {
+QLearning::QLearning(uint32_t zone) {
 	status_t status;
 	uint32_t randdata = 1234;
 	trng_config_t trngConfig;
 
+	this->zone = (zone < QLEARN_ZONES_MAX) ? zone : 0;
+	s_defaultLeds[this->zone] = QLEARN_DEFAULT_LEDS;
+	s_defaultDir[this->zone] = 1;
+	s_defaultReward[this->zone] = 0;
+#if QLEARN_WARM_START
+	s_seedIdx[this->zone] = QLEARN_NO_SLOT;
+	s_learnIdx[this->zone] = QLEARN_NO_SLOT;
+#endif
+	while (!s_backlog[this->zone].empty()) {
+		qlearn_step_t step;
+		s_backlog[this->zone].pop(step);
+	}
+	s_backlogDropped[this->zone] = 0;
+#if QLEARN_TILE_CODING
+	s_tileSteps[this->zone] = 0;
+#endif
+#if QLEARN_WARM_START
+	memset(s_visited[this->zone], 0, sizeof(s_visited[0]));
+#endif
+#if QLEARN_TRACES
+	s_traceCount[this->zone] = 0;
+	s_tableIdx[this->zone] = QLEARN_NO_SLOT;
+	s_prevIdx[this->zone] = QLEARN_NO_SLOT;
+	s_prevDirty[this->zone] = false;
+#endif
+	if (s_seeded)
+		return;
+	s_seeded = true;
+
 	/* setup TRNG for seed */
 	TRNG_GetDefaultConfig(&trngConfig);
 	trngConfig.sampleMode = kTRNG_SampleModeVonNeumann;
@@ -61,22 +241,47 @@ QLearning::QLearning(void) {
 	if (kStatus_Success == status) {
 		status = TRNG_GetRandomData(TRNG, &randdata, sizeof(randdata));
 		if (status == kStatus_Success) {
-			srand(randdata);
+			seedRandom(randdata);
 			TRNG_Deinit(TRNG);
 			return;
 		}
 	}
 
 	/* TRNG failed, so default to something */
-	srand(randdata);
+	seedRandom(randdata);
 }
 
 QLearning::~QLearning() {
 
 }
 
+/* seed every zone's stream, as at boot; a replay passes the recorded seed */
+void QLearning::seedRandom(uint32_t seed) {
+	s_seeded = true;
+	s_randSeed = seed;
+	for (uint32_t z = 0; z < QLEARN_ZONES_MAX; z++) {
+		s_rand[z] = seed ^ (QLEARN_RAND_MIX * (z + 1));
+		if (!s_rand[z]) /* xorshift never leaves 0 */
+			s_rand[z] = QLEARN_RAND_MIX;
+	}
+}
+
+uint32_t QLearning::getRandomSeed(void) {
+	return s_randSeed;
+}
+
+RLIC_HOT_CODE uint32_t QLearning::nextRandom(void) {
+	uint32_t x = s_rand[zone];
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	s_rand[zone] = x;
+	return x;
+}
+
 /* convert time MS to Qtable Index */
-uint32_t QLearning::timeToQTableEntry(uint32_t dayTimeMS) {
+RLIC_HOT_CODE uint32_t QLearning::timeToQTableEntry(uint32_t dayTimeMS) {
 	float seconds = float(dayTimeMS) / 1000.0f;
 
 	uint32_t idx = (uint32_t) (seconds * 2.0f);
@@ -86,35 +291,372 @@ uint32_t QLearning::timeToQTableEntry(uint32_t dayTimeMS) {
 	return idx;
 }
 
+/* update learned data, or keep it while the card is not up */
+RLIC_HOT_CODE bool QLearning::updateQTable(Brightness brightness,
+		uint8_t reward, uint32_t idx) {
+
+	if (!s_storageOpen)
+		return backlogUpdate(brightness, reward, idx);
+
+	learn(brightness, reward, idx);
+	return writeSlot(idx);
+}
+
+/* before the card is up: the hill climb's LED count at full duty */
+RLIC_HOT_CODE uint32_t QLearning::getDefaultBrightness(Brightness &brightness,
+		uint32_t idx, bool &random) {
+
+	random = false;
+	brightness.numOnLeds = s_defaultLeds[zone];
+	brightness.duty = brightness.numOnLeds ? QTABLE_DIMM_MAX : 0;
+	return idx;
+}
+
+/* keep the step for later and move the hill climb on */
+bool QLearning::backlogUpdate(Brightness brightness, uint8_t reward,
+		uint32_t idx) {
+	qlearn_step_t step;
+	int32_t leds;
+
+	step.idx = uint16_t(idx);
+	step.numOnLeds = brightness.numOnLeds;
+	step.duty = brightness.duty;
+	step.reward = reward;
+	if (!s_backlog[zone].push(step))
+		s_backlogDropped[zone]++;
+
+	/* on target stay, worse than the step before turn round */
+	if (reward < QLEARN_REWARD_MIN) {
+		if (reward < s_defaultReward[zone])
+			s_defaultDir[zone] = -s_defaultDir[zone];
+		leds = s_defaultLeds[zone] + s_defaultDir[zone] * QLEARN_DEFAULT_STEP;
+		if ((leds < QTABLE_ONLED_MIN) || (leds > QTABLE_ONLED_MAX)) {
+			s_defaultDir[zone] = -s_defaultDir[zone];
+			leds = (leds < QTABLE_ONLED_MIN) ?
+					QTABLE_ONLED_MIN : QTABLE_ONLED_MAX;
+		}
+		s_defaultLeds[zone] = uint8_t(leds);
+	}
+	s_defaultReward[zone] = reward;
+	return true;
+}
+
+/* learn the kept steps from the card, QLEARN_REPLAY_STEPS per call */
+bool QLearning::replayBacklog(void) {
+	qlearn_step_t step;
+	Brightness brightness;
+	uint32_t idx = QLEARN_NO_SLOT;
+
+	for (uint32_t n = 0; (n < QLEARN_REPLAY_STEPS) && s_backlog[zone].pop(step);
+			n++) {
+		if (step.idx != idx) {
+			if ((idx != QLEARN_NO_SLOT) && !writeSlot(idx))
+				return false;
+			idx = step.idx;
+			if (!loadSlot(idx))
+				return false;
+		}
+		brightness.numOnLeds = step.numOnLeds;
+		brightness.duty = step.duty;
+#if QLEARN_TRACES
+		s_explored[zone] = true; /* not the greedy action of this table */
+#endif
+		learn(brightness, step.reward, idx);
+	}
+	return (idx == QLEARN_NO_SLOT) || writeSlot(idx);
+}
+
+#if QLEARN_TILE_CODING
+/* move the weights towards the reward */
+RLIC_HOT_CODE void QLearning::learn(Brightness brightness, uint8_t reward,
+		uint32_t idx) {
+
+	(void) idx; /* the action values are already at idx */
+	RLIC_Tiles_Update(&s_tiles[zone], brightness.numOnLeds, brightness.duty,
+			reward);
+}
+
+/* weights live in DTCM, saved every QLEARN_TILE_SAVE_STEPS learned slots */
+bool QLearning::writeSlot(uint32_t idx) {
+
+	(void) idx;
+	if (++s_tileSteps[zone] < QLEARN_TILE_SAVE_STEPS)
+		return true;
+	s_tileSteps[zone] = 0;
+	return saveTiles(zone);
+}
+
+/* action values of slot idx */
+bool QLearning::loadSlot(uint32_t idx) {
+	RLIC_Tiles_SetTime(&s_tiles[zone], idx);
+	return true;
+}
+
+/* weights of a zone to RLIC.dat */
+bool QLearning::saveTiles(uint32_t zone) {
+	uint8_t *w = (uint8_t*) s_tiles[zone].w;
+
+	for (uint32_t c = 0; c < QLEARN_TILE_CHUNKS; c++) {
+		if (sdcard.write(QLEARN_TILE_CHUNK_SZ, &w[c * QLEARN_TILE_CHUNK_SZ], c,
+				zone) != kStatus_Success)
+			return false;
+	}
+	return true;
+}
+
+/* weights of every zone from RLIC.dat, a zone never saved starts fresh */
+bool QLearning::loadTiles(void) {
+	for (uint32_t z = 0; z < QLEARN_ZONES_MAX; z++) {
+		uint8_t *w = (uint8_t*) s_tiles[z].w;
+		bool saved = false;
+
+		for (uint32_t c = 0; c < QLEARN_TILE_CHUNKS; c++) {
+			if (sdcard.read(QLEARN_TILE_CHUNK_SZ, &w[c * QLEARN_TILE_CHUNK_SZ],
+					c, z) != kStatus_Success)
+				return false;
+		}
+		for (uint32_t i = 0; (i < sizeof(s_tiles[z].w)) && !saved; i++)
+			saved = (w[i] != 0);
+
+		if (saved)
+			RLIC_Tiles_WeightsChanged(&s_tiles[z]);
+		else
+			RLIC_Tiles_Init(&s_tiles[z], QLEARN_TILE_INIT);
+		s_tileSteps[z] = 0;
+	}
+	return true;
+}
+#else
 /* update QTable with latest data */
-bool QLearning::updateQTable(Brightness brightness, uint8_t reward,
+RLIC_HOT_CODE void QLearning::learn(Brightness brightness, uint8_t reward,
 		uint32_t idx) {
 
 	uint8_t exp_reward =
-			qtable[QTABLE_IDX][brightness.numOnLeds][brightness.duty];
-	qtable[QTABLE_IDX][brightness.numOnLeds][brightness.duty] = (exp_reward
+			qtable[zone][QTABLE_IDX][brightness.numOnLeds][brightness.duty];
+#if QLEARN_TRACES
+	qtable[zone][QTABLE_IDX][brightness.numOnLeds][brightness.duty] =
+			qlearnMove(exp_reward, reward, QLEARN_TRACE_ALPHA);
+	applyTraces(brightness, reward, idx);
+#else
+	qtable[zone][QTABLE_IDX][brightness.numOnLeds][brightness.duty] = (exp_reward
 			+ reward + 1) / 2;
+#endif
+#if QLEARN_WARM_START
+	{
+		uint32_t cell = brightness.numOnLeds * (QTABLE_DIMM_MAX + 1)
+				+ brightness.duty;
+
+		s_warmCells[zone][cell / 32] &= ~(1U << (cell % 32));
+	}
+#endif
 
 	if (reward < QLEARN_REWARD_MIN) {
-		if (qtable[QTABLE_PRUNED_IDX][brightness.numOnLeds][brightness.duty]
+		if (qtable[zone][QTABLE_PRUNED_IDX][brightness.numOnLeds][brightness.duty]
 				< QLEARN_PRUNECTR_MAX) {
-			qtable[QTABLE_PRUNED_IDX][brightness.numOnLeds][brightness.duty] +=
+			qtable[zone][QTABLE_PRUNED_IDX][brightness.numOnLeds][brightness.duty] +=
 					1;
 		}
 	} else {
-		qtable[QTABLE_PRUNED_IDX][brightness.numOnLeds][brightness.duty] = 0;
+		qtable[zone][QTABLE_PRUNED_IDX][brightness.numOnLeds][brightness.duty] = 0;
 	}
+#if !QLEARN_TRACES
+	(void) idx;
+#endif
+}
+
+/* qtable[zone] back to slot idx */
+bool QLearning::writeSlot(uint32_t idx) {
+	status_t status;
 
-	if (sdcard.write(sizeof(qtable), (uint8_t*) qtable, idx)
+#if QLEARN_WARM_START
+	warmOverlay(&qtable[zone][QTABLE_IDX][0][0], false);
+#endif
+	status = sdcard.write(sizeof(qtable[0]), (uint8_t*) qtable[zone], idx, zone);
+#if QLEARN_WARM_START
+	warmOverlay(&qtable[zone][QTABLE_IDX][0][0], true);
+#endif
+	if (status != kStatus_Success)
+		return false;
+#if QLEARN_WARM_START
+	s_learnIdx[zone] = idx;
+#endif
+
+	return true;
+}
+
+/* slot idx into qtable[zone] */
+bool QLearning::loadSlot(uint32_t idx) {
+#if QLEARN_WARM_START
+	saveSeed(idx);
+#endif
+#if QLEARN_TRACES
+	if (!rotateTraces(idx))
+		return false;
+#endif
+#if QLEARN_WARM_START
+	memset(s_warmCells[zone], 0, sizeof(s_warmCells[0]));
+#endif
+	if (sdcard.read(sizeof(qtable[0]), (uint8_t*) qtable[zone], idx, zone)
 			!= kStatus_Success) {
 		return false;
 	}
+#if QLEARN_WARM_START
+	warmStart(idx);
+#endif
+	return true;
+}
+
+#if QLEARN_TRACES
+/*
+ * Before qtable[zone] is read for a new slot: the slot it holds becomes
+ * the previous one, the old previous one is written back if traces moved
+ * it and its traces are dropped.
+ */
+bool QLearning::rotateTraces(uint32_t idx) {
+	uint32_t kept = 0;
+
+	if (s_tableIdx[zone] == idx)
+		return true;
+	if (!flushTraces(zone))
+		return false;
+
+	if (s_tableIdx[zone] != QLEARN_NO_SLOT) {
+		memcpy(s_prevTable[zone], qtable[zone], sizeof(s_prevTable[0]));
+#if QLEARN_WARM_START
+		/* the copy may go to the card, without its seeds */
+		warmOverlay(&s_prevTable[zone][QTABLE_IDX][0][0], false);
+#endif
+	}
+	s_prevIdx[zone] = s_tableIdx[zone];
+	s_tableIdx[zone] = idx;
 
+	for (uint32_t i = 0; i < s_traceCount[zone]; i++) {
+		if (s_trace[zone][i].idx == s_prevIdx[zone])
+			s_trace[zone][kept++] = s_trace[zone][i];
+	}
+	s_traceCount[zone] = kept;
 	return true;
 }
 
+/* previous slot table of a zone back to the card, if traces moved it */
+bool QLearning::flushTraces(uint32_t zone) {
+	if (!s_prevDirty[zone])
+		return true;
+	s_prevDirty[zone] = false;
+	return sdcard.write(sizeof(s_prevTable[0]), (uint8_t*) s_prevTable[zone],
+			s_prevIdx[zone], zone) == kStatus_Success;
+}
+
+/* move the traced pairs towards the reward, decay them, trace this one */
+RLIC_HOT_CODE void QLearning::applyTraces(Brightness brightness,
+		uint8_t reward, uint32_t idx) {
+	qlearn_trace_t *trace = s_trace[zone];
+	uint32_t kept = 0;
+
+	/* a random action says nothing about the greedy ones before it */
+	if (s_explored[zone])
+		s_traceCount[zone] = 0;
+
+	for (uint32_t i = 0; i < s_traceCount[zone]; i++) {
+		qlearn_trace_t t = trace[i];
+		uint8_t *q, moved;
+
+		if ((t.idx == idx) && (t.numOnLeds == brightness.numOnLeds)
+				&& (t.duty == brightness.duty))
+			continue; /* replaced below */
+
+		if (t.idx == idx) {
+			q = &qtable[zone][QTABLE_IDX][t.numOnLeds][t.duty];
+		} else if (t.idx == s_prevIdx[zone]) {
+			q = &s_prevTable[zone][QTABLE_IDX][t.numOnLeds][t.duty];
+		} else {
+			continue; /* out of reach */
+		}
+		moved = qlearnMove(*q, reward,
+				(QLEARN_TRACE_ALPHA * t.e) / QLEARN_TRACE_ONE);
+		if ((moved != *q) && (t.idx != idx))
+			s_prevDirty[zone] = true;
+		*q = moved;
+
+		t.e = (t.e * QLEARN_TRACE_LAMBDA) / QLEARN_TRACE_ONE;
+		if (t.e >= QLEARN_TRACE_MIN)
+			trace[kept++] = t;
+	}
+
+	/* newest first out when full */
+	if (kept == QLEARN_TRACE_MAX)
+		kept--;
+	memmove(&trace[1], &trace[0], kept * sizeof(trace[0]));
+	trace[0].idx = idx;
+	trace[0].numOnLeds = brightness.numOnLeds;
+	trace[0].duty = brightness.duty;
+	trace[0].e = QLEARN_TRACE_LAMBDA; /* as of the next step */
+	s_traceCount[zone] = kept + 1;
+}
+#endif
+
+#if QLEARN_WARM_START
+/* keep the table of the slot just left, before the read replaces it */
+RLIC_HOT_CODE void QLearning::saveSeed(uint32_t idx) {
+	if ((s_learnIdx[zone] == QLEARN_NO_SLOT) || (s_learnIdx[zone] == idx))
+		return;
+	memcpy(s_seed[zone], qtable[zone][QTABLE_IDX], sizeof(s_seed[0]));
+	s_seedIdx[zone] = s_learnIdx[zone];
+	s_learnIdx[zone] = QLEARN_NO_SLOT;
+}
+
+/* fill the untried actions of a sparsely learned slot from the seed */
+RLIC_HOT_CODE void QLearning::warmStart(uint32_t idx) {
+	uint8_t *q = &qtable[zone][QTABLE_IDX][0][0];
+	const uint8_t *pruned = &qtable[zone][QTABLE_PRUNED_IDX][0][0];
+	const uint8_t *seed = &s_seed[zone][0][0];
+	uint32_t learned = 0;
+	uint32_t dist;
+
+	if (s_visited[zone][idx / 32] & (1U << (idx % 32)))
+		return;
+
+	for (uint32_t i = 0; i < QTABLE_TABLE_SZ; i++)
+		learned += (q[i] != 0);
+	if (learned >= QLEARN_WARM_CELLS) {
+		s_visited[zone][idx / 32] |= (1U << (idx % 32));
+		return;
+	}
+
+	if (s_seedIdx[zone] == QLEARN_NO_SLOT)
+		return;
+	dist = (idx > s_seedIdx[zone]) ?
+			(idx - s_seedIdx[zone]) : (s_seedIdx[zone] - idx);
+	if (dist > QLEARN_WARM_SLOTS)
+		return;
+
+	/* untried is zero and never pruned, the slot's own results are kept */
+	for (uint32_t i = 0; i < QTABLE_TABLE_SZ; i++) {
+		if (!q[i] && !pruned[i] && seed[i])
+			s_warmCells[zone][i / 32] |= (1U << (i % 32));
+	}
+	warmOverlay(q, true);
+}
+
+/* seeded cells of a table copy filled from the seed, or cleared */
+RLIC_HOT_CODE void QLearning::warmOverlay(uint8_t *q, bool on) {
+	const uint8_t *seed = &s_seed[zone][0][0];
+	const uint32_t *cells = s_warmCells[zone];
+
+	for (uint32_t w = 0; w < (QTABLE_TABLE_SZ + 31) / 32; w++) {
+		for (uint32_t bits = cells[w]; bits; bits &= bits - 1) {
+			uint32_t i = w * 32 + __builtin_ctz(bits);
+
+			q[i] = on ? uint8_t(seed[i] - (seed[i] >> 2)) : 0;
+		}
+	}
+}
+#endif
+
+#endif /* QLEARN_TILE_CODING */
+
 /* Calculate reward */
-uint8_t QLearning::getReward(uint32_t luxT) {
+RLIC_HOT_CODE uint8_t QLearning::getReward(uint32_t luxT) {
 
 	uint32_t gap = abs(luxT - QLEARN_LUX_MAX);
 	float reward = 0.0;
@@ -127,17 +669,51 @@ uint8_t QLearning::getReward(uint32_t luxT) {
 	return uint8_t(reward * 10);
 }
 
+#if QLEARN_TILE_CODING
+/* Get Brightness, uniform random or the best action at this time */
+RLIC_HOT_CODE uint32_t QLearning::getQBrightness(Brightness &brightness,
+		uint32_t dayTimeMS, bool &random, bool readqtable) {
+
+	uint32_t idx = timeToQTableEntry(dayTimeMS);
+
+	if (!s_storageOpen)
+		return getDefaultBrightness(brightness, idx, random);
+	if (!s_backlog[zone].empty() && !replayBacklog())
+		return QTABLE_ENTRIES_MAX + 1;
+
+	(void) readqtable; /* weights never leave DTCM */
+	RLIC_Tiles_SetTime(&s_tiles[zone], idx);
+
+	brightness.duty = 0;
+	brightness.numOnLeds = 0;
+
+	if (random) {
+		brightness.numOnLeds = uint8_t(nextRandom() % (QTABLE_ONLED_MAX + 1));
+		if (brightness.numOnLeds)
+			brightness.duty = uint8_t(nextRandom() % (QTABLE_DIMM_MAX + 1));
+	} else {
+		uint32_t maxidx = RLIC_Tiles_ArgMax(&s_tiles[zone]);
+		brightness.numOnLeds = maxidx / (QTABLE_DIMM_MAX + 1);
+		brightness.duty = maxidx % (QTABLE_DIMM_MAX + 1);
+	}
+
+	return idx;
+}
+#else
 /* Get Brightness */
-uint32_t QLearning::getQBrightness(Brightness &brightness, uint32_t dayTimeMS,
-		bool &random, bool readqtable) {
+RLIC_HOT_CODE uint32_t QLearning::getQBrightness(Brightness &brightness,
+		uint32_t dayTimeMS, bool &random, bool readqtable) {
 
 	uint32_t idx = timeToQTableEntry(dayTimeMS);
 
+	if (!s_storageOpen)
+		return getDefaultBrightness(brightness, idx, random);
+
 	if(readqtable) {
-		if (sdcard.read(sizeof(qtable), (uint8_t*) qtable, idx)
-				!= kStatus_Success) {
+		if (!s_backlog[zone].empty() && !replayBacklog())
+			return QTABLE_ENTRIES_MAX + 1;
+		if (!loadSlot(idx))
 			return QTABLE_ENTRIES_MAX + 1;
-		}
 	}
 
 	brightness.duty = 0;
@@ -146,88 +722,202 @@ uint32_t QLearning::getQBrightness(Brightness &brightness, uint32_t dayTimeMS,
 	if (random) { /* Retrieve uniform random */
 		uint32_t ctr = QTABLE_TABLE_SZ;
 		do {
-			brightness.numOnLeds = uint8_t(rand() % (QTABLE_ONLED_MAX + 1));
+			brightness.numOnLeds = uint8_t(nextRandom() % (QTABLE_ONLED_MAX + 1));
 			if (brightness.numOnLeds)
-				brightness.duty = uint8_t(rand() % (QTABLE_DIMM_MAX + 1));
+				brightness.duty = uint8_t(nextRandom() % (QTABLE_DIMM_MAX + 1));
 
-			if (qtable[QTABLE_PRUNED_IDX][brightness.numOnLeds][brightness.duty]
+			if (qtable[zone][QTABLE_PRUNED_IDX][brightness.numOnLeds][brightness.duty]
 					< QLEARN_PRUNECTR_MAX)
 				break;
 		} while (ctr--);
 	} else { /* Retrieve Expected */
-		uint32_t maxidx[2] = { 0, 0 };
-		for (int i = 0; i < (QTABLE_ONLED_MAX + 1); i++) {
-			for (int j = 0; j < (QTABLE_DIMM_MAX + 1); j++) {
-				if (qtable[QTABLE_IDX][i][j]
-						> qtable[QTABLE_IDX][maxidx[0]][maxidx[1]]) {
-					maxidx[0] = i;
-					maxidx[1] = j;
-				}
-			}
-		}
-		brightness.numOnLeds = maxidx[0];
-		brightness.duty = maxidx[1];
-		if (qtable[QTABLE_PRUNED_IDX][brightness.numOnLeds][brightness.duty] >=
+		/* row major scan, first max wins as with the nested loops */
+		uint32_t maxidx = RLIC_ArgMaxU8(&qtable[zone][QTABLE_IDX][0][0],
+				QTABLE_TABLE_SZ);
+		brightness.numOnLeds = maxidx / (QTABLE_DIMM_MAX + 1);
+		brightness.duty = maxidx % (QTABLE_DIMM_MAX + 1);
+		if (qtable[zone][QTABLE_PRUNED_IDX][brightness.numOnLeds][brightness.duty] >=
 		QLEARN_PRUNECTR_MAX) {
-			qtable[QTABLE_IDX][brightness.numOnLeds][brightness.duty] = 0;
+			qtable[zone][QTABLE_IDX][brightness.numOnLeds][brightness.duty] = 0;
 			random = true;
 			getQBrightness(brightness, dayTimeMS, random, false);
 		}
 	}
+#if QLEARN_TRACES
+	s_explored[zone] = random;
+#endif
 
 	return idx;
 }
 
+#endif /* QLEARN_TILE_CODING */
+
 /* Decide Explore or Exploit */
-bool QLearning::runExploreExploit(void) {
+RLIC_HOT_CODE bool QLearning::runExploreExploit(void) {
 
 #if QLEARN_FAST_LEARN
 	return true;
 #endif
 
-	if ((rand() % QLEARN_EXPLORE_MAX) >= QLEARN_EXPLORE_MIN) {
-		return false;
-	} else {
-		return true;
-	}
-
-	return false;
+	/* signed, QLEARN_EXPLORE_MIN may be 0; the draw is made either way */
+	return int32_t(nextRandom() % QLEARN_EXPLORE_MAX) < QLEARN_EXPLORE_MIN;
 }
 
-/* mount sdcard */
+/* mount sdcard, once for all zones, waits for the card */
 bool QLearning::initQStorage(void) {
+	bool ready = false;
 
-	if (sdcard.sdcardWaitCardInsert() != kStatus_Success) {
-		return false;
+	while (!ready) {
+		if (startQStorage(&ready) != kStatus_Success)
+			return false;
 	}
+	return true;
+}
 
-	if (sdcard.mount() != kStatus_Success) {
-		return false;
+/*
+ * One step of bringing RLIC.dat up, see SDMMC_Simple::startup(). Call it
+ * between control steps, zones run the default policy until *ready.
+ */
+status_t QLearning::startQStorage(bool *ready) {
+
+	*ready = s_storageOpen;
+	if (s_storageOpen)
+		return kStatus_Success;
+
+	if (sdcard.startup(ready) != kStatus_Success)
+		return kStatus_Fail;
+	if (!*ready)
+		return kStatus_Success;
+
+	*ready = openQStorage();
+	return *ready ? kStatus_Success : kStatus_Fail;
+}
+
+bool QLearning::isStorageReady(void) {
+	return s_storageOpen;
+}
+
+#if RLIC_TRACE
+/* rlic_trace_ops_t writer: TRACE.DAT next to RLIC.dat, kept until it is up */
+status_t QLearning::traceWrite(void *ctx, const void *data, uint32_t len) {
+	(void) ctx;
+	if (!s_storageOpen)
+		return kStatus_Fail;
+	return sdcard.traceAppend(data, len);
+}
+#endif
+
+#if RLIC_SD_BENCHMARK
+/* card benchmark with the entry size this build reads and writes */
+status_t QLearning::benchQStorage(void) {
+	if (!s_storageOpen)
+		return kStatus_Fail;
+#if QLEARN_TILE_CODING
+	return sdcard.benchmark(QLEARN_TILE_CHUNK_SZ);
+#else
+	return sdcard.benchmark(sizeof(qtable[0]));
+#endif
+}
+#endif
+
+/* data file is up: load what lives in RAM, kept steps are learned later */
+bool QLearning::openQStorage(void) {
+
+	for (uint32_t z = 0; z < QLEARN_ZONES_MAX; z++) {
+		if (s_backlog[z].size() || s_backlogDropped[z])
+			PRINTF("zone %d: %d steps before RLIC.dat, %d dropped\r\n", z,
+					s_backlog[z].size(), s_backlogDropped[z]);
 	}
 
-	if (sdcard.open() != kStatus_Success) {
+#if QLEARN_TILE_CODING
+	if (!loadTiles()) {
 		return false;
 	}
+#endif
 
+#if RLIC_CRC32_BENCHMARK
+	/* checksum cost of one Q table entry, paid on every read and write */
+#if QLEARN_TILE_CODING
+	RLIC_Crc32_Benchmark(QLEARN_TILE_CHUNK_SZ);
+#else
+	RLIC_Crc32_Benchmark(sizeof(qtable[0]));
+#endif
+#endif
+#if RLIC_ARGMAX_BENCHMARK
+	RLIC_ArgMax_Benchmark(QTABLE_TABLE_SZ);
+#endif
+#if RLIC_DMABUF_BENCHMARK
+	/* cache maintenance an entry transfer skips from the DMA pool */
+	RLIC_DmaBuf_Benchmark();
+#endif
+#if RLIC_MEMPOOL_BENCHMARK
+	/* what new/delete, OSA and FatFs pay per block, pool vs heap */
+	RLIC_MemPool_Benchmark();
+#endif
+
+	s_storageOpen = true;
 	return true;
 }
 
-/* sync and save the data file */
+/* sync and save the data file, the first zone to close does it */
 void QLearning::closeQStorage(void) {
+	if (!s_storageOpen) {
+		sdcard.close(); /* if it got as far as opening */
+		return;
+	}
+	s_storageOpen = false;
+	for (uint32_t z = 0; z < QLEARN_ZONES_MAX; z++) {
+		if (!s_backlog[z].empty())
+			PRINTF("zone %d: %d kept steps not learned\r\n", z,
+					s_backlog[z].size());
+	}
+#if QLEARN_TRACES
+	for (uint32_t z = 0; z < QLEARN_ZONES_MAX; z++) {
+		if (!flushTraces(z))
+			PRINTF("zone %d traced slot not saved\r\n", z);
+	}
+#endif
+#if QLEARN_TILE_CODING
+	for (uint32_t z = 0; z < QLEARN_ZONES_MAX; z++) {
+		if (!saveTiles(z))
+			PRINTF("zone %d weights not saved\r\n", z);
+	}
+#endif
 	sdcard.close();
 }
 
+uint32_t QLearning::getZone(void) {
+	return zone;
+}
+
+#if QLEARN_TILE_CODING
+/* print action values at idx, reward units x 10 */
+void QLearning::__printQTable(uint32_t idx) {
+
+	RLIC_Tiles_SetTime(&s_tiles[zone], idx);
+
+	for (int i = 0; i < (QTABLE_ONLED_MAX + 1); i++) {
+		PRINTF("\nR-%d:\t", i);
+		for (int j = 0; j < (QTABLE_DIMM_MAX + 1); j++) {
+			PRINTF("%d\t", (RLIC_Tiles_Value(&s_tiles[zone], i, j) * 10)
+					/ RLIC_TILES_ONE);
+		}
+	}
+	PRINTF("\n");
+}
+#else
 /* print Q Table, reads into qtable */
 void QLearning::__printQTable(uint32_t idx) {
 
-	sdcard.read(sizeof(qtable), (uint8_t*) qtable, idx);
+	loadSlot(idx);
 
 	for (int i = 0; i < (QTABLE_ONLED_MAX + 1); i++) {
 		PRINTF("\nR-%d:\t", i);
 		for (int j = 0; j < (QTABLE_DIMM_MAX + 1); j++) {
-			PRINTF("%d [%d]\t", qtable[QTABLE_IDX][i][j],
-					qtable[QTABLE_PRUNED_IDX][i][j]);
+			PRINTF("%d [%d]\t", qtable[zone][QTABLE_IDX][i][j],
+					qtable[zone][QTABLE_PRUNED_IDX][i][j]);
 		}
 	}
 	PRINTF("\n");
 }
+#endif /* QLEARN_TILE_CODING */
@@ -29,6 +29,45 @@
 #include "SDMMC_Simple.h"
 
 #define QTABLE_ENTRIES_MAX	SDMMC_ENTRIES_MAX
+#define QLEARN_ZONES_MAX	SDMMC_ZONES_MAX
+
+/*
+ * Learner backend: 0 keeps a Q table per time slot in RLIC.dat, read and
+ * written every step; 1 keeps tile coded weights (rlic_tiles.h) in DTCM,
+ * saved to RLIC.dat now and then.
+ */
+#ifndef QLEARN_TILE_CODING
+#define QLEARN_TILE_CODING	(0)
+#endif
+
+/* seed sparsely learned time slots from a neighbour, see QLearning.cpp */
+#ifndef QLEARN_WARM_START
+#define QLEARN_WARM_START	(!QLEARN_TILE_CODING)
+#endif
+
+/* Q(lambda) traces: a reward also moves recently tried actions */
+#ifndef QLEARN_TRACES
+#define QLEARN_TRACES		(0)
+#endif
+
+/*
+ * Steps learned before RLIC.dat is up are kept here, per zone, and
+ * learned again from the card once it is; the rest are dropped.
+ */
+#ifndef QLEARN_BACKLOG_MAX
+#define QLEARN_BACKLOG_MAX	(256)
+#endif
+
+#if QLEARN_TILE_CODING && QLEARN_WARM_START
+#error "QLEARN_WARM_START is for the Q table backend"
+#endif
+#if QLEARN_TILE_CODING && QLEARN_TRACES
+#error "QLEARN_TRACES is for the Q table backend"
+#endif
+
+/* learner build, in the step trace's boot record (rlic_trace.h) */
+#define QLEARN_BUILD_FLAGS	((QLEARN_TILE_CODING << 0) | (QLEARN_WARM_START << 1) \
+		| (QLEARN_TRACES << 2) | (QLEARN_BACKLOG_MAX << 8))
 
 class Brightness {
 public:
@@ -36,21 +75,49 @@ public:
 	uint8_t duty;
 };
 
+/* one learner per zone, all zones share the RLIC.dat store */
 class QLearning {
 private:
-	SDMMC_Simple sdcard;
+	uint32_t zone;
+	uint32_t nextRandom(void);
 	uint32_t timeToQTableEntry(uint32_t);
+	uint32_t getDefaultBrightness(Brightness&, uint32_t, bool&);
+	bool backlogUpdate(Brightness, uint8_t, uint32_t);
+	bool replayBacklog(void);
+	bool loadSlot(uint32_t);
+	bool writeSlot(uint32_t);
+	void learn(Brightness, uint8_t, uint32_t);
+	static bool openQStorage(void);
+	void saveSeed(uint32_t);
+	void warmStart(uint32_t);
+	void warmOverlay(uint8_t*, bool);
+	static bool loadTiles(void);
+	bool rotateTraces(uint32_t);
+	void applyTraces(Brightness, uint8_t, uint32_t);
+	static bool flushTraces(uint32_t);
+	static bool saveTiles(uint32_t);
 public:
-	QLearning();
+	QLearning(uint32_t = 0);
 	virtual ~QLearning();
 
 	bool initQStorage(void);
+	static status_t startQStorage(bool*);
+	static bool isStorageReady(void);
+	static void seedRandom(uint32_t);
+	static uint32_t getRandomSeed(void);
+#if RLIC_TRACE
+	static status_t traceWrite(void*, const void*, uint32_t);
+#endif
+#if RLIC_SD_BENCHMARK
+	static status_t benchQStorage(void);
+#endif
 	uint32_t getQBrightness(Brightness&, uint32_t, bool &, bool);
 	uint8_t getReward(uint32_t);
 	bool updateQTable(Brightness, uint8_t, uint32_t);
 	bool runExploreExploit(void);
 	void __printQTable(uint32_t);
 	void closeQStorage(void);
+	uint32_t getZone(void);
 };
 
 #endif /* QLEARNING_H_ */
@@ -0,0 +1,293 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include "RLIC_Zone.h"
+#include "fsl_debug_console.h"
+#include "rlic_section.h"
+#include "systick_delay.h"
+#include "rlic_dmabuf.h"
+
+#define RLIC_EXPLORE_STRING		"[EXPLORE]"
+#define RLIC_EXPLOIT_STRING		"[EXPLOIT]"
+#define RLIC_DEFAULT_STRING		"[DEFAULT]"
+#define RLIC_SENSOR_ID			(2591)
+
+/* sensor bus and LED matrix address of each zone, LEDs are all on LPI2C1;
+ * board.c registers the same devices for its per device counters */
+typedef struct {
+	uint8_t sensorBus;
+	uint8_t ledAddr;
+} rlic_zone_wiring_t;
+
+static const rlic_zone_wiring_t s_zoneWiring[] = {
+	{ BOARD_TSL2591_BUS_ACCEL, HT16K33_RLIC_LED_I2C_ADDR },
+	{ BOARD_TSL2591_BUS_CODEC, HT16K33_RLIC_LED_I2C_ADDR + 1 },
+};
+
+static const char *const s_zoneNames[] = { "zone0", "zone1" };
+
+uint32_t RLIC_Zone::dayTimeMS = 0;
+static bool s_firstAction = false;
+
+#if RLIC_TRACE
+/* step trace of all zones, to TRACE.DAT once RLIC.dat is up */
+static const rlic_trace_ops_t s_traceOps = { QLearning::traceWrite };
+/* from the DMA pool, its blocks go to the card as they are */
+static rlic_trace_t *s_trace;
+#endif
+const rlic_zone_ops_t RLIC_Zone::zoneOps = { RLIC_Zone::beginOp,
+		RLIC_Zone::finishOp };
+
+RLIC_Zone::RLIC_Zone(uint32_t zone) :
+		zone(zone), learner(zone), sensor(RLIC_SENSOR_ID + zone,
+				s_zoneWiring[zone].sensorBus), led(BOARD_CODEC_I2C_BASEADDR,
+				s_zoneWiring[zone].ledAddr) {
+#if RLIC_PROFILE_STEP
+	RLIC_CycleStatReset(&stepCycles);
+#endif
+}
+
+RLIC_Zone::~RLIC_Zone() {
+
+}
+
+/* day time all zones learn against, from the day light cycle */
+void RLIC_Zone::setDayTimeMS(uint32_t ms) {
+	dayTimeMS = ms;
+}
+
+/* LED matrix back to the action from before a warm reset, if there is one */
+bool RLIC_Zone::restoreAction(void) {
+	uint8_t numOnLeds;
+	uint8_t duty;
+
+	if (!RLIC_Boot_LastAction(zone, &numOnLeds, &duty))
+		return false;
+
+	led.restoreLed(numOnLeds, duty);
+	restored = true;
+	return true;
+}
+
+/* sensor and LED matrix, a restored matrix is left showing its action */
+void RLIC_Zone::init(void) {
+	sensor.printSensorDetails();
+	sensor.configureSensor();
+	if (!restored)
+		led.initLed();
+#if RLIC_TRACE
+	/* learners are seeded by now, they are built with the zones */
+	if (s_trace == NULL) {
+		s_trace = (rlic_trace_t*) RLIC_DmaBuf_Alloc(sizeof(rlic_trace_t));
+		if (s_trace != NULL) {
+			RLIC_Trace_Init(s_trace, &s_traceOps, NULL);
+			RLIC_Trace_Boot(s_trace, QLearning::getRandomSeed(),
+					QLEARN_BUILD_FLAGS, RLIC_ZONES);
+		}
+	}
+#endif
+}
+
+/* the first zone mounts the card, the others share it */
+bool RLIC_Zone::initStorage(void) {
+	return learner.initQStorage();
+}
+
+/* one step of bringing the card up, zones keep running meanwhile */
+status_t RLIC_Zone::pollStorage(bool *ready) {
+	status_t status = QLearning::startQStorage(ready);
+
+#if RLIC_TRACE
+	/* steps traced while it came up */
+	if ((status == kStatus_Success) && *ready && (s_trace != NULL))
+		(void) RLIC_Trace_Drain(s_trace);
+#endif
+	return status;
+}
+
+#if RLIC_SD_BENCHMARK
+status_t RLIC_Zone::benchStorage(void) {
+	return QLearning::benchQStorage();
+}
+#endif
+
+void RLIC_Zone::closeStorage(void) {
+#if RLIC_TRACE
+	if (s_trace && (RLIC_Trace_Flush(s_trace) != kStatus_Success))
+		PRINTF("trace: %d blocks not written\n",
+				(s_trace->head - s_trace->tail) / RLIC_TRACE_BLOCK_RECS);
+	if (s_trace && s_trace->dropped)
+		PRINTF("trace: %d of %d steps dropped\n", s_trace->dropped,
+				s_trace->steps);
+#endif
+	learner.closeQStorage();
+}
+
+status_t RLIC_Zone::schedule(rlic_zone_sched_t *sched) {
+	return RLIC_ZoneSched_Add(sched, &this->sched, s_zoneNames[zone],
+			&zoneOps, this);
+}
+
+status_t RLIC_Zone::beginOp(void *ctx, uint32_t *waitMS) {
+	return static_cast<RLIC_Zone*>(ctx)->beginStep(waitMS);
+}
+
+status_t RLIC_Zone::finishOp(void *ctx, uint32_t *waitMS) {
+	return static_cast<RLIC_Zone*>(ctx)->finishStep(waitMS);
+}
+
+/* start one sensor sample, returns when it can be read */
+uint32_t RLIC_Zone::startSample(void) {
+#if TSL2591_AUTO_RANGE
+	sensor.startAutoLuminosity();
+#else
+	sensor.startFullLuminosity();
+#endif
+	return sensor.getWaitMS();
+}
+
+/* explore or exploit, set the LEDs and start sensing */
+RLIC_HOT_CODE status_t RLIC_Zone::beginStep(uint32_t *waitMS) {
+#if RLIC_PROFILE_STEP
+	uint32_t stepStart = RLIC_CyclesGet();
+#endif
+
+	/* Explore or Exploit */
+	exep = learner.runExploreExploit();
+
+	/* get LED and Dimm values */
+#if RLIC_TRACE
+	traceTimeMS = dayTimeMS;
+	traceFlags = QLearning::isStorageReady() ? RLIC_TRACE_CARD_BEGIN : 0;
+#endif
+	idx = learner.getQBrightness(brightness, dayTimeMS, exep, true);
+	if (idx > QTABLE_ENTRIES_MAX)
+		return kStatus_Fail;
+#if RLIC_PROFILE_STEP
+	stepLearn = RLIC_CyclesGet() - stepStart;
+#endif
+
+	/* set LEDs and Dimm */
+	led.setLedBrightness(brightness.numOnLeds, brightness.duty);
+	RLIC_Boot_SaveAction(zone, brightness.numOnLeds, brightness.duty);
+	if (!s_firstAction) {
+		s_firstAction = true;
+#if RLIC_BOOT_PROFILE
+		RLIC_Boot_Mark("first step");
+		RLIC_Boot_Action(RLIC_BOOT_LEARNER);
+		RLIC_Boot_Print();
+#else
+		PRINTF("[boot] first control action at %d ms\n", SysTick_UptimeMS());
+#endif
+	}
+
+	/* Sence the brightness */
+	samples = 0;
+	senseSavedMS = 0;
+	*waitMS = startSample();
+	return kStatus_Success;
+}
+
+/* take the sample, learn from the reward */
+RLIC_HOT_CODE status_t RLIC_Zone::finishStep(uint32_t *waitMS) {
+	const char *exepstr = RLIC_EXPLOIT_STRING;
+	uint8_t reward;
+#if RLIC_PROFILE_STEP
+	uint32_t stepStart;
+#endif
+
+#if TSL2591_AUTO_RANGE
+	if (!sensor.readAutoLuminosity(TSL2591_VISIBLE, &luxT)) {
+		/* saturated, started again one step down */
+		*waitMS = sensor.getWaitMS();
+		return kStatus_Success;
+	}
+	senseSavedMS += sensor.getAutoSavedMS();
+#else
+	uint32_t x = sensor.readFullLuminosity();
+	luxT = uint16_t((x & 0xFFFF) - (x >> 16));
+#endif
+
+	/* more samples give better accuracy */
+	if (++samples < RLIC_ZONE_SAMPLES) {
+		*waitMS = startSample();
+		return kStatus_Success;
+	}
+	*waitMS = 0;
+
+#if RLIC_PROFILE_STEP
+	stepStart = RLIC_CyclesGet();
+#endif
+	/* Calculate reward */
+	reward = learner.getReward(luxT);
+
+	if (exep)
+		exepstr = RLIC_EXPLORE_STRING;
+	if (!QLearning::isStorageReady())
+		exepstr = RLIC_DEFAULT_STRING;
+
+#if RLIC_ZONES > 1
+	PRINTF("[z%d] ", zone);
+#endif
+	PRINTF("[%ld ms] [%ld] numOnLeds: %d duty; %d Lum: %d reward: %d %s"
+			" saved: %d ms\n", dayTimeMS, idx, brightness.numOnLeds,
+			brightness.duty, luxT, reward, exepstr, senseSavedMS);
+
+#if RLIC_TRACE
+	if (s_trace != NULL) {
+		rlic_trace_step_t step;
+
+		step.flags = traceFlags | (exep ? RLIC_TRACE_EXPLORE : 0)
+				| (QLearning::isStorageReady() ? RLIC_TRACE_CARD : 0);
+		step.zone = uint8_t(zone);
+		step.reward = reward;
+		step.dayTimeMS = traceTimeMS;
+		step.lux = luxT;
+		step.slot = uint16_t(idx);
+		step.numOnLeds = brightness.numOnLeds;
+		step.duty = brightness.duty;
+		RLIC_Trace_Step(s_trace, &step);
+	}
+#endif
+
+	/* update learned data */
+	if (!learner.updateQTable(brightness, reward, idx))
+		return kStatus_Fail;
+	SysTick_IdleDecision();
+
+#if RLIC_PROFILE_STEP
+	/* learner only: sensor integration and LED I2C excluded */
+	RLIC_CycleStatAdd(&stepCycles, stepLearn + (RLIC_CyclesGet() - stepStart));
+	if (stepCycles.count >= RLIC_PROFILE_STEP_REPORT) {
+		PRINTF("[profile] step cycles min %d avg %d max %d (%d us avg)\n",
+				stepCycles.min, RLIC_CycleStatAvg(&stepCycles), stepCycles.max,
+				RLIC_CyclesToUS(RLIC_CycleStatAvg(&stepCycles)));
+		RLIC_CycleStatReset(&stepCycles);
+	}
+#endif
+
+	//learner.__printQTable(idx);
+
+	return kStatus_Success;
+}
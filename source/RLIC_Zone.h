@@ -0,0 +1,132 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_ZONE_H_
+#define RLIC_ZONE_H_
+
+#include <stdint.h>
+#include "QLearning.h"
+#include "Adafruit_TSL2591.h"
+#include "HT16K33_Simple.h"
+#include "rlic_zone_sched.h"
+#include "rlic_cycles.h"
+#include "rlic_boot.h"
+
+/*
+ * Zones on this board, see s_zoneWiring in RLIC_Zone.cpp. The TSL2591 has
+ * one fixed address, so one sensor per LPI2C bus and two zones at most.
+ * Build with -DRLIC_ZONES=2 so RLIC.dat gets a region for each.
+ */
+#ifndef RLIC_ZONES
+#define RLIC_ZONES				(1)
+#endif
+
+#if RLIC_ZONES == 1
+#define RLIC_ZONE_TABLE			{ RLIC_Zone(0) }
+#elif RLIC_ZONES == 2
+#define RLIC_ZONE_TABLE			{ RLIC_Zone(0), RLIC_Zone(1) }
+#else
+#error "RLIC_ZONES: one TSL2591 per LPI2C bus, 1 or 2 zones"
+#endif
+
+static_assert(RLIC_ZONES <= QLEARN_ZONES_MAX,
+		"RLIC.dat needs a region per zone, define RLIC_ZONES project wide");
+static_assert(RLIC_ZONES <= RLIC_BOOT_ZONES_MAX,
+		"the last action record holds RLIC_BOOT_ZONES_MAX zones");
+
+/* overlap the sensor waits of all zones, or one step at a time */
+#ifndef RLIC_ZONE_MODE
+#define RLIC_ZONE_MODE			RLIC_ZONE_PIPELINED
+#endif
+
+/*
+ * 1: control starts at once with the learner's default policy while the
+ * card comes up in the sensor waits; 0: wait for RLIC.dat first
+ */
+#ifndef RLIC_STORAGE_BACKGROUND
+#define RLIC_STORAGE_BACKGROUND	(1)
+#endif
+
+/* samples per step, the first also settles the auto range */
+#define RLIC_ZONE_SAMPLES		(2)
+
+/* print scheduler stats every N steps, 0 for off */
+#ifndef RLIC_ZONE_REPORT_STEPS
+#define RLIC_ZONE_REPORT_STEPS	(0)
+#endif
+
+/* report control step cycles every N steps, build with RLIC_PLACE_HOT 0/1
+ * to compare flash XIP against TCM placement */
+#ifndef RLIC_PROFILE_STEP
+#define RLIC_PROFILE_STEP		(0)
+#endif
+#define RLIC_PROFILE_STEP_REPORT	(100U)
+
+/* one luminaire: its sensor, LED matrix, learner and statistics */
+class RLIC_Zone {
+private:
+	uint32_t zone;
+	QLearning learner;
+	Adafruit_TSL2591 sensor;
+	HT16K33_Simple led;
+	rlic_zone_t sched;
+	Brightness brightness = { 0, 0 };
+	uint32_t idx = 0;
+	bool exep = false;
+	uint32_t samples = 0;
+	uint32_t luxT = 0;
+	int32_t senseSavedMS = 0;
+	bool restored = false; /* LEDs set from the last action at boot */
+#if RLIC_TRACE
+	uint32_t traceTimeMS = 0; /* dayTimeMS the action was picked at */
+	uint8_t traceFlags = 0;
+#endif
+#if RLIC_PROFILE_STEP
+	uint32_t stepLearn = 0;
+	rlic_cycle_stat_t stepCycles;
+#endif
+	static uint32_t dayTimeMS;
+	static const rlic_zone_ops_t zoneOps;
+	static status_t beginOp(void*, uint32_t*);
+	static status_t finishOp(void*, uint32_t*);
+	uint32_t startSample(void);
+public:
+	RLIC_Zone(uint32_t);
+	virtual ~RLIC_Zone();
+
+	bool restoreAction(void);
+	void init(void);
+	bool initStorage(void);
+	static status_t pollStorage(bool*);
+#if RLIC_SD_BENCHMARK
+	static status_t benchStorage(void);
+#endif
+	void closeStorage(void);
+	status_t schedule(rlic_zone_sched_t*);
+	status_t beginStep(uint32_t*);
+	status_t finishStep(uint32_t*);
+	static void setDayTimeMS(uint32_t);
+};
+
+#endif /* RLIC_ZONE_H_ */
@@ -23,24 +23,336 @@
  */
 /*! @file */
 #include <SDMMC_Simple.h>
+#include <string.h>
 #include "fsl_sd_disk.h"
 #include "fsl_debug_console.h"
+#include "systick_delay.h"
+#include "rlic_section.h"
+#include "rlic_crc32.h"
+#include "rlic_slot_codec.h"
+#include "rlic_dmabuf.h"
+#if RLIC_SD_BENCHMARK || RLIC_SLOT_CODEC_BENCHMARK
+#include "rlic_cycles.h"
+#endif
+#if RLIC_SD_BENCHMARK
+#include "rlic_sd_bench.h"
+#endif
 
 #define SDMMC_FILEPATH_LEN_MAX	20
+/*
+ * Fleet seed image, tools/rlic_dat.cpp merge: on a card without RLIC.dat
+ * it is renamed to RLIC.dat at open, so it is taken once and learned on.
+ */
+#define SDMMC_SEED_PATH			_T("/dir_1/SEED.DAT")
+#define SDMMC_TRACE_PATH		_T("/dir_1/TRACE.DAT")
 #define SDMMC_ENTRIES_SZ		(4 * 1024)
-#define SDMMC_ENTRIES_OFFSET(x)	(x * SDMMC_ENTRIES_SZ)
+#define SDMMC_ENTRIES_OFFSET(x)	((x) * SDMMC_ENTRIES_SZ)
 #define SDMMC_INIT_CHUNK_SZ		(1024)
-#define SDMMC_FILE_SZ			(SDMMC_ENTRIES_MAX * SDMMC_ENTRIES_SZ)
+#define SDMMC_CHECK_CHUNK_SZ	(256)
 
-SDMMC_Simple::SDMMC_Simple() {
+/*
+ * Every entry has two copies, A in the first bank and B in the second, each
+ * a header followed by the payload. Writes go to the copy that is not the
+ * current one, so a torn write only ever damages the older copy.
+ * Files from before the header have bank A only, those entries are read
+ * as they are until first written.
+ * Each zone has its own pair of banks, zone 0 first, so a file written by a
+ * single zone build is zone 0 of a multi zone one. Entries are addressed by
+ * slot, zone * (SDMMC_ENTRIES_MAX + 1) + index.
+ */
+#define SDMMC_ENTRY_MAGIC		(0x43494C52U) /* "RLIC" */
+#define SDMMC_ENTRY_MAGIC_CODED	(0x5A494C52U) /* "RLIZ", RLIC_SlotCodec payload */
+#define SDMMC_CODED_LEN(d, s)	(((d) << 16) | (s))
+#define SDMMC_ENTRY_HDR_SZ		(sizeof(sdmmc_entry_hdr_t))
+#define SDMMC_ENTRY_DATA_MAX	(SDMMC_ENTRIES_SZ - SDMMC_ENTRY_HDR_SZ)
+#define SDMMC_BANK_SZ			((SDMMC_ENTRIES_MAX + 1) * SDMMC_ENTRIES_SZ)
+#define SDMMC_ZONE_SZ			(2 * SDMMC_BANK_SZ)
+#define SDMMC_SLOT(z, x)		(((z) * (SDMMC_ENTRIES_MAX + 1)) + (x))
+#define SDMMC_COPY_OFFSET(x, c)	((((x) / (SDMMC_ENTRIES_MAX + 1)) * SDMMC_ZONE_SZ) \
+		+ ((c) * SDMMC_BANK_SZ) \
+		+ SDMMC_ENTRIES_OFFSET((x) % (SDMMC_ENTRIES_MAX + 1)))
+#define SDMMC_FILE_SZ			(SDMMC_ZONES_MAX * SDMMC_ZONE_SZ)
+
+/*
+ * Files made by this version start with a header and the copy map, see
+ * sdmmc_file_hdr_t, and are sparse: they grow as copies are first written
+ * and a copy not in the map reads as zero without touching the card.
+ * Files from before have no header and are dense, zero filled to
+ * SDMMC_FILE_SZ and every copy taken as written.
+ */
+#define SDMMC_FILE_MAGIC		(0x4D494C52U) /* "RLIM" */
+#define SDMMC_FILE_VERSION		(1)
+#define SDMMC_FILE_HDR_SZ		(4 * 1024) /* entries stay 4 KB aligned */
+#define SDMMC_MAP_OFFSET		(sizeof(sdmmc_file_hdr_t))
+#define SDMMC_MAP_WORDS			((SDMMC_SLOTS_MAX * 2 + 31) / 32)
+#define SDMMC_MAP_BIT(x, c)		(((x) * 2) + (c))
+#define SDMMC_CARD_OFFSET(x, c)	(s_dataBase + SDMMC_COPY_OFFSET(x, c))
+
+static_assert((SDMMC_MAP_OFFSET + SDMMC_MAP_WORDS * 4) <= SDMMC_FILE_HDR_SZ,
+		"copy map must fit the RLIC.dat header");
+
+/* where the current copy of an entry lives */
+#define SDMMC_COPY_A			(0)
+#define SDMMC_COPY_B			(1)
+#define SDMMC_COPY_LEGACY		(2) /* headerless, bank A */
+#define SDMMC_COPY_NONE			(3) /* no valid copy, reads as zero */
+#define SDMMC_COPY_UNKNOWN		(0xFF) /* not looked at since boot */
+
+/* wrap safe sequence compare */
+#define SDMMC_SEQ_NEWER(a, b)	((int32_t) ((a) - (b)) > 0)
+
+/* resolved per entry on first use, see cardResolve() */
+static uint8_t s_entryCopy[SDMMC_SLOTS_MAX];
+static uint32_t s_entrySeq[SDMMC_SLOTS_MAX];
+
+/* copies on the card, all of them in a dense file */
+static uint32_t s_copyMap[SDMMC_MAP_WORDS];
+/* where the entries start, 0 for a dense file */
+static uint32_t s_dataBase;
+
+#if SDMMC_FAST_SEEK
+#if !FF_USE_FASTSEEK
+#error "SDMMC_FAST_SEEK needs FF_USE_FASTSEEK in ffconf.h"
+#endif
+#define SDMMC_CLMT_NONE			(0xFFFFFFFFU)
+/* cluster link map of RLIC.dat and the file clusters it covers */
+static DWORD s_clmt[SDMMC_CLMT_WORDS];
+static uint32_t s_clmtClusters = SDMMC_CLMT_NONE;
+static bool s_clmtOff;
+#endif
+
+/*
+ * a card entry, header and payload, on its way out; a coded payload in.
+ * From the DMA pool, so its transfers skip the cache maintenance.
+ */
+static uint8_t *s_entryBuf;
+
+#if RLIC_SLOT_CODEC_BENCHMARK
+static rlic_cycle_stat_t s_encodeCycles, s_decodeCycles;
+static uint64_t s_codecRawBytes, s_codecStoredBytes;
+#endif
+
+static inline bool sdmmcCopyMapped(uint32_t fileidx, uint32_t copy) {
+	uint32_t bit = SDMMC_MAP_BIT(fileidx, copy);
 
+	return (s_copyMap[bit / 32] & (1U << (bit % 32))) != 0;
+}
+
+static inline bool sdmmcEntryMagic(uint32_t magic) {
+	return (magic == SDMMC_ENTRY_MAGIC) || (magic == SDMMC_ENTRY_MAGIC_CODED);
+}
+
+/* payload bytes behind the header */
+static inline uint32_t sdmmcStoredLen(const sdmmc_entry_hdr_t *hdr) {
+	return (hdr->magic == SDMMC_ENTRY_MAGIC_CODED) ?
+			(hdr->len & 0xFFFFU) : hdr->len;
+}
+
+/* a header that may hold numbytes of data */
+static inline bool sdmmcEntryFits(const sdmmc_entry_hdr_t *hdr,
+		uint32_t numbytes) {
+	if (hdr->magic == SDMMC_ENTRY_MAGIC_CODED)
+		return ((hdr->len >> 16) == numbytes)
+				&& (sdmmcStoredLen(hdr) <= SDMMC_ENTRY_DATA_MAX);
+	return (hdr->magic == SDMMC_ENTRY_MAGIC) && (hdr->len == numbytes);
+}
+
+#if SDMMC_USE_SDRAM_MIRROR
+/* both banks of every zone */
+#define SDMMC_MIRROR_SZ			SDMMC_FILE_SZ
+
+/* whole data file, fully loaded at open so never zeroed at startup */
+RLIC_AT_SDRAM_NOINIT SDK_ALIGN(static uint8_t s_qmirror[SDMMC_MIRROR_SZ],
+		BOARD_SDMMC_DATA_BUFFER_ALIGN_SIZE);
+#endif
+
+/* copy to try first: the newer of the ones with a plausible header */
+static uint32_t sdmmcNewestCopy(const sdmmc_entry_hdr_t *hdr[2],
+		const bool used[2]) {
+	if (used[SDMMC_COPY_B]
+			&& (!used[SDMMC_COPY_A]
+					|| SDMMC_SEQ_NEWER(hdr[SDMMC_COPY_B]->seq,
+							hdr[SDMMC_COPY_A]->seq)))
+		return SDMMC_COPY_B;
+	return SDMMC_COPY_A;
+}
+
+/* highest sequence seen in either header, next write must be newer */
+static uint32_t sdmmcNewestSeq(const sdmmc_entry_hdr_t *hdr[2]) {
+	uint32_t seq = 0;
+
+	for (uint32_t c = SDMMC_COPY_A; c <= SDMMC_COPY_B; c++) {
+		if (sdmmcEntryMagic(hdr[c]->magic)
+				&& SDMMC_SEQ_NEWER(hdr[c]->seq, seq))
+			seq = hdr[c]->seq;
+	}
+	return seq;
+}
+
+#if RLIC_SLOT_CODEC_BENCHMARK
+/* bytes saved and cycles spent so far, SDMMC_CODEC_REPORT writes apart */
+static void sdmmcCodecReport(void) {
+	uint32_t ratio;
+
+	if (!s_encodeCycles.count
+			|| (s_encodeCycles.count % SDMMC_CODEC_REPORT))
+		return;
+	ratio = (uint32_t) ((s_codecRawBytes * 100)
+			/ (s_codecStoredBytes ? s_codecStoredBytes : 1));
+	PRINTF("slot codec: %d writes, %d -> %d bytes avg (%d.%02dx), "
+			"encode %d/%d cycles, decode %d/%d cycles (avg/max)\r\n",
+			s_encodeCycles.count,
+			(uint32_t) (s_codecRawBytes / s_encodeCycles.count),
+			(uint32_t) (s_codecStoredBytes / s_encodeCycles.count),
+			ratio / 100, ratio % 100, RLIC_CycleStatAvg(&s_encodeCycles),
+			s_encodeCycles.max, RLIC_CycleStatAvg(&s_decodeCycles),
+			s_decodeCycles.max);
+}
+#endif
+
+/*
+ * Payload of a new copy into 'payload', coded when SDMMC_COMPRESS is set
+ * and that is smaller. Fills in the header except the sequence, returns the
+ * bytes stored.
+ */
+static uint32_t sdmmcEncode(sdmmc_entry_hdr_t *hdr, uint8_t *payload,
+		const uint8_t *data, uint32_t numbytes) {
+	uint32_t stored = 0;
+
+#if SDMMC_COMPRESS
+#if RLIC_SLOT_CODEC_BENCHMARK
+	uint32_t t0 = RLIC_CyclesGet();
+#endif
+	if (numbytes)
+		stored = RLIC_SlotCodec_Encode(data, numbytes, payload, numbytes - 1);
+#if RLIC_SLOT_CODEC_BENCHMARK
+	RLIC_CycleStatAdd(&s_encodeCycles, RLIC_CyclesGet() - t0);
+	s_codecRawBytes += numbytes;
+	s_codecStoredBytes += stored ? stored : numbytes;
+	sdmmcCodecReport();
+#endif
+#endif
+
+	if (stored) {
+		hdr->magic = SDMMC_ENTRY_MAGIC_CODED;
+		hdr->len = SDMMC_CODED_LEN(numbytes, stored);
+	} else {
+		memcpy(payload, data, numbytes);
+		hdr->magic = SDMMC_ENTRY_MAGIC;
+		hdr->len = stored = numbytes;
+	}
+	hdr->crc = RLIC_Crc32(payload, stored);
+	return stored;
+}
+
+/* coded payload into data, false unless it is exactly numbytes */
+static bool sdmmcDecode(const uint8_t *payload, uint32_t stored,
+		uint8_t *data, uint32_t numbytes) {
+#if RLIC_SLOT_CODEC_BENCHMARK
+	uint32_t t0 = RLIC_CyclesGet();
+#endif
+	bool ok = (RLIC_SlotCodec_Decode(payload, stored, data, numbytes)
+			== numbytes);
+
+#if RLIC_SLOT_CODEC_BENCHMARK
+	RLIC_CycleStatAdd(&s_decodeCycles, RLIC_CyclesGet() - t0);
+#endif
+	return ok;
+}
+
+/* write target: never the copy that currently holds good data */
+static uint32_t sdmmcTargetCopy(uint32_t fileidx) {
+	switch (s_entryCopy[fileidx]) {
+	case SDMMC_COPY_A:
+	case SDMMC_COPY_LEGACY:
+		return SDMMC_COPY_B;
+	default:
+		return SDMMC_COPY_A;
+	}
+}
+
+SDMMC_Simple::SDMMC_Simple() {
+#if RLIC_SLOT_CODEC_BENCHMARK
+	RLIC_CyclesInit();
+	RLIC_CycleStatReset(&s_encodeCycles);
+	RLIC_CycleStatReset(&s_decodeCycles);
+	s_codecRawBytes = s_codecStoredBytes = 0;
+#endif
 }
 
 SDMMC_Simple::~SDMMC_Simple() {
 
 }
 
-status_t SDMMC_Simple::sdcardWaitCardInsert(void) {
+/*
+ * One step of bringing the card up, so the caller keeps the lights under
+ * control meanwhile; *ready is set once the data file can be used. A step
+ * is one FatFs/SDK call or SDMMC_STARTUP_FILL_SZ of zero fill or one
+ * mirror chunk. The first volume access (card identification) and f_mkfs
+ * of an unformatted card cannot be split and take as long as they take.
+ */
+status_t SDMMC_Simple::startup(bool *ready) {
+	status_t status = kStatus_Success;
+	bool done = true;
+
+	*ready = false;
+	switch (startupState) {
+	case SDMMC_STARTUP_HOST:
+		startupMS = SysTick_UptimeMS();
+		status = hostInit();
+		break;
+	case SDMMC_STARTUP_CARD:
+		if (!SD_IsCardPresent(&g_sd))
+			return kStatus_Success;
+		status = cardInsert();
+		break;
+	case SDMMC_STARTUP_MOUNT:
+		status = mount();
+		break;
+	case SDMMC_STARTUP_OPEN:
+		status = open();
+		break;
+	case SDMMC_STARTUP_FILL:
+		status = initFile(&done);
+		if ((status == kStatus_Success) && done
+				&& (f_sync(&fileRWObject) != FR_OK)) {
+			PRINTF("Sync file failed. \r\n");
+			status = kStatus_Fail;
+		}
+		if ((status == kStatus_Success) && done)
+			status = linkMap(); /* file at its boot size */
+		startupOffset = done ? 0 : startupOffset;
+		break;
+	case SDMMC_STARTUP_MIRROR:
+#if SDMMC_USE_SDRAM_MIRROR
+		status = loadMirror(&done);
+#endif
+		break;
+	case SDMMC_STARTUP_READY:
+		*ready = true;
+		return kStatus_Success;
+	default:
+		return kStatus_Fail;
+	}
+
+	if (status != kStatus_Success) {
+		startupState = SDMMC_STARTUP_FAILED;
+		return kStatus_Fail;
+	}
+	if (done)
+		startupState++;
+	if (startupState == SDMMC_STARTUP_READY) {
+		PRINTF("RLIC.dat ready in %d ms\r\n", SysTick_UptimeMS() - startupMS);
+		*ready = true;
+	}
+	return kStatus_Success;
+}
+
+bool SDMMC_Simple::isReady(void) {
+	return startupState == SDMMC_STARTUP_READY;
+}
+
+status_t SDMMC_Simple::hostInit(void) {
 	BOARD_SD_Config(&g_sd, NULL, BOARD_SDMMC_SD_HOST_IRQ_PRIORITY, NULL);
 
 	/* SD host init function */
@@ -49,7 +361,11 @@ status_t SDMMC_Simple::sdcardWaitCardInsert(void) {
 		return kStatus_Fail;
 	}
 
-	/* wait card insert */
+	return kStatus_Success;
+}
+
+/* card seen by startup(), debounce it and power cycle it */
+status_t SDMMC_Simple::cardInsert(void) {
 	if (SD_PollingCardInsert(&g_sd, kSD_Inserted) == kStatus_Success) {
 		PRINTF("\r\nCard inserted.\r\n");
 		/* power off card */
@@ -67,6 +383,22 @@ status_t SDMMC_Simple::sdcardWaitCardInsert(void) {
 /* Close Sdcard file */
 status_t SDMMC_Simple::close(void) {
 
+	if (!fileOpen)
+		return kStatus_Success;
+	fileOpen = false;
+
+#if RLIC_TRACE
+	if (traceOpen) {
+		traceOpen = false;
+		if (f_close(&traceFile) != FR_OK)
+			PRINTF("failed to close file: TRACE.DAT\n");
+	}
+#endif
+
+	if (flush() != kStatus_Success) {
+		PRINTF("failed to flush file: RLIC.dat\n");
+	}
+
 	if (f_close(&fileRWObject) != FR_OK) {
 		PRINTF("failed to close file: RLIC.dat\n");
 		return kStatus_Fail;
@@ -78,30 +410,344 @@ status_t SDMMC_Simple::close(void) {
 /* Open SDCard File */
 status_t SDMMC_Simple::open(void) {
 
+	bool sparse = true;
 	FRESULT error;
-	UINT bytesWritten;
 
-	if (f_open(&fileRWObject, _T("/dir_1/RLIC.dat"),
-			(FA_WRITE | FA_READ | FA_OPEN_EXISTING)) != FR_OK) {
+	error = f_open(&fileRWObject, _T("/dir_1/RLIC.dat"),
+			(FA_WRITE | FA_READ | FA_OPEN_EXISTING));
+	/* a new card may carry a seed image, it becomes RLIC.dat */
+	if ((error != FR_OK)
+			&& (f_rename(SDMMC_SEED_PATH, _T("/dir_1/RLIC.dat")) == FR_OK)) {
+		PRINTF("RLIC.dat seeded from %s\r\n", SDMMC_SEED_PATH);
+		error = f_open(&fileRWObject, _T("/dir_1/RLIC.dat"),
+				(FA_WRITE | FA_READ | FA_OPEN_EXISTING));
+	}
+	if (error != FR_OK) {
 		setDataFileExists(false);
 		PRINTF("Open existing file failed, Initialising RLIC.dat..\r\n");
 		if (f_open(&fileRWObject, _T("/dir_1/RLIC.dat"),
 				(FA_WRITE | FA_READ | FA_OPEN_ALWAYS)) != FR_OK) {
 			PRINTF("Failed to open RLIC.dat!\r\n");
 			return kStatus_Fail;
-		} else {
-			uint8_t data[SDMMC_INIT_CHUNK_SZ];
-			bzero(data, sizeof(data));
-
-			/* if new file, then initialise */
-			for (int i = 0; i < SDMMC_FILE_SZ / SDMMC_INIT_CHUNK_SZ; i++) {
-				error = f_write(&fileRWObject, data, sizeof(data),
-						&bytesWritten);
-				if ((error) || (bytesWritten != sizeof(data))) {
-					PRINTF("Write file failed. \r\n");
-					return kStatus_Fail;
-				}
+		}
+	}
+
+	fileOpen = true;
+#if SDMMC_FAST_SEEK
+	s_clmtClusters = SDMMC_CLMT_NONE;
+	s_clmtOff = false;
+#endif
+	memset(s_entryCopy, SDMMC_COPY_UNKNOWN, sizeof(s_entryCopy));
+	bzero(s_entrySeq, sizeof(s_entrySeq));
+
+	if (f_size(&fileRWObject) == 0) {
+		if (createFile() != kStatus_Success)
+			return kStatus_Fail;
+	} else if (loadFileHdr(&sparse) != kStatus_Success) {
+		return kStatus_Fail;
+	}
+
+	/* only a dense file is grown by initFile() */
+	startupOffset = sparse ? SDMMC_FILE_SZ : f_size(&fileRWObject);
+	return kStatus_Success;
+}
+
+/* header and an empty copy map, entries are added as they are written */
+status_t SDMMC_Simple::createFile(void) {
+	uint8_t hdrbuf[SDMMC_FILE_HDR_SZ];
+	sdmmc_file_hdr_t *hdr = (sdmmc_file_hdr_t*) hdrbuf;
+
+#if SDMMC_CONTIGUOUS
+	if (f_expand(&fileRWObject, SDMMC_FILE_HDR_SZ + SDMMC_FILE_SZ, 1)
+			!= FR_OK)
+		PRINTF("RLIC.dat: no contiguous space, allocated as written\r\n");
+#endif
+
+	bzero(hdrbuf, sizeof(hdrbuf));
+	hdr->magic = SDMMC_FILE_MAGIC;
+	hdr->version = SDMMC_FILE_VERSION;
+	hdr->zones = SDMMC_ZONES_MAX;
+	hdr->entries = SDMMC_ENTRIES_MAX + 1;
+	if (cardWriteAt(0, hdrbuf, sizeof(hdrbuf)) != kStatus_Success)
+		return kStatus_Fail;
+	if (f_sync(&fileRWObject) != FR_OK) {
+		PRINTF("Sync file failed. \r\n");
+		return kStatus_Fail;
+	}
+
+	bzero(s_copyMap, sizeof(s_copyMap));
+	s_dataBase = SDMMC_FILE_HDR_SZ;
+	return kStatus_Success;
+}
+
+/* copy map of a sparse file; a file without a header is dense */
+status_t SDMMC_Simple::loadFileHdr(bool *sparse) {
+	sdmmc_file_hdr_t hdr;
+
+	*sparse = false;
+	bzero(&hdr, sizeof(hdr));
+	if ((f_size(&fileRWObject) >= SDMMC_FILE_HDR_SZ)
+			&& (cardReadAt(0, &hdr, sizeof(hdr)) != kStatus_Success))
+		return kStatus_Fail;
+
+	if (hdr.magic != SDMMC_FILE_MAGIC) {
+		memset(s_copyMap, 0xFF, sizeof(s_copyMap));
+		s_dataBase = 0;
+		PRINTF("RLIC.dat: dense, no copy map\r\n");
+		return kStatus_Success;
+	}
+
+	if ((hdr.version != SDMMC_FILE_VERSION)
+			|| (hdr.entries != (SDMMC_ENTRIES_MAX + 1))) {
+		PRINTF("RLIC.dat: version %d, %d entries not supported\r\n",
+				hdr.version, hdr.entries);
+		return kStatus_Fail;
+	}
+
+	/* zones past the ones in the file have no copies yet */
+	if (cardReadAt(SDMMC_MAP_OFFSET, s_copyMap, sizeof(s_copyMap))
+			!= kStatus_Success)
+		return kStatus_Fail;
+	s_dataBase = SDMMC_FILE_HDR_SZ;
+	*sparse = true;
+	return kStatus_Success;
+}
+
+/*
+ * copy just written goes into the map of a sparse file, after its data so
+ * a torn write never maps a copy holding whatever the clusters had
+ * before. Caller syncs.
+ */
+status_t SDMMC_Simple::markCopy(uint32_t fileidx, uint32_t copy) {
+	uint32_t bit = SDMMC_MAP_BIT(fileidx, copy);
+	uint32_t w = bit / 32;
+
+	if (sdmmcCopyMapped(fileidx, copy))
+		return kStatus_Success;
+
+	s_copyMap[w] |= (1U << (bit % 32));
+	return cardWriteAt(SDMMC_MAP_OFFSET + (w * sizeof(s_copyMap[0])),
+			&s_copyMap[w], sizeof(s_copyMap[0]));
+}
+
+/*
+ * Cluster link map of RLIC.dat for FatFs fast seek, so f_lseek() to a
+ * slot costs the same for every slot instead of following the FAT chain
+ * from the start of the file (and the copy map write goes back there after
+ * every entry). The map ends at the last cluster of the file: growing
+ * goes the slow way in cardWriteAt() and the map is built again when a
+ * cluster was added. A file in more fragments than the map holds is
+ * seeked the slow way.
+ */
+status_t SDMMC_Simple::linkMap(void) {
+#if SDMMC_FAST_SEEK
+	uint32_t clusterSz = fileRWObject.obj.fs->csize * FF_MAX_SS;
+	uint32_t clusters = (f_size(&fileRWObject) + clusterSz - 1) / clusterSz;
+	FRESULT error;
+
+	if (s_clmtOff)
+		return kStatus_Success;
+	fileRWObject.cltbl = s_clmt;
+	if (clusters == s_clmtClusters)
+		return kStatus_Success;
+
+	s_clmt[0] = SDMMC_CLMT_WORDS;
+	error = f_lseek(&fileRWObject, CREATE_LINKMAP);
+	if (error == FR_NOT_ENOUGH_CORE) {
+		PRINTF("RLIC.dat: link map needs %d words, fast seek off\r\n",
+				s_clmt[0]);
+		fileRWObject.cltbl = NULL;
+		s_clmtOff = true;
+		return kStatus_Success;
+	}
+	if (error != FR_OK) {
+		PRINTF("Link map file failed. \r\n");
+		fileRWObject.cltbl = NULL;
+		return kStatus_Fail;
+	}
+	s_clmtClusters = clusters;
+#endif
+	return kStatus_Success;
+}
+
+/*
+ * grow a dense file to both banks, SDMMC_STARTUP_FILL_SZ per call from
+ * startupOffset. New space is zero filled, clusters of an old deleted
+ * file could otherwise pass for valid entries. The fill starts at the end
+ * of the file, not a chunk boundary before it: a file from before the
+ * header ends inside its last written slot (slot 1000 ends at 4098080).
+ */
+status_t SDMMC_Simple::initFile(bool *done) {
+	FRESULT error;
+	UINT bytesWritten;
+	uint8_t data[SDMMC_INIT_CHUNK_SZ];
+	uint32_t fileSz = startupOffset;
+	uint32_t end = fileSz + SDMMC_STARTUP_FILL_SZ;
+
+	*done = (fileSz >= SDMMC_FILE_SZ);
+	if (*done)
+		return kStatus_Success;
+
+	if (f_lseek(&fileRWObject, fileSz) != FR_OK) {
+		PRINTF("Init lseek file failed. \r\n");
+		return kStatus_Fail;
+	}
+
+	bzero(data, sizeof(data));
+	while ((fileSz < SDMMC_FILE_SZ) && (fileSz < end)) {
+		/* a partial chunk first, to the next boundary */
+		UINT len = sizeof(data) - (fileSz % sizeof(data));
+
+		if (len > (SDMMC_FILE_SZ - fileSz))
+			len = SDMMC_FILE_SZ - fileSz;
+		error = f_write(&fileRWObject, data, len, &bytesWritten);
+		if ((error) || (bytesWritten != len)) {
+			PRINTF("Write file failed. \r\n");
+			return kStatus_Fail;
+		}
+		fileSz += len;
+	}
+
+	startupOffset = fileSz;
+	*done = (fileSz >= SDMMC_FILE_SZ);
+	return kStatus_Success;
+}
+
+#if SDMMC_USE_SDRAM_MIRROR
+/* load the file into SDRAM, one large sequential read per call */
+status_t SDMMC_Simple::loadMirror(bool *done) {
+	FRESULT error;
+	UINT bytesRead;
+	uint32_t elapsedMS;
+	uint32_t fileSz = f_size(&fileRWObject) - s_dataBase;
+	uint32_t off = startupOffset;
+	UINT chunk;
+
+	if (fileSz > SDMMC_MIRROR_SZ)
+		fileSz = SDMMC_MIRROR_SZ;
+
+	*done = false;
+	if (off < fileSz) {
+		if (!off)
+			lastFlushMS = SysTick_UptimeMS(); /* load start */
+		if (f_lseek(&fileRWObject, s_dataBase + off) != FR_OK) {
+			PRINTF("Mirror lseek file failed. \r\n");
+			return kStatus_Fail;
+		}
+
+		chunk = fileSz - off;
+		if (chunk > SDMMC_MIRROR_CHUNK_SZ)
+			chunk = SDMMC_MIRROR_CHUNK_SZ;
+		error = f_read(&fileRWObject, &s_qmirror[off], chunk, &bytesRead);
+		if ((error) || (bytesRead != chunk)) {
+			PRINTF("Mirror read file failed. \r\n");
+			return kStatus_Fail;
+		}
+		startupOffset = off + chunk;
+		return kStatus_Success;
+	}
+
+	/* entries past the end of the file read back as zero */
+	bzero(&s_qmirror[fileSz], SDMMC_MIRROR_SZ - fileSz);
+
+	bzero(dirty, sizeof(dirty));
+	dirtyCount = 0;
+
+	elapsedMS = SysTick_UptimeMS() - lastFlushMS;
+	lastFlushMS = SysTick_UptimeMS();
+	PRINTF("SDRAM mirror: %d KB loaded in %d ms (%d KB/s)\r\n",
+			fileSz / 1024, elapsedMS,
+			elapsedMS ? (fileSz / elapsedMS) * 1000 / 1024 : 0);
+
+	resolveMirror();
+
+	startupOffset = 0;
+	*done = true;
+	return kStatus_Success;
+}
+
+/* pick the current copy of every entry, checked in SDRAM */
+void SDMMC_Simple::resolveMirror(void) {
+	uint32_t startMS = SysTick_UptimeMS();
+	uint32_t count[SDMMC_COPY_NONE + 1] = { 0 };
+	uint32_t recovered = 0;
+	static const sdmmc_entry_hdr_t noHdr = { 0, 0, 0, 0 };
+
+	for (uint32_t fileidx = 0; fileidx < SDMMC_SLOTS_MAX; fileidx++) {
+		const sdmmc_entry_hdr_t *hdr[2];
+		bool used[2];
+		uint32_t first;
+
+		for (uint32_t c = SDMMC_COPY_A; c <= SDMMC_COPY_B; c++) {
+			hdr[c] = (const sdmmc_entry_hdr_t*) &s_qmirror[SDMMC_COPY_OFFSET(
+					fileidx, c)];
+			if (!sdmmcCopyMapped(fileidx, c))
+				hdr[c] = &noHdr; /* a hole, whatever the clusters hold */
+			used[c] = sdmmcEntryMagic(hdr[c]->magic)
+					&& (sdmmcStoredLen(hdr[c]) <= SDMMC_ENTRY_DATA_MAX);
+		}
+
+		first = sdmmcNewestCopy(hdr, used);
+		s_entryCopy[fileidx] = SDMMC_COPY_UNKNOWN;
+		for (uint32_t i = 0; i < 2; i++) {
+			uint32_t c = i ? (first ^ 1) : first;
+
+			if (!used[c])
+				continue;
+			if (RLIC_Crc32((const uint8_t*) hdr[c] + SDMMC_ENTRY_HDR_SZ,
+					sdmmcStoredLen(hdr[c])) == hdr[c]->crc) {
+				s_entryCopy[fileidx] = c;
+				s_entrySeq[fileidx] = hdr[c]->seq;
+				recovered += i;
+				break;
+			}
+		}
+
+		if (s_entryCopy[fileidx] == SDMMC_COPY_UNKNOWN) {
+			s_entrySeq[fileidx] = sdmmcNewestSeq(hdr);
+			if (!s_dataBase && !sdmmcEntryMagic(hdr[SDMMC_COPY_A]->magic))
+				s_entryCopy[fileidx] = SDMMC_COPY_LEGACY;
+			else
+				s_entryCopy[fileidx] = SDMMC_COPY_NONE;
+		}
+		count[s_entryCopy[fileidx]]++;
+	}
+
+	PRINTF("RLIC.dat: %d A, %d B, %d legacy, %d lost, %d recovered "
+			"in %d ms\r\n", count[SDMMC_COPY_A], count[SDMMC_COPY_B],
+			count[SDMMC_COPY_LEGACY], count[SDMMC_COPY_NONE], recovered,
+			SysTick_UptimeMS() - startMS);
+}
+#endif
+
+/* write dirty mirror entries back to the card, one sync at the end */
+status_t SDMMC_Simple::flush(void) {
+#if SDMMC_USE_SDRAM_MIRROR
+	uint32_t startMS = SysTick_UptimeMS();
+	uint32_t flushed = dirtyCount;
+
+	if (!dirtyCount) {
+		lastFlushMS = startMS;
+		return kStatus_Success;
+	}
+
+	for (uint32_t w = 0; w < (sizeof(dirty) / sizeof(dirty[0])); w++) {
+		while (dirty[w]) {
+			uint32_t bit = __builtin_ctz(dirty[w]);
+			uint32_t fileidx = (w * 32) + bit;
+			uint32_t offset = SDMMC_COPY_OFFSET(fileidx,
+					s_entryCopy[fileidx]);
+			const sdmmc_entry_hdr_t *hdr =
+					(const sdmmc_entry_hdr_t*) &s_qmirror[offset];
+
+			if (cardWriteAt(s_dataBase + offset, &s_qmirror[offset],
+					SDMMC_ENTRY_HDR_SZ + sdmmcStoredLen(hdr)) != kStatus_Success) {
+				return kStatus_Fail;
 			}
+			if (markCopy(fileidx, s_entryCopy[fileidx]) != kStatus_Success)
+				return kStatus_Fail;
+			dirty[w] &= ~(1U << bit);
+			dirtyCount--;
 		}
 	}
 
@@ -110,8 +756,59 @@ status_t SDMMC_Simple::open(void) {
 		return kStatus_Fail;
 	}
 
+	lastFlushMS = SysTick_UptimeMS();
+	PRINTF("SDRAM mirror: flushed %d entries in %d ms\r\n", flushed,
+			lastFlushMS - startMS);
+#endif
+	return kStatus_Success;
+}
+
+#if RLIC_TRACE
+/*
+ * Append whole trace blocks to TRACE.DAT, opened on first use. The file
+ * only grows by whole sectors, so FatFs writes them straight to the card;
+ * a sync every SDMMC_TRACE_SYNC_SZ bounds what a power cut loses, the
+ * steps themselves never wait for one.
+ */
+status_t SDMMC_Simple::traceAppend(const void *data, uint32_t len) {
+	UINT written;
+
+	if (!isReady())
+		return kStatus_Fail;
+
+	if (!traceOpen) {
+		if (f_open(&traceFile, SDMMC_TRACE_PATH,
+				(FA_WRITE | FA_OPEN_APPEND)) != FR_OK) {
+			PRINTF("Failed to open TRACE.DAT!\r\n");
+			return kStatus_Fail;
+		}
+		/* a block cut short by a power cut, the next boot starts aligned */
+		if ((f_size(&traceFile) % RLIC_TRACE_BLOCK_SZ)
+				&& (f_lseek(&traceFile, f_size(&traceFile)
+						+ RLIC_TRACE_BLOCK_SZ
+						- (f_size(&traceFile) % RLIC_TRACE_BLOCK_SZ)) != FR_OK)) {
+			f_close(&traceFile);
+			return kStatus_Fail;
+		}
+		traceOpen = true;
+		traceUnsynced = 0;
+	}
+
+	if ((f_write(&traceFile, data, len, &written) != FR_OK)
+			|| (written != len)) {
+		PRINTF("Write TRACE.DAT failed.\r\n");
+		return kStatus_Fail;
+	}
+
+	traceUnsynced += len;
+	if (traceUnsynced >= SDMMC_TRACE_SYNC_SZ) {
+		traceUnsynced = 0;
+		if (f_sync(&traceFile) != FR_OK)
+			return kStatus_Fail;
+	}
 	return kStatus_Success;
 }
+#endif
 
 /* mount sdcard */
 status_t SDMMC_Simple::mount(void) {
@@ -119,6 +816,11 @@ status_t SDMMC_Simple::mount(void) {
 	FRESULT error;
 	const TCHAR driverNumberBuffer[3U] = { SDDISK + '0', ':', '/' };
 
+	if (s_entryBuf == NULL)
+		s_entryBuf = (uint8_t*) RLIC_DmaBuf_Alloc(SDMMC_ENTRIES_SZ);
+	if (s_entryBuf == NULL)
+		return kStatus_Fail;
+
 	if ((f_mount(&fileSystem, driverNumberBuffer, 0U) != FR_OK)) {
 		PRINTF("Mount volume failed.\r\n");
 		return kStatus_Fail;
@@ -150,14 +852,121 @@ status_t SDMMC_Simple::mount(void) {
 	return kStatus_Success;
 }
 
-/* read data from sdcard */
-status_t SDMMC_Simple::read(uint32_t numbytes, uint8_t *data,
-		uint32_t fileidx) {
+#if RLIC_SD_BENCHMARK
+/*
+ * Card speed as the controller sees it: the bus mode the card came up in,
+ * see RLIC_SdBus_Start(), then RLIC_SdBench_Run() on a scratch file next
+ * to RLIC.dat. The card is up and RLIC.dat open, slotSz is what a step
+ * reads and writes.
+ */
+status_t SDMMC_Simple::benchmark(uint32_t slotSz) {
+	rlic_sd_bench_cfg_t cfg;
+
+	RLIC_SdBus_Print(&g_sdBus);
+	if (g_sdBus.info.timing == RLIC_SD_BUS_TIMING_SDR12)
+		PRINTF("SD card: high speed not negotiated\r\n");
+
+	RLIC_CyclesInit();
+	cfg.now = RLIC_CyclesGet;
+	cfg.ticksPerUS = SystemCoreClock / 1000000U;
+	cfg.pdrv = SDDISK;
+	cfg.path = _T("/dir_1/BENCH.TMP");
+	cfg.regionSz = 4 * 1024 * 1024;
+	cfg.reps = 64;
+	cfg.slotSz = slotSz;
+
+	return RLIC_SdBench_Run(&cfg, NULL, 0, NULL);
+}
+#endif
+
+/* read data, from the SDRAM mirror when enabled */
+status_t SDMMC_Simple::read(uint32_t numbytes, uint8_t *data, uint32_t idx,
+		uint32_t zone) {
+	if ((idx > SDMMC_ENTRIES_MAX) || (zone >= SDMMC_ZONES_MAX)
+			|| (numbytes > SDMMC_ENTRY_DATA_MAX))
+		return kStatus_Fail;
+
+	uint32_t fileidx = SDMMC_SLOT(zone, idx);
+
+#if SDMMC_USE_SDRAM_MIRROR
+	uint32_t copy = s_entryCopy[fileidx];
+	uint32_t offset = SDMMC_COPY_OFFSET(fileidx, copy);
+	const sdmmc_entry_hdr_t *hdr = (const sdmmc_entry_hdr_t*) &s_qmirror[offset];
+
+	if (copy == SDMMC_COPY_LEGACY) {
+		memcpy(data, &s_qmirror[SDMMC_COPY_OFFSET(fileidx, SDMMC_COPY_A)],
+				numbytes);
+	} else if ((copy > SDMMC_COPY_B) || !sdmmcEntryFits(hdr, numbytes)) {
+		bzero(data, numbytes);
+	} else if (hdr->magic == SDMMC_ENTRY_MAGIC_CODED) {
+		if (!sdmmcDecode(&s_qmirror[offset + SDMMC_ENTRY_HDR_SZ],
+				sdmmcStoredLen(hdr), data, numbytes))
+			bzero(data, numbytes);
+	} else {
+		memcpy(data, &s_qmirror[offset + SDMMC_ENTRY_HDR_SZ], numbytes);
+	}
+	return kStatus_Success;
+#else
+	return cardRead(numbytes, data, fileidx);
+#endif
+}
+
+/* update data, the mirror is written back by flush() */
+status_t SDMMC_Simple::write(uint32_t numbytes, uint8_t *data, uint32_t idx,
+		uint32_t zone) {
+	if ((idx > SDMMC_ENTRIES_MAX) || (zone >= SDMMC_ZONES_MAX)
+			|| (numbytes > SDMMC_ENTRY_DATA_MAX))
+		return kStatus_Fail;
+
+	uint32_t fileidx = SDMMC_SLOT(zone, idx);
+
+#if SDMMC_USE_SDRAM_MIRROR
+	uint32_t copy;
+	sdmmc_entry_hdr_t *hdr;
+
+	/*
+	 * one target copy per flush period: rewriting the same copy until it
+	 * is flushed keeps the one on the card intact
+	 */
+	if (dirty[fileidx / 32] & (1U << (fileidx % 32))) {
+		copy = s_entryCopy[fileidx];
+	} else {
+		copy = sdmmcTargetCopy(fileidx);
+		dirty[fileidx / 32] |= (1U << (fileidx % 32));
+		dirtyCount++;
+	}
+
+	hdr = (sdmmc_entry_hdr_t*) &s_qmirror[SDMMC_COPY_OFFSET(fileidx, copy)];
+	sdmmcEncode(hdr, (uint8_t*) hdr + SDMMC_ENTRY_HDR_SZ, data, numbytes);
+	hdr->seq = s_entrySeq[fileidx] + 1;
+	s_entryCopy[fileidx] = copy;
+	s_entrySeq[fileidx] = hdr->seq;
+
+	if ((SysTick_UptimeMS() - lastFlushMS) >= SDMMC_MIRROR_FLUSH_MS)
+		return flush();
+
+	return kStatus_Success;
+#else
+	if (cardWrite(numbytes, data, fileidx) != kStatus_Success)
+		return kStatus_Fail;
+
+	if (f_sync(&fileRWObject) != FR_OK) {
+		PRINTF("Sync file failed. \r\n");
+		return kStatus_Fail;
+	}
+
+	return kStatus_Success;
+#endif
+}
+
+/* read raw bytes at a file offset */
+status_t SDMMC_Simple::cardReadAt(uint32_t offset, void *data,
+		uint32_t numbytes) {
 
 	FRESULT error;
 	UINT bytesRead;
 
-	if (f_lseek(&fileRWObject, SDMMC_ENTRIES_OFFSET(fileidx)) != FR_OK) {
+	if (f_lseek(&fileRWObject, offset) != FR_OK) {
 		PRINTF("Read lseek file failed. \r\n");
 		return kStatus_Fail;
 	}
@@ -171,14 +980,23 @@ status_t SDMMC_Simple::read(uint32_t numbytes, uint8_t *data,
 	return kStatus_Success;
 }
 
-/* update sdcard data */
-status_t SDMMC_Simple::write(uint32_t numbytes, uint8_t *data,
-		uint32_t fileidx) {
+/* write raw bytes at a file offset, caller syncs */
+status_t SDMMC_Simple::cardWriteAt(uint32_t offset, const void *data,
+		uint32_t numbytes) {
 
 	FRESULT error;
 	UINT bytesWritten;
+	bool grow = false;
+
+#if SDMMC_FAST_SEEK
+	/* fast seek cannot take the file past its last cluster */
+	if (fileRWObject.cltbl && ((offset + numbytes) > f_size(&fileRWObject))) {
+		fileRWObject.cltbl = NULL;
+		grow = true;
+	}
+#endif
 
-	if (f_lseek(&fileRWObject, SDMMC_ENTRIES_OFFSET(fileidx)) != FR_OK) {
+	if (f_lseek(&fileRWObject, offset) != FR_OK) {
 		PRINTF("Write lseek file failed. \r\n");
 		return kStatus_Fail;
 	}
@@ -189,11 +1007,168 @@ status_t SDMMC_Simple::write(uint32_t numbytes, uint8_t *data,
 		return kStatus_Fail;
 	}
 
-	if (f_sync(&fileRWObject) != FR_OK) {
-		PRINTF("Sync file failed. \r\n");
-		return kStatus_Fail;
+	return grow ? linkMap() : kStatus_Success;
+}
+
+/*
+ * check one copy against its header, payload into data unless NULL; a
+ * coded payload is read whole and decoded into data
+ */
+status_t SDMMC_Simple::cardCheckCopy(uint32_t fileidx, uint32_t copy,
+		const sdmmc_entry_hdr_t *hdr, uint8_t *data, bool *valid) {
+
+	uint32_t offset = SDMMC_CARD_OFFSET(fileidx, copy) + SDMMC_ENTRY_HDR_SZ;
+	uint32_t stored = sdmmcStoredLen(hdr);
+	uint32_t crc = 0;
+
+	if (data && (hdr->magic == SDMMC_ENTRY_MAGIC_CODED)) {
+		if (cardReadAt(offset, s_entryBuf, stored) != kStatus_Success)
+			return kStatus_Fail;
+		*valid = (RLIC_Crc32(s_entryBuf, stored) == hdr->crc)
+				&& sdmmcDecode(s_entryBuf, stored, data, hdr->len >> 16);
+		return kStatus_Success;
+	}
+
+	if (data) {
+		if (cardReadAt(offset, data, stored) != kStatus_Success)
+			return kStatus_Fail;
+		crc = RLIC_Crc32(data, stored);
+	} else {
+		uint8_t chunk[SDMMC_CHECK_CHUNK_SZ];
+
+		for (uint32_t off = 0; off < stored; off += sizeof(chunk)) {
+			uint32_t len = stored - off;
+
+			if (len > sizeof(chunk))
+				len = sizeof(chunk);
+			if (cardReadAt(offset + off, chunk, len) != kStatus_Success)
+				return kStatus_Fail;
+			crc = RLIC_Crc32_Update(crc, chunk, len);
+		}
+	}
+
+	*valid = (crc == hdr->crc);
+	return kStatus_Success;
+}
+
+/*
+ * Find the newest copy of an entry whose CRC holds. Runs once per entry
+ * after boot, on first access, so recovering from a torn write costs the
+ * entries actually used instead of a scan of the whole file.
+ * With data NULL the payload is only checked.
+ */
+status_t SDMMC_Simple::cardResolve(uint32_t numbytes, uint32_t fileidx,
+		uint8_t *data) {
+
+	sdmmc_entry_hdr_t hdrbuf[2];
+	const sdmmc_entry_hdr_t *hdr[2] = { &hdrbuf[0], &hdrbuf[1] };
+	bool used[2], valid;
+	uint32_t first;
+
+	for (uint32_t c = SDMMC_COPY_A; c <= SDMMC_COPY_B; c++) {
+		/* not in the map: never written, nothing to read */
+		bzero(&hdrbuf[c], sizeof(hdrbuf[c]));
+		if (sdmmcCopyMapped(fileidx, c)
+				&& (cardReadAt(SDMMC_CARD_OFFSET(fileidx, c), &hdrbuf[c],
+						sizeof(hdrbuf[c])) != kStatus_Success))
+			return kStatus_Fail;
+		used[c] = sdmmcEntryFits(hdr[c], numbytes);
 	}
 
+	first = sdmmcNewestCopy(hdr, used);
+	for (uint32_t i = 0; i < 2; i++) {
+		uint32_t c = i ? (first ^ 1) : first;
+
+		if (!used[c])
+			continue;
+		if (cardCheckCopy(fileidx, c, hdr[c], data, &valid)
+				!= kStatus_Success)
+			return kStatus_Fail;
+		if (valid) {
+			s_entryCopy[fileidx] = c;
+			s_entrySeq[fileidx] = hdr[c]->seq;
+			return kStatus_Success;
+		}
+		PRINTF("RLIC.dat entry %d copy %c corrupt\r\n", fileidx, 'A' + c);
+	}
+
+	s_entrySeq[fileidx] = sdmmcNewestSeq(hdr);
+	if (!s_dataBase && !sdmmcEntryMagic(hdr[SDMMC_COPY_A]->magic)) {
+		/* written before entries had headers, or never written */
+		s_entryCopy[fileidx] = SDMMC_COPY_LEGACY;
+		if (data)
+			return cardReadAt(SDMMC_CARD_OFFSET(fileidx, SDMMC_COPY_A), data,
+					numbytes);
+		return kStatus_Success;
+	}
+
+	/* no good copy left, the entry starts over */
+	if (hdr[SDMMC_COPY_A]->magic || hdr[SDMMC_COPY_B]->magic)
+		PRINTF("RLIC.dat entry %d lost, reset\r\n", fileidx);
+	s_entryCopy[fileidx] = SDMMC_COPY_NONE;
+	if (data)
+		bzero(data, numbytes);
+	return kStatus_Success;
+}
+
+/* read the current copy of an entry from sdcard */
+status_t SDMMC_Simple::cardRead(uint32_t numbytes, uint8_t *data,
+		uint32_t fileidx) {
+
+	sdmmc_entry_hdr_t hdr;
+	uint32_t copy = s_entryCopy[fileidx];
+	bool valid = false;
+
+	switch (copy) {
+	case SDMMC_COPY_LEGACY:
+		return cardReadAt(SDMMC_CARD_OFFSET(fileidx, SDMMC_COPY_A), data,
+				numbytes);
+	case SDMMC_COPY_NONE:
+		bzero(data, numbytes);
+		return kStatus_Success;
+	case SDMMC_COPY_A:
+	case SDMMC_COPY_B:
+		if (cardReadAt(SDMMC_CARD_OFFSET(fileidx, copy), &hdr, sizeof(hdr))
+				!= kStatus_Success)
+			return kStatus_Fail;
+		if (sdmmcEntryFits(&hdr, numbytes)
+				&& (cardCheckCopy(fileidx, copy, &hdr, data, &valid)
+						!= kStatus_Success))
+			return kStatus_Fail;
+		if (valid)
+			return kStatus_Success;
+		break;
+	default:
+		break;
+	}
+
+	return cardResolve(numbytes, fileidx, data);
+}
+
+/* write a new copy of an entry to sdcard, caller syncs */
+status_t SDMMC_Simple::cardWrite(uint32_t numbytes, uint8_t *data,
+		uint32_t fileidx) {
+
+	sdmmc_entry_hdr_t *hdr = (sdmmc_entry_hdr_t*) s_entryBuf;
+	uint32_t copy, stored;
+
+	if ((s_entryCopy[fileidx] == SDMMC_COPY_UNKNOWN)
+			&& (cardResolve(numbytes, fileidx, NULL) != kStatus_Success))
+		return kStatus_Fail;
+
+	copy = sdmmcTargetCopy(fileidx);
+	stored = sdmmcEncode(hdr, &s_entryBuf[SDMMC_ENTRY_HDR_SZ], data, numbytes);
+	hdr->seq = s_entrySeq[fileidx] + 1;
+
+	/* header and payload in one go, a coded slot is a single sector */
+	if (cardWriteAt(SDMMC_CARD_OFFSET(fileidx, copy), s_entryBuf,
+			SDMMC_ENTRY_HDR_SZ + stored) != kStatus_Success)
+		return kStatus_Fail;
+	if (markCopy(fileidx, copy) != kStatus_Success)
+		return kStatus_Fail;
+
+	s_entryCopy[fileidx] = copy;
+	s_entrySeq[fileidx] = hdr->seq;
 	return kStatus_Success;
 }
 
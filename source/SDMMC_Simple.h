@@ -27,24 +27,147 @@
 
 #include "sdmmc_config.h"
 #include "ff.h"
+#include "rlic_trace.h"
 
 #define SDMMC_ENTRIES_MAX		(1000)
 
+/* learners sharing RLIC.dat, each zone has its own entries */
+#ifndef SDMMC_ZONES_MAX
+#ifdef RLIC_ZONES
+#define SDMMC_ZONES_MAX			(RLIC_ZONES)
+#else
+#define SDMMC_ZONES_MAX			(1)
+#endif
+#endif
+#define SDMMC_SLOTS_MAX			(SDMMC_ZONES_MAX * (SDMMC_ENTRIES_MAX + 1))
+
+/* keep a full copy of RLIC.dat in SDRAM, card is only written on flush */
+#ifndef SDMMC_USE_SDRAM_MIRROR
+#define SDMMC_USE_SDRAM_MIRROR	(0)
+#endif
+#define SDMMC_MIRROR_FLUSH_MS	(60 * 1000) /* periodic write back */
+#define SDMMC_MIRROR_CHUNK_SZ	(64 * 1024) /* boot load read size */
+
+/* boot time card benchmark, see SDMMC_Simple::benchmark() */
+#ifndef RLIC_SD_BENCHMARK
+#define RLIC_SD_BENCHMARK		(0)
+#endif
+
+/* card bring up, one step per SDMMC_Simple::startup() call */
+enum sdmmc_startup_t {
+	SDMMC_STARTUP_HOST = 0,
+	SDMMC_STARTUP_CARD, /* waiting for a card */
+	SDMMC_STARTUP_MOUNT,
+	SDMMC_STARTUP_OPEN,
+	SDMMC_STARTUP_FILL, /* growing a new file */
+	SDMMC_STARTUP_MIRROR, /* loading the SDRAM mirror */
+	SDMMC_STARTUP_READY,
+	SDMMC_STARTUP_FAILED,
+};
+#define SDMMC_STARTUP_FILL_SZ	(32 * 1024) /* zero fill per step */
+
+/* reserve the whole of a new RLIC.dat in one run of clusters (f_expand) */
+#ifndef SDMMC_CONTIGUOUS
+#define SDMMC_CONTIGUOUS		(0)
+#endif
+
+/* seek RLIC.dat through a cluster link map, not the FAT chain */
+#ifndef SDMMC_FAST_SEEK
+#define SDMMC_FAST_SEEK			(1)
+#endif
+#define SDMMC_CLMT_WORDS		(64) /* 2 per fragment + 2 */
+
+/*
+ * store entries coded by RLIC_SlotCodec (rlic_slot_codec.h) when that is
+ * smaller, a Q table slot and its header then fit one sector. Coded and
+ * plain entries are read whatever this is set to.
+ */
+#ifndef SDMMC_COMPRESS
+#define SDMMC_COMPRESS			(0)
+#endif
+
+/* slot codec ratio and cycles, printed every SDMMC_CODEC_REPORT writes */
+#ifndef RLIC_SLOT_CODEC_BENCHMARK
+#define RLIC_SLOT_CODEC_BENCHMARK	(0)
+#endif
+#define SDMMC_CODEC_REPORT		(256)
+
+/* step trace file, RLIC_TRACE in rlic_trace.h; synced every so many bytes */
+#define SDMMC_TRACE_SYNC_SZ		(32 * 1024)
+
+/*
+ * RLIC.dat header: first 4 KB of files made by this version, followed by
+ * the copy map, two bits per slot (copy A, copy B) set once that copy has
+ * been written. The entries come after the header.
+ */
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t zones; /* when created, later zones append */
+	uint32_t entries; /* per zone bank */
+} sdmmc_file_hdr_t;
+
+/* per entry record, precedes the payload in each of the A/B copies */
+typedef struct {
+	uint32_t magic;
+	uint32_t seq; /* bumped on every write, newest valid copy wins */
+	uint32_t len; /* payload bytes, coded: decoded << 16 | stored */
+	uint32_t crc; /* RLIC_Crc32() of the payload */
+} sdmmc_entry_hdr_t;
+
 class SDMMC_Simple {
 private:
 	FATFS fileSystem; /* File system object */
 	FIL fileRWObject; /* File object */
 	bool dataFileExists = true;
+	bool fileOpen = false;
+	uint32_t startupState = SDMMC_STARTUP_HOST;
+	uint32_t startupOffset = 0; /* fill or mirror load position */
+	uint32_t startupMS = 0;
+#if SDMMC_USE_SDRAM_MIRROR
+	uint32_t dirty[(SDMMC_SLOTS_MAX + 31) / 32];
+	uint32_t dirtyCount = 0;
+	uint32_t lastFlushMS = 0;
+	status_t loadMirror(bool*);
+	void resolveMirror(void);
+#endif
+	status_t hostInit(void);
+	status_t cardInsert(void);
+	status_t open(void);
+	status_t initFile(bool*);
+	status_t cardReadAt(uint32_t, void*, uint32_t);
+	status_t cardWriteAt(uint32_t, const void*, uint32_t);
+	status_t cardCheckCopy(uint32_t, uint32_t, const sdmmc_entry_hdr_t*,
+			uint8_t*, bool*);
+	status_t cardResolve(uint32_t, uint32_t, uint8_t*);
+	status_t cardRead(uint32_t, uint8_t*, uint32_t);
+	status_t cardWrite(uint32_t, uint8_t*, uint32_t);
+	status_t createFile(void);
+	status_t loadFileHdr(bool*);
+	status_t markCopy(uint32_t, uint32_t);
+	status_t linkMap(void);
+#if RLIC_TRACE
+	FIL traceFile;
+	bool traceOpen = false;
+	uint32_t traceUnsynced = 0;
+#endif
 public:
 	SDMMC_Simple();
 	virtual ~SDMMC_Simple();
 
-	status_t sdcardWaitCardInsert(void);
-	status_t open(void);
+	status_t startup(bool*);
+	bool isReady(void);
 	status_t mount(void);
 	status_t close(void);
-	status_t read(uint32_t, uint8_t*, uint32_t);
-	status_t write(uint32_t, uint8_t*, uint32_t);
+	status_t read(uint32_t, uint8_t*, uint32_t, uint32_t = 0);
+	status_t write(uint32_t, uint8_t*, uint32_t, uint32_t = 0);
+	status_t flush(void);
+#if RLIC_TRACE
+	status_t traceAppend(const void*, uint32_t);
+#endif
+#if RLIC_SD_BENCHMARK
+	status_t benchmark(uint32_t);
+#endif
 	bool isDataFileExists(void);
 	void setDataFileExists(bool);
 };
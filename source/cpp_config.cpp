@@ -34,25 +34,36 @@
 //*****************************************************************************
 
 #include <stdlib.h>
+#include "rlic_mempool.h"
+
+#if RLIC_MEMPOOL_ENABLE
+// Serve from the fixed size-class pool, oversized or exhausted
+// requests still go to the heap.
+#define pool_new    RLIC_MemPool_AllocAny
+#define pool_delete RLIC_MemPool_FreeAny
+#else
+#define pool_new    malloc
+#define pool_delete free
+#endif
 
 void *operator new(size_t size)
 {
-    return malloc(size);
+    return pool_new(size);
 }
 
 void *operator new[](size_t size)
 {
-    return malloc(size);
+    return pool_new(size);
 }
 
 void operator delete(void *p)
 {
-    free(p);
+    pool_delete(p);
 }
 
 void operator delete[](void *p)
 {
-    free(p);
+    pool_delete(p);
 }
 
 extern "C" int __aeabi_atexit(void *object,
@@ -69,6 +80,15 @@ extern "C" void *malloc(size_t) {
 
 extern "C" void free(void *) {
 }
+#elif RLIC_MEMPOOL_ENABLE && RLIC_MEMPOOL_MALLOC
+// Whole heap replaced by the pool (calloc/realloc are not routed).
+extern "C" void *malloc(size_t size) {
+	return RLIC_MemPool_Alloc(size);
+}
+
+extern "C" void free(void *p) {
+	RLIC_MemPool_Free(p);
+}
 #endif
 
 #ifndef CPP_USE_CPPLIBRARY_TERMINATE_HANDLER
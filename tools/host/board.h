@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef _BOARD_H_
+#define _BOARD_H_
+
+/* Host stand-in, the I2C entry points are implemented by a fake device */
+#include "fsl_common.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define BOARD_TSL2591_BUS_ACCEL		(0U)
+#define BOARD_TSL2591_BUS_CODEC		(1U)
+
+status_t BOARD_TSL2591_I2C_Send(uint8_t bus, uint8_t deviceAddress,
+		uint32_t subAddress, uint8_t subaddressSize, uint32_t txBuff);
+status_t BOARD_TSL2591_I2C_Send_Clear(uint8_t bus, uint8_t deviceAddress,
+		uint32_t subAddress, uint8_t subaddressSize);
+status_t BOARD_TSL2591_I2C_Receive(uint8_t bus, uint8_t deviceAddress,
+		uint32_t subAddress, uint8_t subaddressSize, uint8_t *rxBuff,
+		uint8_t rxBuffSize);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _BOARD_H_ */
@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef FSL_COMMON_H_
+#define FSL_COMMON_H_
+
+/*
+ * Host stand-in for the SDK header, just enough for the drivers and
+ * utilities the programs in tools/ build on a PC. Not used on target.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef int32_t status_t;
+
+enum {
+	kStatus_Success = 0,
+	kStatus_Fail = 1,
+	kStatus_ReadOnly = 2,
+	kStatus_OutOfRange = 3,
+	kStatus_InvalidArgument = 4,
+	kStatus_Timeout = 5,
+};
+
+#define SDK_ALIGN(var, alignbytes) var __attribute__((aligned(alignbytes)))
+
+#define MAKE_STATUS(group, code) ((((group)*100) + (code)))
+
+enum {
+	kStatusGroup_LIST = 142,
+};
+
+/* one thread, nothing to mask */
+static inline uint32_t DisableGlobalIRQ(void) {
+	return 0;
+}
+
+static inline void EnableGlobalIRQ(uint32_t primask) {
+	(void) primask;
+}
+
+#endif /* FSL_COMMON_H_ */
@@ -0,0 +1,47 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef FSL_SD_DISK_H_
+#define FSL_SD_DISK_H_
+
+/* Host stand-in, the program provides the disk_*() functions, or the
+ * sd_disk_*() ones when it links fatfs/source/diskio.c. FatFs types come
+ * from the real ff.h, included first by SDMMC_Simple.h */
+#include "diskio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+DSTATUS sd_disk_initialize(BYTE pdrv);
+DSTATUS sd_disk_status(BYTE pdrv);
+DRESULT sd_disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count);
+DRESULT sd_disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count);
+DRESULT sd_disk_ioctl(BYTE pdrv, BYTE cmd, void *buff);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FSL_SD_DISK_H_ */
@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef FSL_TRNG_H_
+#define FSL_TRNG_H_
+
+/* Host stand-in, no TRNG: init fails and callers use their fallback seed */
+#include "fsl_common.h"
+
+typedef struct {
+	int sampleMode;
+} trng_config_t;
+
+typedef struct {
+	int unused;
+} TRNG_Type;
+
+#define TRNG						((TRNG_Type*) 0)
+#define kTRNG_SampleModeVonNeumann	(0)
+
+static inline void TRNG_GetDefaultConfig(trng_config_t *config) {
+	config->sampleMode = 0;
+}
+
+static inline status_t TRNG_Init(TRNG_Type *base, const trng_config_t *config) {
+	(void) base;
+	(void) config;
+	return kStatus_Fail;
+}
+
+static inline status_t TRNG_GetRandomData(TRNG_Type *base, void *data,
+		size_t dataSize) {
+	(void) base;
+	(void) data;
+	(void) dataSize;
+	return kStatus_Fail;
+}
+
+static inline void TRNG_Deinit(TRNG_Type *base) {
+	(void) base;
+}
+
+#endif /* FSL_TRNG_H_ */
@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef SDMMC_CONFIG_H_
+#define SDMMC_CONFIG_H_
+
+/*
+ * Host stand-in. The plant sim provides the SDMMC_Simple store itself,
+ * sdmmc_store_sim builds the real one with a card that is always there.
+ */
+#include "fsl_common.h"
+
+#define BOARD_SDMMC_DATA_BUFFER_ALIGN_SIZE	(4U)
+#define BOARD_SDMMC_SD_HOST_IRQ_PRIORITY	(5U)
+#define kSD_Inserted						(1U)
+
+typedef struct {
+	int unused;
+} sd_card_t;
+
+extern sd_card_t g_sd;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void BOARD_SD_Config(void *card, void *cd, uint32_t hostIrqPriority,
+		void *userData);
+status_t SD_HostInit(sd_card_t *card);
+bool SD_IsCardPresent(sd_card_t *card);
+status_t SD_PollingCardInsert(sd_card_t *card, uint32_t status);
+void SD_SetCardPower(sd_card_t *card, bool enable);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SDMMC_CONFIG_H_ */
@@ -0,0 +1,262 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Host check of the bus clear and error accounting in utilities/rlic_i2c_bus.c.
+ *
+ *   cc -O2 -I tools/host -I utilities tools/i2c_recovery_sim.c \
+ *       utilities/rlic_i2c_bus.c -o i2c_recovery_sim && ./i2c_recovery_sim
+ *
+ * A fake open drain bus stands in for the pins: a slave can hold SDA low for
+ * a number of clocks (stopped mid byte), for ever, or hold SCL low. The
+ * program checks the recovery outcome, that the bus ends with a STOP, the
+ * per device counters and the rate selection, then prints the wire time of
+ * the per sample TSL2591 read at each rate. Target numbers come from
+ * RLIC_I2C_BENCHMARK=1 in board.c (DWT cycles).
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "rlic_i2c_bus.h"
+
+typedef struct {
+	bool gpio; /* pins muxed to GPIO */
+	bool sclOut, sdaOut; /* master side, true = released */
+	int sdaHoldClocks; /* slave holds SDA for this many clocks, -1 for ever */
+	bool sclStuck;
+	uint32_t clocks; /* SCL rising edges seen in GPIO mode */
+	uint32_t stops;
+	uint32_t reinits;
+	uint32_t lastBaud;
+	uint64_t elapsedUs;
+} fake_bus_t;
+
+static bool fakeScl(const fake_bus_t *b) {
+	return b->sclOut && !b->sclStuck;
+}
+
+static bool fakeSda(const fake_bus_t *b) {
+	bool slaveLow = (b->sdaHoldClocks < 0)
+			|| (b->clocks < (uint32_t) b->sdaHoldClocks);
+
+	return b->sdaOut && !slaveLow;
+}
+
+static void fakeEnterGpio(void *ctx) {
+	fake_bus_t *b = (fake_bus_t*) ctx;
+
+	b->gpio = true;
+	b->sclOut = b->sdaOut = true;
+	b->clocks = 0;
+}
+
+static void fakeLeaveGpio(void *ctx, uint32_t baudHz) {
+	fake_bus_t *b = (fake_bus_t*) ctx;
+
+	b->gpio = false;
+	b->reinits++;
+	b->lastBaud = baudHz;
+}
+
+static void fakeSetScl(void *ctx, bool high) {
+	fake_bus_t *b = (fake_bus_t*) ctx;
+	bool was = fakeScl(b);
+
+	b->sclOut = high;
+	if (!was && fakeScl(b))
+		b->clocks++;
+}
+
+static void fakeSetSda(void *ctx, bool high) {
+	fake_bus_t *b = (fake_bus_t*) ctx;
+	bool was = fakeSda(b);
+
+	b->sdaOut = high;
+	if (!was && fakeSda(b) && fakeScl(b))
+		b->stops++;
+}
+
+static bool fakeGetScl(void *ctx) {
+	return fakeScl((fake_bus_t*) ctx);
+}
+
+static bool fakeGetSda(void *ctx) {
+	return fakeSda((fake_bus_t*) ctx);
+}
+
+static void fakeDelayUs(void *ctx, uint32_t us) {
+	((fake_bus_t*) ctx)->elapsedUs += us;
+}
+
+static const rlic_i2c_pin_ops_t s_fakeOps = { fakeEnterGpio, fakeLeaveGpio,
+		fakeSetScl, fakeSetSda, fakeGetScl, fakeGetSda, fakeDelayUs };
+
+static uint32_t s_failures;
+
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		s_failures++; \
+	} \
+} while (0)
+
+static void setupBus(rlic_i2c_bus_t *bus, fake_bus_t *fake,
+		rlic_i2c_device_t *dev) {
+	*fake = (fake_bus_t ) { 0 };
+	fake->sclOut = fake->sdaOut = true;
+	RLIC_I2C_BusInit(bus, "fake", &s_fakeOps, fake);
+	dev->name = "dev";
+	dev->address = 0x29;
+	dev->maxBaudHz = RLIC_I2C_BAUD_FAST;
+	RLIC_I2C_BusAddDevice(bus, dev);
+	RLIC_I2C_BusSelectBaud(bus);
+}
+
+/* slave stopped mid byte, released after n clocks */
+static void checkStuckSda(void) {
+	for (int n = 0; n <= RLIC_I2C_RECOVER_CLOCKS; n++) {
+		rlic_i2c_bus_t bus;
+		fake_bus_t fake;
+		rlic_i2c_device_t dev;
+
+		setupBus(&bus, &fake, &dev);
+		fake.sdaHoldClocks = n;
+		CHECK(RLIC_I2C_BusRecover(&bus) == kStatus_Success);
+		CHECK(fake.clocks == (uint32_t ) n + 1); /* + the STOP clock */
+		CHECK(fake.stops == 1);
+		CHECK(fake.reinits == 1 && !fake.gpio);
+		CHECK(fake.lastBaud == RLIC_I2C_BAUD_FAST);
+		CHECK(bus.recoveries == 1 && bus.recoveryFails == 0);
+		if (n == RLIC_I2C_RECOVER_CLOCKS)
+			printf("stuck SDA, %d clocks: cleared in %d us\n", n,
+					(int) fake.elapsedUs);
+	}
+}
+
+/* SDA held for ever, or SCL held low: reported, controller still reset */
+static void checkDeadBus(void) {
+	rlic_i2c_bus_t bus;
+	fake_bus_t fake;
+	rlic_i2c_device_t dev;
+
+	setupBus(&bus, &fake, &dev);
+	fake.sdaHoldClocks = -1;
+	CHECK(RLIC_I2C_BusRecover(&bus) == kStatus_Fail);
+	CHECK(fake.clocks == RLIC_I2C_RECOVER_CLOCKS);
+	CHECK(fake.stops == 0 && fake.reinits == 1);
+	CHECK(bus.recoveries == 0 && bus.recoveryFails == 1);
+
+	setupBus(&bus, &fake, &dev);
+	fake.sclStuck = true;
+	CHECK(RLIC_I2C_BusRecover(&bus) == kStatus_Fail);
+	CHECK(fake.clocks == 0 && fake.reinits == 1);
+	CHECK(fake.elapsedUs >= RLIC_I2C_STRETCH_MAX_US);
+	CHECK(bus.recoveryFails == 1);
+}
+
+/* what RLIC_I2C_BusComplete() does with each result */
+static void checkComplete(void) {
+	rlic_i2c_bus_t bus;
+	fake_bus_t fake;
+	rlic_i2c_device_t dev;
+
+	/* NAK storm: cleared on the RLIC_I2C_RECOVER_ERRORS'th NAK in a row */
+	setupBus(&bus, &fake, &dev);
+	for (int i = 1; i < RLIC_I2C_RECOVER_ERRORS; i++)
+		CHECK(!RLIC_I2C_BusComplete(&bus, &dev, RLIC_I2C_NAK));
+	CHECK(RLIC_I2C_BusComplete(&bus, &dev, RLIC_I2C_NAK));
+	CHECK(bus.recoveries == 1 && bus.errorRun == 0);
+	CHECK(dev.errors[RLIC_I2C_NAK] == RLIC_I2C_RECOVER_ERRORS);
+
+	/* a good transfer ends the run */
+	setupBus(&bus, &fake, &dev);
+	for (int i = 0; i < 10; i++) {
+		CHECK(!RLIC_I2C_BusComplete(&bus, &dev, RLIC_I2C_NAK));
+		CHECK(!RLIC_I2C_BusComplete(&bus, &dev, RLIC_I2C_OK));
+	}
+	CHECK(bus.recoveries == 0 && dev.transfers == 20);
+	CHECK(dev.errors[RLIC_I2C_NAK] == 10);
+	RLIC_I2C_BusPrintStats(&bus);
+
+	/* bus level errors clear straight away */
+	setupBus(&bus, &fake, &dev);
+	CHECK(RLIC_I2C_BusComplete(&bus, &dev, RLIC_I2C_PIN_LOW));
+	CHECK(RLIC_I2C_BusComplete(&bus, &dev, RLIC_I2C_BUSY));
+	CHECK(RLIC_I2C_BusComplete(&bus, &dev, RLIC_I2C_ARB_LOST));
+	CHECK(bus.recoveries == 3);
+
+	/* failed clear, no retry */
+	setupBus(&bus, &fake, &dev);
+	fake.sdaHoldClocks = -1;
+	CHECK(!RLIC_I2C_BusComplete(&bus, &dev, RLIC_I2C_PIN_LOW));
+	CHECK(bus.recoveryFails == 1);
+
+	/* unknown addresses land on the bus' catch all */
+	setupBus(&bus, &fake, &dev);
+	CHECK(RLIC_I2C_BusFindDevice(&bus, 0x29) == &dev);
+	CHECK(RLIC_I2C_BusFindDevice(&bus, 0x50) == &bus.other);
+}
+
+static void checkBaud(void) {
+	rlic_i2c_bus_t bus;
+	fake_bus_t fake;
+	rlic_i2c_device_t dev, fmp = { .name = "fmp", .address = 0x30,
+			.maxBaudHz = RLIC_I2C_BAUD_FAST_PLUS };
+
+	setupBus(&bus, &fake, &dev);
+	CHECK(bus.baudHz == RLIC_I2C_BAUD_FAST);
+	dev.maxBaudHz = RLIC_I2C_BAUD_FAST_PLUS;
+	RLIC_I2C_BusAddDevice(&bus, &fmp);
+	CHECK(RLIC_I2C_BusSelectBaud(&bus) == RLIC_I2C_BAUD_MAX);
+	dev.maxBaudHz = RLIC_I2C_BAUD_STANDARD;
+	CHECK(RLIC_I2C_BusSelectBaud(&bus) == RLIC_I2C_BAUD_STANDARD);
+}
+
+/*
+ * Wire time of the TSL2591 status and channel read: START, address+W,
+ * command, repeated START, address+R, 5 data bytes, STOP. 9 bits a byte.
+ */
+static void printWireTime(void) {
+	static const uint32_t bauds[] = { RLIC_I2C_BAUD_STANDARD,
+			RLIC_I2C_BAUD_FAST, RLIC_I2C_BAUD_FAST_PLUS };
+	const uint32_t bits = 1 + 9 + 9 + 1 + 9 + 5 * 9 + 1;
+
+	for (uint32_t i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++) {
+		printf("%4d kHz: 5 byte read %4d us on the wire, %5d B/s payload\n",
+				(int) (bauds[i] / 1000), (int) (bits * 1000000ULL / bauds[i]),
+				(int) (5ULL * bauds[i] / bits));
+	}
+}
+
+int main(void) {
+	checkStuckSda();
+	checkDeadBus();
+	checkComplete();
+	checkBaud();
+	printWireTime();
+
+	printf("%s (%d failures)\n", s_failures ? "FAILED" : "passed",
+			(int) s_failures);
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Host model of the idle manager in utilities/rlic_idle.c.
+ *
+ *   cc -O2 -I tools/host -I utilities tools/idle_sim.c utilities/rlic_idle.c \
+ *       -o idle_sim && ./idle_sim
+ *
+ * One zone runs an hour of control steps on a virtual clock the way the
+ * board does: the step runs (learner, LED frame and sensor reads over I2C,
+ * the RLIC.dat write over SD), each transfer waited for asleep, then the
+ * core sleeps until the sensor integration is done. Sleeps end at the next
+ * 1 ms tick or at the completion of the transfer going on. The scale op
+ * waits for a tick as the board does and the millisecond time base loses
+ * SIM_RELOAD_US at each switch, the SysTick reload. The program checks
+ * that no wait ends late, that the core is back at full clock whenever a
+ * wait returns, that long waits run divided, that the time base keeps to
+ * the reference and that the accounting adds up.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "rlic_idle.h"
+
+#define SIM_STEP_MS			(265) /* sensor integration and sample pair */
+#define SIM_LEARN_US		(3500) /* Q update */
+#define SIM_I2C_US			(420) /* LED frame, 400 kHz */
+#define SIM_I2C_XFERS		(3) /* frame, two sensor reads */
+#define SIM_SD_US			(2100) /* one RLIC.dat sector */
+#define SIM_RELOAD_US		(2) /* time base lost per clock switch */
+#define SIM_RUN_MS			(60 * 60 * 1000)
+
+static uint64_t s_nowUs; /* reference */
+static uint64_t s_lostUs; /* time base behind the reference */
+static uint64_t s_doneUs; /* transfer completion, 0 = none */
+static uint32_t s_div = 1;
+static uint32_t s_switches;
+static uint32_t s_failures;
+
+static void check(bool ok, const char *what) {
+	printf("  %-48s %s\n", what, ok ? "ok" : "FAILED");
+	if (!ok)
+		s_failures++;
+}
+
+static uint32_t simClockUS(void) {
+	return (uint32_t) s_nowUs;
+}
+
+static uint32_t simClockMS(void) {
+	return (uint32_t) ((s_nowUs - s_lostUs) / 1000);
+}
+
+/* WFI: to the next tick, or the transfer interrupt if sooner */
+static void simSleep(void) {
+	uint64_t tick = ((s_nowUs - s_lostUs) / 1000 + 1) * 1000 + s_lostUs;
+
+	if (s_doneUs && (s_doneUs < tick))
+		s_nowUs = s_doneUs;
+	else
+		s_nowUs = tick;
+}
+
+static void simScale(uint32_t div) {
+	uint32_t ms = simClockMS();
+
+	if (div == s_div)
+		return;
+	while (simClockMS() == ms)
+		simSleep();
+	s_lostUs += SIM_RELOAD_US;
+	s_div = div;
+	s_switches++;
+}
+
+static const rlic_idle_ops_t s_ops = { simClockUS, simClockMS, simSleep,
+		simScale };
+
+/* a transfer waited for the way board.c and fsl_sdmmc_osa.c do */
+static bool simTransfer(rlic_idle_t *idle, uint32_t us, uint32_t reason) {
+	bool fullClock = true;
+
+	s_doneUs = s_nowUs + us;
+	while (s_nowUs < s_doneUs) {
+		fullClock = fullClock && (s_div == 1);
+		RLIC_Idle_Sleep(idle, reason);
+	}
+	s_doneUs = 0;
+	return fullClock;
+}
+
+static void simReset(rlic_idle_t *idle, uint32_t scaleDiv) {
+	s_nowUs = 1000000; /* not at zero, the wrap safe compares matter */
+	s_lostUs = 0;
+	s_doneUs = 0;
+	s_div = 1;
+	s_switches = 0;
+	RLIC_Idle_Init(idle, &s_ops, scaleDiv);
+}
+
+/* an hour of steps, returns the number taken */
+static uint32_t simRun(rlic_idle_t *idle, uint32_t stepMS, bool *restored,
+		bool *fullClockXfers) {
+	uint32_t start = simClockMS();
+	uint32_t steps = 0;
+
+	*restored = true;
+	*fullClockXfers = true;
+	while ((simClockMS() - start) < SIM_RUN_MS) {
+		uint32_t stepStart = simClockMS();
+		uint32_t busy;
+
+		s_nowUs += SIM_LEARN_US;
+		for (uint32_t i = 0; i < SIM_I2C_XFERS; i++)
+			*fullClockXfers &= simTransfer(idle, SIM_I2C_US, RLIC_IDLE_I2C);
+		*fullClockXfers &= simTransfer(idle, SIM_SD_US, RLIC_IDLE_SD);
+		RLIC_Idle_Decision(idle);
+		steps++;
+
+		busy = simClockMS() - stepStart;
+		RLIC_Idle_WaitMS(idle, (busy < stepMS) ? (stepMS - busy) : 0);
+		*restored &= (s_div == 1);
+	}
+	return steps;
+}
+
+static void checkSteps(void) {
+	rlic_idle_t idle;
+	uint64_t total = 0;
+	bool restored, fullClock;
+	uint32_t steps, uj, minUJ, maxUJ;
+	int64_t driftUS;
+
+	printf("%d ms steps, core clock / %d while idle\n", SIM_STEP_MS,
+			RLIC_IDLE_SCALE_DIV);
+	simReset(&idle, RLIC_IDLE_SCALE_DIV);
+	steps = simRun(&idle, SIM_STEP_MS, &restored, &fullClock);
+	RLIC_Idle_PrintStats(&idle);
+
+	for (uint32_t s = 0; s < RLIC_IDLE_STATES; s++)
+		total += idle.timeUS[s];
+	driftUS = (int64_t) (simClockMS() - idle.startMS) * 1000 - (int64_t) total;
+	uj = RLIC_Idle_EnergyUJ(&idle);
+	minUJ = SIM_STEP_MS * RLIC_IDLE_SCALED_MW;
+	maxUJ = (SIM_STEP_MS + 10) * RLIC_IDLE_RUN_MW;
+
+	check(idle.decisions == steps, "every decision counted");
+	check(idle.lateMax == 0, "no wait ends past its deadline");
+	check(restored, "full clock back when a wait returns");
+	check(fullClock, "transfers waited for at full clock");
+	check(idle.scaled == idle.waits, "every step wait runs divided");
+	check(s_switches == 2 * idle.scaled, "one switch down and up per wait");
+	check(idle.timeUS[RLIC_IDLE_SCALED] * 100 > total * 80,
+			"over 80% of the hour at the divided clock");
+	check(idle.reasonUS[RLIC_IDLE_I2C] > 0 && idle.reasonUS[RLIC_IDLE_SD] > 0,
+			"I2C and SD waits slept");
+	if (driftUS < 0)
+		driftUS = -driftUS;
+	check(((uint64_t) driftUS * 1000000 < total * 100)
+			&& ((uint64_t) driftUS <= s_lostUs + 1000),
+			"time base within 100 ppm of the reference");
+	check((uj > minUJ) && (uj < maxUJ), "energy per decision in range");
+
+	/* the next hour starts from nothing */
+	RLIC_Idle_ResetStats(&idle);
+	check((idle.decisions == 0) && (idle.timeUS[RLIC_IDLE_SCALED] == 0),
+			"stats reset");
+}
+
+static void checkShortAndUnscaled(void) {
+	rlic_idle_t idle;
+	bool restored, fullClock;
+	uint32_t scaledUJ, sleepUJ;
+
+	/* below RLIC_IDLE_SCALE_MIN_MS of waiting the clock stays up */
+	simReset(&idle, RLIC_IDLE_SCALE_DIV);
+	(void) simRun(&idle, 12, &restored, &fullClock);
+	check((idle.scaled == 0) && (s_switches == 0) && restored,
+			"short waits sleep at full clock");
+	check(idle.lateMax == 0, "short waits on time");
+
+	simReset(&idle, RLIC_IDLE_SCALE_DIV);
+	(void) simRun(&idle, SIM_STEP_MS, &restored, &fullClock);
+	scaledUJ = RLIC_Idle_EnergyUJ(&idle);
+	simReset(&idle, 1);
+	(void) simRun(&idle, SIM_STEP_MS, &restored, &fullClock);
+	sleepUJ = RLIC_Idle_EnergyUJ(&idle);
+	check((idle.scaled == 0) && (s_switches == 0), "divider 1 never switches");
+	check(scaledUJ < sleepUJ, "divided clock costs less per decision");
+	printf("  %d uJ per decision asleep, %d uJ divided\n", sleepUJ, scaledUJ);
+}
+
+int main(void) {
+	checkSteps();
+	checkShortAndUnscaled();
+	printf(s_failures ? "FAILED\n" : "all checks passed\n");
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,342 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Host plant model for the learner, drives the real source/QLearning.cpp.
+ *
+ *   g++ -O2 -I tools/host -I source -I utilities tools/qlearn_plant_sim.cpp \
+ *       source/QLearning.cpp utilities/rlic_argmax.c utilities/rlic_tiles.c \
+ *       utilities/rlic_trace.c -o qlearn_plant_sim
+ *
+ *   qlearn_plant_sim [TRACE]
+ *
+ * With TRACE the run is recorded as the board records TRACE.DAT
+ * (rlic_trace.h), for tools/trace_replay.cpp.
+ *
+ * Add -DQLEARN_WARM_START=0 for slots that start from zero, or
+ * -DQLEARN_TILE_CODING=1 for the tile coded learner, -DQLEARN_TRACES=1 for
+ * Q(lambda) traces on the table, -DQLEARN_SIM_CARD_STEPS=n for a card that
+ * takes n steps to come up, run meanwhile by the default policy,
+ * -DQLEARN_SIM_REBOOT_DAY=d to reboot the board before day d. The room gets
+ * day light following a half sine over a compressed day plus the LEDs,
+ * lux rising with LEDs on times duty. Steps come at the board's rate (two
+ * samples each), so a time slot sees about two steps a day. A step is on
+ * target when its reward is QLEARN_SIM_ON_TARGET or better; the program
+ * prints the share of on target steps per day and the steps each slot
+ * needed before its first on target step and before its first step in the
+ * QLEARN_REWARD_MIN band, the learner's memory and card
+ * traffic and its host time per step (getQBrightness plus updateQTable).
+ * Target cycles come from RLIC_PROFILE_STEP=1.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <new>
+#include "QLearning.h"
+#include "rlic_tiles.h"
+#include "rlic_trace.h"
+
+#define QLEARN_SIM_DAY_MS		(480000) /* 960 slots, as the day light cycle */
+#define QLEARN_SIM_STEP_MS		(265)
+#define QLEARN_SIM_DAYS			(10)
+#define QLEARN_SIM_DAYLIGHT_MAX	(3000.0f) /* lux at noon */
+#define QLEARN_SIM_LED_LUX		(5.5f) /* per LED per duty step */
+#define QLEARN_SIM_NOISE_PCT	(2)
+#define QLEARN_SIM_ON_TARGET	(9) /* reward, within 10 % of the target */
+#define QLEARN_SIM_BAND			(8) /* QLEARN_REWARD_MIN, not pruned */
+#define QLEARN_SIM_SEED			(1234)
+#define QLEARN_SIM_SLOTS		(QTABLE_ENTRIES_MAX + 1)
+#ifndef QLEARN_SIM_CARD_STEPS
+#define QLEARN_SIM_CARD_STEPS	(0) /* steps before RLIC.dat is up */
+#endif
+#ifndef QLEARN_SIM_REBOOT_DAY
+#define QLEARN_SIM_REBOOT_DAY	(0) /* 0: no reboot */
+#endif
+
+/* card stand-in: entries held in memory, accesses counted */
+static uint8_t s_store[SDMMC_ZONES_MAX][QLEARN_SIM_SLOTS][4096];
+static uint32_t s_storeLen[SDMMC_ZONES_MAX][QLEARN_SIM_SLOTS];
+static uint32_t s_reads, s_writes;
+static uint32_t s_cardWait = QLEARN_SIM_CARD_STEPS; /* startup() calls left */
+static bool s_cardUp;
+
+SDMMC_Simple::SDMMC_Simple() {
+
+}
+
+SDMMC_Simple::~SDMMC_Simple() {
+
+}
+
+/* one call per step, as the board's main loop */
+status_t SDMMC_Simple::startup(bool *ready) {
+	if (s_cardWait) {
+		s_cardWait--;
+		*ready = false;
+	} else {
+		*ready = true;
+		s_cardUp = true;
+	}
+	return kStatus_Success;
+}
+
+bool SDMMC_Simple::isReady(void) {
+	return s_cardUp;
+}
+
+status_t SDMMC_Simple::close(void) {
+	return kStatus_Success;
+}
+
+status_t SDMMC_Simple::read(uint32_t numbytes, uint8_t *data, uint32_t idx,
+		uint32_t zone) {
+	if ((idx >= QLEARN_SIM_SLOTS) || (zone >= SDMMC_ZONES_MAX)
+			|| (numbytes > sizeof(s_store[0][0])))
+		return kStatus_Fail;
+	s_reads++;
+	if (s_storeLen[zone][idx] == numbytes)
+		memcpy(data, s_store[zone][idx], numbytes);
+	else
+		memset(data, 0, numbytes);
+	return kStatus_Success;
+}
+
+status_t SDMMC_Simple::write(uint32_t numbytes, uint8_t *data, uint32_t idx,
+		uint32_t zone) {
+	if ((idx >= QLEARN_SIM_SLOTS) || (zone >= SDMMC_ZONES_MAX)
+			|| (numbytes > sizeof(s_store[0][0])))
+		return kStatus_Fail;
+	s_writes++;
+	memcpy(s_store[zone][idx], data, numbytes);
+	s_storeLen[zone][idx] = numbytes;
+	return kStatus_Success;
+}
+
+static double nowNS(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* learner state per zone, by backend */
+static void printFootprint(void) {
+#if QLEARN_TILE_CODING
+	printf("learner: tile coding, %u weights, %u bytes DTCM per zone, "
+			"%u KB of RLIC.dat per zone\n",
+			(unsigned) (sizeof(rlic_tiles_weights_t) / sizeof(int16_t)),
+			(unsigned) sizeof(rlic_tiles_t),
+			(unsigned) (2 * 2 * 4)); /* two entries, A/B copies */
+#else
+	printf("learner: Q table, %u bytes DTCM, %u bytes RAM per zone, "
+			"%u KB of RLIC.dat per zone\n", (unsigned) (2 * RLIC_TILES_ACTIONS),
+			(unsigned) (QLEARN_WARM_START ?
+					(RLIC_TILES_ACTIONS + (QLEARN_SIM_SLOTS + 31) / 32 * 4) : 0),
+			(unsigned) (QLEARN_SIM_SLOTS * 2 * 4));
+#endif
+}
+
+/* trace writer: whole blocks to the file */
+static status_t traceWrite(void *ctx, const void *data, uint32_t len) {
+	return (fwrite(data, 1, len, (FILE*) ctx) == len) ?
+			kStatus_Success : kStatus_Fail;
+}
+
+static const rlic_trace_ops_t s_traceOps = { traceWrite };
+static rlic_trace_t s_trace;
+
+/* noise apart from the learner's random stream */
+static uint32_t s_noise = 1;
+
+static float plantLux(uint32_t dayTimeMS, const Brightness &b) {
+	float phase = (float) dayTimeMS / QLEARN_SIM_DAY_MS;
+	float daylight = QLEARN_SIM_DAYLIGHT_MAX * 4.0f * phase * (1.0f - phase);
+	float lux = daylight;
+	int32_t noise;
+
+	if (b.numOnLeds)
+		lux += b.numOnLeds * (b.duty + 1) * QLEARN_SIM_LED_LUX;
+	s_noise = (s_noise * 1103515245U) + 12345U;
+	noise = (int32_t) ((s_noise >> 16) % (2 * QLEARN_SIM_NOISE_PCT + 1))
+			- QLEARN_SIM_NOISE_PCT;
+	return lux * (100 + noise) / 100.0f;
+}
+
+int main(int argc, char **argv) {
+	static uint32_t slotSteps[QLEARN_SIM_SLOTS];
+	static bool slotHit[QLEARN_SIM_SLOTS];
+	static uint32_t bandSteps[QLEARN_SIM_SLOTS];
+	static bool bandHit[QLEARN_SIM_SLOTS];
+	QLearning learner(0);
+	uint32_t totalSteps = 0;
+	uint32_t hitSlots = 0, hitSteps = 0, seenSlots = 0;
+	uint32_t bandSlots = 0, bandTotal = 0;
+	uint32_t earlySteps = 0, earlyBand = 0;
+	double learnNS = 0;
+	bool ready = false;
+	FILE *trace = NULL;
+
+	QLearning::seedRandom(QLEARN_SIM_SEED);
+	if (argc > 1) {
+		trace = fopen(argv[1], "wb");
+		if (!trace) {
+			perror(argv[1]);
+			return 1;
+		}
+		RLIC_Trace_Init(&s_trace, &s_traceOps, trace);
+		RLIC_Trace_Boot(&s_trace, QLearning::getRandomSeed(),
+				QLEARN_BUILD_FLAGS, 1);
+	}
+
+	printFootprint();
+	printf("warm start %s, traces %s\n", QLEARN_WARM_START ? "on" : "off",
+			QLEARN_TRACES ? "on" : "off");
+	for (uint32_t day = 0; day < QLEARN_SIM_DAYS; day++) {
+		uint32_t steps = 0, onTarget = 0;
+
+		if (QLEARN_SIM_REBOOT_DAY && (day == QLEARN_SIM_REBOOT_DAY)) {
+			/* the board again, RLIC.dat as it was left */
+			learner.closeQStorage();
+			learner.~QLearning();
+			new (&learner) QLearning(0);
+			QLearning::seedRandom(QLEARN_SIM_SEED + day);
+			s_cardWait = QLEARN_SIM_CARD_STEPS;
+			s_cardUp = false;
+			ready = false;
+			if (trace)
+				RLIC_Trace_Boot(&s_trace, QLearning::getRandomSeed(),
+						QLEARN_BUILD_FLAGS, 1);
+		}
+
+		for (uint32_t t = 0; t < QLEARN_SIM_DAY_MS; t += QLEARN_SIM_STEP_MS) {
+			Brightness b;
+			bool exep;
+			double start;
+			uint32_t idx;
+			uint32_t lux;
+			uint8_t reward;
+			bool early;
+
+			if (!ready && (QLearning::startQStorage(&ready) != kStatus_Success)) {
+				printf("storage init failed\n");
+				return 1;
+			}
+			early = !ready;
+			exep = learner.runExploreExploit();
+			start = nowNS();
+			idx = learner.getQBrightness(b, t, exep, true);
+
+			if (idx >= QLEARN_SIM_SLOTS) {
+				printf("getQBrightness failed\n");
+				return 1;
+			}
+			learnNS += nowNS() - start;
+			lux = (uint32_t) plantLux(t, b);
+			reward = learner.getReward(lux);
+			start = nowNS();
+			if (!learner.updateQTable(b, reward, idx)) {
+				printf("updateQTable failed\n");
+				return 1;
+			}
+			learnNS += nowNS() - start;
+
+			if (trace) {
+				rlic_trace_step_t step;
+
+				step.flags = (early ? 0 : RLIC_TRACE_CARD_BEGIN)
+						| (exep ? RLIC_TRACE_EXPLORE : 0)
+						| (QLearning::isStorageReady() ? RLIC_TRACE_CARD : 0);
+				step.zone = 0;
+				step.reward = reward;
+				step.dayTimeMS = t;
+				step.lux = lux;
+				step.slot = uint16_t(idx);
+				step.numOnLeds = b.numOnLeds;
+				step.duty = b.duty;
+				RLIC_Trace_Step(&s_trace, &step);
+			}
+
+			if (early) {
+				earlySteps++;
+				earlyBand += (reward >= QLEARN_SIM_BAND);
+			}
+			steps++;
+			if (reward >= QLEARN_SIM_ON_TARGET)
+				onTarget++;
+			if (!slotSteps[idx] && !slotHit[idx])
+				seenSlots++;
+			if (!bandHit[idx]) {
+				bandSteps[idx]++;
+				if (reward >= QLEARN_SIM_BAND) {
+					bandHit[idx] = true;
+					bandSlots++;
+					bandTotal += bandSteps[idx];
+				}
+			}
+			if (!slotHit[idx]) {
+				slotSteps[idx]++;
+				if (reward >= QLEARN_SIM_ON_TARGET) {
+					slotHit[idx] = true;
+					hitSlots++;
+					hitSteps += slotSteps[idx];
+				}
+			}
+		}
+		totalSteps += steps;
+		printf("day %2u: %4u steps, %3u%% on target, %3u of %3u slots "
+				"reached\n", (unsigned) (day + 1), (unsigned) steps,
+				(unsigned) (onTarget * 100 / steps), (unsigned) hitSlots,
+				(unsigned) seenSlots);
+	}
+
+	printf("steps to target: %u.%02u per slot, %u slots never reached\n",
+			(unsigned) (hitSteps / (hitSlots ? hitSlots : 1)),
+			(unsigned) ((hitSteps * 100 / (hitSlots ? hitSlots : 1)) % 100),
+			(unsigned) (seenSlots - hitSlots));
+	printf("steps to band:   %u.%02u per slot, %u slots never reached\n",
+			(unsigned) (bandTotal / (bandSlots ? bandSlots : 1)),
+			(unsigned) ((bandTotal * 100 / (bandSlots ? bandSlots : 1)) % 100),
+			(unsigned) (seenSlots - bandSlots));
+	printf("card: %u.%02u reads, %u.%02u writes per step\n",
+			(unsigned) (s_reads / totalSteps),
+			(unsigned) ((s_reads * 100 / totalSteps) % 100),
+			(unsigned) (s_writes / totalSteps),
+			(unsigned) ((s_writes * 100 / totalSteps) % 100));
+	printf("learner: %.0f ns per step on this host\n", learnNS / totalSteps);
+	if (earlySteps)
+		printf("before the card: %u steps, %u%% in band\n",
+				(unsigned) earlySteps, (unsigned) (earlyBand * 100 / earlySteps));
+	learner.closeQStorage();
+	if (trace) {
+		if ((RLIC_Trace_Flush(&s_trace) != kStatus_Success) || fclose(trace)) {
+			printf("trace not written\n");
+			return 1;
+		}
+		printf("trace: %u steps in %u blocks\n", (unsigned) s_trace.steps,
+				(unsigned) s_trace.blocks);
+	}
+	return 0;
+}
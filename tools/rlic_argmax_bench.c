@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Host check and benchmark for utilities/rlic_argmax.c.
+ *
+ *   cc -O2 -I utilities tools/rlic_argmax_bench.c utilities/rlic_argmax.c \
+ *       -o rlic_argmax_bench && ./rlic_argmax_bench
+ *
+ * Compares the vector build of RLIC_ArgMaxU8()/RLIC_ArgMaxU8_Masked() with
+ * the scalar reference on random tables (few distinct values, so plenty of
+ * ties) and odd lengths, then reports ns per scan of a Q table sized input.
+ * The target numbers come from RLIC_ARGMAX_BENCHMARK=1 (DWT cycles).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "rlic_argmax.h"
+
+#define BENCH_LEN		(65 * 16) /* one Q table plane */
+#define BENCH_SCANS		(200000)
+#define CHECK_ROUNDS	(20000)
+
+static double nowNS(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(void) {
+	static uint8_t data[4096 + 3], mask[4096 + 3];
+	volatile uint32_t sink = 0;
+	uint32_t errors = 0;
+	double t0, ns[4];
+
+	srand(1);
+	for (uint32_t r = 0; r < CHECK_ROUNDS; r++) {
+		uint32_t len = rand() % 4096;
+		uint32_t off = rand() % 4; /* unaligned starts */
+		uint32_t range = 1 + (rand() % 255);
+
+		for (uint32_t i = 0; i < len; i++) {
+			data[off + i] = rand() % range;
+			mask[off + i] = rand() % 5;
+		}
+		if (RLIC_ArgMaxU8(&data[off], len)
+				!= RLIC_ArgMaxU8_Scalar(&data[off], len))
+			errors++;
+		if (RLIC_ArgMaxU8_Masked(&data[off], &mask[off], len, 3)
+				!= RLIC_ArgMaxU8_MaskedScalar(&data[off], &mask[off], len, 3))
+			errors++;
+		if (RLIC_ArgMaxU8_Masked(&data[off], &mask[off], len, 0) != len)
+			errors++;
+	}
+	printf("%u random tables: %u mismatches\n", CHECK_ROUNDS, errors);
+
+	for (uint32_t i = 0; i < BENCH_LEN; i++) {
+		data[i] = rand() % 11;
+		mask[i] = rand() % 4;
+	}
+
+	t0 = nowNS();
+	for (uint32_t n = 0; n < BENCH_SCANS; n++)
+		sink += RLIC_ArgMaxU8_Scalar(data, BENCH_LEN);
+	ns[0] = (nowNS() - t0) / BENCH_SCANS;
+	t0 = nowNS();
+	for (uint32_t n = 0; n < BENCH_SCANS; n++)
+		sink += RLIC_ArgMaxU8(data, BENCH_LEN);
+	ns[1] = (nowNS() - t0) / BENCH_SCANS;
+	t0 = nowNS();
+	for (uint32_t n = 0; n < BENCH_SCANS; n++)
+		sink += RLIC_ArgMaxU8_MaskedScalar(data, mask, BENCH_LEN, 3);
+	ns[2] = (nowNS() - t0) / BENCH_SCANS;
+	t0 = nowNS();
+	for (uint32_t n = 0; n < BENCH_SCANS; n++)
+		sink += RLIC_ArgMaxU8_Masked(data, mask, BENCH_LEN, 3);
+	ns[3] = (nowNS() - t0) / BENCH_SCANS;
+
+	printf("argmax %d bytes: scalar %.1f ns, vector %.1f ns\n", BENCH_LEN,
+			ns[0], ns[1]);
+	printf("masked argmax %d bytes: scalar %.1f ns, vector %.1f ns\n",
+			BENCH_LEN, ns[2], ns[3]);
+
+	return errors ? 1 : 0;
+}
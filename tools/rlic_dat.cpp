@@ -0,0 +1,997 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Host tool for RLIC.dat files as the card keeps them.
+ *
+ *   g++ -O2 -pthread -I source -I tools/host -I fatfs/source -I utilities \
+ *       tools/rlic_dat.cpp utilities/rlic_crc32.c utilities/rlic_slot_codec.c \
+ *       utilities/rlic_argmax.c -o rlic_dat
+ *
+ *   rlic_dat info FILE...              layout, copies per zone, learned cells
+ *   rlic_dat show [-z Z] FILE SLOT     one Q table, as __printQTable() prints it
+ *   rlic_dat summary [-z Z] [-a] FILE  best action and pruned share per slot
+ *   rlic_dat diff [-z Z] A B           slots whose tables differ, exits 1 if any
+ *   rlic_dat merge [-m max|avg|visits] [-p min|any|avg] [-Z N] [-j N]
+ *                  [-f v1|legacy] [-c] -o OUT FILE...
+ *   rlic_dat convert [-f v1|legacy] [-z Z] [-c] IN OUT
+ *   rlic_dat export [-b] [-a] IN OUT   CSV cells, or the raw slots with -b
+ *   rlic_dat bench [-j N] FILE...      slots resolved per second
+ *
+ * Files are mapped read only and each slot is picked as the firmware does
+ * (source/SDMMC_Simple.cpp): the newer of copy A and B whose CRC holds,
+ * coded entries decoded, headerless entries of a dense file read as they
+ * are. A raw entry is used in place, nothing is copied but coded ones.
+ * Only slots holding a Q table (2080 bytes, see source/QLearning.cpp) are
+ * shown, compared or merged; others, tile coding chunks, are carried over
+ * by convert.
+ *
+ * Merge combines each cell over the files that hold the slot, zone by
+ * zone, or with -Z every zone of every file into each of N output zones
+ * (rooms alike enough to share a policy). Q values (-m): the max, the
+ * average over the units that learned the cell, or that average weighted
+ * by the cells each unit learned in the slot, as no visit counts are kept.
+ * Pruning counters (-p): the lowest, so an action stays open if any unit
+ * found it good, the highest, pruned if any unit pruned it, or the
+ * average. -j threads (all cores by default) take slots off a shared
+ * counter a few at a time, each reading every file; files are mapped, so
+ * only the pages of the entries used are read.
+ *
+ * The merge output is a seed image: copied to a new card as
+ * /dir_1/SEED.DAT it becomes RLIC.dat on first boot, see
+ * SDMMC_Simple::open(), and the unit learns on from there.
+ * Output formats: v1 is the sparse file with header and copy map of this
+ * firmware (-c codes the entries, see SDMMC_COMPRESS), legacy the file of
+ * the build before the header: one zone, bank A only, raw slots 4 KB
+ * apart with no entry headers, zero filled to slot 1000, which grows it
+ * past 4096000 bytes when written. That build reads it back, this one
+ * takes it as legacy copies and grows it to both banks at boot. Convert
+ * writes zone -z of the input to it, a merge to legacy takes one zone.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "SDMMC_Simple.h"
+#include "rlic_crc32.h"
+#include "rlic_slot_codec.h"
+#include "rlic_argmax.h"
+
+/* card layout, as in source/SDMMC_Simple.cpp */
+#define DAT_ENTRY_MAGIC			(0x43494C52U) /* "RLIC" */
+#define DAT_ENTRY_MAGIC_CODED	(0x5A494C52U) /* "RLIZ" */
+#define DAT_FILE_MAGIC			(0x4D494C52U) /* "RLIM" */
+#define DAT_FILE_VERSION		(1)
+#define DAT_ENTRY_SZ			(4 * 1024)
+#define DAT_ENTRY_HDR_SZ		(sizeof(sdmmc_entry_hdr_t))
+#define DAT_ENTRY_DATA_MAX		(DAT_ENTRY_SZ - DAT_ENTRY_HDR_SZ)
+#define DAT_ENTRIES				(SDMMC_ENTRIES_MAX + 1)
+#define DAT_BANK_SZ				((size_t) DAT_ENTRIES * DAT_ENTRY_SZ)
+#define DAT_ZONE_SZ				(2 * DAT_BANK_SZ)
+#define DAT_FILE_HDR_SZ			(4 * 1024)
+#define DAT_MAP_OFFSET			(sizeof(sdmmc_file_hdr_t))
+#define DAT_MAP_BITS			((DAT_FILE_HDR_SZ - DAT_MAP_OFFSET) * 8)
+#define DAT_ZONES_MAX			(DAT_MAP_BITS / (2 * DAT_ENTRIES))
+#define DAT_LEGACY_SZ			((size_t) SDMMC_ENTRIES_MAX * DAT_ENTRY_SZ)
+#define DAT_SEQ_NEWER(a, b)		((int32_t) ((a) - (b)) > 0)
+
+/* Q table slot, as in source/QLearning.cpp */
+#define DAT_LEDS				(64 + 1)
+#define DAT_DUTIES				(15 + 1)
+#define DAT_CELLS				(DAT_LEDS * DAT_DUTIES)
+#define DAT_QTABLE_SZ			(2 * DAT_CELLS) /* Q values, then pruning */
+#define DAT_PRUNECTR_MAX		(3)
+#define DAT_SLOTS_PER_S			(2)
+
+#define DAT_USAGE				(-1) /* command line wrong, exit 2 */
+
+enum {
+	DAT_COPY_A = 0, DAT_COPY_B, DAT_COPY_LEGACY, DAT_COPY_NONE,
+};
+static const char *const s_copyName[] = { "A", "B", "legacy", "none" };
+
+enum {
+	DAT_FORMAT_V1 = 0, DAT_FORMAT_LEGACY,
+};
+
+/* merge rules for Q values and for pruning counters */
+enum {
+	DAT_Q_MAX = 0, DAT_Q_AVG, DAT_Q_VISITS,
+};
+static const char *const s_qRule[] = { "max", "avg", "visits" };
+enum {
+	DAT_PRUNE_MIN = 0, DAT_PRUNE_ANY, DAT_PRUNE_AVG,
+};
+static const char *const s_pruneRule[] = { "min", "any", "avg" };
+#define DAT_MERGE_CHUNK			(16) /* slots a merge thread takes at once */
+
+struct DatFile {
+	const char *path;
+	const uint8_t *base;
+	size_t size;
+	bool sparse; /* v1: header and copy map */
+	uint32_t zones;
+};
+
+struct DatSlot {
+	uint32_t copy;
+	uint32_t seq;
+	bool coded;
+	bool recovered; /* the newer copy was bad */
+	uint32_t len;
+	const uint8_t *data; /* in the mapping, or the caller's buffer */
+};
+
+static const uint8_t s_zero[DAT_ENTRY_SZ] = { 0 };
+
+static bool datOpen(DatFile *f, const char *path) {
+	struct stat st;
+	int fd = open(path, O_RDONLY);
+	sdmmc_file_hdr_t hdr;
+
+	memset(f, 0, sizeof(*f));
+	f->path = path;
+	if ((fd < 0) || fstat(fd, &st)) {
+		fprintf(stderr, "%s: cannot open\n", path);
+		if (fd >= 0)
+			close(fd);
+		return false;
+	}
+	f->size = (size_t) st.st_size;
+	f->base = s_zero;
+	if (f->size) {
+		void *p = mmap(NULL, f->size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (p == MAP_FAILED) {
+			fprintf(stderr, "%s: cannot map\n", path);
+			close(fd);
+			return false;
+		}
+		madvise(p, f->size, MADV_SEQUENTIAL);
+		f->base = (const uint8_t*) p;
+	}
+	close(fd); /* the mapping stays */
+
+	memset(&hdr, 0, sizeof(hdr));
+	if (f->size >= DAT_FILE_HDR_SZ)
+		memcpy(&hdr, f->base, sizeof(hdr));
+	if (hdr.magic == DAT_FILE_MAGIC) {
+		if ((hdr.version != DAT_FILE_VERSION) || (hdr.entries != DAT_ENTRIES)
+				|| !hdr.zones || (hdr.zones > DAT_ZONES_MAX)) {
+			fprintf(stderr, "%s: version %u, %u entries, %u zones not "
+					"supported\n", path, (unsigned) hdr.version,
+					(unsigned) hdr.entries, (unsigned) hdr.zones);
+			return false;
+		}
+		f->sparse = true;
+		f->zones = hdr.zones;
+		/* zones appended by a later build */
+		while ((f->zones < DAT_ZONES_MAX) && (f->size > (DAT_FILE_HDR_SZ
+				+ f->zones * DAT_ZONE_SZ)))
+			f->zones++;
+	} else {
+		f->zones = (uint32_t) ((f->size + DAT_ZONE_SZ - 1) / DAT_ZONE_SZ);
+		f->zones = f->zones ? f->zones : 1;
+	}
+	return true;
+}
+
+static void datClose(DatFile *f) {
+	if (f->size)
+		munmap((void*) f->base, f->size);
+	f->size = 0;
+}
+
+static size_t datCopyOffset(const DatFile *f, uint32_t zone, uint32_t idx,
+		uint32_t copy) {
+	return (f->sparse ? DAT_FILE_HDR_SZ : 0) + zone * DAT_ZONE_SZ
+			+ copy * DAT_BANK_SZ + (size_t) idx * DAT_ENTRY_SZ;
+}
+
+static bool datMapped(const DatFile *f, uint32_t zone, uint32_t idx,
+		uint32_t copy) {
+	uint32_t bit = ((zone * DAT_ENTRIES + idx) * 2) + copy;
+
+	if (!f->sparse)
+		return true;
+	return (f->base[DAT_MAP_OFFSET + bit / 8] >> (bit % 8)) & 1;
+}
+
+static uint32_t datStoredLen(const sdmmc_entry_hdr_t *hdr) {
+	return (hdr->magic == DAT_ENTRY_MAGIC_CODED) ?
+			(hdr->len & 0xFFFFU) : hdr->len;
+}
+
+static uint32_t datDataLen(const sdmmc_entry_hdr_t *hdr) {
+	return (hdr->magic == DAT_ENTRY_MAGIC_CODED) ? (hdr->len >> 16) : hdr->len;
+}
+
+/* current copy of a slot; buf takes a decoded one, DAT_ENTRY_SZ bytes */
+static void datSlot(const DatFile *f, uint32_t zone, uint32_t idx,
+		uint8_t *buf, DatSlot *s) {
+	sdmmc_entry_hdr_t hdr[2];
+	const uint8_t *payload[2];
+	bool used[2];
+	uint32_t first;
+
+	for (uint32_t c = DAT_COPY_A; c <= DAT_COPY_B; c++) {
+		size_t off = datCopyOffset(f, zone, idx, c);
+
+		memset(&hdr[c], 0, sizeof(hdr[c]));
+		payload[c] = s_zero;
+		if (datMapped(f, zone, idx, c) && ((off + DAT_ENTRY_HDR_SZ) <= f->size)) {
+			memcpy(&hdr[c], &f->base[off], sizeof(hdr[c]));
+			payload[c] = &f->base[off + DAT_ENTRY_HDR_SZ];
+		}
+		/* the last entry of a sparse file ends with its payload */
+		used[c] = ((hdr[c].magic == DAT_ENTRY_MAGIC)
+				|| (hdr[c].magic == DAT_ENTRY_MAGIC_CODED))
+				&& (datStoredLen(&hdr[c]) <= DAT_ENTRY_DATA_MAX)
+				&& (datDataLen(&hdr[c]) <= DAT_ENTRY_DATA_MAX)
+				&& ((off + DAT_ENTRY_HDR_SZ + datStoredLen(&hdr[c])) <= f->size);
+	}
+
+	first = (used[DAT_COPY_B] && (!used[DAT_COPY_A]
+			|| DAT_SEQ_NEWER(hdr[DAT_COPY_B].seq, hdr[DAT_COPY_A].seq))) ?
+			DAT_COPY_B : DAT_COPY_A;
+	for (uint32_t i = 0; i < 2; i++) {
+		uint32_t c = i ? (first ^ 1) : first;
+		uint32_t stored = datStoredLen(&hdr[c]);
+
+		if (!used[c] || (RLIC_Crc32(payload[c], stored) != hdr[c].crc))
+			continue;
+		s->copy = c;
+		s->seq = hdr[c].seq;
+		s->coded = (hdr[c].magic == DAT_ENTRY_MAGIC_CODED);
+		s->recovered = (i != 0);
+		s->len = datDataLen(&hdr[c]);
+		s->data = payload[c];
+		if (!s->coded)
+			return;
+		if (RLIC_SlotCodec_Decode(payload[c], stored, buf, DAT_ENTRY_SZ)
+				== s->len) {
+			s->data = buf;
+			return;
+		}
+	}
+
+	memset(s, 0, sizeof(*s));
+	s->len = DAT_QTABLE_SZ;
+	s->data = s_zero;
+	s->copy = DAT_COPY_NONE;
+	if (!f->sparse && (hdr[DAT_COPY_A].magic != DAT_ENTRY_MAGIC)
+			&& (hdr[DAT_COPY_A].magic != DAT_ENTRY_MAGIC_CODED)) {
+		size_t off = datCopyOffset(f, zone, idx, DAT_COPY_A);
+
+		if ((off + DAT_QTABLE_SZ) <= f->size) {
+			s->copy = DAT_COPY_LEGACY;
+			s->data = &f->base[off];
+		}
+	}
+}
+
+/* learned cells: a Q value or a pruning count */
+static uint32_t qtLearned(const uint8_t *qt) {
+	uint32_t n = 0;
+
+	for (uint32_t i = 0; i < DAT_CELLS; i++)
+		n += (qt[i] || qt[DAT_CELLS + i]);
+	return n;
+}
+
+static uint32_t qtPruned(const uint8_t *qt) {
+	uint32_t n = 0;
+
+	for (uint32_t i = 0; i < DAT_CELLS; i++)
+		n += (qt[DAT_CELLS + i] >= DAT_PRUNECTR_MAX);
+	return n;
+}
+
+/* the action the firmware exploits: first max Q, row major */
+static uint32_t qtBest(const uint8_t *qt) {
+	return RLIC_ArgMaxU8(qt, DAT_CELLS);
+}
+
+static bool datIsQTable(const DatSlot *s) {
+	return (s->copy != DAT_COPY_NONE) && (s->len == DAT_QTABLE_SZ);
+}
+
+static bool datZoneArg(const DatFile *f, uint32_t zone) {
+	if (zone < f->zones)
+		return true;
+	fprintf(stderr, "%s: zone %u, file has %u\n", f->path, (unsigned) zone,
+			(unsigned) f->zones);
+	return false;
+}
+
+/* output file, slots from a callback; all zero slots are left out of v1 */
+typedef bool (*DatSource)(void *ctx, uint32_t zone, uint32_t idx,
+		uint8_t *buf, const uint8_t **data, uint32_t *len);
+
+static bool datWrite(const char *path, uint32_t format, bool coded,
+		uint32_t zones, DatSource src, void *ctx) {
+	static uint8_t entry[DAT_ENTRY_SZ], buf[DAT_ENTRY_SZ];
+	static uint8_t hdrbuf[DAT_FILE_HDR_SZ];
+	sdmmc_file_hdr_t *fhdr = (sdmmc_file_hdr_t*) hdrbuf;
+	size_t base = (format == DAT_FORMAT_V1) ? DAT_FILE_HDR_SZ : 0;
+	size_t size = (format == DAT_FORMAT_V1) ? base : DAT_LEGACY_SZ;
+	uint32_t written = 0, codedCount = 0;
+	bool ok = true;
+	int fd;
+
+	if ((format == DAT_FORMAT_LEGACY) && (zones != 1)) {
+		fprintf(stderr, "%s: legacy holds one zone, not %u\n", path,
+				(unsigned) zones);
+		return false;
+	}
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		fprintf(stderr, "%s: cannot create\n", path);
+		return false;
+	}
+
+	memset(hdrbuf, 0, sizeof(hdrbuf));
+	fhdr->magic = DAT_FILE_MAGIC;
+	fhdr->version = DAT_FILE_VERSION;
+	fhdr->zones = zones;
+	fhdr->entries = DAT_ENTRIES;
+
+	for (uint32_t z = 0; ok && (z < zones); z++) {
+		for (uint32_t idx = 0; ok && (idx < DAT_ENTRIES); idx++) {
+			size_t off = base + z * DAT_ZONE_SZ + (size_t) idx * DAT_ENTRY_SZ;
+			sdmmc_entry_hdr_t *hdr = (sdmmc_entry_hdr_t*) entry;
+			const uint8_t *data;
+			uint32_t len, stored = 0, bit;
+
+			if (!src(ctx, z, idx, buf, &data, &len))
+				continue;
+			if (!memcmp(data, s_zero, len))
+				continue; /* reads as zero unmapped, or zero filled */
+			if (format == DAT_FORMAT_LEGACY) {
+				/* bank A, no header: the raw slot */
+				ok = pwrite(fd, data, len, off) == (ssize_t) len;
+				if ((off + len) > size)
+					size = off + len;
+				written++;
+				continue;
+			}
+
+			if (coded)
+				stored = RLIC_SlotCodec_Encode(data, len,
+						&entry[DAT_ENTRY_HDR_SZ], len - 1);
+			if (stored) {
+				hdr->magic = DAT_ENTRY_MAGIC_CODED;
+				hdr->len = (len << 16) | stored;
+				codedCount++;
+			} else {
+				memcpy(&entry[DAT_ENTRY_HDR_SZ], data, len);
+				hdr->magic = DAT_ENTRY_MAGIC;
+				hdr->len = stored = len;
+			}
+			hdr->seq = 1;
+			hdr->crc = RLIC_Crc32(&entry[DAT_ENTRY_HDR_SZ], stored);
+			ok = pwrite(fd, entry, DAT_ENTRY_HDR_SZ + stored, off)
+					== (ssize_t) (DAT_ENTRY_HDR_SZ + stored);
+			bit = ((z * DAT_ENTRIES + idx) * 2) + DAT_COPY_A;
+			hdrbuf[DAT_MAP_OFFSET + bit / 8] |= (uint8_t) (1U << (bit % 8));
+			if ((off + DAT_ENTRY_HDR_SZ + stored) > size)
+				size = off + DAT_ENTRY_HDR_SZ + stored;
+			written++;
+		}
+	}
+
+	if (ok && (format == DAT_FORMAT_V1))
+		ok = pwrite(fd, hdrbuf, sizeof(hdrbuf), 0) == (ssize_t) sizeof(hdrbuf);
+	ok = ok && !ftruncate(fd, (off_t) size);
+	ok = !close(fd) && ok;
+	if (!ok) {
+		fprintf(stderr, "%s: write failed\n", path);
+		return false;
+	}
+	printf("%s: %s, %u zones, %u slots written", path,
+			(format == DAT_FORMAT_V1) ? "v1" : "legacy", (unsigned) zones,
+			(unsigned) written);
+	if (format == DAT_FORMAT_V1)
+		printf(", %u coded", (unsigned) codedCount);
+	printf(", %zu bytes\n", size);
+	return true;
+}
+
+static int cmdInfo(int argc, char **argv) {
+	static uint8_t buf[DAT_ENTRY_SZ];
+	int rc = 0;
+
+	if (!argc)
+		return DAT_USAGE;
+	for (int a = 0; a < argc; a++) {
+		DatFile f;
+
+		if (!datOpen(&f, argv[a])) {
+			rc = 1;
+			continue;
+		}
+		printf("%s: %zu bytes, %s, %u zones\n", f.path, f.size,
+				f.sparse ? "v1 with copy map" : "dense, no header",
+				(unsigned) f.zones);
+		for (uint32_t z = 0; z < f.zones; z++) {
+			uint32_t count[DAT_COPY_NONE + 1] = { 0 };
+			uint32_t coded = 0, recovered = 0, other = 0, slots = 0;
+			uint64_t learned = 0;
+
+			for (uint32_t idx = 0; idx < DAT_ENTRIES; idx++) {
+				DatSlot s;
+
+				datSlot(&f, z, idx, buf, &s);
+				count[s.copy]++;
+				coded += s.coded;
+				recovered += s.recovered;
+				if (datIsQTable(&s)) {
+					uint32_t n = qtLearned(s.data);
+
+					learned += n;
+					slots += (n != 0);
+				} else if (s.copy != DAT_COPY_NONE) {
+					other++;
+				}
+			}
+			printf("  zone %u: %u A, %u B, %u legacy, %u none; %u coded, "
+					"%u from the older copy\n", (unsigned) z,
+					(unsigned) count[DAT_COPY_A], (unsigned) count[DAT_COPY_B],
+					(unsigned) count[DAT_COPY_LEGACY],
+					(unsigned) count[DAT_COPY_NONE], (unsigned) coded,
+					(unsigned) recovered);
+			printf("          %u slots learned, %llu cells (%.2f%%), %u not "
+					"Q tables\n", (unsigned) slots, (unsigned long long) learned,
+					100.0 * learned / ((double) DAT_ENTRIES * DAT_CELLS),
+					(unsigned) other);
+		}
+		datClose(&f);
+	}
+	return rc;
+}
+
+static int cmdShow(int argc, char **argv, uint32_t zone) {
+	static uint8_t buf[DAT_ENTRY_SZ];
+	DatFile f;
+	DatSlot s;
+	uint32_t idx;
+
+	if (argc != 2)
+		return DAT_USAGE;
+	idx = (uint32_t) strtoul(argv[1], NULL, 0);
+	if (!datOpen(&f, argv[0]) || !datZoneArg(&f, zone) || (idx >= DAT_ENTRIES))
+		return 1;
+
+	datSlot(&f, zone, idx, buf, &s);
+	printf("%s zone %u slot %u (%.1f s): copy %s, seq %u%s, %u bytes\n",
+			f.path, (unsigned) zone, (unsigned) idx,
+			(double) idx / DAT_SLOTS_PER_S, s_copyName[s.copy],
+			(unsigned) s.seq, s.coded ? ", coded" : "", (unsigned) s.len);
+	if (s.len != DAT_QTABLE_SZ) {
+		printf("not a Q table\n");
+		datClose(&f);
+		return 0;
+	}
+	for (uint32_t i = 0; i < DAT_LEDS; i++) {
+		printf("\nR-%u:\t", (unsigned) i);
+		for (uint32_t j = 0; j < DAT_DUTIES; j++)
+			printf("%u [%u]\t", s.data[i * DAT_DUTIES + j],
+					s.data[DAT_CELLS + i * DAT_DUTIES + j]);
+	}
+	printf("\n");
+	datClose(&f);
+	return 0;
+}
+
+static int cmdSummary(int argc, char **argv, uint32_t zone, bool all) {
+	static uint8_t buf[DAT_ENTRY_SZ];
+	DatFile f;
+
+	if (argc != 1)
+		return DAT_USAGE;
+	if (!datOpen(&f, argv[0]) || !datZoneArg(&f, zone))
+		return 1;
+
+	printf("slot\ttime_s\tcopy\tleds\tduty\tq\tlearned\tpruned_%%\n");
+	for (uint32_t idx = 0; idx < DAT_ENTRIES; idx++) {
+		DatSlot s;
+		uint32_t best, learned;
+
+		datSlot(&f, zone, idx, buf, &s);
+		if (!datIsQTable(&s))
+			continue;
+		learned = qtLearned(s.data);
+		if (!learned && !all)
+			continue;
+		best = qtBest(s.data);
+		printf("%u\t%.1f\t%s\t%u\t%u\t%u\t%u\t%.1f\n", (unsigned) idx,
+				(double) idx / DAT_SLOTS_PER_S, s_copyName[s.copy],
+				(unsigned) (best / DAT_DUTIES), (unsigned) (best % DAT_DUTIES),
+				s.data[best], (unsigned) learned,
+				100.0 * qtPruned(s.data) / DAT_CELLS);
+	}
+	datClose(&f);
+	return 0;
+}
+
+static int cmdDiff(int argc, char **argv, uint32_t zone) {
+	static uint8_t bufA[DAT_ENTRY_SZ], bufB[DAT_ENTRY_SZ];
+	uint32_t slots = 0, cells = 0, moved = 0;
+	DatFile fa, fb;
+
+	if (argc != 2)
+		return DAT_USAGE;
+	if (!datOpen(&fa, argv[0]) || !datOpen(&fb, argv[1])
+			|| !datZoneArg(&fa, zone) || !datZoneArg(&fb, zone))
+		return 2;
+
+	printf("slot\tcells\tmax_dq\tbest_a\tbest_b\n");
+	for (uint32_t idx = 0; idx < DAT_ENTRIES; idx++) {
+		DatSlot sa, sb;
+		uint32_t n = 0, dqMax = 0, ba, bb;
+
+		datSlot(&fa, zone, idx, bufA, &sa);
+		datSlot(&fb, zone, idx, bufB, &sb);
+		if ((sa.len != DAT_QTABLE_SZ) || (sb.len != DAT_QTABLE_SZ))
+			continue;
+		for (uint32_t i = 0; i < DAT_QTABLE_SZ; i++) {
+			uint32_t d = abs((int) sa.data[i] - (int) sb.data[i]);
+
+			n += (d != 0);
+			if ((i < DAT_CELLS) && (d > dqMax))
+				dqMax = d;
+		}
+		if (!n)
+			continue;
+		ba = qtBest(sa.data);
+		bb = qtBest(sb.data);
+		printf("%u\t%u\t%u\t%u/%u\t%u/%u%s\n", (unsigned) idx, (unsigned) n,
+				(unsigned) dqMax, (unsigned) (ba / DAT_DUTIES),
+				(unsigned) (ba % DAT_DUTIES), (unsigned) (bb / DAT_DUTIES),
+				(unsigned) (bb % DAT_DUTIES), (ba != bb) ? "\t*" : "");
+		slots++;
+		cells += n;
+		moved += (ba != bb);
+	}
+	printf("%u slots differ, %u cells, best action moved in %u\n",
+			(unsigned) slots, (unsigned) cells, (unsigned) moved);
+	datClose(&fa);
+	datClose(&fb);
+	return slots ? 1 : 0;
+}
+
+/*
+ * Merged Q tables, one per slot. Threads take DAT_MERGE_CHUNK slots at a
+ * time off 'next' until none are left, so a thread that hits heavy slots
+ * (many coded or learned ones) does not hold the others up.
+ */
+struct DatMerge {
+	std::vector<DatFile> *files;
+	uint32_t qRule;
+	uint32_t pruneRule;
+	uint32_t zones; /* of the output */
+	bool pool; /* every zone of every file into each output zone */
+	std::atomic<uint32_t> next;
+	std::atomic<uint64_t> slotsRead;
+	std::vector<uint8_t> table; /* zones x slots x DAT_QTABLE_SZ */
+	std::vector<uint8_t> present;
+};
+
+/* one output slot over every file, returns the input slots used */
+static uint32_t mergeSlot(DatMerge *m, uint32_t n, uint8_t *buf) {
+	uint32_t z = n / DAT_ENTRIES, idx = n % DAT_ENTRIES, units = 0;
+	uint8_t *out = &m->table[(size_t) n * DAT_QTABLE_SZ];
+	uint8_t pMin[DAT_CELLS], pMax[DAT_CELLS];
+	uint32_t pSum[DAT_CELLS];
+	uint64_t qSum[DAT_CELLS], qWeight[DAT_CELLS];
+
+	memset(out, 0, DAT_QTABLE_SZ);
+	memset(pMin, 0xFF, sizeof(pMin));
+	memset(pMax, 0, sizeof(pMax));
+	memset(pSum, 0, sizeof(pSum));
+	memset(qSum, 0, sizeof(qSum));
+	memset(qWeight, 0, sizeof(qWeight));
+
+	for (DatFile &f : *m->files) {
+		uint32_t zFirst = m->pool ? 0 : z;
+		uint32_t zLast = m->pool ? (f.zones - 1) : z;
+
+		for (uint32_t fz = zFirst; (fz <= zLast) && (fz < f.zones); fz++) {
+			DatSlot s;
+			uint32_t w = 1;
+
+			datSlot(&f, fz, idx, buf, &s);
+			if (!datIsQTable(&s))
+				continue;
+			/*
+			 * no visit counts are kept, the cells a unit learned in the
+			 * slot stand in for how often it was there
+			 */
+			if (m->qRule == DAT_Q_VISITS)
+				w = qtLearned(s.data);
+			units++;
+			for (uint32_t i = 0; i < DAT_CELLS; i++) {
+				uint8_t q = s.data[i], p = s.data[DAT_CELLS + i];
+
+				out[i] = (q > out[i]) ? q : out[i];
+				qSum[i] += (uint64_t) q * w; /* unlearned cells add nothing */
+				qWeight[i] += (q != 0) ? w : 0;
+				pSum[i] += p;
+				pMin[i] = (p < pMin[i]) ? p : pMin[i];
+				pMax[i] = (p > pMax[i]) ? p : pMax[i];
+			}
+		}
+	}
+
+	m->present[n] = (units != 0);
+	if (!units)
+		return 0;
+	for (uint32_t i = 0; i < DAT_CELLS; i++) {
+		if ((m->qRule != DAT_Q_MAX) && qWeight[i])
+			out[i] = (uint8_t) ((qSum[i] + qWeight[i] / 2) / qWeight[i]);
+		if (m->pruneRule == DAT_PRUNE_MIN)
+			out[DAT_CELLS + i] = pMin[i];
+		else if (m->pruneRule == DAT_PRUNE_ANY)
+			out[DAT_CELLS + i] = pMax[i];
+		else
+			out[DAT_CELLS + i] = (uint8_t) ((pSum[i] + units / 2) / units);
+	}
+	return units;
+}
+
+static void mergeWorker(DatMerge *m) {
+	static thread_local uint8_t buf[DAT_ENTRY_SZ];
+	uint32_t total = m->zones * DAT_ENTRIES;
+	uint64_t read = 0;
+
+	for (;;) {
+		uint32_t first = m->next.fetch_add(DAT_MERGE_CHUNK);
+
+		if (first >= total)
+			break;
+		for (uint32_t n = first; (n < total) && (n < first + DAT_MERGE_CHUNK);
+				n++)
+			read += mergeSlot(m, n, buf);
+	}
+	m->slotsRead += read;
+}
+
+static bool mergeSource(void *ctx, uint32_t zone, uint32_t idx, uint8_t *buf,
+		const uint8_t **data, uint32_t *len) {
+	DatMerge *m = (DatMerge*) ctx;
+	size_t n = (size_t) zone * DAT_ENTRIES + idx;
+
+	(void) buf;
+	*data = &m->table[n * DAT_QTABLE_SZ];
+	*len = DAT_QTABLE_SZ;
+	return m->present[n] != 0;
+}
+
+static double nowMS(void) {
+	return std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int cmdMerge(int argc, char **argv, const char *out, uint32_t qRule,
+		uint32_t pruneRule, uint32_t zones, uint32_t jobs, uint32_t format,
+		bool coded) {
+	std::vector<DatFile> files;
+	std::vector<std::thread> threads;
+	DatMerge m;
+	double t0, ms;
+
+	if (!argc || !out || (zones > DAT_ZONES_MAX))
+		return DAT_USAGE;
+	t0 = nowMS();
+	files.resize(argc);
+	m.zones = 0;
+	for (int a = 0; a < argc; a++) {
+		if (!datOpen(&files[a], argv[a]))
+			return 1;
+		if (files[a].zones > m.zones)
+			m.zones = files[a].zones;
+	}
+	m.files = &files;
+	m.qRule = qRule;
+	m.pruneRule = pruneRule;
+	m.pool = (zones != 0);
+	m.zones = m.pool ? zones : m.zones;
+	m.next = 0;
+	m.slotsRead = 0;
+	m.table.resize((size_t) m.zones * DAT_ENTRIES * DAT_QTABLE_SZ);
+	m.present.assign((size_t) m.zones * DAT_ENTRIES, 0);
+
+	for (uint32_t j = 0; j < jobs; j++)
+		threads.push_back(std::thread(mergeWorker, &m));
+	for (std::thread &t : threads)
+		t.join();
+	ms = nowMS() - t0;
+	printf("merged %d files (Q %s, pruning %s%s) on %u threads in %.1f ms: "
+			"%.0f files/s, %llu slots, %.1f MB of tables\n", argc,
+			s_qRule[qRule], s_pruneRule[pruneRule], m.pool ? ", pooled" : "",
+			(unsigned) jobs, ms, argc * 1000.0 / ms,
+			(unsigned long long) m.slotsRead,
+			m.slotsRead * (double) DAT_QTABLE_SZ / 1e6);
+
+	for (DatFile &f : files)
+		datClose(&f);
+	return datWrite(out, format, coded, m.zones, mergeSource, &m) ? 0 : 1;
+}
+
+struct DatConvert {
+	DatFile f;
+	uint32_t first; /* input zone of output zone 0 */
+};
+
+static bool convertSource(void *ctx, uint32_t zone, uint32_t idx,
+		uint8_t *buf, const uint8_t **data, uint32_t *len) {
+	DatConvert *c = (DatConvert*) ctx;
+	DatSlot s;
+
+	datSlot(&c->f, c->first + zone, idx, buf, &s);
+	*data = s.data;
+	*len = s.len;
+	return s.copy != DAT_COPY_NONE;
+}
+
+/* every zone to v1, or the one -z picks to legacy */
+static int cmdConvert(int argc, char **argv, uint32_t zone, uint32_t format,
+		bool coded) {
+	DatConvert c;
+	uint32_t zones;
+	bool ok;
+
+	if (argc != 2)
+		return DAT_USAGE;
+	if (!datOpen(&c.f, argv[0]))
+		return 1;
+	c.first = (format == DAT_FORMAT_LEGACY) ? zone : 0;
+	zones = (format == DAT_FORMAT_LEGACY) ? 1 : c.f.zones;
+	ok = datZoneArg(&c.f, c.first)
+			&& datWrite(argv[1], format, coded, zones, convertSource, &c);
+	datClose(&c.f);
+	return ok ? 0 : 1;
+}
+
+static int cmdExport(int argc, char **argv, bool bin, bool all) {
+	static uint8_t buf[DAT_ENTRY_SZ];
+	DatFile f;
+	FILE *out;
+
+	if (argc != 2)
+		return DAT_USAGE;
+	if (!datOpen(&f, argv[0]))
+		return 1;
+	out = fopen(argv[1], bin ? "wb" : "w");
+	if (!out) {
+		fprintf(stderr, "%s: cannot create\n", argv[1]);
+		return 1;
+	}
+
+	if (!bin)
+		fprintf(out, "zone,slot,leds,duty,q,pruned\n");
+	for (uint32_t z = 0; z < f.zones; z++) {
+		for (uint32_t idx = 0; idx < DAT_ENTRIES; idx++) {
+			DatSlot s;
+
+			datSlot(&f, z, idx, buf, &s);
+			if (bin) {
+				/* fixed stride, a slot that is no Q table reads as zero */
+				fwrite(datIsQTable(&s) ? s.data : s_zero, 1, DAT_QTABLE_SZ,
+						out);
+				continue;
+			}
+			if (!datIsQTable(&s))
+				continue;
+			for (uint32_t i = 0; i < DAT_CELLS; i++) {
+				if (all || s.data[i] || s.data[DAT_CELLS + i])
+					fprintf(out, "%u,%u,%u,%u,%u,%u\n", (unsigned) z,
+							(unsigned) idx, (unsigned) (i / DAT_DUTIES),
+							(unsigned) (i % DAT_DUTIES), s.data[i],
+							s.data[DAT_CELLS + i]);
+			}
+		}
+	}
+	datClose(&f);
+	return fclose(out) ? 1 : 0;
+}
+
+static void benchSlots(std::vector<DatFile> *files, uint32_t first,
+		uint32_t step, uint64_t *bytes) {
+	static thread_local uint8_t buf[DAT_ENTRY_SZ];
+	uint64_t sum = 0;
+
+	for (DatFile &f : *files) {
+		for (uint32_t n = first; n < (f.zones * DAT_ENTRIES); n += step) {
+			DatSlot s;
+
+			datSlot(&f, n / DAT_ENTRIES, n % DAT_ENTRIES, buf, &s);
+			if (datIsQTable(&s))
+				sum += qtBest(s.data) + s.len;
+		}
+	}
+	*bytes = sum;
+}
+
+static int cmdBench(int argc, char **argv, uint32_t jobs) {
+	std::vector<DatFile> files;
+	uint64_t slots = 0, mapped = 0;
+	double t0 = nowMS();
+
+	if (!argc)
+		return DAT_USAGE;
+	files.resize(argc);
+	for (int a = 0; a < argc; a++) {
+		if (!datOpen(&files[a], argv[a]))
+			return 1;
+		slots += files[a].zones * DAT_ENTRIES;
+		mapped += files[a].size;
+	}
+	printf("%d files, %.1f MB mapped in %.1f ms\n", argc, mapped / 1e6,
+			nowMS() - t0);
+
+	for (uint32_t j = 1;; j = (j * 2 < jobs) ? j * 2 : jobs) {
+		std::vector<std::thread> threads;
+		std::vector<uint64_t> sink(j);
+
+		t0 = nowMS();
+		for (uint32_t t = 0; t < j; t++)
+			threads.push_back(std::thread(benchSlots, &files, t, j, &sink[t]));
+		for (std::thread &t : threads)
+			t.join();
+		t0 = nowMS() - t0;
+		printf("  %2u threads: %llu slots resolved in %.1f ms, %.0f slots/s\n",
+				(unsigned) j, (unsigned long long) slots, t0,
+				slots * 1000.0 / t0);
+		if (j == jobs)
+			break;
+	}
+
+	for (DatFile &f : files)
+		datClose(&f);
+	return 0;
+}
+
+static bool ruleArg(const char *arg, const char *const *names, uint32_t n,
+		uint32_t *rule) {
+	for (uint32_t i = 0; i < n; i++) {
+		if (!strcmp(arg, names[i])) {
+			*rule = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+static void usage(void) {
+	fprintf(stderr,
+			"usage: rlic_dat info FILE...\n"
+			"       rlic_dat show [-z ZONE] FILE SLOT\n"
+			"       rlic_dat summary [-z ZONE] [-a] FILE\n"
+			"       rlic_dat diff [-z ZONE] A B\n"
+			"       rlic_dat merge [-m max|avg|visits] [-p min|any|avg] [-Z N] "
+			"[-j N]\n"
+			"                      [-f v1|legacy] [-c] -o OUT FILE...\n"
+			"       rlic_dat convert [-f v1|legacy] [-z ZONE] [-c] IN OUT\n"
+			"       rlic_dat export [-b] [-a] IN OUT\n"
+			"       rlic_dat bench [-j N] FILE...\n");
+}
+
+int main(int argc, char **argv) {
+	const char *cmd, *out = NULL;
+	uint32_t zone = 0, format = DAT_FORMAT_V1;
+	uint32_t jobs = std::thread::hardware_concurrency();
+	uint32_t qRule = DAT_Q_MAX, pruneRule = DAT_PRUNE_MIN, zones = 0;
+	bool all = false, bin = false, coded = false;
+	int opt, rc;
+
+	if (argc < 2) {
+		usage();
+		return 2;
+	}
+	cmd = argv[1];
+	argc--;
+	argv++;
+	while ((opt = getopt(argc, argv, "z:am:p:Z:j:f:co:b")) != -1) {
+		switch (opt) {
+		case 'z':
+			zone = (uint32_t) strtoul(optarg, NULL, 0);
+			break;
+		case 'a':
+			all = true;
+			break;
+		case 'm':
+			if (!ruleArg(optarg, s_qRule, 3, &qRule)) {
+				usage();
+				return 2;
+			}
+			break;
+		case 'p':
+			if (!ruleArg(optarg, s_pruneRule, 3, &pruneRule)) {
+				usage();
+				return 2;
+			}
+			break;
+		case 'Z':
+			zones = (uint32_t) strtoul(optarg, NULL, 0);
+			break;
+		case 'j':
+			jobs = (uint32_t) strtoul(optarg, NULL, 0);
+			break;
+		case 'f':
+			format = strcmp(optarg, "legacy") ? DAT_FORMAT_V1 : DAT_FORMAT_LEGACY;
+			break;
+		case 'c':
+			coded = true;
+			break;
+		case 'o':
+			out = optarg;
+			break;
+		case 'b':
+			bin = true;
+			break;
+		default:
+			usage();
+			return 2;
+		}
+	}
+	argc -= optind;
+	argv += optind;
+	jobs = jobs ? jobs : 1;
+
+	if (!strcmp(cmd, "info"))
+		rc = cmdInfo(argc, argv);
+	else if (!strcmp(cmd, "show"))
+		rc = cmdShow(argc, argv, zone);
+	else if (!strcmp(cmd, "summary"))
+		rc = cmdSummary(argc, argv, zone, all);
+	else if (!strcmp(cmd, "diff"))
+		rc = cmdDiff(argc, argv, zone);
+	else if (!strcmp(cmd, "merge"))
+		rc = cmdMerge(argc, argv, out, qRule, pruneRule, zones, jobs, format,
+				coded);
+	else if (!strcmp(cmd, "convert"))
+		rc = cmdConvert(argc, argv, zone, format, coded);
+	else if (!strcmp(cmd, "export"))
+		rc = cmdExport(argc, argv, bin, all);
+	else if (!strcmp(cmd, "bench"))
+		rc = cmdBench(argc, argv, jobs);
+	else
+		rc = DAT_USAGE;
+
+	if (rc == DAT_USAGE) {
+		usage();
+		rc = 2;
+	}
+	return rc;
+}
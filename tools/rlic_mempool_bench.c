@@ -0,0 +1,267 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Host check and benchmark for utilities/rlic_mempool.c.
+ *
+ *   cc -O2 -I tools/host -I utilities tools/rlic_mempool_bench.c \
+ *       utilities/rlic_mempool.c -o rlic_mempool_bench && ./rlic_mempool_bench
+ *
+ * A random alloc/free churn over live slots, sizes mostly below 256 bytes
+ * and a few above the largest class, goes through RLIC_MemPool_AllocAny()
+ * as new/delete, OSA and FatFs do. A model of the class free lists
+ * predicts every allocation: the class it comes from or the heap. Each
+ * block is filled and checked before it is freed, so blocks that overlap
+ * show up. At the end the per class stats (in use, high water, allocs,
+ * fails) and the heap fallbacks must match the model. Then the same churn
+ * is timed against newlib/glibc malloc and free. The target numbers come
+ * from RLIC_MEMPOOL_BENCHMARK=1 (DWT cycles).
+ * Exits non zero when a check fails.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "rlic_mempool.h"
+
+#define BENCH_COUNT(sz, n)	+1
+#define BENCH_DEF(sz, n)	{ (sz), (n) },
+#define BENCH_CLASSES		(0 RLIC_MEMPOOL_CLASS_LIST(BENCH_COUNT))
+
+#define CHURN_SLOTS			(64)
+#define CHURN_OPS			(200000)
+#define CHURN_BIG_SZ		(1100) /* above the largest class */
+#define TIMED_SLOTS			(16)
+#define TIMED_OPS			(2000000)
+
+static const uint16_t s_def[BENCH_CLASSES][2] = {
+RLIC_MEMPOOL_CLASS_LIST(BENCH_DEF) };
+
+/* what the pool should have done */
+typedef struct {
+	uint32_t freeBlocks[BENCH_CLASSES];
+	rlic_mempool_stats_t stats[BENCH_CLASSES];
+	uint32_t heap;
+} model_t;
+
+typedef struct {
+	uint8_t *p;
+	uint32_t size;
+	uint32_t cls; /* BENCH_CLASSES: the heap */
+} live_t;
+
+static uint32_t s_failures;
+static uint32_t s_seed = 0x2545F491;
+
+static void check(bool ok, const char *what) {
+	printf("  %-48s %s\n", what, ok ? "ok" : "FAILED");
+	if (!ok)
+		s_failures++;
+}
+
+static uint32_t nextRandom(void) {
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+static double nowNS(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* mostly small blocks, one in 64 larger than any class */
+static uint32_t churnSize(void) {
+	uint32_t r = nextRandom();
+
+	if ((r & 63) == 0)
+		return CHURN_BIG_SZ;
+	if ((r & 7) == 0)
+		return 257 + ((r >> 8) % 768);
+	return 1 + ((r >> 8) % 256);
+}
+
+static void modelInit(model_t *m) {
+	memset(m, 0, sizeof(*m));
+	for (uint32_t c = 0; c < BENCH_CLASSES; c++) {
+		m->freeBlocks[c] = s_def[c][1];
+		m->stats[c].blockSize = s_def[c][0];
+		m->stats[c].blocks = s_def[c][1];
+	}
+}
+
+/* as RLIC_MemPool_Alloc(): first fitting class, larger ones if it is dry */
+static uint32_t modelAlloc(model_t *m, uint32_t size) {
+	uint32_t c, first;
+
+	for (c = 0; c < BENCH_CLASSES; c++) {
+		if (size <= s_def[c][0])
+			break;
+	}
+	if (c == BENCH_CLASSES)
+		m->stats[BENCH_CLASSES - 1].fails++;
+	for (first = c; c < BENCH_CLASSES; c++) {
+		rlic_mempool_stats_t *st = &m->stats[c];
+
+		if (m->freeBlocks[c]) {
+			m->freeBlocks[c]--;
+			st->inUse++;
+			st->allocs++;
+			if (st->inUse > st->highWater)
+				st->highWater = st->inUse;
+			return c;
+		}
+		if (c == first)
+			st->fails++;
+	}
+	m->heap++;
+	return BENCH_CLASSES;
+}
+
+static void modelFree(model_t *m, uint32_t cls) {
+	if (cls < BENCH_CLASSES) {
+		m->freeBlocks[cls]++;
+		m->stats[cls].inUse--;
+	}
+}
+
+static bool liveIntact(const live_t *l, uint8_t fill) {
+	for (uint32_t i = 0; i < l->size; i++) {
+		if (l->p[i] != fill)
+			return false;
+	}
+	return true;
+}
+
+static void checkChurn(void) {
+	static live_t live[CHURN_SLOTS];
+	model_t m;
+	uint32_t wrongSource = 0, misaligned = 0, nulls = 0, overlaps = 0;
+	bool statsMatch = true, empty = true;
+
+	printf("random churn, %u ops over %u slots\n", CHURN_OPS, CHURN_SLOTS);
+	modelInit(&m);
+	for (uint32_t n = 0; n < CHURN_OPS; n++) {
+		uint32_t s = nextRandom() % CHURN_SLOTS;
+		live_t *l = &live[s];
+
+		if (l->p) {
+			overlaps += !liveIntact(l, (uint8_t) s);
+			RLIC_MemPool_FreeAny(l->p);
+			modelFree(&m, l->cls);
+			l->p = NULL;
+			continue;
+		}
+		l->size = churnSize();
+		l->cls = modelAlloc(&m, l->size);
+		l->p = (uint8_t*) RLIC_MemPool_AllocAny(l->size);
+		if (!l->p) {
+			nulls++;
+			continue;
+		}
+		wrongSource += (RLIC_MemPool_Owns(l->p) != (l->cls < BENCH_CLASSES));
+		misaligned += ((uintptr_t) l->p & 7) != 0;
+		memset(l->p, (int) s, l->size);
+	}
+
+	check(!nulls, "every request served");
+	check(!wrongSource, "pool or heap as the model predicts");
+	check(!misaligned, "blocks 8 byte aligned");
+	check(!overlaps, "no block written over by another");
+	for (uint32_t c = 0; c < BENCH_CLASSES; c++) {
+		rlic_mempool_stats_t st;
+
+		RLIC_MemPool_GetStats(c, &st);
+		statsMatch = statsMatch && !memcmp(&st, &m.stats[c], sizeof(st));
+	}
+	check(statsMatch, "class stats match the model");
+	check(RLIC_MemPool_HeapAllocs() == m.heap, "heap fallbacks match the model");
+	check(m.stats[BENCH_CLASSES - 1].fails > 0, "oversize requests counted");
+
+	for (uint32_t s = 0; s < CHURN_SLOTS; s++) {
+		if (live[s].p) {
+			overlaps += !liveIntact(&live[s], (uint8_t) s);
+			RLIC_MemPool_FreeAny(live[s].p);
+			live[s].p = NULL;
+		}
+	}
+	for (uint32_t c = 0; c < BENCH_CLASSES; c++) {
+		rlic_mempool_stats_t st;
+
+		RLIC_MemPool_GetStats(c, &st);
+		empty = empty && !st.inUse;
+	}
+	check(empty && !overlaps, "all blocks back after freeing");
+	check(RLIC_MemPool_Alloc(CHURN_BIG_SZ) == NULL, "pool alone refuses oversize");
+	RLIC_MemPool_PrintStats();
+}
+
+typedef void* (*bench_alloc_t)(size_t);
+typedef void (*bench_free_t)(void*);
+
+/* same churn, small blocks as the firmware makes them, ns per operation */
+static double timeChurn(bench_alloc_t a, bench_free_t f) {
+	void *slot[TIMED_SLOTS] = { 0 };
+	double t0;
+
+	s_seed = 0x12345678;
+	t0 = nowNS();
+	for (uint32_t n = 0; n < TIMED_OPS; n++) {
+		uint32_t r = nextRandom();
+		uint32_t s = r % TIMED_SLOTS;
+
+		if (slot[s]) {
+			f(slot[s]);
+			slot[s] = NULL;
+		} else {
+			slot[s] = a(8 + ((r >> 8) % 248));
+		}
+	}
+	for (uint32_t s = 0; s < TIMED_SLOTS; s++)
+		f(slot[s]);
+	return (nowNS() - t0) / TIMED_OPS;
+}
+
+int main(void) {
+	uint32_t heap;
+	double pool, libc;
+
+	checkChurn();
+
+	heap = RLIC_MemPool_HeapAllocs();
+	pool = timeChurn(RLIC_MemPool_AllocAny, RLIC_MemPool_FreeAny);
+	libc = timeChurn(malloc, free);
+	printf("alloc/free churn, %u ops over %u slots of 8..255 bytes:\n",
+			TIMED_OPS, TIMED_SLOTS);
+	printf("  pool %.1f ns (%u to the heap), malloc/free %.1f ns\n", pool,
+			RLIC_MemPool_HeapAllocs() - heap, libc);
+
+	printf(s_failures ? "FAILED\n" : "all checks passed\n");
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2021 Subhasish Ghosh
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+"""Memory placement report from the linker map.
+
+Usage: rlic_placement_report.py Debug/MIMXRT1021_RLIC_Main.map [pattern ...]
+
+Lists where the hot symbols (see RLIC_HOT_CODE/RLIC_HOT_DATA in
+utilities/rlic_section.h) and the DMA buffers ended up, and the bytes used
+per memory. Add as a post-build step or run by hand.
+"""
+import re
+import sys
+
+# RT1021 memory map, matches BOARD_ConfigMPU
+REGIONS = [
+    ("ITCM", 0x00000000, 0x00040000),
+    ("DTCM", 0x20000000, 0x20040000),
+    ("OCRAM", 0x20200000, 0x20240000),
+    ("FLASH", 0x60000000, 0x70000000),
+    ("SDRAM", 0x80000000, 0x82000000),
+]
+
+# symbols, or input sections for statics the map does not name (qtable)
+DEFAULT_PATTERNS = [
+    "$SRAM_ITC", "$SRAM_DTC", "$NCACHE_REGION", "NonCacheable",
+    "getQBrightness", "updateQTable", "getReward",
+    "timeToQTableEntry", "runExploreExploit", "SysTick_Handler",
+    "SysTick_UptimeMS", "TMR2_IRQHandler", "cycleDayLight",
+    "setLedBrightness", "BOARD_LPI2C_Send", "BOARD_LPI2C_Receive",
+    "LPI2C_MasterTransferBlocking", "s_sdmmcHostDmaBuffer",
+    "s_sdmmcCacheLineAlignBuffer", "s_poolStorage", "RLIC_ArgMaxU8",
+    "RLIC_Crc32_Update", "s_crcTable", "s_dmaPool",
+]
+
+SECTION_RE = re.compile(r"^ (\S+)\s*$")
+INLINE_SECTION_RE = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S+)")
+SIZE_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S+)")
+SYMBOL_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+
+
+def region_of(addr):
+    for name, lo, hi in REGIONS:
+        if lo <= addr < hi:
+            return name
+    return "?"
+
+
+def parse(path):
+    """Yield (section, address, size, object, symbol) from a GNU ld map."""
+    section = None
+    size = 0
+    obj = ""
+    with open(path, errors="replace") as fp:
+        for line in fp:
+            line = line.rstrip("\n")
+            m = INLINE_SECTION_RE.match(line)
+            if m:
+                section, size, obj = m.group(1), int(m.group(3), 16), m.group(4)
+                yield section, int(m.group(2), 16), size, obj, None
+                continue
+            m = SECTION_RE.match(line)
+            if m:
+                section = m.group(1)
+                continue
+            m = SIZE_RE.match(line)
+            if m and section:
+                size, obj = int(m.group(2), 16), m.group(3)
+                yield section, int(m.group(1), 16), size, obj, None
+                continue
+            m = SYMBOL_RE.match(line)
+            if m and section:
+                yield section, int(m.group(1), 16), size, obj, m.group(2).strip()
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__)
+        return 1
+
+    patterns = argv[2:] or DEFAULT_PATTERNS
+    used = {}
+    hits = []
+
+    for section, addr, size, obj, sym in parse(argv[1]):
+        if sym is None:
+            if addr and size:
+                reg = region_of(addr)
+                used[reg] = used.get(reg, 0) + size
+                for pat in patterns:
+                    if pat in section:
+                        name = "%s(%s)" % (section, obj.split("/")[-1])
+                        hits.append((pat, name, addr, size, section))
+                        break
+            continue
+        for pat in patterns:
+            if pat in sym:
+                hits.append((pat, sym, addr, size, section))
+                break
+
+    print("%-30s %-10s %-6s %8s  %s" % ("symbol", "address", "region",
+                                         "size", "section"))
+    seen = set()
+    for pat, sym, addr, size, section in sorted(hits, key=lambda h: h[2]):
+        if (sym, addr) in seen:
+            continue
+        seen.add((sym, addr))
+        print("%-30s 0x%08x %-6s %8d  %s" % (sym[:30], addr, region_of(addr),
+                                              size, section))
+
+    missing = [p for p in patterns if not any(h[0] == p for h in hits)]
+    if missing:
+        print("\nnot found (inlined or unused): " + ", ".join(missing))
+
+    print("\nbytes per region:")
+    for name, _, _ in REGIONS:
+        if name in used:
+            print("  %-6s %8d" % (name, used[name]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
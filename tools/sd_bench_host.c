@@ -0,0 +1,308 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Host run of the storage benchmark in utilities/rlic_sd_bench.c, the code
+ * the board runs with RLIC_SD_BENCHMARK when the user button is held at boot.
+ *
+ *   gcc -O2 -I fatfs/source -I source -I tools/host -I utilities \
+ *       tools/sd_bench_host.c utilities/rlic_sd_bench.c fatfs/source/ff.c \
+ *       -o sd_bench_host && ./sd_bench_host
+ *
+ * The default disk is a card model on a virtual us clock: a command costs
+ * a fixed overhead plus a time per sector, and every SIM_STALL_EVERY-th
+ * write command stalls as a card does for its garbage collection. The
+ * program checks that the disk level rows come out as the model says,
+ * that f_read of large sequential blocks loses little to FatFs, and how
+ * many card commands one RLIC.dat entry write costs; a change in the
+ * storage stack that adds commands or seeks shows up here first.
+ *
+ * With fatfs/source/fsl_ram_disk (64 KB, so a small scratch file), on the
+ * host clock; this only smoke tests the harness on the SDK disk glue:
+ *
+ *   gcc -O2 -DSD_BENCH_RAMDISK -DRAM_DISK_ENABLE -I fatfs/source \
+ *       -I fatfs/source/fsl_ram_disk -I source -I tools/host -I utilities \
+ *       tools/sd_bench_host.c utilities/rlic_sd_bench.c fatfs/source/ff.c \
+ *       fatfs/source/diskio.c fatfs/source/fsl_ram_disk/fsl_ram_disk.c \
+ *       -o sd_bench_ram && ./sd_bench_ram
+ *
+ * Exits non zero when a check fails.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "rlic_sd_bench.h"
+#include "diskio.h"
+
+#define SIM_SLOT_SZ			(2 * 65 * 16) /* one Q table slot */
+
+#ifndef SD_BENCH_RAMDISK
+#include <stdlib.h>
+
+#define SIM_SECTOR_SZ		(512)
+#define SIM_DISK_SZ			(32 * 1024 * 1024)
+#define SIM_READ_CMD_US		(150)
+#define SIM_READ_SECTOR_US	(26) /* ~20 MB/s, SDR25 */
+#define SIM_WRITE_CMD_US	(250)
+#define SIM_WRITE_SECTOR_US	(40)
+#define SIM_STALL_EVERY		(32)
+#define SIM_STALL_US		(20000)
+#define SIM_PDRV			(SDDISK)
+#define SIM_VOLUME			"2:"
+#define SIM_REGION_SZ		(4 * 1024 * 1024)
+#define SIM_REPS			(64)
+/*
+ * one entry write today: the header sector read and written back, the
+ * whole sectors of the payload in one write, the last partial sector read
+ * and written on f_sync, the directory sector read and written
+ */
+#define SIM_ENTRY_CMDS_MAX	(8)
+
+static uint8_t s_disk[SIM_DISK_SZ];
+static uint32_t s_nowUS;
+static uint32_t s_readCmds, s_writeCmds;
+
+/* card model */
+DSTATUS disk_initialize(BYTE pdrv) {
+	return (pdrv == SIM_PDRV) ? 0 : STA_NOINIT;
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+	return (pdrv == SIM_PDRV) ? 0 : STA_NOINIT;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+	if ((pdrv != SIM_PDRV)
+			|| ((sector + count) * SIM_SECTOR_SZ > sizeof(s_disk)))
+		return RES_PARERR;
+	memcpy(buff, &s_disk[sector * SIM_SECTOR_SZ], count * SIM_SECTOR_SZ);
+	s_nowUS += SIM_READ_CMD_US + (count * SIM_READ_SECTOR_US);
+	s_readCmds++;
+	return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+	if ((pdrv != SIM_PDRV)
+			|| ((sector + count) * SIM_SECTOR_SZ > sizeof(s_disk)))
+		return RES_PARERR;
+	memcpy(&s_disk[sector * SIM_SECTOR_SZ], buff, count * SIM_SECTOR_SZ);
+	s_nowUS += SIM_WRITE_CMD_US + (count * SIM_WRITE_SECTOR_US);
+	if ((++s_writeCmds % SIM_STALL_EVERY) == 0)
+		s_nowUS += SIM_STALL_US;
+	return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+	if (pdrv != SIM_PDRV)
+		return RES_PARERR;
+	switch (cmd) {
+	case CTRL_SYNC:
+		return RES_OK;
+	case GET_SECTOR_COUNT:
+		*(LBA_t*) buff = sizeof(s_disk) / SIM_SECTOR_SZ;
+		return RES_OK;
+	case GET_BLOCK_SIZE:
+		*(DWORD*) buff = 1;
+		return RES_OK;
+	default:
+		return RES_PARERR;
+	}
+}
+
+static uint32_t simNow(void) {
+	return s_nowUS;
+}
+#else
+#include <time.h>
+
+#define SIM_PDRV			(RAMDISK)
+#define SIM_VOLUME			"0:"
+#define SIM_REGION_SZ		(16 * 1024)
+#define SIM_REPS			(16)
+
+/* ffconf.h enables the SD glue too, no card on the host */
+DSTATUS sd_disk_initialize(BYTE pdrv) {
+	(void) pdrv;
+	return STA_NOINIT;
+}
+
+DSTATUS sd_disk_status(BYTE pdrv) {
+	(void) pdrv;
+	return STA_NOINIT;
+}
+
+DRESULT sd_disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+	(void) pdrv;
+	(void) buff;
+	(void) sector;
+	(void) count;
+	return RES_NOTRDY;
+}
+
+DRESULT sd_disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+	(void) pdrv;
+	(void) buff;
+	(void) sector;
+	(void) count;
+	return RES_NOTRDY;
+}
+
+DRESULT sd_disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+	(void) pdrv;
+	(void) cmd;
+	(void) buff;
+	return RES_NOTRDY;
+}
+
+static uint32_t simNow(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t) ((ts.tv_sec * 1000000U) + (ts.tv_nsec / 1000U));
+}
+#endif
+
+static FATFS s_fs;
+static rlic_sd_bench_result_t s_results[RLIC_SD_BENCH_RESULTS_MAX];
+static uint32_t s_numResults;
+static uint32_t s_failed;
+
+static void check(int ok, const char *what) {
+	printf("%s: %s\n", ok ? "ok  " : "FAIL", what);
+	if (!ok)
+		s_failed++;
+}
+
+static const rlic_sd_bench_result_t* findResult(const char *name,
+		uint32_t size) {
+	for (uint32_t i = 0; i < s_numResults; i++) {
+		if (!strcmp(s_results[i].name, name) && (s_results[i].size == size))
+			return &s_results[i];
+	}
+	return NULL;
+}
+
+#ifndef SD_BENCH_RAMDISK
+/* disk rows against the card model, f_read against the disk rows */
+static void checkModel(void) {
+	static const uint32_t sizes[] = { 512, 4 * 1024, 16 * 1024, 64 * 1024 };
+	const rlic_sd_bench_result_t *disk, *file;
+	char what[96];
+
+	for (uint32_t s = 0; s < (sizeof(sizes) / sizeof(sizes[0])); s++) {
+		uint32_t sectors = sizes[s] / SIM_SECTOR_SZ;
+		uint32_t readUS = SIM_READ_CMD_US + (sectors * SIM_READ_SECTOR_US);
+		uint32_t writeUS = SIM_WRITE_CMD_US + (sectors * SIM_WRITE_SECTOR_US);
+
+		disk = findResult("disk rand read", sizes[s]);
+		snprintf(what, sizeof(what), "disk rand read %d B p50 %d us", sizes[s],
+				readUS);
+		check(disk && (disk->p50US == readUS) && (disk->maxUS == readUS),
+				what);
+		disk = findResult("disk rand write", sizes[s]);
+		snprintf(what, sizeof(what), "disk rand write %d B p50 %d us, "
+				"p99 has the stall", sizes[s], writeUS);
+		check(disk && (disk->p50US == writeUS)
+				&& (disk->p99US == (writeUS + SIM_STALL_US)), what);
+	}
+
+	disk = findResult("disk seq read", 64 * 1024);
+	file = findResult("f_read seq", 64 * 1024);
+	check(disk && file && ((file->kbps * 10) >= (disk->kbps * 9)),
+			"f_read seq 64 KB within 10% of the disk");
+}
+
+/* card commands of one RLIC.dat entry write, header + payload + f_sync */
+static void checkSlotCommands(void) {
+	FIL fil;
+	UINT done;
+	uint8_t buf[SIM_SLOT_SZ];
+	uint32_t cmds;
+
+	memset(buf, 0x5A, sizeof(buf));
+	if ((f_open(&fil, SIM_VOLUME "/SLOT.TMP", FA_READ | FA_WRITE |
+	FA_CREATE_ALWAYS) != FR_OK) || (f_expand(&fil, 64 * 1024, 1) != FR_OK)) {
+		check(0, "slot file");
+		return;
+	}
+	cmds = s_readCmds + s_writeCmds;
+	f_lseek(&fil, 5 * 4096);
+	f_write(&fil, buf, 16, &done);
+	f_lseek(&fil, (5 * 4096) + 16);
+	f_write(&fil, buf, sizeof(buf), &done);
+	f_sync(&fil);
+	cmds = s_readCmds + s_writeCmds - cmds;
+	printf("one entry write: %d card commands\n", cmds);
+	check(cmds <= SIM_ENTRY_CMDS_MAX, "entry write command count");
+	f_close(&fil);
+	f_unlink(SIM_VOLUME "/SLOT.TMP");
+}
+#endif
+
+int main(void) {
+	static BYTE work[FF_MAX_SS];
+	rlic_sd_bench_cfg_t cfg;
+	status_t status;
+#ifndef SD_BENCH_RAMDISK
+	/* 32 KB clusters, as the SD formatter lays out cards of this class */
+	MKFS_PARM opt = { FM_ANY, 0, 0, 0, 32 * 1024 };
+#else
+	MKFS_PARM opt = { FM_FAT | FM_SFD, 0, 0, 0, 0 }; /* 128 sectors, no MBR */
+#endif
+
+	if ((f_mkfs(SIM_VOLUME, &opt, work, sizeof(work)) != FR_OK)
+			|| (f_mount(&s_fs, SIM_VOLUME, 1) != FR_OK)) {
+		printf("no volume\n");
+		return 1;
+	}
+
+	cfg.now = simNow;
+	cfg.ticksPerUS = 1;
+	cfg.pdrv = SIM_PDRV;
+	cfg.path = SIM_VOLUME "/BENCH.TMP";
+	cfg.regionSz = SIM_REGION_SZ;
+	cfg.reps = SIM_REPS;
+	cfg.slotSz = SIM_SLOT_SZ;
+	status = RLIC_SdBench_Run(&cfg, s_results, RLIC_SD_BENCH_RESULTS_MAX,
+			&s_numResults);
+
+	check(status == kStatus_Success, "benchmark ran");
+	check(findResult("disk seq read", 512) != NULL, "disk level rows");
+	check(findResult("f_sync rand", 4 * 1024) != NULL, "f_sync rows");
+	check(findResult("slot write rand", 16 + SIM_SLOT_SZ) != NULL,
+			"slot rows");
+	check(f_stat(cfg.path, NULL) == FR_NO_FILE, "scratch file removed");
+#ifndef SD_BENCH_RAMDISK
+	check(s_numResults == 44, "44 rows");
+	checkModel();
+	checkSlotCommands();
+#endif
+
+	if (s_failed) {
+		printf("%d checks failed\n", s_failed);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,237 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Host test of the SD bus mode ladder in utilities/rlic_sd_bus.c.
+ *
+ *   cc -O2 -I tools/host -I utilities tools/sd_bus_sim.c \
+ *       utilities/rlic_sd_bus.c -o sd_bus_sim && ./sd_bus_sim
+ *
+ * The fake controller negotiates as SD_CardInit() does within the mode's
+ * limits: 1.8 V and a tuned SDR50/SDR104 for a UHS-I card when allowed,
+ * else SDR25 at 3.3 V, with the clock capped. The fake card has the
+ * faults seen on real slots: transfers failing CRC above some clock,
+ * tuning that fails, one off errors, removal. Transfers go through
+ * RLIC_SdBus_Retry() as sd_disk_read/write do. Exits non zero when a
+ * check fails.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "rlic_sd_bus.h"
+
+#define SIM_TRANSFERS		(100)
+
+typedef struct {
+	bool uhs; /* 1.8 V signalling */
+	bool sdr104;
+	uint32_t crcAboveHz; /* transfers fail above this clock, 0 = never */
+	uint32_t tuneAboveHz; /* tuning fails above this clock, 0 = never */
+	uint32_t transients; /* one off transfer errors to come */
+	bool present;
+	/* controller state */
+	bool up;
+	rlic_sd_bus_info_t bus;
+	uint32_t inits;
+} sim_card_t;
+
+static uint32_t s_failed;
+
+static uint32_t simMin(uint32_t a, uint32_t b) {
+	return (a < b) ? a : b;
+}
+
+static status_t simInit(void *ctx, const rlic_sd_bus_limit_t *limit) {
+	sim_card_t *card = (sim_card_t*) ctx;
+
+	card->inits++;
+	card->up = false;
+	if (!card->present)
+		return kStatus_Fail;
+
+	card->bus.width = 4;
+	if (limit->allow1V8 && card->uhs) {
+		card->bus.is1V8 = true;
+		if ((limit->timing == RLIC_SD_BUS_TIMING_SDR104) && card->sdr104) {
+			card->bus.timing = RLIC_SD_BUS_TIMING_SDR104;
+			card->bus.clockHz = simMin(208000000U, limit->maxHz);
+		} else {
+			card->bus.timing = RLIC_SD_BUS_TIMING_SDR50;
+			card->bus.clockHz = simMin(100000000U, limit->maxHz);
+		}
+		if (card->tuneAboveHz && (card->bus.clockHz > card->tuneAboveHz))
+			return kStatus_Fail; /* kStatus_SDMMC_TuningFail */
+	} else {
+		card->bus.is1V8 = false;
+		card->bus.timing = RLIC_SD_BUS_TIMING_SDR25;
+		card->bus.clockHz = simMin(50000000U, limit->maxHz);
+	}
+	card->up = true;
+	return kStatus_Success;
+}
+
+static void simGetInfo(void *ctx, rlic_sd_bus_info_t *info) {
+	*info = ((sim_card_t*) ctx)->bus;
+}
+
+static bool simPresent(void *ctx) {
+	return ((sim_card_t*) ctx)->present;
+}
+
+static const rlic_sd_bus_ops_t s_ops = { simInit, simGetInfo, simPresent };
+
+/* one block transfer as the controller would see it */
+static status_t simTransfer(sim_card_t *card) {
+	if (!card->present || !card->up)
+		return kStatus_Fail;
+	if (card->transients) {
+		card->transients--;
+		return kStatus_Fail;
+	}
+	if (card->crcAboveHz && (card->bus.clockHz > card->crcAboveHz))
+		return kStatus_Fail;
+	return kStatus_Success;
+}
+
+/* as sd_disk_read(), the number of transfers that failed for good */
+static uint32_t simRun(rlic_sd_bus_t *bus, sim_card_t *card, uint32_t n) {
+	uint32_t failed = 0;
+
+	for (uint32_t i = 0; i < n; i++) {
+		status_t status;
+		uint32_t tries = 0;
+
+		do {
+			status = simTransfer(card);
+			if (++tries > (RLIC_SD_BUS_MODES * RLIC_SD_BUS_RETRIES + 1)) {
+				printf("transfer retried forever\n");
+				s_failed++;
+				return n;
+			}
+		} while (RLIC_SdBus_Retry(bus, status));
+		if (status != kStatus_Success)
+			failed++;
+	}
+	return failed;
+}
+
+static void check(int ok, const char *what) {
+	printf("%s: %s\n", ok ? "ok  " : "FAIL", what);
+	if (!ok)
+		s_failed++;
+}
+
+static status_t simStart(rlic_sd_bus_t *bus, sim_card_t *card, uint32_t top,
+		uint32_t maxHz) {
+	RLIC_SdBus_Init(bus, &s_ops, card, top, maxHz);
+	return RLIC_SdBus_Start(bus);
+}
+
+int main(void) {
+	rlic_sd_bus_t bus;
+	sim_card_t card;
+	uint32_t failed;
+
+	printf("-- UHS-I card, clean slot\n");
+	card = (sim_card_t ) { .uhs = true, .present = true };
+	check(simStart(&bus, &card, RLIC_SD_BUS_SDR50, 100000000U)
+			== kStatus_Success, "card up");
+	check((bus.mode == RLIC_SD_BUS_SDR50) && bus.info.is1V8
+			&& (bus.info.clockHz == 100000000U) && (bus.info.width == 4),
+			"4 bit SDR50 at 100 MHz, 1.8 V");
+	check(simRun(&bus, &card, SIM_TRANSFERS) == 0, "transfers pass");
+	check(bus.fallbacks == 0, "no step down");
+
+	printf("-- board clock below the mode\n");
+	card = (sim_card_t ) { .uhs = true, .sdr104 = true, .present = true };
+	simStart(&bus, &card, RLIC_SD_BUS_SDR104, 100000000U);
+	check((bus.mode == RLIC_SD_BUS_SDR104)
+			&& (bus.info.timing == RLIC_SD_BUS_TIMING_SDR104)
+			&& (bus.info.clockHz == 100000000U), "SDR104 at the board's 100 MHz");
+
+	printf("-- 3.3 V only card\n");
+	card = (sim_card_t ) { .present = true };
+	simStart(&bus, &card, RLIC_SD_BUS_SDR50, 100000000U);
+	check((bus.mode == RLIC_SD_BUS_HIGH_SPEED) && !bus.info.is1V8
+			&& (bus.info.clockHz == 50000000U), "settles on high speed");
+	check(card.inits == 1, "one identification");
+
+	printf("-- tuning fails at 100 MHz\n");
+	card = (sim_card_t ) { .uhs = true, .tuneAboveHz = 50000000U,
+			.present = true };
+	check(simStart(&bus, &card, RLIC_SD_BUS_SDR50, 100000000U)
+			== kStatus_Success, "card up");
+	check((bus.mode == RLIC_SD_BUS_HIGH_SPEED) && !bus.info.is1V8,
+			"high speed at 3.3 V");
+
+	printf("-- CRC errors above 50 MHz\n");
+	card = (sim_card_t ) { .uhs = true, .crcAboveHz = 50000000U,
+			.present = true };
+	simStart(&bus, &card, RLIC_SD_BUS_SDR50, 100000000U);
+	failed = simRun(&bus, &card, SIM_TRANSFERS);
+	check(failed == 0, "no transfer lost");
+	check((bus.mode == RLIC_SD_BUS_HIGH_SPEED) && (bus.fallbacks == 1)
+			&& (bus.info.clockHz == 50000000U), "one step down to 50 MHz");
+	check(bus.errors == RLIC_SD_BUS_RETRIES, "errors counted");
+
+	printf("-- CRC errors above 25 MHz\n");
+	card = (sim_card_t ) { .uhs = true, .crcAboveHz = 25000000U,
+			.present = true };
+	simStart(&bus, &card, RLIC_SD_BUS_SDR50, 100000000U);
+	failed = simRun(&bus, &card, SIM_TRANSFERS);
+	check((failed == 0) && (bus.mode == RLIC_SD_BUS_DEFAULT)
+			&& (bus.fallbacks == 2), "two step downs, default speed");
+
+	printf("-- one off errors\n");
+	card = (sim_card_t ) { .uhs = true, .transients = 1, .present = true };
+	simStart(&bus, &card, RLIC_SD_BUS_SDR50, 100000000U);
+	failed = simRun(&bus, &card, SIM_TRANSFERS);
+	check((failed == 0) && (bus.mode == RLIC_SD_BUS_SDR50)
+			&& (bus.fallbacks == 0), "retried, mode kept");
+
+	printf("-- nothing works\n");
+	card = (sim_card_t ) { .uhs = true, .crcAboveHz = 1, .present = true };
+	simStart(&bus, &card, RLIC_SD_BUS_SDR50, 100000000U);
+	failed = simRun(&bus, &card, 10);
+	check(failed == 10, "transfers fail");
+	check(bus.mode == RLIC_SD_BUS_DEFAULT, "stops at default speed");
+
+	printf("-- card pulled\n");
+	card = (sim_card_t ) { .uhs = true, .present = true };
+	simStart(&bus, &card, RLIC_SD_BUS_SDR50, 100000000U);
+	card.present = false;
+	failed = simRun(&bus, &card, 10);
+	check((failed == 10) && (bus.fallbacks == 0)
+			&& (bus.mode == RLIC_SD_BUS_SDR50), "no step down");
+	check(simStart(&bus, &card, RLIC_SD_BUS_SDR50, 100000000U) == kStatus_Fail,
+			"bring up fails");
+	check(card.inits == 2, "without walking the ladder");
+
+	if (s_failed) {
+		printf("%d checks failed\n", s_failed);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,591 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Host check of the RLIC.dat store: the real source/SDMMC_Simple.cpp and
+ * FatFs on a RAM disk that counts sector reads and writes.
+ *
+ *   gcc -c -O2 -I source -I fatfs/source fatfs/source/ff.c -o ff.o
+ *   g++ -O2 -I fatfs/source -I source -I tools/host -I utilities \
+ *       tools/sdmmc_store_sim.cpp source/SDMMC_Simple.cpp \
+ *       utilities/rlic_crc32.c utilities/rlic_slot_codec.c \
+ *       utilities/rlic_dmabuf.c ff.o -o sdmmc_store_sim
+ *
+ * The disk is first covered with valid looking entries, as an old
+ * RLIC.dat leaves behind in free clusters. Then: first boot on the fresh
+ * card (startup() steps and sectors written), reads of never written
+ * slots, write and read back across a reboot, a power cut between an
+ * entry write and its copy map update, a bad CRC on the newer copy and a
+ * power cut partway through a payload (the older copy must be read),
+ * sectors read per slot over all slots (FAT chain reads by f_lseek,
+ * -DSDMMC_FAST_SEEK=0 for the cost without the link map), sectors moved
+ * for a sparse Q table slot (-DSDMMC_COMPRESS=1 to code it), a new card
+ * that only has a seed image and an RLIC.dat from the build before the
+ * header: 4 MB, bank A only, ending inside slot 1000, grown to both banks
+ * at boot. Add -DSDMMC_CONTIGUOUS=1 for a file reserved by f_expand,
+ * -DRLIC_TRACE=1 for TRACE.DAT appends, also after a block cut short.
+ * Exits non zero when a check fails.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "SDMMC_Simple.h"
+#include "fsl_sd_disk.h"
+#include "rlic_crc32.h"
+
+#define STORE_SIM_SECTOR_SZ		(512)
+#define STORE_SIM_DISK_SZ		(64 * 1024 * 1024)
+#define STORE_SIM_ENTRY_SZ		(4 * 1024)
+#define STORE_SIM_PAYLOAD_SZ	(2 * 65 * 16) /* one Q table slot */
+#define STORE_SIM_BANK_SZ		((SDMMC_ENTRIES_MAX + 1) * STORE_SIM_ENTRY_SZ)
+#define STORE_SIM_DENSE_SZ		(SDMMC_ZONES_MAX * 2 * STORE_SIM_BANK_SZ)
+/* the build before the header: zero filled to slot 1000, which then grew it */
+#define STORE_SIM_BASE_SZ		(SDMMC_ENTRIES_MAX * STORE_SIM_ENTRY_SZ)
+#define STORE_SIM_HDR_SZ		(4 * 1024) /* RLIC.dat header, sparse files */
+#define STORE_SIM_CRC_OFFSET	(12) /* in the entry header */
+#define STORE_SIM_STALE_SEQ		(1000)
+#define STORE_SIM_HDR_MAGIC		(0x4D494C52U) /* RLIC.dat header */
+
+sd_card_t g_sd;
+
+static uint8_t s_disk[STORE_SIM_DISK_SZ];
+static uint32_t s_sectorsRead, s_sectorsWritten;
+static uint32_t s_uptimeMS;
+static bool s_cutAtHdr; /* drop the header write and all after it */
+static int32_t s_tearSectors = -1; /* sectors that still land, -1 all */
+static bool s_cut;
+static uint32_t s_failed;
+
+/* RAM disk */
+DSTATUS disk_initialize(BYTE pdrv) {
+	(void) pdrv;
+	return 0;
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+	(void) pdrv;
+	return 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+	(void) pdrv;
+	if ((sector + count) * STORE_SIM_SECTOR_SZ > sizeof(s_disk))
+		return RES_PARERR;
+	memcpy(buff, &s_disk[sector * STORE_SIM_SECTOR_SZ],
+			count * STORE_SIM_SECTOR_SZ);
+	s_sectorsRead += count;
+	return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+	uint32_t magic;
+
+	(void) pdrv;
+	if ((sector + count) * STORE_SIM_SECTOR_SZ > sizeof(s_disk))
+		return RES_PARERR;
+	memcpy(&magic, buff, sizeof(magic));
+	if (s_cutAtHdr && (magic == STORE_SIM_HDR_MAGIC))
+		s_cut = true;
+	if (s_cut)
+		return RES_OK; /* power is gone, the card never sees it */
+	if (s_tearSectors >= 0) {
+		/* power fails in this write, its first sectors made it */
+		if (count > (UINT) s_tearSectors) {
+			count = s_tearSectors;
+			s_cut = true;
+		}
+		s_tearSectors -= count;
+	}
+	memcpy(&s_disk[sector * STORE_SIM_SECTOR_SZ], buff,
+			count * STORE_SIM_SECTOR_SZ);
+	s_sectorsWritten += count;
+	return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+	(void) pdrv;
+	switch (cmd) {
+	case CTRL_SYNC:
+		return RES_OK;
+	case GET_SECTOR_COUNT:
+		*(LBA_t*) buff = sizeof(s_disk) / STORE_SIM_SECTOR_SZ;
+		return RES_OK;
+	case GET_BLOCK_SIZE:
+		*(DWORD*) buff = 1;
+		return RES_OK;
+	default:
+		return RES_PARERR;
+	}
+}
+
+/* card and clock */
+void BOARD_SD_Config(void *card, void *cd, uint32_t hostIrqPriority,
+		void *userData) {
+	(void) card;
+	(void) cd;
+	(void) hostIrqPriority;
+	(void) userData;
+}
+
+status_t SD_HostInit(sd_card_t *card) {
+	(void) card;
+	return kStatus_Success;
+}
+
+bool SD_IsCardPresent(sd_card_t *card) {
+	(void) card;
+	return true;
+}
+
+status_t SD_PollingCardInsert(sd_card_t *card, uint32_t status) {
+	(void) card;
+	(void) status;
+	return kStatus_Success;
+}
+
+void SD_SetCardPower(sd_card_t *card, bool enable) {
+	(void) card;
+	(void) enable;
+}
+
+uint32_t SysTick_UptimeMS(void) {
+	return s_uptimeMS++;
+}
+
+void SysTick_DelayTicksMS(uint32_t n) {
+	s_uptimeMS += n;
+}
+
+static void check(bool ok, const char *what) {
+	printf("  %-48s %s\n", what, ok ? "ok" : "FAILED");
+	s_failed += !ok;
+}
+
+/* free clusters holding entries of an older file, newer than any here */
+static void staleFill(void) {
+	static uint8_t payload[STORE_SIM_PAYLOAD_SZ];
+	sdmmc_entry_hdr_t hdr;
+
+	memset(payload, 0x5A, sizeof(payload));
+	hdr.magic = 0x43494C52U; /* entry magic */
+	hdr.seq = STORE_SIM_STALE_SEQ;
+	hdr.len = sizeof(payload);
+	hdr.crc = RLIC_Crc32(payload, sizeof(payload));
+	for (uint32_t off = 0; off < sizeof(s_disk); off += STORE_SIM_ENTRY_SZ) {
+		memcpy(&s_disk[off], &hdr, sizeof(hdr));
+		memcpy(&s_disk[off + sizeof(hdr)], payload, sizeof(payload));
+	}
+}
+
+/* power back: the card takes writes again */
+static void powerOn(void) {
+	s_cutAtHdr = s_cut = false;
+	s_tearSectors = -1;
+}
+
+/* flip a bit of the CRC in an entry copy of a sparse file, zone 0 */
+static bool corruptCrc(uint32_t idx, uint32_t copy) {
+	FIL fil;
+	uint8_t b;
+	UINT n;
+	bool ok;
+
+	if (f_open(&fil, _T("/dir_1/RLIC.dat"), FA_READ | FA_WRITE) != FR_OK)
+		return false;
+	ok = (f_lseek(&fil, STORE_SIM_HDR_SZ + copy * STORE_SIM_BANK_SZ
+			+ idx * STORE_SIM_ENTRY_SZ + STORE_SIM_CRC_OFFSET) == FR_OK)
+			&& (f_read(&fil, &b, 1, &n) == FR_OK) && (n == 1);
+	b ^= 0x01;
+	ok = ok && (f_lseek(&fil, f_tell(&fil) - 1) == FR_OK)
+			&& (f_write(&fil, &b, 1, &n) == FR_OK) && (n == 1);
+	return (f_close(&fil) == FR_OK) && ok;
+}
+
+/* boot: run startup() to the end, returns the number of steps */
+static uint32_t boot(SDMMC_Simple *sd) {
+	bool ready = false;
+	uint32_t steps = 0;
+
+	while (!ready) {
+		if (sd->startup(&ready) != kStatus_Success)
+			return 0;
+		steps++;
+	}
+	return steps;
+}
+
+static bool isZero(const uint8_t *p, uint32_t len) {
+	for (uint32_t i = 0; i < len; i++) {
+		if (p[i])
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Sectors read per slot read or write, over the slots in order, early
+ * ones against late ones. The data sectors are the same for every slot,
+ * the rest is the FAT chain followed by f_lseek().
+ */
+static void seekCost(SDMMC_Simple *sd, uint8_t *buf, bool write) {
+	const uint32_t n = SDMMC_ENTRIES_MAX + 1;
+	uint32_t early = 0, late = 0, max = 0;
+	bool ok = true;
+
+	for (uint32_t idx = 0; idx < n; idx++) {
+		uint32_t reads = s_sectorsRead;
+
+		if (write)
+			ok = ok && (sd->write(STORE_SIM_PAYLOAD_SZ, buf, idx)
+					== kStatus_Success);
+		else
+			ok = ok && (sd->read(STORE_SIM_PAYLOAD_SZ, buf, idx)
+					== kStatus_Success);
+		reads = s_sectorsRead - reads;
+		if (idx < 100)
+			early += reads;
+		if (idx >= (n - 100))
+			late += reads;
+		max = (reads > max) ? reads : max;
+	}
+
+	printf("  %s: %.1f sectors read per slot for the first 100, %.1f for "
+			"the last 100, %u at most\n", write ? "write" : "read",
+			early / 100.0, late / 100.0, (unsigned) max);
+	check(ok, write ? "all slots written" : "all slots read");
+#if SDMMC_FAST_SEEK
+	check(late <= early, "late slots cost no more than early ones");
+#endif
+}
+
+/* a file copy through FatFs, as a host would put a seed image on the card */
+static bool copyFile(const TCHAR *from, const TCHAR *to) {
+	static uint8_t chunk[64 * 1024];
+	FIL src, dst;
+	UINT br, bw;
+	bool ok;
+
+	if (f_open(&src, from, FA_READ) != FR_OK)
+		return false;
+	ok = f_open(&dst, to, FA_WRITE | FA_CREATE_ALWAYS) == FR_OK;
+	while (ok && (f_read(&src, chunk, sizeof(chunk), &br) == FR_OK) && br)
+		ok = (f_write(&dst, chunk, br, &bw) == FR_OK) && (bw == br);
+	f_close(&src);
+	return (f_close(&dst) == FR_OK) && ok;
+}
+
+/*
+ * A slot as learning leaves it: a few expected rewards up to 10 and
+ * pruning counters up to 3 among zeros. Sectors moved per write, and per
+ * first read after a reboot, one per entry copy once coded
+ * (-DSDMMC_COMPRESS=1).
+ */
+static SDMMC_Simple* qtableSlot(SDMMC_Simple *sd, uint8_t *slot,
+		uint8_t *buf, uint32_t idx) {
+	uint32_t reads, writes;
+	bool ok;
+
+	memset(slot, 0, STORE_SIM_PAYLOAD_SZ);
+	for (uint32_t i = 0; i < 40; i++) {
+		slot[(i * 37) % (STORE_SIM_PAYLOAD_SZ / 2)] = (uint8_t) (1 + i % 10);
+		slot[STORE_SIM_PAYLOAD_SZ / 2 + (i * 53) % (STORE_SIM_PAYLOAD_SZ / 2)] =
+				(uint8_t) (i % 4);
+	}
+
+	sd->write(STORE_SIM_PAYLOAD_SZ, slot, idx); /* both copies mapped */
+	writes = s_sectorsWritten;
+	ok = sd->write(STORE_SIM_PAYLOAD_SZ, slot, idx) == kStatus_Success;
+	writes = s_sectorsWritten - writes;
+	printf("  write: %u sectors written\n", (unsigned) writes);
+	check(ok, "slot written");
+	sd->close();
+	delete sd;
+
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	sd->read(STORE_SIM_PAYLOAD_SZ, buf, idx + 1); /* FAT and link map */
+	reads = s_sectorsRead;
+	ok = (sd->read(STORE_SIM_PAYLOAD_SZ, buf, idx) == kStatus_Success)
+			&& !memcmp(buf, slot, STORE_SIM_PAYLOAD_SZ);
+	reads = s_sectorsRead - reads;
+	printf("  read after reboot: %u sectors read\n", (unsigned) reads);
+	check(ok, "kept across reboot");
+#if SDMMC_COMPRESS && !SDMMC_USE_SDRAM_MIRROR
+	/* the entry and the copy map; both copy headers on the first read */
+	check(writes <= 2, "write is one entry sector");
+#if SDMMC_FAST_SEEK
+	check(reads <= 2, "read is one sector per copy");
+#endif
+#endif
+	return sd;
+}
+
+int main(void) {
+	static uint8_t p1[STORE_SIM_PAYLOAD_SZ], p2[STORE_SIM_PAYLOAD_SZ];
+	static uint8_t buf[STORE_SIM_PAYLOAD_SZ], q[STORE_SIM_PAYLOAD_SZ];
+	static uint8_t p3[STORE_SIM_PAYLOAD_SZ];
+	SDMMC_Simple *sd;
+	uint32_t steps, reads;
+	bool zero = true;
+	FIL fil;
+	UINT bw;
+
+	for (uint32_t i = 0; i < sizeof(p1); i++) {
+		p1[i] = (uint8_t) (i * 3 + 1);
+		p2[i] = (uint8_t) (i * 5 + 2);
+		p3[i] = (uint8_t) (i * 7 + 3);
+	}
+	staleFill();
+
+	printf("first boot, fresh card (%u zones, %u KB of entries)\n",
+			(unsigned) SDMMC_ZONES_MAX, (unsigned) (STORE_SIM_DENSE_SZ / 1024));
+	sd = new SDMMC_Simple();
+	steps = boot(sd);
+	printf("  %u startup steps, %u sectors written, %u read "
+			"(a dense file is %u sectors)\n", (unsigned) steps,
+			(unsigned) s_sectorsWritten, (unsigned) s_sectorsRead,
+			(unsigned) (STORE_SIM_DENSE_SZ / STORE_SIM_SECTOR_SZ));
+	check(steps != 0, "card up");
+	check(s_sectorsWritten < 1024, "no zero fill");
+
+	reads = s_sectorsRead;
+	for (uint32_t z = 0; z < SDMMC_ZONES_MAX; z++) {
+		for (uint32_t idx = 0; idx <= SDMMC_ENTRIES_MAX; idx++) {
+			if (sd->read(sizeof(buf), buf, idx, z) != kStatus_Success)
+				zero = false;
+			zero = zero && isZero(buf, sizeof(buf));
+		}
+	}
+	check(zero, "unwritten slots read as zero");
+	check(s_sectorsRead == reads, "... without card reads");
+
+	check(sd->write(sizeof(p1), p1, 5) == kStatus_Success, "write slot 5");
+	check((sd->read(sizeof(buf), buf, 5) == kStatus_Success)
+			&& !memcmp(buf, p1, sizeof(buf)), "read back");
+	check((sd->write(sizeof(p2), p2, SDMMC_ENTRIES_MAX, SDMMC_ZONES_MAX - 1)
+			== kStatus_Success), "write last slot of last zone");
+	sd->close();
+	delete sd;
+
+	printf("reboot\n");
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	check((sd->read(sizeof(buf), buf, 5) == kStatus_Success)
+			&& !memcmp(buf, p1, sizeof(buf)), "slot 5 kept");
+	check((sd->read(sizeof(buf), buf, SDMMC_ENTRIES_MAX, SDMMC_ZONES_MAX - 1)
+			== kStatus_Success) && !memcmp(buf, p2, sizeof(buf)),
+			"last slot kept");
+	check((sd->read(sizeof(buf), buf, 6) == kStatus_Success)
+			&& isZero(buf, sizeof(buf)), "slot 6 still zero");
+
+	printf("power cut between entry write and copy map\n");
+	s_cutAtHdr = true;
+	sd->write(sizeof(p2), p2, 5); /* second copy, first time mapped */
+	delete sd; /* no close, the power is gone */
+	powerOn();
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	check((sd->read(sizeof(buf), buf, 5) == kStatus_Success)
+			&& !memcmp(buf, p1, sizeof(buf)), "slot 5 has the old value");
+	check((sd->write(sizeof(p2), p2, 5) == kStatus_Success)
+			&& (sd->read(sizeof(buf), buf, 5) == kStatus_Success)
+			&& !memcmp(buf, p2, sizeof(buf)), "and takes a new one");
+
+	/*
+	 * slots 500 and 501, clear of the seek cost windows; a flush after
+	 * each write, the SDRAM mirror keeps one copy per flush period
+	 */
+	printf("bad CRC on the newer copy\n");
+	check((sd->write(sizeof(p1), p1, 500) == kStatus_Success)
+			&& (sd->flush() == kStatus_Success)
+			&& (sd->write(sizeof(p2), p2, 500) == kStatus_Success)
+			&& (sd->flush() == kStatus_Success),
+			"slot 500: A then B");
+	sd->close();
+	check(corruptCrc(500, 1), "CRC of copy B broken");
+	delete sd;
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	check((sd->read(sizeof(buf), buf, 500) == kStatus_Success)
+			&& !memcmp(buf, p1, sizeof(buf)), "older copy A read");
+	check((sd->write(sizeof(p3), p3, 500) == kStatus_Success)
+			&& (sd->read(sizeof(buf), buf, 500) == kStatus_Success)
+			&& !memcmp(buf, p3, sizeof(buf)), "next write replaces the bad one");
+	sd->close();
+	delete sd;
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	check((sd->read(sizeof(buf), buf, 500) == kStatus_Success)
+			&& !memcmp(buf, p3, sizeof(buf)), "and is kept across reboot");
+
+	printf("power cut partway through a payload\n");
+	check((sd->write(sizeof(p1), p1, 501) == kStatus_Success)
+			&& (sd->flush() == kStatus_Success)
+			&& (sd->write(sizeof(p2), p2, 501) == kStatus_Success)
+			&& (sd->flush() == kStatus_Success),
+			"slot 501: A then B, both mapped");
+	s_tearSectors = 2; /* header and the start of the payload */
+	sd->write(sizeof(p3), p3, 501); /* over A, the older copy */
+	sd->flush();
+	delete sd;
+	check(s_cut, "write torn");
+	powerOn();
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	check((sd->read(sizeof(buf), buf, 501) == kStatus_Success)
+			&& !memcmp(buf, p2, sizeof(buf)), "older copy B read");
+	check((sd->write(sizeof(p3), p3, 501) == kStatus_Success)
+			&& (sd->read(sizeof(buf), buf, 501) == kStatus_Success)
+			&& !memcmp(buf, p3, sizeof(buf)), "and written over again");
+	sd->close();
+
+	printf("seek cost over all %u slots\n", (unsigned) (SDMMC_ENTRIES_MAX + 1));
+	delete sd;
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	for (uint32_t idx = 0; idx <= SDMMC_ENTRIES_MAX; idx++)
+		sd->write(sizeof(p1), p1, idx);
+	sd->close();
+	delete sd;
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	seekCost(sd, buf, false);
+	seekCost(sd, p2, true);
+	sd->close();
+
+	printf("sparse Q table slots%s\n",
+			SDMMC_COMPRESS ? ", coded" : "");
+	delete sd;
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	sd = qtableSlot(sd, q, buf, 7);
+	sd->close();
+
+	printf("new card with a seed image\n");
+	check(copyFile(_T("/dir_1/RLIC.dat"), _T("/dir_1/SEED.DAT")),
+			"RLIC.dat copied to SEED.DAT");
+	check(f_unlink(_T("/dir_1/RLIC.dat")) == FR_OK, "RLIC.dat removed");
+	delete sd;
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	check((sd->read(sizeof(buf), buf, 7) == kStatus_Success)
+			&& !memcmp(buf, q, sizeof(buf)), "slot 7 from the seed");
+	check(f_stat(_T("/dir_1/SEED.DAT"), NULL) == FR_NO_FILE, "seed taken");
+	sd->close();
+
+	printf("RLIC.dat from the build before the header\n");
+	check(f_unlink(_T("/dir_1/RLIC.dat")) == FR_OK, "old file removed");
+	check(f_open(&fil, _T("/dir_1/RLIC.dat"), FA_WRITE | FA_CREATE_ALWAYS)
+			== FR_OK, "headerless file created");
+	memset(buf, 0, sizeof(buf));
+	for (uint32_t off = 0; off < STORE_SIM_BASE_SZ; off += sizeof(buf)) {
+		uint32_t len = STORE_SIM_BASE_SZ - off;
+
+		f_write(&fil, buf, (len < sizeof(buf)) ? len : sizeof(buf), &bw);
+	}
+	f_lseek(&fil, 3 * STORE_SIM_ENTRY_SZ); /* headerless entries, bank A */
+	f_write(&fil, p1, sizeof(p1), &bw);
+	f_lseek(&fil, SDMMC_ENTRIES_MAX * STORE_SIM_ENTRY_SZ);
+	f_write(&fil, p2, sizeof(p2), &bw);
+	printf("  %u bytes\n", (unsigned) f_size(&fil));
+	check(f_size(&fil) == STORE_SIM_BASE_SZ + STORE_SIM_PAYLOAD_SZ,
+			"ends inside slot 1000");
+	f_close(&fil);
+	delete sd;
+
+	sd = new SDMMC_Simple();
+	steps = boot(sd);
+	printf("  %u startup steps to grow it\n", (unsigned) steps);
+	check(steps != 0, "card up");
+	check((sd->read(sizeof(buf), buf, 3) == kStatus_Success)
+			&& !memcmp(buf, p1, sizeof(buf)), "legacy slot 3 read");
+	check((sd->read(sizeof(buf), buf, SDMMC_ENTRIES_MAX) == kStatus_Success)
+			&& !memcmp(buf, p2, sizeof(buf)), "legacy slot 1000 kept whole");
+	/* bank B is new space over the stale entries */
+	zero = true;
+	for (uint32_t z = 0; z < SDMMC_ZONES_MAX; z++) {
+		zero = zero && (sd->read(sizeof(buf), buf, 600, z) == kStatus_Success)
+				&& isZero(buf, sizeof(buf));
+	}
+	check(zero, "grown banks read as zero");
+	check((sd->write(sizeof(p3), p3, 4) == kStatus_Success)
+			&& (sd->read(sizeof(buf), buf, 4) == kStatus_Success)
+			&& !memcmp(buf, p3, sizeof(buf)), "slot 4 written");
+	sd->close();
+	check((f_open(&fil, _T("/dir_1/RLIC.dat"), FA_READ) == FR_OK)
+			&& (f_size(&fil) == STORE_SIM_DENSE_SZ), "grown to both banks");
+	f_close(&fil);
+	delete sd;
+
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up again");
+	check((sd->read(sizeof(buf), buf, SDMMC_ENTRIES_MAX) == kStatus_Success)
+			&& !memcmp(buf, p2, sizeof(buf))
+			&& (sd->read(sizeof(buf), buf, 4) == kStatus_Success)
+			&& !memcmp(buf, p3, sizeof(buf)), "slots 1000 and 4 kept");
+	sd->close();
+	delete sd;
+
+#if RLIC_TRACE
+	uint32_t writes;
+
+	printf("step trace, TRACE.DAT\n");
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	memset(q, 0xA5, 2 * RLIC_TRACE_BLOCK_SZ);
+	check(sd->traceAppend(q, RLIC_TRACE_BLOCK_SZ) == kStatus_Success,
+			"file made, one block appended");
+	writes = s_sectorsWritten;
+	check(sd->traceAppend(&q[RLIC_TRACE_BLOCK_SZ], RLIC_TRACE_BLOCK_SZ)
+			== kStatus_Success, "another block appended");
+	writes = s_sectorsWritten - writes;
+	printf("  %u sectors written\n", (unsigned) writes);
+	check(writes == 1, "straight to its sector, no sync");
+	sd->close();
+	delete sd;
+	/* power cut in the middle of a block */
+	check((f_open(&fil, _T("/dir_1/TRACE.DAT"), FA_WRITE | FA_OPEN_APPEND)
+			== FR_OK) && (f_write(&fil, p1, 100, &bw) == FR_OK),
+			"block cut short");
+	f_close(&fil);
+	sd = new SDMMC_Simple();
+	check(boot(sd) != 0, "card up");
+	check(sd->traceAppend(p1, RLIC_TRACE_BLOCK_SZ) == kStatus_Success,
+			"block appended after it");
+	sd->close();
+	check((f_open(&fil, _T("/dir_1/TRACE.DAT"), FA_READ) == FR_OK)
+			&& (f_size(&fil) == 4 * RLIC_TRACE_BLOCK_SZ)
+			&& (f_read(&fil, buf, 2 * RLIC_TRACE_BLOCK_SZ, &bw) == FR_OK)
+			&& !memcmp(buf, q, 2 * RLIC_TRACE_BLOCK_SZ)
+			&& (f_lseek(&fil, 3 * RLIC_TRACE_BLOCK_SZ) == FR_OK)
+			&& (f_read(&fil, buf, RLIC_TRACE_BLOCK_SZ, &bw) == FR_OK)
+			&& !memcmp(buf, p1, RLIC_TRACE_BLOCK_SZ), "blocks aligned");
+	f_close(&fil);
+	delete sd;
+#endif
+
+	printf("%s\n", s_failed ? "FAILED" : "all checks passed");
+	return s_failed ? 1 : 0;
+}
@@ -0,0 +1,222 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Host check and benchmark for utilities/rlic_slot_codec.c.
+ *
+ *   cc -O2 -I utilities tools/slot_codec_bench.c utilities/rlic_slot_codec.c \
+ *       -o slot_codec_bench && ./slot_codec_bench docs/data/weights/RLIC.DAT
+ *
+ * Round trips every Q table slot of the given RLIC.dat (dense, headerless,
+ * one 4 KB entry per slot) and reports the encoded sizes, the card sectors
+ * an entry write would take with its 16 byte header, and ns per encode and
+ * decode. Then round trips random slots of every mix (zeros, nibbles,
+ * bytes, odd lengths), checks that cut short and overlong streams are
+ * refused and that encode honours its cap.
+ * The target numbers come from RLIC_SLOT_CODEC_BENCHMARK=1 (DWT cycles).
+ * Exits non zero when a check fails.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "rlic_slot_codec.h"
+
+#define BENCH_ENTRY_SZ		(4 * 1024)
+#define BENCH_SLOT_SZ		(2 * 65 * 16) /* Q values and pruning counters */
+#define BENCH_HDR_SZ		(16) /* sdmmc_entry_hdr_t */
+#define BENCH_SECTOR_SZ		(512)
+#define BENCH_SLOTS_MAX		(4 * 1024)
+#define BENCH_REPS			(200)
+#define CHECK_ROUNDS		(20000)
+
+static uint32_t s_failed;
+
+static double nowNS(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void check(bool ok, const char *what) {
+	printf("  %-48s %s\n", what, ok ? "ok" : "FAILED");
+	s_failed += !ok;
+}
+
+static bool roundTrip(const uint8_t *src, size_t len, size_t *coded) {
+	static uint8_t enc[2 * BENCH_ENTRY_SZ], dec[BENCH_ENTRY_SZ];
+
+	*coded = RLIC_SlotCodec_Encode(src, len, enc, sizeof(enc));
+	if (!*coded && len)
+		return false;
+	memset(dec, 0xA5, sizeof(dec));
+	return (RLIC_SlotCodec_Decode(enc, *coded, dec, len) == len)
+			&& !memcmp(dec, src, len);
+}
+
+static void shippedFile(const char *path) {
+	static uint8_t slots[BENCH_SLOTS_MAX][BENCH_SLOT_SZ];
+	static uint8_t enc[BENCH_SLOTS_MAX][BENCH_SLOT_SZ];
+	static uint8_t dec[BENCH_SLOT_SZ];
+	static uint8_t entry[BENCH_ENTRY_SZ];
+	uint32_t n = 0, sizeMin = UINT32_MAX, sizeMax = 0, sectors[4] = { 0 };
+	uint64_t sizeSum = 0;
+	size_t coded[BENCH_SLOTS_MAX];
+	bool ok = true;
+	double t0, encNS, decNS;
+	volatile size_t sink = 0;
+	FILE *f = fopen(path, "rb");
+
+	printf("%s\n", path);
+	if (!f) {
+		check(false, "file opened");
+		return;
+	}
+	while ((n < BENCH_SLOTS_MAX)
+			&& (fread(entry, 1, sizeof(entry), f) == sizeof(entry)))
+		memcpy(slots[n++], entry, BENCH_SLOT_SZ);
+	fclose(f);
+	check(n != 0, "slots loaded");
+	if (!n)
+		return;
+
+	for (uint32_t s = 0; s < n; s++) {
+		uint32_t sec;
+
+		coded[s] = RLIC_SlotCodec_Encode(slots[s], BENCH_SLOT_SZ, enc[s],
+				sizeof(enc[s]));
+		ok = ok && coded[s]
+				&& (RLIC_SlotCodec_Decode(enc[s], coded[s], dec, sizeof(dec))
+						== BENCH_SLOT_SZ) && !memcmp(dec, slots[s], sizeof(dec));
+		sizeMin = (coded[s] < sizeMin) ? coded[s] : sizeMin;
+		sizeMax = (coded[s] > sizeMax) ? coded[s] : sizeMax;
+		sizeSum += coded[s];
+		sec = (BENCH_HDR_SZ + coded[s] + BENCH_SECTOR_SZ - 1) / BENCH_SECTOR_SZ;
+		sectors[(sec < 3) ? sec : 3]++;
+	}
+	check(ok, "every slot round trips");
+
+	t0 = nowNS();
+	for (uint32_t r = 0; r < BENCH_REPS; r++) {
+		for (uint32_t s = 0; s < n; s++)
+			sink += RLIC_SlotCodec_Encode(slots[s], BENCH_SLOT_SZ, enc[s],
+					sizeof(enc[s]));
+	}
+	encNS = (nowNS() - t0) / ((double) BENCH_REPS * n);
+	t0 = nowNS();
+	for (uint32_t r = 0; r < BENCH_REPS; r++) {
+		for (uint32_t s = 0; s < n; s++)
+			sink += RLIC_SlotCodec_Decode(enc[s], coded[s], dec, sizeof(dec));
+	}
+	decNS = (nowNS() - t0) / ((double) BENCH_REPS * n);
+
+	printf("  %u slots of %u bytes: encoded %u min, %.1f avg, %u max "
+			"(%.1fx)\n", (unsigned) n, (unsigned) BENCH_SLOT_SZ,
+			(unsigned) sizeMin, (double) sizeSum / n, (unsigned) sizeMax,
+			(double) BENCH_SLOT_SZ * n / sizeSum);
+	printf("  entry write with header: %u in 1 sector, %u in 2, %u in more "
+			"(raw: %u sectors each)\n", (unsigned) sectors[1],
+			(unsigned) sectors[2], (unsigned) sectors[3],
+			(unsigned) ((BENCH_HDR_SZ + BENCH_SLOT_SZ + BENCH_SECTOR_SZ - 1)
+					/ BENCH_SECTOR_SZ));
+	printf("  %.0f ns per encode, %.0f ns per decode (%u)\n", encNS, decNS,
+			(unsigned) (sink & 1));
+	check(sectors[3] == 0, "every entry in at most 2 sectors");
+}
+
+/* random slot: runs of zeros, small values and full bytes */
+static size_t randomSlot(uint8_t *buf, size_t cap) {
+	size_t len = (size_t) rand() % (cap + 1);
+
+	for (size_t i = 0; i < len;) {
+		size_t run = 1 + (size_t) rand() % ((rand() % 8) ? 8 : 300);
+		int kind = rand() % 3;
+
+		for (size_t k = 0; (k < run) && (i < len); k++, i++) {
+			if (kind == 0)
+				buf[i] = 0;
+			else if (kind == 1)
+				buf[i] = (uint8_t) (rand() % 16);
+			else
+				buf[i] = (uint8_t) rand();
+		}
+	}
+	return len;
+}
+
+static void randomSlots(void) {
+	static uint8_t src[BENCH_ENTRY_SZ], enc[2 * BENCH_ENTRY_SZ];
+	static uint8_t dec[BENCH_ENTRY_SZ];
+	size_t coded, worst = 0;
+	bool ok = true, capOK = true, cutOK = true;
+
+	printf("random slots\n");
+	srand(1);
+	for (uint32_t r = 0; r < CHECK_ROUNDS; r++) {
+		size_t len = randomSlot(src, sizeof(src));
+
+		ok = ok && roundTrip(src, len, &coded);
+		if (len && ((coded * 1000 / len) > worst))
+			worst = coded * 1000 / len;
+
+		/* any cap below the encoded size is refused, never overrun */
+		if (coded > 1) {
+			size_t cap = (size_t) rand() % coded;
+
+			memset(enc, 0x5A, sizeof(enc));
+			capOK = capOK && !RLIC_SlotCodec_Encode(src, len, enc, cap)
+					&& (enc[cap] == 0x5A);
+
+			/* a stream cut short or decoded into less room */
+			coded = RLIC_SlotCodec_Encode(src, len, enc, sizeof(enc));
+			cutOK = cutOK
+					&& (RLIC_SlotCodec_Decode(enc, coded, dec, len - 1)
+							!= len)
+					&& (RLIC_SlotCodec_Decode(enc, cap, dec, len) != len);
+		}
+	}
+	printf("  worst case %.3f encoded bytes per byte\n", worst / 1000.0);
+	check(ok, "random slots round trip");
+	check(capOK, "encode stops at its cap");
+	check(cutOK, "short streams and short buffers refused");
+
+	memset(src, 0, sizeof(src));
+	check(roundTrip(src, sizeof(src), &coded) && (coded == 2),
+			"all zero entry in 2 bytes");
+	memset(src, 0xFF, sizeof(src));
+	check(roundTrip(src, sizeof(src), &coded)
+			&& (coded == sizeof(src) + sizeof(src) / RLIC_SLOT_CODEC_RUN_MAX),
+			"all 0xFF entry, one lead byte per 64");
+}
+
+int main(int argc, char **argv) {
+	shippedFile((argc > 1) ? argv[1] : "docs/data/weights/RLIC.DAT");
+	randomSlots();
+
+	printf("%s\n", s_failed ? "FAILED" : "all checks passed");
+	return s_failed ? 1 : 0;
+}
@@ -0,0 +1,433 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Replays a step trace (TRACE.DAT, see rlic_trace.h) through the real
+ * source/QLearning.cpp and checks it decides as the board did.
+ *
+ *   g++ -O3 -march=native -I tools/host -I source -I utilities \
+ *       tools/trace_replay.cpp source/QLearning.cpp utilities/rlic_argmax.c \
+ *       utilities/rlic_tiles.c -o trace_replay
+ *
+ *   trace_replay [-i IMAGE] [-r N] [-v] TRACE.DAT
+ *
+ * Build with the learner flags of the firmware that made the trace
+ * (QLEARN_*, and -DRLIC_ZONES=2 for two zones); its boot records carry
+ * QLEARN_BUILD_FLAGS and a different build is reported. Each boot record
+ * builds the learners again and seeds them with the recorded seed, then
+ * each step is run as RLIC_Zone runs it: explore or exploit, pick the
+ * action for the recorded day time, take the reward of the recorded lux
+ * and learn. The action, slot, explore flag and reward must come out as
+ * recorded. RLIC.dat is held in memory and carries over boots as the card
+ * does; it starts empty, or from IMAGE, a legacy RLIC.dat (rlic_dat
+ * convert -f legacy) of the card as it was when the trace began. That
+ * holds one zone, the others start empty. The card comes up when the
+ * trace says it was up.
+ *
+ * After a learner change the first step that differs shows where it
+ * parts from the recorded run; from there on the lux no longer belongs to
+ * the action taken. -r N runs the trace N times from the start, for a
+ * steps per second figure; -v prints every step that differs, not the
+ * first ten. Exits 0 when all steps match, 1 when any differ, 2 on a bad
+ * command line or trace.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <new>
+#include <getopt.h>
+#include "QLearning.h"
+#include "rlic_trace.h"
+
+#define REPLAY_SLOTS		(QTABLE_ENTRIES_MAX + 1)
+#define REPLAY_ENTRY_SZ		(4 * 1024) /* RLIC.dat entry stride */
+#define REPLAY_ZONE_SZ		(2 * (size_t) REPLAY_SLOTS * REPLAY_ENTRY_SZ)
+#define REPLAY_QTABLE_SZ	(2 * 65 * 16) /* Q values, then pruning */
+#define REPLAY_SHOW			(10) /* differing steps printed without -v */
+
+/* card stand-in: entries held in memory, up when the trace says so */
+static uint8_t s_store[SDMMC_ZONES_MAX][REPLAY_SLOTS][REPLAY_ENTRY_SZ];
+static uint32_t s_storeLen[SDMMC_ZONES_MAX][REPLAY_SLOTS];
+static bool s_cardUp;
+
+SDMMC_Simple::SDMMC_Simple() {
+
+}
+
+SDMMC_Simple::~SDMMC_Simple() {
+
+}
+
+status_t SDMMC_Simple::startup(bool *ready) {
+	*ready = s_cardUp;
+	return kStatus_Success;
+}
+
+bool SDMMC_Simple::isReady(void) {
+	return s_cardUp;
+}
+
+status_t SDMMC_Simple::close(void) {
+	return kStatus_Success;
+}
+
+status_t SDMMC_Simple::read(uint32_t numbytes, uint8_t *data, uint32_t idx,
+		uint32_t zone) {
+	if ((idx >= REPLAY_SLOTS) || (zone >= SDMMC_ZONES_MAX)
+			|| (numbytes > REPLAY_ENTRY_SZ))
+		return kStatus_Fail;
+	if (s_storeLen[zone][idx] == numbytes)
+		memcpy(data, s_store[zone][idx], numbytes);
+	else
+		memset(data, 0, numbytes);
+	return kStatus_Success;
+}
+
+status_t SDMMC_Simple::write(uint32_t numbytes, uint8_t *data, uint32_t idx,
+		uint32_t zone) {
+	if ((idx >= REPLAY_SLOTS) || (zone >= SDMMC_ZONES_MAX)
+			|| (numbytes > REPLAY_ENTRY_SZ))
+		return kStatus_Fail;
+	memcpy(s_store[zone][idx], data, numbytes);
+	s_storeLen[zone][idx] = numbytes;
+	return kStatus_Success;
+}
+
+typedef struct {
+	const rlic_trace_rec_t *recs;
+	uint32_t count;
+	uint32_t boots;
+	uint32_t steps;
+	uint32_t gaps;
+	uint32_t dropped;
+	uint32_t zones;
+} replay_trace_t;
+
+typedef struct {
+	uint32_t steps;
+	uint32_t diffs; /* steps that differ in anything */
+	uint32_t action; /* LEDs, duty or slot */
+	uint32_t explore;
+	uint32_t reward;
+	uint32_t shown;
+	uint32_t first; /* step number of the first difference */
+	bool verbose;
+} replay_result_t;
+
+static double nowNS(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* whole file, records checked for type and boot records for magic */
+static bool loadTrace(const char *path, replay_trace_t *t) {
+	FILE *f = fopen(path, "rb");
+	rlic_trace_rec_t *recs;
+	long size;
+
+	memset(t, 0, sizeof(*t));
+	if (!f) {
+		perror(path);
+		return false;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	recs = (rlic_trace_rec_t*) malloc(size ? size : 1);
+	if (!recs || (fread(recs, 1, size, f) != (size_t) size)) {
+		fprintf(stderr, "%s: read failed\n", path);
+		fclose(f);
+		free(recs);
+		return false;
+	}
+	fclose(f);
+	if (size % RLIC_TRACE_BLOCK_SZ)
+		fprintf(stderr, "%s: %ld bytes past the last whole block\n", path,
+				size % RLIC_TRACE_BLOCK_SZ);
+	t->recs = recs;
+	t->count = (uint32_t) (size / RLIC_TRACE_REC_SZ);
+
+	for (uint32_t i = 0; i < t->count; i++) {
+		const rlic_trace_rec_t *r = &recs[i];
+
+		switch (r->type) {
+		case RLIC_TRACE_PAD:
+			break;
+		case RLIC_TRACE_BOOT:
+			if ((r->boot.magic != RLIC_TRACE_MAGIC)
+					|| (r->boot.version != RLIC_TRACE_VERSION)) {
+				fprintf(stderr, "%s: record %u: not a trace boot record\n",
+						path, (unsigned) i);
+				return false;
+			}
+			if (r->boot.config != QLEARN_BUILD_FLAGS)
+				printf("boot %u: learner build 0x%x, this replay 0x%x\n",
+						(unsigned) t->boots, (unsigned) r->boot.config,
+						(unsigned) QLEARN_BUILD_FLAGS);
+			if (r->boot.zones > t->zones)
+				t->zones = r->boot.zones;
+			t->boots++;
+			break;
+		case RLIC_TRACE_STEP:
+			if (!t->boots) {
+				fprintf(stderr, "%s: steps before the first boot record\n",
+						path);
+				return false;
+			}
+			if (r->step.zone >= SDMMC_ZONES_MAX) {
+				fprintf(stderr, "%s: record %u: zone %u, build with "
+						"-DRLIC_ZONES=%u\n", path, (unsigned) i,
+						(unsigned) r->step.zone,
+						(unsigned) (r->step.zone + 1));
+				return false;
+			}
+			t->steps++;
+			break;
+		case RLIC_TRACE_GAP:
+			t->gaps++;
+			t->dropped += r->gap.dropped;
+			break;
+		default:
+			fprintf(stderr, "%s: record %u: unknown type %u\n", path,
+					(unsigned) i, (unsigned) r->type);
+			return false;
+		}
+	}
+	return true;
+}
+
+/* legacy RLIC.dat: Q table of each slot at the start of its entry */
+static uint8_t* loadImage(const char *path, size_t *size) {
+	FILE *f = fopen(path, "rb");
+	uint8_t *image;
+
+	if (!f) {
+		perror(path);
+		return NULL;
+	}
+	fseek(f, 0, SEEK_END);
+	*size = (size_t) ftell(f);
+	fseek(f, 0, SEEK_SET);
+	image = (uint8_t*) malloc(*size ? *size : 1);
+	if (!image || (fread(image, 1, *size, f) != *size)) {
+		fprintf(stderr, "%s: read failed\n", path);
+		free(image);
+		image = NULL;
+	}
+	fclose(f);
+	return image;
+}
+
+static void resetStore(const uint8_t *image, size_t size) {
+	memset(s_storeLen, 0, sizeof(s_storeLen));
+	if (!image)
+		return;
+	for (uint32_t z = 0; z < SDMMC_ZONES_MAX; z++) {
+		for (uint32_t idx = 0; idx < REPLAY_SLOTS; idx++) {
+			size_t off = z * REPLAY_ZONE_SZ + (size_t) idx * REPLAY_ENTRY_SZ;
+
+			if ((off + REPLAY_QTABLE_SZ) > size)
+				return;
+			memcpy(s_store[z][idx], &image[off], REPLAY_QTABLE_SZ);
+			s_storeLen[z][idx] = REPLAY_QTABLE_SZ;
+		}
+	}
+}
+
+static void showStep(replay_result_t *res, uint32_t n,
+		const rlic_trace_step_t *s, const Brightness &b, uint32_t idx,
+		bool exep, uint8_t reward) {
+	if (!res->verbose && (res->shown >= REPLAY_SHOW))
+		return;
+	res->shown++;
+	printf("step %u zone %u at %u ms: recorded slot %u %u LEDs duty %u%s "
+			"reward %u, replayed slot %u %u LEDs duty %u%s reward %u\n",
+			(unsigned) n, (unsigned) s->zone, (unsigned) s->dayTimeMS,
+			(unsigned) s->slot, (unsigned) s->numOnLeds, (unsigned) s->duty,
+			(s->flags & RLIC_TRACE_EXPLORE) ? " explore" : "",
+			(unsigned) s->reward, (unsigned) idx, (unsigned) b.numOnLeds,
+			(unsigned) b.duty, exep ? " explore" : "", (unsigned) reward);
+}
+
+/* card up by now: bring the learners' storage up as pollStorage() does */
+static bool cardUp(void) {
+	bool ready;
+
+	s_cardUp = true;
+	return (QLearning::startQStorage(&ready) == kStatus_Success) && ready;
+}
+
+/* one pass over the trace, learners built again at each boot record */
+static bool replay(const replay_trace_t *t, QLearning *learners,
+		replay_result_t *res) {
+	uint32_t n = 0;
+
+	for (uint32_t i = 0; i < t->count; i++) {
+		const rlic_trace_rec_t *r = &t->recs[i];
+		const rlic_trace_step_t *s = &r->step;
+		QLearning *learner;
+		Brightness b;
+		uint32_t idx;
+		uint8_t reward;
+		bool exep, diff = false;
+
+		if (r->type == RLIC_TRACE_BOOT) {
+			/* a reboot: RAM state gone, the card stays */
+			learners[0].closeQStorage();
+			s_cardUp = false;
+			for (uint32_t z = 0; z < SDMMC_ZONES_MAX; z++) {
+				learners[z].~QLearning();
+				new (&learners[z]) QLearning(z);
+			}
+			QLearning::seedRandom(r->boot.seed);
+			continue;
+		}
+		if (r->type != RLIC_TRACE_STEP)
+			continue;
+
+		learner = &learners[s->zone];
+		if ((s->flags & RLIC_TRACE_CARD_BEGIN) && !QLearning::isStorageReady()
+				&& !cardUp())
+			return false;
+		exep = learner->runExploreExploit();
+		idx = learner->getQBrightness(b, s->dayTimeMS, exep, true);
+		if (idx >= REPLAY_SLOTS) {
+			printf("step %u: getQBrightness failed\n", (unsigned) n);
+			return false;
+		}
+		if ((s->flags & RLIC_TRACE_CARD) && !QLearning::isStorageReady()
+				&& !cardUp())
+			return false;
+		reward = learner->getReward(s->lux);
+
+		if ((idx != s->slot) || (b.numOnLeds != s->numOnLeds)
+				|| (b.duty != s->duty)) {
+			res->action++;
+			diff = true;
+		}
+		if (exep != !!(s->flags & RLIC_TRACE_EXPLORE)) {
+			res->explore++;
+			diff = true;
+		}
+		if (reward != s->reward) {
+			res->reward++;
+			diff = true;
+		}
+		if (diff) {
+			if (!res->diffs++)
+				res->first = n;
+			showStep(res, n, s, b, idx, exep, reward);
+		}
+
+		if (!learner->updateQTable(b, reward, idx)) {
+			printf("step %u: updateQTable failed\n", (unsigned) n);
+			return false;
+		}
+		n++;
+	}
+	learners[0].closeQStorage();
+	res->steps += n;
+	return true;
+}
+
+static void usage(void) {
+	fprintf(stderr, "usage: trace_replay [-i IMAGE] [-r N] [-v] TRACE.DAT\n");
+}
+
+int main(int argc, char **argv) {
+	static QLearning learners[SDMMC_ZONES_MAX];
+	replay_trace_t trace;
+	replay_result_t res, timed;
+	const char *imagePath = NULL;
+	uint8_t *image = NULL;
+	size_t imageSize = 0;
+	uint32_t runs = 1;
+	double start, ns;
+	int opt;
+
+	memset(&res, 0, sizeof(res));
+	while ((opt = getopt(argc, argv, "i:r:v")) != -1) {
+		switch (opt) {
+		case 'i':
+			imagePath = optarg;
+			break;
+		case 'r':
+			runs = (uint32_t) strtoul(optarg, NULL, 0);
+			break;
+		case 'v':
+			res.verbose = true;
+			break;
+		default:
+			usage();
+			return 2;
+		}
+	}
+	if ((optind != (argc - 1)) || !runs) {
+		usage();
+		return 2;
+	}
+	if (!loadTrace(argv[optind], &trace))
+		return 2;
+	if (imagePath && !(image = loadImage(imagePath, &imageSize)))
+		return 2;
+
+	printf("%s: %u records, %u boots, %u steps, %u zones", argv[optind],
+			(unsigned) trace.count, (unsigned) trace.boots,
+			(unsigned) trace.steps, (unsigned) trace.zones);
+	if (trace.gaps)
+		printf(", %u gaps (%u steps dropped, later steps may differ)",
+				(unsigned) trace.gaps, (unsigned) trace.dropped);
+	printf("\n");
+
+	/* the first run is checked, the others only timed */
+	memset(&timed, 0, sizeof(timed));
+	timed.shown = REPLAY_SHOW;
+	ns = 0;
+	for (uint32_t run = 0; run < runs; run++) {
+		resetStore(image, imageSize);
+		start = nowNS();
+		if (!replay(&trace, learners, run ? &timed : &res))
+			return 1;
+		ns += nowNS() - start;
+	}
+	timed.steps += res.steps;
+
+	printf("replayed %u steps in %.3f s: %.2f M steps/s, %.0f ns per step\n",
+			(unsigned) timed.steps, ns / 1e9, timed.steps * 1e3 / ns,
+			ns / timed.steps);
+	if (res.diffs) {
+		printf("%u steps of %u differ (first at step %u): %u actions, "
+				"%u explore flags, %u rewards\n", (unsigned) res.diffs,
+				(unsigned) trace.steps, (unsigned) res.first,
+				(unsigned) res.action, (unsigned) res.explore,
+				(unsigned) res.reward);
+		return 1;
+	}
+	printf("all %u steps match\n", (unsigned) trace.steps);
+	return 0;
+}
@@ -0,0 +1,237 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Fake TSL2591 on a fake I2C bus, drives the real driver on a PC.
+ *
+ *   g++ -O2 -I tools/host -I Adafruit_Sensor -I Adafruit_TSL2591_Library \
+ *       tools/tsl2591_fakedev.cpp Adafruit_TSL2591_Library/Adafruit_TSL2591.cpp \
+ *       Adafruit_Sensor/Adafruit_Sensor.cpp -o tsl2591_fakedev
+ *
+ * Add -DTSL2591_REGMAP=0 for the old register by register access. The
+ * device models the register file, auto increment reads, the command
+ * byte and integration timing. Integrations run back to back while AEN is
+ * set, each at the gain and time CONTROL held when it started: a new
+ * setting written to a running device only applies from the next one, as
+ * on the part; AEN off and on starts a fresh integration and clears
+ * AVALID. A read that returns no data, or data of another setting than
+ * CONTROL holds, is stale and reported. Prints I2C transactions per
+ * sample for the fixed and the auto ranging paths.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include "Adafruit_TSL2591.h"
+
+#define FAKE_CMD_MASK		(0xE0)
+#define FAKE_CMD_NORMAL		(0xA0)
+#define FAKE_CMD_SPECIAL	(0xE0)
+#define FAKE_ADDR_MASK		(0x1F)
+
+static uint32_t s_nowMS;
+
+void SysTick_DelayTicksMS(uint32_t n) {
+	s_nowMS += n;
+}
+
+uint32_t SysTick_UptimeMS(void) {
+	return s_nowMS;
+}
+
+void SysTick_IdleMS(uint32_t ms) {
+	s_nowMS += ms;
+}
+
+/* light in counts per 100 ms at 1x gain, IR share of channel 0 */
+static struct {
+	uint8_t regs[0x20];
+	double light;
+	double irShare;
+	uint32_t startMS; /* integration in progress started */
+	uint8_t startControl; /* and its setting */
+	uint16_t data[2]; /* latched at the end of each integration */
+	uint8_t dataControl; /* setting the data was taken at */
+	bool valid;
+	uint32_t transactions;
+} s_dev;
+
+static bool fakeRunning(void) {
+	return (s_dev.regs[TSL2591_REGISTER_ENABLE]
+			& (TSL2591_ENABLE_POWERON | TSL2591_ENABLE_AEN))
+			== (TSL2591_ENABLE_POWERON | TSL2591_ENABLE_AEN);
+}
+
+/* AEN on starts an integration, off drops what was measured */
+static void fakeEnable(uint8_t value) {
+	bool wasRunning = fakeRunning();
+
+	s_dev.regs[TSL2591_REGISTER_ENABLE] = value;
+	if (!fakeRunning()) {
+		s_dev.valid = false;
+		s_dev.regs[TSL2591_REGISTER_DEVICE_STATUS] &= ~TSL2591_STATUS_AVALID;
+	} else if (!wasRunning) {
+		s_dev.startMS = s_nowMS;
+		s_dev.startControl = s_dev.regs[TSL2591_REGISTER_CONTROL];
+	}
+}
+
+/* finish the integrations time has run through, each at its own setting */
+static void fakeConvert(void) {
+	static const double gainX[] = { 1, 25, 428, 9876 };
+
+	while (fakeRunning()) {
+		uint8_t control = s_dev.startControl;
+		uint32_t atime = (control & 0x07) + 1;
+		double fs = (atime == 1) ? 37888 : 65535;
+		double ch0, ch1;
+
+		if ((s_nowMS - s_dev.startMS) < (atime * 100))
+			return;
+
+		ch0 = s_dev.light * gainX[(control >> 4) & 3] * atime;
+		ch1 = ch0 * s_dev.irShare;
+		s_dev.data[0] = (ch0 >= fs) ? 0xFFFF : (uint16_t) ch0;
+		s_dev.data[1] = (ch1 >= fs) ? 0xFFFF : (uint16_t) ch1;
+		s_dev.dataControl = control;
+		s_dev.valid = true;
+		s_dev.regs[TSL2591_REGISTER_DEVICE_STATUS] |= TSL2591_STATUS_AVALID;
+		s_dev.startMS += atime * 100;
+		s_dev.startControl = s_dev.regs[TSL2591_REGISTER_CONTROL];
+	}
+}
+
+/* the last read gave no counts, or counts of an older setting */
+static bool fakeStale(void) {
+	return !s_dev.valid
+			|| (s_dev.dataControl != s_dev.regs[TSL2591_REGISTER_CONTROL]);
+}
+
+extern "C" status_t BOARD_TSL2591_I2C_Send(uint8_t bus, uint8_t deviceAddress,
+		uint32_t subAddress, uint8_t subaddressSize, uint32_t txBuff) {
+	uint8_t reg = subAddress & FAKE_ADDR_MASK;
+
+	(void) bus;
+	(void) deviceAddress;
+	(void) subaddressSize;
+	s_dev.transactions++;
+	if ((subAddress & FAKE_CMD_MASK) != FAKE_CMD_NORMAL)
+		return kStatus_Fail;
+
+	fakeConvert();
+	if (reg == TSL2591_REGISTER_ENABLE)
+		fakeEnable(txBuff);
+	else
+		s_dev.regs[reg] = txBuff; /* CONTROL: from the next integration */
+	return kStatus_Success;
+}
+
+extern "C" status_t BOARD_TSL2591_I2C_Send_Clear(uint8_t bus,
+		uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize) {
+	(void) bus;
+	(void) deviceAddress;
+	(void) subaddressSize;
+	s_dev.transactions++;
+	return ((subAddress & FAKE_CMD_MASK) == FAKE_CMD_SPECIAL) ?
+			kStatus_Success : kStatus_Fail;
+}
+
+extern "C" status_t BOARD_TSL2591_I2C_Receive(uint8_t bus,
+		uint8_t deviceAddress, uint32_t subAddress, uint8_t subaddressSize,
+		uint8_t *rxBuff, uint8_t rxBuffSize) {
+	uint8_t reg = subAddress & FAKE_ADDR_MASK;
+
+	(void) bus;
+	(void) deviceAddress;
+	(void) subaddressSize;
+	s_dev.transactions++;
+	if ((subAddress & FAKE_CMD_MASK) != FAKE_CMD_NORMAL)
+		return kStatus_Fail;
+
+	fakeConvert();
+	s_dev.regs[TSL2591_REGISTER_DEVICE_ID] = 0x50;
+	s_dev.regs[TSL2591_REGISTER_CHAN0_LOW] = s_dev.data[0] & 0xFF;
+	s_dev.regs[TSL2591_REGISTER_CHAN0_HIGH] = s_dev.data[0] >> 8;
+	s_dev.regs[TSL2591_REGISTER_CHAN1_LOW] = s_dev.data[1] & 0xFF;
+	s_dev.regs[TSL2591_REGISTER_CHAN1_HIGH] = s_dev.data[1] >> 8;
+
+	/* auto increment */
+	for (uint8_t i = 0; i < rxBuffSize; i++)
+		rxBuff[i] = s_dev.regs[(reg + i) & FAKE_ADDR_MASK];
+	return kStatus_Success;
+}
+
+int main(void) {
+	static const double levels[] = { 0.02, 0.5, 4, 30, 90, 400, 2500, 30000,
+			2500, 90, 4, 0.5 };
+	const uint32_t nlevels = sizeof(levels) / sizeof(levels[0]);
+	Adafruit_TSL2591 tsl(2591);
+	uint32_t count, errors = 0, stale = 0;
+	uint32_t waitMS;
+
+	s_dev.irShare = 0.25;
+	if (!tsl.begin()) {
+		printf("device not found\n");
+		return 1;
+	}
+	tsl.configureSensor();
+
+	/* fixed medium gain, 200 ms, as the controller ran before auto range */
+	count = s_dev.transactions;
+	for (uint32_t i = 0; i < nlevels; i++) {
+		s_dev.light = (levels[i] > 60) ? 60 : levels[i]; /* no saturation */
+		tsl.getLuminosity(TSL2591_FULLSPECTRUM);
+		if (fakeStale())
+			stale++;
+	}
+	printf("fixed: %.2f I2C transactions per sample\n",
+			(double) (s_dev.transactions - count) / nlevels);
+
+	/* auto ranging, two reads per step like main() */
+	count = s_dev.transactions;
+	waitMS = s_nowMS;
+	for (uint32_t i = 0; i < nlevels; i++) {
+		double expect;
+		uint32_t got;
+
+		s_dev.light = levels[i];
+		tsl.getAutoLuminosity(TSL2591_FULLSPECTRUM);
+		got = tsl.getAutoLuminosity(TSL2591_FULLSPECTRUM);
+		if (fakeStale())
+			stale++;
+
+		/* medium gain, 200 ms units */
+		expect = levels[i] * 25 * 2;
+		if ((got < expect * 0.98 - 50) || (got > expect * 1.02 + 50)) {
+			printf("light %.2f: got %u expected %.0f\n", levels[i], got,
+					expect);
+			errors++;
+		}
+	}
+	printf("auto:  %.2f I2C transactions per sample, %u ms per step\n",
+			(double) (s_dev.transactions - count) / (2 * nlevels),
+			(s_nowMS - waitMS) / nlevels);
+	printf("TSL2591_REGMAP=%d: %u stale reads, %u value errors\n",
+			TSL2591_REGMAP, stale, errors);
+
+	return (errors || stale) ? 1 : 0;
+}
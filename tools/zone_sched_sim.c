@@ -0,0 +1,202 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+/*
+ * Host model of the zone scheduler in utilities/rlic_zone_sched.c.
+ *
+ *   cc -O2 -DRLIC_ZONES_MAX=64 -I tools/host -I utilities \
+ *       tools/zone_sched_sim.c utilities/rlic_zone_sched.c \
+ *       -o zone_sched_sim && ./zone_sched_sim
+ *
+ * Each virtual zone does what RLIC_Zone does on the board, on a virtual
+ * clock: begin writes the LED frame and starts the sensor, the first finish
+ * reads and restarts it for the second sample, the second finish reads,
+ * learns and writes the entry back. Costs are the 400 kHz wire times and a
+ * few ms for the card write; the integration time is 110 to 220 ms per
+ * zone. The board has one TSL2591 per LPI2C bus (fixed address), so two
+ * zones is the real limit, the higher counts show where the CPU and bus
+ * time saturate. The program checks that a sequential scheduler never has
+ * two zones sensing, that every zone makes progress and that an error from
+ * a zone reaches the caller and does not stop the others.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "rlic_zone_sched.h"
+
+#define SIM_BEGIN_US		(1100) /* explore, 17 byte LED frame, sensor enable */
+#define SIM_READ_US			(250) /* 5 byte status and channel read */
+#define SIM_LEARN_US		(3500) /* Q update and RLIC.dat write */
+#define SIM_RUN_MS			(60000)
+
+typedef struct {
+	uint32_t sampleMS; /* integration time */
+	uint32_t sample; /* samples taken this step */
+	uint32_t failAtStep; /* 0 = never */
+	uint32_t steps;
+} sim_zone_t;
+
+static uint64_t s_nowUs;
+static uint32_t s_failures;
+
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		s_failures++; \
+	} \
+} while (0)
+
+static uint32_t simClockMS(void) {
+	return (uint32_t) (s_nowUs / 1000);
+}
+
+static status_t simBegin(void *ctx, uint32_t *waitMS) {
+	sim_zone_t *z = (sim_zone_t*) ctx;
+
+	s_nowUs += SIM_BEGIN_US;
+	z->sample = 0;
+	*waitMS = z->sampleMS;
+	return kStatus_Success;
+}
+
+static status_t simFinish(void *ctx, uint32_t *waitMS) {
+	sim_zone_t *z = (sim_zone_t*) ctx;
+
+	s_nowUs += SIM_READ_US;
+	if (++z->sample < 2) {
+		*waitMS = z->sampleMS;
+		return kStatus_Success;
+	}
+	z->steps++;
+	if (z->failAtStep && (z->steps == z->failAtStep))
+		return kStatus_Fail;
+	s_nowUs += SIM_LEARN_US;
+	*waitMS = 0;
+	return kStatus_Success;
+}
+
+static const rlic_zone_ops_t s_simOps = { simBegin, simFinish };
+
+typedef struct {
+	uint32_t steps;
+	uint32_t busyPct;
+	uint32_t errors;
+	uint32_t maxSensing;
+	uint32_t minZoneSteps;
+} sim_result_t;
+
+static sim_result_t simRun(uint32_t numZones, uint32_t mode, uint32_t failZone) {
+	static rlic_zone_t zones[RLIC_ZONES_MAX];
+	static sim_zone_t sims[RLIC_ZONES_MAX];
+	static char names[RLIC_ZONES_MAX][8];
+	rlic_zone_sched_t sched;
+	sim_result_t res = { 0, 0, 0, 0, UINT32_MAX };
+
+	s_nowUs = 0;
+	RLIC_ZoneSched_Init(&sched, mode, simClockMS);
+	for (uint32_t i = 0; i < numZones; i++) {
+		sims[i].sampleMS = 110 + ((i * 37) % 111);
+		sims[i].sample = 0;
+		sims[i].steps = 0;
+		sims[i].failAtStep = (i == failZone) ? 3 : 0;
+		snprintf(names[i], sizeof(names[i]), "zone%u", (unsigned) i);
+		CHECK(RLIC_ZoneSched_Add(&sched, &zones[i], names[i], &s_simOps,
+				&sims[i]) == kStatus_Success);
+	}
+	RLIC_ZoneSched_ResetStats(&sched);
+
+	while (simClockMS() < SIM_RUN_MS) {
+		uint32_t waitMS, sensing = 0;
+
+		if (RLIC_ZoneSched_Run(&sched, &waitMS) != kStatus_Success)
+			res.errors++;
+		for (uint32_t i = 0; i < numZones; i++)
+			if (zones[i].state == RLIC_ZONE_SENSING)
+				sensing++;
+		if (sensing > res.maxSensing)
+			res.maxSensing = sensing;
+		/* the main loop sleeps until the next sample is due */
+		s_nowUs += (uint64_t) waitMS * 1000;
+	}
+
+	res.steps = sched.steps;
+	res.busyPct = (uint32_t) (((uint64_t) sched.busyMS * 100) / simClockMS());
+	for (uint32_t i = 0; i < numZones; i++) {
+		if (zones[i].steps < res.minZoneSteps)
+			res.minZoneSteps = zones[i].steps;
+		CHECK(zones[i].errors == ((i == failZone) ? 1U : 0U));
+	}
+	return res;
+}
+
+static void checkModes(void) {
+	sim_result_t seq = simRun(2, RLIC_ZONE_SEQUENTIAL, UINT32_MAX);
+	sim_result_t pipe = simRun(2, RLIC_ZONE_PIPELINED, UINT32_MAX);
+
+	CHECK(seq.maxSensing == 1);
+	CHECK(pipe.maxSensing == 2);
+	CHECK(seq.minZoneSteps > 0);
+	CHECK(pipe.steps > seq.steps);
+
+	/* one zone fails a step, the caller sees it once, the rest carry on */
+	seq = simRun(4, RLIC_ZONE_SEQUENTIAL, 1);
+	CHECK(seq.errors == 1);
+	CHECK(seq.minZoneSteps > 3);
+	pipe = simRun(4, RLIC_ZONE_PIPELINED, 2);
+	CHECK(pipe.errors == 1);
+	CHECK(pipe.minZoneSteps > 3);
+
+	/* one zone sequential is the single zone main loop */
+	seq = simRun(1, RLIC_ZONE_SEQUENTIAL, UINT32_MAX);
+	pipe = simRun(1, RLIC_ZONE_PIPELINED, UINT32_MAX);
+	CHECK(seq.steps == pipe.steps);
+}
+
+static void printScaling(void) {
+	static const uint32_t counts[] = { 1, 2, 4, 8, 16, 32, 48, 64 };
+
+	printf("zones  sequential steps/s busy   pipelined steps/s busy\n");
+	for (uint32_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+		uint32_t n = counts[i];
+		sim_result_t seq, pipe;
+
+		if (n > RLIC_ZONES_MAX)
+			break;
+		seq = simRun(n, RLIC_ZONE_SEQUENTIAL, UINT32_MAX);
+		pipe = simRun(n, RLIC_ZONE_PIPELINED, UINT32_MAX);
+		CHECK(seq.maxSensing == 1);
+		CHECK(pipe.minZoneSteps > 0);
+		printf("%5u  %17.2f %3u%%   %16.2f %3u%%\n", (unsigned) n,
+				seq.steps * 1000.0 / SIM_RUN_MS, (unsigned) seq.busyPct,
+				pipe.steps * 1000.0 / SIM_RUN_MS, (unsigned) pipe.busyPct);
+	}
+}
+
+int main(void) {
+	checkModes();
+	printScaling();
+	printf("%s (%d failures)\n", s_failures ? "FAILED" : "passed",
+			(int) s_failures);
+	return s_failures ? 1 : 0;
+}
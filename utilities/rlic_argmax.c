@@ -0,0 +1,268 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <string.h>
+#include "rlic_argmax.h"
+
+#if defined(__arm__)
+#include "fsl_common.h"
+#include "fsl_debug_console.h"
+#include "rlic_section.h"
+#include "rlic_cycles.h"
+#else
+#define RLIC_HOT_CODE
+#endif
+
+#if RLIC_ARGMAX_SIMD && defined(__arm__) && defined(__ARM_FEATURE_DSP)
+#define RLIC_ARGMAX_DSP			(1)
+#elif RLIC_ARGMAX_SIMD && !defined(__arm__) && defined(__GNUC__)
+#define RLIC_ARGMAX_VECTOR		(1)
+#endif
+
+/*
+ * The SIMD variants run two passes: the largest value with packed compares,
+ * then the first byte equal to it. Ties resolve to the lowest index exactly
+ * like the scalar loop. Little endian only (both targets are).
+ */
+
+uint32_t RLIC_ArgMaxU8_Scalar(const uint8_t *data, uint32_t len) {
+	uint32_t best = 0;
+
+	for (uint32_t i = 1; i < len; i++) {
+		if (data[i] > data[best])
+			best = i;
+	}
+	return best;
+}
+
+uint32_t RLIC_ArgMaxU8_MaskedScalar(const uint8_t *data, const uint8_t *mask,
+		uint32_t len, uint8_t maskLimit) {
+	uint32_t best = len;
+
+	for (uint32_t i = 0; i < len; i++) {
+		if (mask[i] >= maskLimit)
+			continue;
+		if ((best == len) || (data[i] > data[best]))
+			best = i;
+	}
+	return best;
+}
+
+#if defined(RLIC_ARGMAX_DSP) || defined(RLIC_ARGMAX_VECTOR)
+static inline uint32_t rlicArgMaxLoad32(const uint8_t *p) {
+	uint32_t w;
+
+	memcpy(&w, p, sizeof(w)); /* single LDR, M7 handles unaligned */
+	return w;
+}
+
+/* 0x80 in each byte lane of w that is zero, no borrow between lanes */
+static inline uint32_t rlicArgMaxZeroBytes(uint32_t w) {
+	uint32_t t = (w & 0x7F7F7F7FU) + 0x7F7F7F7FU;
+
+	return ~(t | w | 0x7F7F7F7FU);
+}
+
+/* first unmasked index holding max, len if none */
+RLIC_HOT_CODE static uint32_t rlicArgMaxFind(const uint8_t *data,
+		const uint8_t *mask, uint32_t len, uint8_t maskLimit, uint8_t max) {
+	uint32_t maxv = max * 0x01010101U;
+	uint32_t i = 0;
+
+	for (; (i + 4) <= len; i += 4) {
+		uint32_t hits = rlicArgMaxZeroBytes(rlicArgMaxLoad32(&data[i]) ^ maxv);
+
+		while (hits) {
+			uint32_t k = i + (__builtin_ctz(hits) >> 3);
+
+			if (!mask || (mask[k] < maskLimit))
+				return k;
+			hits &= hits - 1;
+		}
+	}
+
+	for (; i < len; i++) {
+		if ((data[i] == max) && (!mask || (mask[i] < maskLimit)))
+			return i;
+	}
+	return len;
+}
+#endif
+
+#if defined(RLIC_ARGMAX_DSP)
+/* largest unmasked value, masked lanes count as 0 */
+RLIC_HOT_CODE static uint8_t rlicArgMaxValue(const uint8_t *data,
+		const uint8_t *mask, uint32_t len, uint8_t maskLimit) {
+	uint32_t limv = maskLimit * 0x01010101U;
+	uint32_t m = 0, hi;
+	uint32_t i = 0;
+
+	/* USUB8 sets GE per lane where x >= m, SEL keeps those lanes of x */
+	if (mask) {
+		for (; (i + 4) <= len; i += 4) {
+			uint32_t x = rlicArgMaxLoad32(&data[i]);
+
+			(void) __USUB8(rlicArgMaxLoad32(&mask[i]), limv);
+			x = __SEL(0, x);
+			(void) __USUB8(x, m);
+			m = __SEL(x, m);
+		}
+	} else {
+		for (; (i + 16) <= len; i += 16) {
+			uint32_t x0 = rlicArgMaxLoad32(&data[i]);
+			uint32_t x1 = rlicArgMaxLoad32(&data[i + 4]);
+			uint32_t x2 = rlicArgMaxLoad32(&data[i + 8]);
+			uint32_t x3 = rlicArgMaxLoad32(&data[i + 12]);
+
+			(void) __USUB8(x0, m);
+			m = __SEL(x0, m);
+			(void) __USUB8(x1, m);
+			m = __SEL(x1, m);
+			(void) __USUB8(x2, m);
+			m = __SEL(x2, m);
+			(void) __USUB8(x3, m);
+			m = __SEL(x3, m);
+		}
+		for (; (i + 4) <= len; i += 4) {
+			uint32_t x = rlicArgMaxLoad32(&data[i]);
+
+			(void) __USUB8(x, m);
+			m = __SEL(x, m);
+		}
+	}
+
+	/* fold the four lanes */
+	hi = m >> 16;
+	(void) __USUB8(m, hi);
+	m = __SEL(m, hi);
+	hi = m >> 8;
+	(void) __USUB8(m, hi);
+	m = __SEL(m, hi) & 0xFF;
+
+	for (; i < len; i++) {
+		if ((data[i] > m) && (!mask || (mask[i] < maskLimit)))
+			m = data[i];
+	}
+	return (uint8_t) m;
+}
+#elif defined(RLIC_ARGMAX_VECTOR)
+typedef uint8_t rlic_v16u8_t __attribute__((vector_size(16)));
+
+/* largest unmasked value, masked lanes count as 0 */
+static uint8_t rlicArgMaxValue(const uint8_t *data, const uint8_t *mask,
+		uint32_t len, uint8_t maskLimit) {
+	rlic_v16u8_t m = { 0 };
+	rlic_v16u8_t limv = m + maskLimit;
+	uint8_t lanes[16];
+	uint8_t max = 0;
+	uint32_t i = 0;
+
+	for (; (i + 16) <= len; i += 16) {
+		rlic_v16u8_t x, gt;
+
+		memcpy(&x, &data[i], sizeof(x));
+		if (mask) {
+			rlic_v16u8_t pm;
+
+			memcpy(&pm, &mask[i], sizeof(pm));
+			x &= (rlic_v16u8_t) (pm < limv);
+		}
+		gt = (rlic_v16u8_t) (x > m);
+		m = (x & gt) | (m & ~gt);
+	}
+
+	memcpy(lanes, &m, sizeof(lanes));
+	for (uint32_t k = 0; k < sizeof(lanes); k++) {
+		if (lanes[k] > max)
+			max = lanes[k];
+	}
+
+	for (; i < len; i++) {
+		if ((data[i] > max) && (!mask || (mask[i] < maskLimit)))
+			max = data[i];
+	}
+	return max;
+}
+#endif
+
+RLIC_HOT_CODE uint32_t RLIC_ArgMaxU8(const uint8_t *data, uint32_t len) {
+#if defined(RLIC_ARGMAX_DSP) || defined(RLIC_ARGMAX_VECTOR)
+	if (!len)
+		return 0;
+	return rlicArgMaxFind(data, NULL, len, 0,
+			rlicArgMaxValue(data, NULL, len, 0));
+#else
+	return RLIC_ArgMaxU8_Scalar(data, len);
+#endif
+}
+
+RLIC_HOT_CODE uint32_t RLIC_ArgMaxU8_Masked(const uint8_t *data,
+		const uint8_t *mask, uint32_t len, uint8_t maskLimit) {
+#if defined(RLIC_ARGMAX_DSP) || defined(RLIC_ARGMAX_VECTOR)
+	return rlicArgMaxFind(data, mask, len, maskLimit,
+			rlicArgMaxValue(data, mask, len, maskLimit));
+#else
+	return RLIC_ArgMaxU8_MaskedScalar(data, mask, len, maskLimit);
+#endif
+}
+
+#if RLIC_ARGMAX_BENCHMARK && defined(__arm__)
+/* cycles per scan of a 'len' byte table, scalar vs configured */
+void RLIC_ArgMax_Benchmark(uint32_t len) {
+	static uint8_t data[2048], mask[2048];
+	uint32_t seed = 1, t0, cyc[4], idx[4];
+
+	if (len > sizeof(data))
+		len = sizeof(data);
+	for (uint32_t i = 0; i < len; i++) {
+		seed = seed * 1103515245U + 12345U;
+		data[i] = (seed >> 16) % 11; /* Q values are 0..10, lots of ties */
+		mask[i] = (seed >> 24) & 3;
+	}
+
+	RLIC_CyclesInit();
+
+	t0 = RLIC_CyclesGet();
+	idx[0] = RLIC_ArgMaxU8_Scalar(data, len);
+	cyc[0] = RLIC_CyclesGet() - t0;
+	t0 = RLIC_CyclesGet();
+	idx[1] = RLIC_ArgMaxU8(data, len);
+	cyc[1] = RLIC_CyclesGet() - t0;
+	t0 = RLIC_CyclesGet();
+	idx[2] = RLIC_ArgMaxU8_MaskedScalar(data, mask, len, 3);
+	cyc[2] = RLIC_CyclesGet() - t0;
+	t0 = RLIC_CyclesGet();
+	idx[3] = RLIC_ArgMaxU8_Masked(data, mask, len, 3);
+	cyc[3] = RLIC_CyclesGet() - t0;
+
+	PRINTF("argmax %d bytes: scalar %d, simd %d cycles; "
+			"masked scalar %d, simd %d cycles%s\r\n", len, cyc[0], cyc[1],
+			cyc[2], cyc[3],
+			((idx[0] == idx[1]) && (idx[2] == idx[3])) ? "" : " MISMATCH");
+}
+#else
+void RLIC_ArgMax_Benchmark(uint32_t len) {
+	(void) len;
+}
+#endif /* RLIC_ARGMAX_BENCHMARK */
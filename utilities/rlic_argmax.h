@@ -0,0 +1,67 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_ARGMAX_H_
+#define RLIC_ARGMAX_H_
+
+#include <stdint.h>
+
+/*
+ * Arg max over a flat uint8_t table, first index wins on ties, same as a
+ * plain loop with a strict '>'.
+ *
+ * RLIC_ArgMaxU8() picks the fastest variant for the build:
+ *   Cortex-M7 - DSP packed byte ops (__USUB8/__SEL), 4 lanes per word
+ *   host      - GCC vector extensions, 16 lanes (SSE2/NEON/whatever)
+ *   otherwise - the scalar reference
+ * The _Scalar functions are the reference, always built.
+ *
+ * The masked versions skip entries whose mask byte is >= maskLimit (the
+ * pruned Q table) and return len when every entry is masked.
+ */
+#ifndef RLIC_ARGMAX_SIMD
+#define RLIC_ARGMAX_SIMD		(1)
+#endif
+
+#ifndef RLIC_ARGMAX_BENCHMARK
+#define RLIC_ARGMAX_BENCHMARK	(0)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t RLIC_ArgMaxU8(const uint8_t *data, uint32_t len);
+uint32_t RLIC_ArgMaxU8_Masked(const uint8_t *data, const uint8_t *mask,
+		uint32_t len, uint8_t maskLimit);
+uint32_t RLIC_ArgMaxU8_Scalar(const uint8_t *data, uint32_t len);
+uint32_t RLIC_ArgMaxU8_MaskedScalar(const uint8_t *data, const uint8_t *mask,
+		uint32_t len, uint8_t maskLimit);
+void RLIC_ArgMax_Benchmark(uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_ARGMAX_H_ */
@@ -0,0 +1,189 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <stddef.h>
+#include "fsl_common.h"
+#include "fsl_debug_console.h"
+#include "rlic_boot.h"
+#include "rlic_cycles.h"
+#include "rlic_crc32.h"
+
+/* change with the record layout, an old record then reads as invalid */
+#define RLIC_BOOT_ACTION_MAGIC	(0x524C4131U)
+
+typedef struct {
+	uint32_t magic;
+	uint32_t zones; /* bit per zone that has an action */
+	uint8_t numOnLeds[RLIC_BOOT_ZONES_MAX];
+	uint8_t duty[RLIC_BOOT_ZONES_MAX];
+	uint32_t crc; /* over all of the above */
+} rlic_boot_action_t;
+
+#define RLIC_BOOT_ACTION_CRC_SZ	(offsetof(rlic_boot_action_t, crc))
+
+#if RLIC_BOOT_RESTORE
+RLIC_AT_DTC_NOINIT static rlic_boot_action_t s_lastAction;
+#endif
+
+#if RLIC_BOOT_PROFILE
+static rlic_boot_phase_t s_bootPhase[RLIC_BOOT_PHASES_MAX];
+static uint32_t s_bootPhases;
+static uint32_t s_bootDropped;
+static uint32_t s_bootLast; /* counter at the last mark */
+static uint32_t s_bootHz; /* clock of the running phase, 0 before main */
+static uint32_t s_bootUS; /* closed phases */
+static const char *s_actionSource;
+static uint32_t s_actionUS;
+static bool s_bootDone;
+
+/*
+ * From SystemInit(), before the startup code initialises RAM: registers
+ * only, and it runs from flash as the ITCM code is not copied yet.
+ */
+void SystemInitHook(void) {
+	RLIC_CyclesInit();
+	/* a warm reset does not reset the debug block, it may be running */
+	DWT->CYCCNT = 0;
+}
+
+static uint32_t RLIC_Boot_ToUS(uint32_t cycles, uint32_t hz) {
+	return (uint32_t) (((uint64_t) cycles * 1000000U) / hz);
+}
+
+/* close the running phase under this name, the next one starts now */
+void RLIC_Boot_Mark(const char *name) {
+	uint32_t now = RLIC_CyclesGet();
+	uint32_t cycles = now - s_bootLast;
+
+	if (s_bootDone)
+		return;
+
+	if (s_bootHz == 0) {
+		/* the clock the ROM left, SystemCoreClock is only a default yet */
+		SystemCoreClockUpdate();
+		s_bootHz = SystemCoreClock;
+	}
+
+	if (s_bootPhases < RLIC_BOOT_PHASES_MAX) {
+		s_bootPhase[s_bootPhases].name = name;
+		s_bootPhase[s_bootPhases].cycles = cycles;
+		s_bootPhase[s_bootPhases].hz = s_bootHz;
+		s_bootPhases++;
+	} else {
+		s_bootDropped++;
+	}
+	s_bootUS += RLIC_Boot_ToUS(cycles, s_bootHz);
+	s_bootLast = now;
+	s_bootHz = SystemCoreClock;
+}
+
+/* the LEDs got their first action, the first call counts */
+void RLIC_Boot_Action(const char *source) {
+	if (s_bootDone || (s_actionSource != NULL) || (s_bootHz == 0))
+		return;
+
+	s_actionUS = s_bootUS
+			+ RLIC_Boot_ToUS(RLIC_CyclesGet() - s_bootLast, s_bootHz);
+	s_actionSource = source;
+}
+
+/* print the phases once, later marks are ignored */
+void RLIC_Boot_Print(void) {
+	uint32_t atUS = 0;
+
+	if (s_bootDone)
+		return;
+	s_bootDone = true;
+
+	PRINTF("[boot] %-12s %8s %8s  (from the reset handler)\r\n", "phase", "us",
+			"at us");
+	for (uint32_t i = 0; i < s_bootPhases; i++) {
+		uint32_t us = RLIC_Boot_ToUS(s_bootPhase[i].cycles, s_bootPhase[i].hz);
+
+		atUS += us;
+		PRINTF("[boot] %-12s %8d %8d\r\n", s_bootPhase[i].name, us, atUS);
+	}
+	if (s_bootDropped)
+		PRINTF("[boot] %d more phases, %d us in all\r\n", s_bootDropped,
+				s_bootUS);
+	if (s_actionSource != NULL)
+		PRINTF("[boot] first control action at %d us, %s\r\n", s_actionUS,
+				s_actionSource);
+}
+#else
+void RLIC_Boot_Mark(const char *name) {
+	(void) name;
+}
+
+void RLIC_Boot_Action(const char *source) {
+	(void) source;
+}
+
+void RLIC_Boot_Print(void) {
+}
+#endif
+
+/* every step, a few stores and a CRC over 16 bytes */
+void RLIC_Boot_SaveAction(uint32_t zone, uint8_t numOnLeds, uint8_t duty) {
+#if RLIC_BOOT_RESTORE
+	if (zone >= RLIC_BOOT_ZONES_MAX)
+		return;
+
+	if ((s_lastAction.magic != RLIC_BOOT_ACTION_MAGIC)
+			|| (s_lastAction.crc
+					!= RLIC_Crc32(&s_lastAction, RLIC_BOOT_ACTION_CRC_SZ))) {
+		s_lastAction.magic = RLIC_BOOT_ACTION_MAGIC;
+		s_lastAction.zones = 0;
+	}
+	s_lastAction.numOnLeds[zone] = numOnLeds;
+	s_lastAction.duty[zone] = duty;
+	s_lastAction.zones |= 1U << zone;
+	s_lastAction.crc = RLIC_Crc32(&s_lastAction, RLIC_BOOT_ACTION_CRC_SZ);
+#else
+	(void) zone;
+	(void) numOnLeds;
+	(void) duty;
+#endif
+}
+
+/* the action saved before a warm reset, false after power up */
+bool RLIC_Boot_LastAction(uint32_t zone, uint8_t *numOnLeds, uint8_t *duty) {
+#if RLIC_BOOT_RESTORE
+	if ((zone >= RLIC_BOOT_ZONES_MAX)
+			|| (s_lastAction.magic != RLIC_BOOT_ACTION_MAGIC)
+			|| (s_lastAction.crc
+					!= RLIC_Crc32(&s_lastAction, RLIC_BOOT_ACTION_CRC_SZ))
+			|| !(s_lastAction.zones & (1U << zone)))
+		return false;
+
+	*numOnLeds = s_lastAction.numOnLeds[zone];
+	*duty = s_lastAction.duty[zone];
+	return true;
+#else
+	(void) zone;
+	(void) numOnLeds;
+	(void) duty;
+	return false;
+#endif
+}
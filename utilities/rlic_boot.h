@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_BOOT_H_
+#define RLIC_BOOT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rlic_section.h"
+
+/*
+ * Boot phase profiler and last action record.
+ *
+ * The DWT cycle counter is started from SystemInitHook(), before the
+ * startup code copies and zeroes RAM, so the first phase covers the reset
+ * handler up to main. Time spent in the boot ROM before the reset handler
+ * is not seen. main() closes each phase with RLIC_Boot_Mark(); a phase is
+ * converted at the core clock it started at, so the clock setup does not
+ * skew the phases around it. The table is printed once, at the first
+ * learner step, when logging is long up; phases must stay below 2^32
+ * cycles (8 s at 500 MHz).
+ *
+ * The last action of every zone is kept in DTCM that the startup code
+ * does not touch. After a watchdog or software reset main() puts it back
+ * on the LEDs before logging, sensor setup or the card, so the light does
+ * not go out while the board comes up again. After power up the record
+ * fails its CRC and the first learner step sets the LEDs as before.
+ */
+#ifndef RLIC_BOOT_PROFILE
+#define RLIC_BOOT_PROFILE		(1)
+#endif
+
+/* restore the last action after a warm reset */
+#ifndef RLIC_BOOT_RESTORE
+#define RLIC_BOOT_RESTORE		(1)
+#endif
+
+#define RLIC_BOOT_PHASES_MAX	(16)
+#define RLIC_BOOT_ZONES_MAX		(4)
+
+/* where the first control action came from, RLIC_Boot_Action() */
+#define RLIC_BOOT_RESTORED		"restored"
+#define RLIC_BOOT_LEARNER		"learner"
+
+typedef struct {
+	const char *name;
+	uint32_t cycles;
+	uint32_t hz; /* core clock the phase started at */
+} rlic_boot_phase_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void RLIC_Boot_Mark(const char *name);
+void RLIC_Boot_Action(const char *source);
+void RLIC_Boot_Print(void);
+
+void RLIC_Boot_SaveAction(uint32_t zone, uint8_t numOnLeds, uint8_t duty);
+bool RLIC_Boot_LastAction(uint32_t zone, uint8_t *numOnLeds, uint8_t *duty);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_BOOT_H_ */
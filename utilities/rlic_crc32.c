@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <stdbool.h>
+#include "rlic_crc32.h"
+#include "rlic_section.h"
+#if defined(__arm__)
+#include "fsl_common.h"
+#include "fsl_debug_console.h"
+#include "rlic_cycles.h"
+#else
+/* host build for tools/, the SDK console is not there */
+#include <stdio.h>
+#define PRINTF printf
+#endif
+
+#define RLIC_CRC32_POLY		(0xEDB88320U)
+
+#if RLIC_CRC32_SLICE8
+#define RLIC_CRC32_TABLES	(8)
+#else
+#define RLIC_CRC32_TABLES	(1)
+#endif
+
+/* built on first use, DTCM for single cycle lookups */
+RLIC_HOT_DATA static uint32_t s_crcTable[RLIC_CRC32_TABLES][256];
+static bool s_crcReady = false;
+
+static void RLIC_Crc32_Init(void) {
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t c = i;
+
+		for (uint32_t k = 0; k < 8; k++)
+			c = (c & 1) ? (c >> 1) ^ RLIC_CRC32_POLY : (c >> 1);
+		s_crcTable[0][i] = c;
+	}
+
+	for (uint32_t t = 1; t < RLIC_CRC32_TABLES; t++) {
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t c = s_crcTable[t - 1][i];
+
+			s_crcTable[t][i] = (c >> 8) ^ s_crcTable[0][c & 0xFF];
+		}
+	}
+	s_crcReady = true;
+}
+
+static uint32_t RLIC_Crc32_Bytewise(uint32_t crc, const uint8_t *p,
+		size_t len) {
+	while (len--)
+		crc = (crc >> 8) ^ s_crcTable[0][(crc ^ *p++) & 0xFF];
+	return crc;
+}
+
+#if RLIC_CRC32_SLICE8
+static uint32_t RLIC_Crc32_Slice8(uint32_t crc, const uint8_t *p,
+		size_t len) {
+	/* align to a word so the 8 byte loads are single LDRs */
+	while (len && ((uintptr_t) p & 3)) {
+		crc = (crc >> 8) ^ s_crcTable[0][(crc ^ *p++) & 0xFF];
+		len--;
+	}
+
+	while (len >= 8) {
+		uint32_t lo = *(const uint32_t*) p ^ crc; /* little endian */
+		uint32_t hi = *(const uint32_t*) (p + 4);
+
+		crc = s_crcTable[7][lo & 0xFF] ^ s_crcTable[6][(lo >> 8) & 0xFF]
+				^ s_crcTable[5][(lo >> 16) & 0xFF] ^ s_crcTable[4][lo >> 24]
+				^ s_crcTable[3][hi & 0xFF] ^ s_crcTable[2][(hi >> 8) & 0xFF]
+				^ s_crcTable[1][(hi >> 16) & 0xFF] ^ s_crcTable[0][hi >> 24];
+		p += 8;
+		len -= 8;
+	}
+
+	return RLIC_Crc32_Bytewise(crc, p, len);
+}
+#endif
+
+RLIC_HOT_CODE uint32_t RLIC_Crc32_Update(uint32_t crc, const void *data,
+		size_t len) {
+	if (!s_crcReady)
+		RLIC_Crc32_Init();
+
+	crc = ~crc;
+#if RLIC_CRC32_SLICE8
+	crc = RLIC_Crc32_Slice8(crc, (const uint8_t*) data, len);
+#else
+	crc = RLIC_Crc32_Bytewise(crc, (const uint8_t*) data, len);
+#endif
+	return ~crc;
+}
+
+uint32_t RLIC_Crc32(const void *data, size_t len) {
+	return RLIC_Crc32_Update(0, data, len);
+}
+
+#if RLIC_CRC32_BENCHMARK
+/* cycles to checksum one entry of 'len' bytes, byte-wise vs configured */
+void RLIC_Crc32_Benchmark(size_t len) {
+	static uint8_t buf[4096];
+	uint32_t t0, bytewise, configured, crc;
+
+	if (len > sizeof(buf))
+		len = sizeof(buf);
+	for (size_t i = 0; i < len; i++)
+		buf[i] = (uint8_t) (i * 7);
+
+	RLIC_CyclesInit();
+	crc = RLIC_Crc32(buf, len); /* builds the tables */
+
+	t0 = RLIC_CyclesGet();
+	(void) RLIC_Crc32_Bytewise(~0U, buf, len);
+	bytewise = RLIC_CyclesGet() - t0;
+
+	t0 = RLIC_CyclesGet();
+	crc = RLIC_Crc32(buf, len);
+	configured = RLIC_CyclesGet() - t0;
+
+	PRINTF("CRC32 %d bytes: byte-wise %d cycles, %s %d cycles (0x%08x)\r\n",
+			(int) len, bytewise, RLIC_CRC32_SLICE8 ? "slice-by-8" : "byte-wise",
+			configured, crc);
+}
+#else
+void RLIC_Crc32_Benchmark(size_t len) {
+	(void) len;
+}
+#endif /* RLIC_CRC32_BENCHMARK */
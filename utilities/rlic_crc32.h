@@ -0,0 +1,56 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_CRC32_H_
+#define RLIC_CRC32_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * CRC-32 (IEEE 802.3, reflected 0xEDB88320, init/xorout 0xFFFFFFFF), same
+ * value as zlib crc32(). Slice-by-8 handles 8 bytes per step with eight
+ * 1 KB tables; the byte-wise variant needs a single table.
+ */
+#ifndef RLIC_CRC32_SLICE8
+#define RLIC_CRC32_SLICE8	(1)
+#endif
+
+#ifndef RLIC_CRC32_BENCHMARK
+#define RLIC_CRC32_BENCHMARK	(0)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t RLIC_Crc32(const void *data, size_t len);
+uint32_t RLIC_Crc32_Update(uint32_t crc, const void *data, size_t len);
+void RLIC_Crc32_Benchmark(size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_CRC32_H_ */
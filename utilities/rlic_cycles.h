@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_CYCLES_H_
+#define RLIC_CYCLES_H_
+
+#include <stdint.h>
+#include "fsl_common.h"
+
+/*
+ * DWT cycle counter, used for the benchmark reports. Users take
+ * differences, so a counter already running (the boot profiler starts it
+ * before main) is left alone rather than zeroed under it.
+ */
+static inline void RLIC_CyclesInit(void) {
+	if (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)
+		return;
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55; /* unlock on M7 */
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t RLIC_CyclesGet(void) {
+	return DWT->CYCCNT;
+}
+
+/* cycles to microseconds at the current core clock */
+static inline uint32_t RLIC_CyclesToUS(uint32_t cycles) {
+	return (uint32_t) (((uint64_t) cycles * 1000000U) / SystemCoreClock);
+}
+
+/* running min/avg/max of a measured section */
+typedef struct {
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t count;
+} rlic_cycle_stat_t;
+
+static inline void RLIC_CycleStatReset(rlic_cycle_stat_t *st) {
+	st->min = UINT32_MAX;
+	st->max = 0;
+	st->sum = 0;
+	st->count = 0;
+}
+
+static inline void RLIC_CycleStatAdd(rlic_cycle_stat_t *st, uint32_t cycles) {
+	if (cycles < st->min)
+		st->min = cycles;
+	if (cycles > st->max)
+		st->max = cycles;
+	st->sum += cycles;
+	st->count++;
+}
+
+static inline uint32_t RLIC_CycleStatAvg(const rlic_cycle_stat_t *st) {
+	return st->count ? (uint32_t) (st->sum / st->count) : 0;
+}
+
+#endif /* RLIC_CYCLES_H_ */
@@ -0,0 +1,211 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <string.h>
+#include "fsl_common.h"
+#include "rlic_dmabuf.h"
+
+#if defined(__arm__)
+#include "fsl_debug_console.h"
+#else
+/* host build for tools/, the SDK console is not there */
+#include <stdio.h>
+#define PRINTF printf
+#endif
+
+#if (RLIC_DMABUF_REGION == RLIC_REGION_DTC)
+#define RLIC_DMABUF_AT			RLIC_AT_DTC_BSS
+#elif (RLIC_DMABUF_REGION == RLIC_REGION_NCACHE)
+#define RLIC_DMABUF_AT			RLIC_AT_NCACHE_BSS
+#elif (RLIC_DMABUF_REGION == RLIC_REGION_OC)
+#define RLIC_DMABUF_AT			RLIC_AT_OC_BSS
+#else
+#error "RLIC_DMABUF_REGION: DTC, NCACHE, or OC to measure the cached case"
+#endif
+
+#define RLIC_DMABUF_ROUND(x)	(((x) + RLIC_DMABUF_ALIGN - 1) \
+		& ~(RLIC_DMABUF_ALIGN - 1))
+
+typedef struct {
+	uintptr_t base;
+	uintptr_t end;
+} rlic_dmabuf_region_t;
+
+RLIC_DMABUF_AT static uint8_t s_dmaPool[RLIC_DMABUF_POOL_SZ]
+		__attribute__((aligned(RLIC_DMABUF_ALIGN)));
+
+static rlic_dmabuf_region_t s_dmaRegion[RLIC_DMABUF_REGIONS_MAX];
+static uint32_t s_dmaRegions;
+static rlic_dmabuf_stats_t s_dmaStats;
+
+/* cycles of the range maintenance per line, x16, from the benchmark */
+static uint32_t s_dmaLineCycles16[2];
+
+/*
+ * a buffer for the life of the program, NULL when the pool is spent.
+ * Init time only, from the main loop, never from an ISR.
+ */
+void *RLIC_DmaBuf_Alloc(size_t size) {
+	void *p = NULL;
+
+	size = RLIC_DMABUF_ROUND(size);
+	if (size <= (RLIC_DMABUF_POOL_SZ - s_dmaStats.used)) {
+		p = &s_dmaPool[s_dmaStats.used];
+		s_dmaStats.used += size;
+	} else {
+		s_dmaStats.fails++;
+	}
+
+	if (p == NULL)
+		PRINTF("DMA pool: %d bytes not available, %d of %d used\r\n",
+				(uint32_t) size, s_dmaStats.used, RLIC_DMABUF_POOL_SZ);
+	return p;
+}
+
+/* memory the D-cache does not hold, see BOARD_ConfigMPU() */
+void RLIC_DmaBuf_AddRegion(uint32_t base, uint32_t size) {
+	if ((size == 0) || (s_dmaRegions >= RLIC_DMABUF_REGIONS_MAX))
+		return;
+	s_dmaRegion[s_dmaRegions].base = base;
+	s_dmaRegion[s_dmaRegions].end = (uintptr_t) base + size;
+	s_dmaRegions++;
+}
+
+/* no cache maintenance needed around a DMA to or from p */
+RLIC_HOT_CODE bool RLIC_DmaBuf_Coherent(const void *p, size_t size) {
+	uintptr_t a = (uintptr_t) p;
+
+	for (uint32_t r = 0; r < s_dmaRegions; r++) {
+		if ((a >= s_dmaRegion[r].base) && (a < s_dmaRegion[r].end)
+				&& (size <= (s_dmaRegion[r].end - a)))
+			return true;
+	}
+	return false;
+}
+
+/* asked by the SD host before a data transfer, counts the outcome */
+RLIC_HOT_CODE bool RLIC_DmaBuf_Transfer(const void *p, size_t size,
+		bool receive) {
+	uint32_t dir = receive ? RLIC_DMABUF_RX : RLIC_DMABUF_TX;
+
+	if (RLIC_DmaBuf_Coherent(p, size)) {
+		s_dmaStats.coherent[dir]++;
+		s_dmaStats.coherentBytes[dir] += size;
+		return true;
+	}
+	s_dmaStats.maintained[dir]++;
+	s_dmaStats.maintainedBytes[dir] += size;
+	return false;
+}
+
+void RLIC_DmaBuf_GetStats(rlic_dmabuf_stats_t *stats) {
+	*stats = s_dmaStats;
+}
+
+void RLIC_DmaBuf_PrintStats(void) {
+	const rlic_dmabuf_stats_t *st = &s_dmaStats;
+
+	PRINTF("DMA pool @0x%x: %d of %d bytes used, %d allocations failed\r\n",
+			(uint32_t) (uintptr_t) s_dmaPool, st->used, RLIC_DMABUF_POOL_SZ,
+			st->fails);
+	PRINTF("  SD transfers without maintenance: %d tx %d rx (%d KB)\r\n",
+			st->coherent[RLIC_DMABUF_TX], st->coherent[RLIC_DMABUF_RX],
+			(uint32_t) ((st->coherentBytes[RLIC_DMABUF_TX]
+					+ st->coherentBytes[RLIC_DMABUF_RX]) / 1024));
+	PRINTF("  SD transfers maintained by range: %d tx %d rx (%d KB)\r\n",
+			st->maintained[RLIC_DMABUF_TX], st->maintained[RLIC_DMABUF_RX],
+			(uint32_t) ((st->maintainedBytes[RLIC_DMABUF_TX]
+					+ st->maintainedBytes[RLIC_DMABUF_RX]) / 1024));
+	if (s_dmaLineCycles16[RLIC_DMABUF_RX]) {
+		uint64_t saved = 0;
+
+		for (uint32_t d = 0; d < 2; d++)
+			saved += (st->coherentBytes[d] / RLIC_DMABUF_ALIGN)
+					* s_dmaLineCycles16[d] / 16;
+		PRINTF("  maintenance saved ~%d k cycles\r\n",
+				(uint32_t) (saved / 1000));
+	}
+}
+
+#if RLIC_DMABUF_BENCHMARK && defined(__arm__)
+#include "fsl_cache.h"
+#include "rlic_cycles.h"
+
+#define RLIC_DMABUF_BENCH_SZ	(4 * 1024)
+#define RLIC_DMABUF_BENCH_REPS	(16)
+
+/* cached write back OCRAM, what a buffer outside the pool gets */
+RLIC_AT_OC_BSS static uint8_t s_benchBuf[RLIC_DMABUF_BENCH_SZ]
+		__attribute__((aligned(RLIC_DMABUF_ALIGN)));
+
+/*
+ * The maintenance fsl_sdmmc_host.c does per transfer, on a buffer the CPU
+ * just wrote (dirty lines): a clean before a write; a clean before and an
+ * invalidate after a read. Against it, the check that replaces it.
+ */
+void RLIC_DmaBuf_Benchmark(void) {
+	static const uint32_t sizes[] = { 512, RLIC_DMABUF_BENCH_SZ };
+	uint32_t tx, rx, check, t;
+
+	RLIC_CyclesInit();
+	for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		uint32_t size = sizes[i];
+
+		tx = rx = check = 0;
+		for (uint32_t r = 0; r < RLIC_DMABUF_BENCH_REPS; r++) {
+			memset(s_benchBuf, (int) r, size);
+			t = RLIC_CyclesGet();
+			DCACHE_CleanByRange((uint32_t) s_benchBuf, size);
+			tx += RLIC_CyclesGet() - t;
+
+			memset(s_benchBuf, (int) r, size);
+			t = RLIC_CyclesGet();
+			DCACHE_CleanByRange((uint32_t) s_benchBuf, size);
+			DCACHE_InvalidateByRange((uint32_t) s_benchBuf, size);
+			rx += RLIC_CyclesGet() - t;
+
+			t = RLIC_CyclesGet();
+			(void) RLIC_DmaBuf_Coherent(s_dmaPool, size);
+			check += RLIC_CyclesGet() - t;
+		}
+		tx /= RLIC_DMABUF_BENCH_REPS;
+		rx /= RLIC_DMABUF_BENCH_REPS;
+		check /= RLIC_DMABUF_BENCH_REPS;
+		PRINTF("DMA %d B: maintenance tx %d rx %d cycles, pool check %d, "
+				"saved per transfer tx %d rx %d cycles (%d us rx)\r\n", size,
+				tx, rx, check, tx - check, rx - check,
+				RLIC_CyclesToUS(rx - check));
+	}
+	/* per line from the largest size, for the running estimate */
+	s_dmaLineCycles16[RLIC_DMABUF_TX] = (tx * 16)
+			/ (RLIC_DMABUF_BENCH_SZ / RLIC_DMABUF_ALIGN);
+	s_dmaLineCycles16[RLIC_DMABUF_RX] = (rx * 16)
+			/ (RLIC_DMABUF_BENCH_SZ / RLIC_DMABUF_ALIGN);
+	PRINTF("DMA pool coherent: %s\r\n",
+			RLIC_DmaBuf_Coherent(s_dmaPool, sizeof(s_dmaPool)) ? "yes" : "no");
+}
+#else
+void RLIC_DmaBuf_Benchmark(void) {
+}
+#endif /* RLIC_DMABUF_BENCHMARK */
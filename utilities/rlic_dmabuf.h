@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_DMABUF_H_
+#define RLIC_DMABUF_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "rlic_section.h"
+
+/*
+ * DMA buffers that need no cache maintenance.
+ * Buffers are handed out once at init, cache line aligned and padded, from
+ * a pool in memory the D-cache never holds: DTCM (not cached, reachable by
+ * the uSDHC DMA) or the MPU non-cacheable region. The SD host driver asks
+ * RLIC_DmaBuf_Transfer() before every data transfer and skips the clean /
+ * invalidate by range for buffers inside a coherent region; buffers
+ * elsewhere keep the range maintenance.
+ *
+ * Coherent regions are registered by BOARD_ConfigMPU() as it programs
+ * them, so the check always matches the MPU setup.
+ */
+
+/*! @brief pool region, RLIC_REGION_DTC or _NCACHE; _OC for the cached A/B */
+#ifndef RLIC_DMABUF_REGION
+#define RLIC_DMABUF_REGION		RLIC_REGION_DTC
+#endif
+
+/*! @brief pool bytes: the card entry buffer and the trace ring */
+#ifndef RLIC_DMABUF_POOL_SZ
+#define RLIC_DMABUF_POOL_SZ		(10 * 1024)
+#endif
+
+/*! @brief D-cache line, the alignment and padding of every buffer */
+#define RLIC_DMABUF_ALIGN		(32U)
+
+#define RLIC_DMABUF_REGIONS_MAX	(4)
+
+/*! @brief measure the range maintenance the pool saves, at storage open */
+#ifndef RLIC_DMABUF_BENCHMARK
+#define RLIC_DMABUF_BENCHMARK	(0)
+#endif
+
+/* transfer directions, the stats index */
+#define RLIC_DMABUF_TX			(0)
+#define RLIC_DMABUF_RX			(1)
+
+typedef struct {
+	uint32_t used; /* pool bytes handed out */
+	uint32_t fails;
+	uint32_t coherent[2]; /* transfers without maintenance */
+	uint32_t maintained[2]; /* transfers with range maintenance */
+	uint64_t coherentBytes[2];
+	uint64_t maintainedBytes[2];
+} rlic_dmabuf_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *RLIC_DmaBuf_Alloc(size_t size);
+void RLIC_DmaBuf_AddRegion(uint32_t base, uint32_t size);
+bool RLIC_DmaBuf_Coherent(const void *p, size_t size);
+bool RLIC_DmaBuf_Transfer(const void *p, size_t size, bool receive);
+void RLIC_DmaBuf_GetStats(rlic_dmabuf_stats_t *stats);
+void RLIC_DmaBuf_PrintStats(void);
+void RLIC_DmaBuf_Benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_DMABUF_H_ */
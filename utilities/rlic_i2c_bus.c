@@ -0,0 +1,183 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <string.h>
+#include "rlic_i2c_bus.h"
+
+#if defined(__arm__)
+#include "fsl_debug_console.h"
+#else
+/* host build for tools/, the SDK console is not there */
+#include <stdio.h>
+#define PRINTF printf
+#endif
+
+static const char *const s_resultNames[RLIC_I2C_RESULTS] = { "ok", "nak",
+		"arb", "pinlow", "busy", "other" };
+
+void RLIC_I2C_BusInit(rlic_i2c_bus_t *bus, const char *name,
+		const rlic_i2c_pin_ops_t *ops, void *ctx) {
+	memset(bus, 0, sizeof(*bus));
+	bus->name = name;
+	bus->ops = ops;
+	bus->ctx = ctx;
+	bus->other.name = "other";
+	bus->other.maxBaudHz = RLIC_I2C_BAUD_MAX;
+	bus->baudHz = RLIC_I2C_BAUD_STANDARD;
+}
+
+status_t RLIC_I2C_BusAddDevice(rlic_i2c_bus_t *bus, rlic_i2c_device_t *dev) {
+	if (bus->numDevices >= RLIC_I2C_DEVICES_MAX)
+		return kStatus_Fail;
+
+	dev->transfers = 0;
+	memset(dev->errors, 0, sizeof(dev->errors));
+	bus->devices[bus->numDevices++] = dev;
+	return kStatus_Success;
+}
+
+/* fastest rate all devices on the bus, and the wiring, can take */
+uint32_t RLIC_I2C_BusSelectBaud(rlic_i2c_bus_t *bus) {
+	uint32_t baud = RLIC_I2C_BAUD_MAX;
+
+	for (uint32_t i = 0; i < bus->numDevices; i++) {
+		if (bus->devices[i]->maxBaudHz < baud)
+			baud = bus->devices[i]->maxBaudHz;
+	}
+	bus->baudHz = baud;
+	return baud;
+}
+
+rlic_i2c_device_t* RLIC_I2C_BusFindDevice(rlic_i2c_bus_t *bus,
+		uint8_t address) {
+	for (uint32_t i = 0; i < bus->numDevices; i++) {
+		if (bus->devices[i]->address == address)
+			return bus->devices[i];
+	}
+	return &bus->other;
+}
+
+/*
+ * Account one transfer. Pin low, busy and arbitration errors point at the
+ * bus itself and clear it straight away, NAKs only after a run of them.
+ * Returns true when the bus was cleared, the caller may retry once.
+ */
+bool RLIC_I2C_BusComplete(rlic_i2c_bus_t *bus, rlic_i2c_device_t *dev,
+		enum rlic_i2c_result_t result) {
+	dev->transfers++;
+	if (result == RLIC_I2C_OK) {
+		bus->errorRun = 0;
+		return false;
+	}
+
+	dev->errors[(result < RLIC_I2C_RESULTS) ? result : RLIC_I2C_OTHER]++;
+	bus->errorRun++;
+
+	if ((result == RLIC_I2C_PIN_LOW) || (result == RLIC_I2C_BUSY)
+			|| (result == RLIC_I2C_ARB_LOST)
+			|| (bus->errorRun >= RLIC_I2C_RECOVER_ERRORS)) {
+		bus->errorRun = 0;
+		return RLIC_I2C_BusRecover(bus) == kStatus_Success;
+	}
+	return false;
+}
+
+/* bus clear, then the controller is reinitialised by leaveGpio() */
+status_t RLIC_I2C_BusRecover(rlic_i2c_bus_t *bus) {
+	const rlic_i2c_pin_ops_t *ops = bus->ops;
+	void *ctx = bus->ctx;
+	status_t status = kStatus_Fail;
+	uint32_t waitUs = 0;
+
+	if (!ops)
+		return kStatus_Fail;
+
+	ops->enterGpio(ctx);
+
+	/* a slave stretching the clock for ever cannot be fixed from here */
+	while (!ops->getScl(ctx) && (waitUs < RLIC_I2C_STRETCH_MAX_US)) {
+		ops->delayUs(ctx, RLIC_I2C_RECOVER_HALF_US);
+		waitUs += RLIC_I2C_RECOVER_HALF_US;
+	}
+
+	if (ops->getScl(ctx)) {
+		/* clock out whatever byte a slave is still sending */
+		for (uint32_t i = 0; (i < RLIC_I2C_RECOVER_CLOCKS) && !ops->getSda(ctx);
+				i++) {
+			ops->setScl(ctx, false);
+			ops->delayUs(ctx, RLIC_I2C_RECOVER_HALF_US);
+			ops->setScl(ctx, true);
+			ops->delayUs(ctx, RLIC_I2C_RECOVER_HALF_US);
+		}
+
+		if (ops->getSda(ctx)) {
+			/* STOP: SDA rises while SCL is high, resets every slave */
+			ops->setScl(ctx, false);
+			ops->delayUs(ctx, RLIC_I2C_RECOVER_HALF_US);
+			ops->setSda(ctx, false);
+			ops->delayUs(ctx, RLIC_I2C_RECOVER_HALF_US);
+			ops->setScl(ctx, true);
+			ops->delayUs(ctx, RLIC_I2C_RECOVER_HALF_US);
+			ops->setSda(ctx, true);
+			ops->delayUs(ctx, RLIC_I2C_RECOVER_HALF_US);
+			status = ops->getSda(ctx) && ops->getScl(ctx) ?
+					kStatus_Success : kStatus_Fail;
+		}
+	}
+
+	ops->leaveGpio(ctx, bus->baudHz);
+
+	if (status == kStatus_Success) {
+		bus->recoveries++;
+	} else {
+		bus->recoveryFails++;
+		PRINTF("I2C %s: bus stuck (SCL %d SDA %d)\r\n", bus->name,
+				ops->getScl(ctx), ops->getSda(ctx));
+	}
+	return status;
+}
+
+static void RLIC_I2C_PrintDevice(const rlic_i2c_device_t *dev) {
+	uint32_t errors = 0;
+
+	for (uint32_t r = RLIC_I2C_OK + 1; r < RLIC_I2C_RESULTS; r++)
+		errors += dev->errors[r];
+
+	PRINTF("  %-8s 0x%02x: %d transfers, %d errors", dev->name, dev->address,
+			dev->transfers, errors);
+	for (uint32_t r = RLIC_I2C_OK + 1; r < RLIC_I2C_RESULTS; r++) {
+		if (dev->errors[r])
+			PRINTF(" %s %d", s_resultNames[r], dev->errors[r]);
+	}
+	PRINTF("\r\n");
+}
+
+void RLIC_I2C_BusPrintStats(const rlic_i2c_bus_t *bus) {
+	PRINTF("I2C %s @ %d kHz: %d recoveries, %d failed\r\n", bus->name,
+			bus->baudHz / 1000, bus->recoveries, bus->recoveryFails);
+	for (uint32_t i = 0; i < bus->numDevices; i++)
+		RLIC_I2C_PrintDevice(bus->devices[i]);
+	if (bus->other.transfers)
+		RLIC_I2C_PrintDevice(&bus->other);
+}
@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_I2C_BUS_H_
+#define RLIC_I2C_BUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fsl_common.h"
+
+/*
+ * I2C bus bookkeeping shared by the LPI2C glue in board.c and the host
+ * simulator in tools/. A bus runs at the fastest rate every attached
+ * device supports, counts errors per device and, on a stuck bus or a
+ * run of failures, clears it by clocking SCL by hand (I2C spec "bus
+ * clear": up to nine clocks until SDA is released, then a STOP) before
+ * the controller is set up again.
+ */
+#define RLIC_I2C_BAUD_STANDARD		(100000U)
+#define RLIC_I2C_BAUD_FAST			(400000U)
+#define RLIC_I2C_BAUD_FAST_PLUS		(1000000U)
+
+/* wiring limit, pull ups and trace length, devices may allow more */
+#ifndef RLIC_I2C_BAUD_MAX
+#define RLIC_I2C_BAUD_MAX			RLIC_I2C_BAUD_FAST_PLUS
+#endif
+
+/* failed transfers in a row before the bus is cleared */
+#ifndef RLIC_I2C_RECOVER_ERRORS
+#define RLIC_I2C_RECOVER_ERRORS		(3)
+#endif
+
+#ifndef RLIC_I2C_BENCHMARK
+#define RLIC_I2C_BENCHMARK			(0)
+#endif
+
+#define RLIC_I2C_RECOVER_CLOCKS		(9)
+#define RLIC_I2C_RECOVER_HALF_US	(5) /* 100 kHz, fine for every device */
+#define RLIC_I2C_STRETCH_MAX_US		(1000) /* SCL held low longer is stuck */
+#define RLIC_I2C_DEVICES_MAX		(4)
+
+/* outcome of one transfer, mapped from the controller status by the glue */
+enum rlic_i2c_result_t {
+	RLIC_I2C_OK = 0,
+	RLIC_I2C_NAK, /* no acknowledge, absent or busy device */
+	RLIC_I2C_ARB_LOST, /* bus driven by someone else, glitch or stuck slave */
+	RLIC_I2C_PIN_LOW, /* SCL or SDA held low past the pin low timeout */
+	RLIC_I2C_BUSY, /* bus never went idle */
+	RLIC_I2C_OTHER,
+	RLIC_I2C_RESULTS,
+};
+
+typedef struct {
+	const char *name;
+	uint8_t address;
+	uint32_t maxBaudHz;
+	uint32_t transfers;
+	uint32_t errors[RLIC_I2C_RESULTS]; /* [RLIC_I2C_OK] unused */
+} rlic_i2c_device_t;
+
+/* pin level access for the bus clear, lines are open drain */
+typedef struct {
+	void (*enterGpio)(void *ctx); /* pins to GPIO, both released */
+	void (*leaveGpio)(void *ctx, uint32_t baudHz); /* back to I2C, reinit */
+	void (*setScl)(void *ctx, bool high);
+	void (*setSda)(void *ctx, bool high);
+	bool (*getScl)(void *ctx);
+	bool (*getSda)(void *ctx);
+	void (*delayUs)(void *ctx, uint32_t us);
+} rlic_i2c_pin_ops_t;
+
+typedef struct {
+	const char *name;
+	const rlic_i2c_pin_ops_t *ops;
+	void *ctx;
+	rlic_i2c_device_t *devices[RLIC_I2C_DEVICES_MAX];
+	uint32_t numDevices;
+	rlic_i2c_device_t other; /* addresses not registered */
+	uint32_t baudHz;
+	uint32_t errorRun; /* failed transfers in a row */
+	uint32_t recoveries;
+	uint32_t recoveryFails;
+} rlic_i2c_bus_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void RLIC_I2C_BusInit(rlic_i2c_bus_t *bus, const char *name,
+		const rlic_i2c_pin_ops_t *ops, void *ctx);
+status_t RLIC_I2C_BusAddDevice(rlic_i2c_bus_t *bus, rlic_i2c_device_t *dev);
+uint32_t RLIC_I2C_BusSelectBaud(rlic_i2c_bus_t *bus);
+rlic_i2c_device_t* RLIC_I2C_BusFindDevice(rlic_i2c_bus_t *bus,
+		uint8_t address);
+bool RLIC_I2C_BusComplete(rlic_i2c_bus_t *bus, rlic_i2c_device_t *dev,
+		enum rlic_i2c_result_t result);
+status_t RLIC_I2C_BusRecover(rlic_i2c_bus_t *bus);
+void RLIC_I2C_BusPrintStats(const rlic_i2c_bus_t *bus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_I2C_BUS_H_ */
@@ -0,0 +1,163 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <string.h>
+#include "rlic_idle.h"
+#include "rlic_section.h"
+
+#if defined(__arm__)
+#include "fsl_debug_console.h"
+#else
+/* host build for tools/, the SDK console is not there */
+#include <stdio.h>
+#define PRINTF printf
+#endif
+
+/* wrap safe: has the clock reached t */
+#define RLIC_IDLE_REACHED(now, t)	((int32_t) ((now) - (t)) >= 0)
+
+static const uint32_t s_idleMW[RLIC_IDLE_STATES] = { RLIC_IDLE_RUN_MW,
+		RLIC_IDLE_SLEEP_MW, RLIC_IDLE_SCALED_MW };
+
+/* book the time since the last change to the state left */
+static RLIC_HOT_CODE void RLIC_Idle_Enter(rlic_idle_t *idle, uint32_t state,
+		uint32_t reason) {
+	uint32_t now = idle->ops->clockUS();
+	uint32_t us = now - idle->stateUS;
+
+	idle->timeUS[idle->state] += us;
+	if (idle->state != RLIC_IDLE_RUN)
+		idle->reasonUS[idle->reason] += us;
+	idle->stateUS = now;
+	idle->state = state;
+	idle->reason = reason;
+}
+
+void RLIC_Idle_Init(rlic_idle_t *idle, const rlic_idle_ops_t *ops,
+		uint32_t scaleDiv) {
+	memset(idle, 0, sizeof(*idle));
+	idle->ops = ops;
+	idle->scaleDiv = scaleDiv ? scaleDiv : 1;
+	idle->stateUS = ops->clockUS();
+	idle->startMS = ops->clockMS();
+}
+
+/* sleep until the time base reaches now + ms, divided clock if long enough */
+RLIC_HOT_CODE void RLIC_Idle_WaitMS(rlic_idle_t *idle, uint32_t ms) {
+	const rlic_idle_ops_t *ops = idle->ops;
+	uint32_t deadline = ops->clockMS() + ms;
+	uint32_t late;
+
+	idle->waits++;
+	RLIC_Idle_Enter(idle, RLIC_IDLE_SLEEP, RLIC_IDLE_STEP);
+	if ((idle->scaleDiv > 1) && (ms >= RLIC_IDLE_SCALE_MIN_MS)) {
+		ops->scale(idle->scaleDiv);
+		RLIC_Idle_Enter(idle, RLIC_IDLE_SCALED, RLIC_IDLE_STEP);
+		while (!RLIC_IDLE_REACHED(ops->clockMS(),
+				deadline - RLIC_IDLE_RESTORE_MS))
+			ops->sleep();
+		RLIC_Idle_Enter(idle, RLIC_IDLE_SLEEP, RLIC_IDLE_STEP);
+		ops->scale(1);
+		idle->scaled++;
+	}
+	while (!RLIC_IDLE_REACHED(ops->clockMS(), deadline))
+		ops->sleep();
+	RLIC_Idle_Enter(idle, RLIC_IDLE_RUN, RLIC_IDLE_STEP);
+
+	late = ops->clockMS() - deadline;
+	if (late > idle->lateMax)
+		idle->lateMax = late;
+}
+
+/* one sleep in a completion wait, the caller checks again after it */
+RLIC_HOT_CODE void RLIC_Idle_Sleep(rlic_idle_t *idle, uint32_t reason) {
+	RLIC_Idle_Enter(idle, RLIC_IDLE_SLEEP, reason);
+	idle->ops->sleep();
+	RLIC_Idle_Enter(idle, RLIC_IDLE_RUN, reason);
+}
+
+void RLIC_Idle_Decision(rlic_idle_t *idle) {
+	idle->decisions++;
+}
+
+/* estimated energy per decision since the last reset */
+uint32_t RLIC_Idle_EnergyUJ(const rlic_idle_t *idle) {
+	uint64_t nj = 0; /* mW x us */
+
+	if (!idle->decisions)
+		return 0;
+	for (uint32_t s = 0; s < RLIC_IDLE_STATES; s++)
+		nj += idle->timeUS[s] * s_idleMW[s];
+	return (uint32_t) (nj / 1000 / idle->decisions);
+}
+
+void RLIC_Idle_ResetStats(rlic_idle_t *idle) {
+	RLIC_Idle_Enter(idle, idle->state, idle->reason);
+	memset(idle->timeUS, 0, sizeof(idle->timeUS));
+	memset(idle->reasonUS, 0, sizeof(idle->reasonUS));
+	idle->startMS = idle->ops->clockMS();
+	idle->decisions = 0;
+	idle->waits = 0;
+	idle->scaled = 0;
+	idle->lateMax = 0;
+}
+
+void RLIC_Idle_PrintStats(rlic_idle_t *idle) {
+	static const char *const names[RLIC_IDLE_STATES] = { "run", "sleep",
+			"scaled" };
+	uint64_t totalUS = 0;
+	int64_t driftUS;
+	uint32_t elapsedMS, uj;
+
+	RLIC_Idle_Enter(idle, idle->state, idle->reason);
+	elapsedMS = idle->ops->clockMS() - idle->startMS;
+	for (uint32_t s = 0; s < RLIC_IDLE_STATES; s++)
+		totalUS += idle->timeUS[s];
+	if (!totalUS)
+		return;
+
+	PRINTF("idle: %d ms,", elapsedMS);
+	for (uint32_t s = 0; s < RLIC_IDLE_STATES; s++)
+		PRINTF(" %s %d ms (%d%%)", names[s],
+				(uint32_t) (idle->timeUS[s] / 1000),
+				(uint32_t) (idle->timeUS[s] * 100 / totalUS));
+	PRINTF("\r\n");
+	PRINTF("  slept for steps %d ms, I2C %d ms, SD %d ms; %d waits, %d at "
+			"1/%d clock, %d ms late at most\r\n",
+			(uint32_t) (idle->reasonUS[RLIC_IDLE_STEP] / 1000),
+			(uint32_t) (idle->reasonUS[RLIC_IDLE_I2C] / 1000),
+			(uint32_t) (idle->reasonUS[RLIC_IDLE_SD] / 1000), idle->waits,
+			idle->scaled, idle->scaleDiv, idle->lateMax);
+	uj = RLIC_Idle_EnergyUJ(idle);
+	PRINTF("  %d decisions, %d.%03d mJ each, %d mW average (estimated)\r\n",
+			idle->decisions, uj / 1000, uj % 1000,
+			(uint32_t) ((idle->timeUS[RLIC_IDLE_RUN] * RLIC_IDLE_RUN_MW
+					+ idle->timeUS[RLIC_IDLE_SLEEP] * RLIC_IDLE_SLEEP_MW
+					+ idle->timeUS[RLIC_IDLE_SCALED] * RLIC_IDLE_SCALED_MW)
+					/ totalUS));
+	/* time base against the reference clock, ms resolution */
+	driftUS = (int64_t) elapsedMS * 1000 - (int64_t) totalUS;
+	PRINTF("  time base %d us off the reference (%d ppm)\r\n",
+			(int32_t) driftUS, (int32_t) (driftUS * 1000000 / (int64_t) totalUS));
+}
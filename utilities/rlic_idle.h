@@ -0,0 +1,132 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_IDLE_H_
+#define RLIC_IDLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fsl_common.h"
+
+/*
+ * Idle manager. Most of a control step is the sensor integrating; the
+ * core has nothing to do but wait for the next deadline, an I2C transfer
+ * or an SD transfer to finish. Waits go through here: the core sleeps
+ * (WFI) until an interrupt, and a wait long enough to be worth it runs at
+ * a divided core clock, restored RLIC_IDLE_RESTORE_MS before the deadline
+ * so the step after it runs at full speed.
+ *
+ * Time in each state is taken from a reference clock that does not
+ * follow the core clock (GPT on the board), so the stats also show
+ * whether the millisecond time base kept time across the clock changes.
+ * Energy per decision is an estimate from RLIC_IDLE_*_MW, the supply
+ * power in each state; measure the board and override them.
+ *
+ * Portable C, the clocks and the sleep are reached through rlic_idle_ops_t
+ * so the host simulator in tools/ drives the same code.
+ */
+#ifndef RLIC_IDLE
+#define RLIC_IDLE				(1)
+#endif
+
+/* core clock divider while idle, 1 for sleep at full clock only */
+#ifndef RLIC_IDLE_SCALE_DIV
+#define RLIC_IDLE_SCALE_DIV		(4)
+#endif
+/* shorter waits are slept at full clock, a switch costs up to two ticks */
+#define RLIC_IDLE_SCALE_MIN_MS	(10)
+#define RLIC_IDLE_RESTORE_MS	(1)
+
+/* stats printed every so often, 0 for never */
+#ifndef RLIC_IDLE_REPORT_MS
+#define RLIC_IDLE_REPORT_MS		(60 * 60 * 1000)
+#endif
+
+/* supply power estimates, mW: running, asleep, asleep at the divided clock */
+#ifndef RLIC_IDLE_RUN_MW
+#define RLIC_IDLE_RUN_MW		(330)
+#endif
+#ifndef RLIC_IDLE_SLEEP_MW
+#define RLIC_IDLE_SLEEP_MW		(210)
+#endif
+#ifndef RLIC_IDLE_SCALED_MW
+#define RLIC_IDLE_SCALED_MW		(110)
+#endif
+
+enum rlic_idle_state_t {
+	RLIC_IDLE_RUN = 0,
+	RLIC_IDLE_SLEEP, /* WFI at full clock */
+	RLIC_IDLE_SCALED, /* WFI at the divided clock */
+	RLIC_IDLE_STATES,
+};
+
+/* what a sleep waited for */
+enum rlic_idle_reason_t {
+	RLIC_IDLE_STEP = 0, /* the next step, sensor integrating */
+	RLIC_IDLE_I2C,
+	RLIC_IDLE_SD,
+	RLIC_IDLE_REASONS,
+};
+
+typedef struct {
+	uint32_t (*clockUS)(void); /* reference clock, free running */
+	uint32_t (*clockMS)(void); /* time base the deadlines are in */
+	void (*sleep)(void); /* until the next interrupt */
+	/* core clock divider, 1 for full speed; returns just after a tick */
+	void (*scale)(uint32_t div);
+} rlic_idle_ops_t;
+
+typedef struct {
+	const rlic_idle_ops_t *ops;
+	uint32_t scaleDiv;
+	uint32_t state;
+	uint32_t reason; /* of the sleep going on */
+	uint32_t stateUS; /* reference clock at the last state change */
+	uint64_t timeUS[RLIC_IDLE_STATES];
+	uint64_t reasonUS[RLIC_IDLE_REASONS];
+	uint32_t startMS; /* time base at the last reset */
+	uint32_t decisions;
+	uint32_t waits;
+	uint32_t scaled; /* waits at the divided clock */
+	uint32_t lateMax; /* ms a wait returned past its deadline */
+} rlic_idle_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void RLIC_Idle_Init(rlic_idle_t *idle, const rlic_idle_ops_t *ops,
+		uint32_t scaleDiv);
+void RLIC_Idle_WaitMS(rlic_idle_t *idle, uint32_t ms);
+void RLIC_Idle_Sleep(rlic_idle_t *idle, uint32_t reason);
+void RLIC_Idle_Decision(rlic_idle_t *idle);
+uint32_t RLIC_Idle_EnergyUJ(const rlic_idle_t *idle);
+void RLIC_Idle_ResetStats(rlic_idle_t *idle);
+void RLIC_Idle_PrintStats(rlic_idle_t *idle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_IDLE_H_ */
@@ -0,0 +1,284 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "fsl_common.h"
+#include "rlic_mempool.h"
+
+#if defined(__arm__)
+#include "fsl_debug_console.h"
+#else
+/* host build for tools/, the SDK console is not there */
+#include <stdio.h>
+#define PRINTF printf
+#endif
+
+#define RLIC_MEMPOOL_COUNT(sz, n)	+1
+#define RLIC_MEMPOOL_BYTES(sz, n)	+((sz) * (n))
+#define RLIC_MEMPOOL_INIT(sz, n)	{ (sz), (n) },
+
+#define RLIC_MEMPOOL_CLASSES	(0 RLIC_MEMPOOL_CLASS_LIST(RLIC_MEMPOOL_COUNT))
+#define RLIC_MEMPOOL_STORAGE_SZ	(0 RLIC_MEMPOOL_CLASS_LIST(RLIC_MEMPOOL_BYTES))
+
+#if (RLIC_MEMPOOL_REGION == RLIC_REGION_DTC)
+#define RLIC_MEMPOOL_AT		RLIC_AT_DTC_BSS
+#elif (RLIC_MEMPOOL_REGION == RLIC_REGION_OC)
+#define RLIC_MEMPOOL_AT		RLIC_AT_OC_BSS
+#elif (RLIC_MEMPOOL_REGION == RLIC_REGION_SDRAM)
+#define RLIC_MEMPOOL_AT		RLIC_AT_SDRAM_BSS
+#else
+#define RLIC_MEMPOOL_AT
+#endif
+
+typedef struct rlic_pool_block {
+	struct rlic_pool_block *next;
+} rlic_pool_block_t;
+
+typedef struct {
+	uint8_t *base;
+	uint8_t *end;
+	rlic_pool_block_t *freeList;
+	rlic_mempool_stats_t stats;
+} rlic_pool_class_t;
+
+RLIC_MEMPOOL_AT static uint8_t s_poolStorage[RLIC_MEMPOOL_STORAGE_SZ]
+		__attribute__((aligned(8)));
+
+static const uint16_t s_poolDef[RLIC_MEMPOOL_CLASSES][2] = {
+RLIC_MEMPOOL_CLASS_LIST(RLIC_MEMPOOL_INIT) };
+
+static rlic_pool_class_t s_poolClass[RLIC_MEMPOOL_CLASSES];
+static bool s_poolReady = false;
+static uint32_t s_poolHeapAllocs; /* served by the heap instead */
+
+/* carve the storage into per class free lists, called with IRQs masked */
+static void RLIC_MemPool_Init(void) {
+	uint8_t *p = s_poolStorage;
+
+	for (uint32_t c = 0; c < RLIC_MEMPOOL_CLASSES; c++) {
+		rlic_pool_class_t *cls = &s_poolClass[c];
+		uint32_t blockSize = s_poolDef[c][0];
+		uint32_t blocks = s_poolDef[c][1];
+
+		memset(&cls->stats, 0, sizeof(cls->stats));
+		cls->stats.blockSize = (uint16_t) blockSize;
+		cls->stats.blocks = (uint16_t) blocks;
+		cls->base = p;
+		cls->freeList = NULL;
+		/* push in reverse so the lowest address is handed out first */
+		for (uint32_t b = blocks; b > 0; b--) {
+			rlic_pool_block_t *blk = (rlic_pool_block_t*) (p
+					+ (b - 1) * blockSize);
+			blk->next = cls->freeList;
+			cls->freeList = blk;
+		}
+		p += blockSize * blocks;
+		cls->end = p;
+	}
+	s_poolReady = true;
+}
+
+void *RLIC_MemPool_Alloc(size_t size) {
+	void *p = NULL;
+	uint32_t c;
+	uint32_t primask = DisableGlobalIRQ();
+
+	if (!s_poolReady)
+		RLIC_MemPool_Init();
+
+	for (c = 0; c < RLIC_MEMPOOL_CLASSES; c++) {
+		if (size <= s_poolClass[c].stats.blockSize)
+			break;
+	}
+	if (c == RLIC_MEMPOOL_CLASSES)
+		s_poolClass[RLIC_MEMPOOL_CLASSES - 1].stats.fails++;
+
+	/* first fitting class, then larger ones if it ran dry */
+	for (uint32_t first = c; c < RLIC_MEMPOOL_CLASSES; c++) {
+		rlic_pool_class_t *cls = &s_poolClass[c];
+
+		if (cls->freeList) {
+			p = cls->freeList;
+			cls->freeList = cls->freeList->next;
+			cls->stats.inUse++;
+			cls->stats.allocs++;
+			if (cls->stats.inUse > cls->stats.highWater)
+				cls->stats.highWater = cls->stats.inUse;
+			break;
+		}
+		if (c == first)
+			cls->stats.fails++;
+	}
+
+	EnableGlobalIRQ(primask);
+	return p;
+}
+
+/*
+ * Pool first, the heap when the pool cannot serve it. With
+ * RLIC_MEMPOOL_MALLOC malloc is the pool, there is nothing behind it.
+ */
+void *RLIC_MemPool_AllocAny(size_t size) {
+	void *p = RLIC_MemPool_Alloc(size);
+
+#if !RLIC_MEMPOOL_MALLOC
+	if (p == NULL) {
+		p = malloc(size);
+		if (p != NULL) {
+			uint32_t primask = DisableGlobalIRQ();
+
+			s_poolHeapAllocs++;
+			EnableGlobalIRQ(primask);
+		}
+	}
+#endif
+	return p;
+}
+
+void RLIC_MemPool_FreeAny(void *p) {
+	if (RLIC_MemPool_Owns(p))
+		RLIC_MemPool_Free(p);
+#if !RLIC_MEMPOOL_MALLOC
+	else
+		free(p);
+#endif
+}
+
+bool RLIC_MemPool_Owns(const void *p) {
+	const uint8_t *b = (const uint8_t*) p;
+
+	return (b >= s_poolStorage) && (b < (s_poolStorage + sizeof(s_poolStorage)));
+}
+
+void RLIC_MemPool_Free(void *p) {
+	uint8_t *b = (uint8_t*) p;
+
+	if ((p == NULL) || !RLIC_MemPool_Owns(p))
+		return;
+
+	uint32_t primask = DisableGlobalIRQ();
+
+	for (uint32_t c = 0; c < RLIC_MEMPOOL_CLASSES; c++) {
+		rlic_pool_class_t *cls = &s_poolClass[c];
+
+		if (b < cls->end) {
+			assert(((uint32_t) (b - cls->base) % cls->stats.blockSize) == 0);
+			((rlic_pool_block_t*) b)->next = cls->freeList;
+			cls->freeList = (rlic_pool_block_t*) b;
+			cls->stats.inUse--;
+			break;
+		}
+	}
+
+	EnableGlobalIRQ(primask);
+}
+
+void RLIC_MemPool_GetStats(uint32_t cls, rlic_mempool_stats_t *stats) {
+	uint32_t primask = DisableGlobalIRQ();
+
+	if (!s_poolReady)
+		RLIC_MemPool_Init();
+	if (cls < RLIC_MEMPOOL_CLASSES)
+		*stats = s_poolClass[cls].stats;
+	else
+		memset(stats, 0, sizeof(*stats));
+
+	EnableGlobalIRQ(primask);
+}
+
+uint32_t RLIC_MemPool_HeapAllocs(void) {
+	return s_poolHeapAllocs;
+}
+
+void RLIC_MemPool_PrintStats(void) {
+	rlic_mempool_stats_t st;
+
+	PRINTF("MemPool @0x%x (%d bytes)\r\n", (uint32_t) (uintptr_t) s_poolStorage,
+			(int) sizeof(s_poolStorage));
+	for (uint32_t c = 0; c < RLIC_MEMPOOL_CLASSES; c++) {
+		RLIC_MemPool_GetStats(c, &st);
+		PRINTF("  %4d B x %2d: used %2d high %2d allocs %d fails %d\r\n",
+				st.blockSize, st.blocks, st.inUse, st.highWater, st.allocs,
+				st.fails);
+	}
+	PRINTF("  heap fallback: %d allocs\r\n", s_poolHeapAllocs);
+}
+
+#if RLIC_MEMPOOL_BENCHMARK && defined(__arm__)
+#include "rlic_cycles.h"
+
+#define RLIC_MEMPOOL_BENCH_SLOTS	(16)
+#define RLIC_MEMPOOL_BENCH_OPS		(2000)
+
+typedef void* (*rlic_bench_alloc_t)(size_t);
+typedef void (*rlic_bench_free_t)(void*);
+
+/* random sized alloc/free churn, reports average and worst case cycles */
+static void RLIC_MemPool_BenchRun(const char *name, rlic_bench_alloc_t a,
+		rlic_bench_free_t f) {
+	void *slot[RLIC_MEMPOOL_BENCH_SLOTS] = { 0 };
+	uint32_t seed = 0x12345678;
+	uint32_t total = 0, worst = 0;
+
+	for (uint32_t i = 0; i < RLIC_MEMPOOL_BENCH_OPS; i++) {
+		uint32_t s, t0, dt;
+
+		seed = seed * 1664525U + 1013904223U;
+		s = (seed >> 8) % RLIC_MEMPOOL_BENCH_SLOTS;
+
+		t0 = RLIC_CyclesGet();
+		if (slot[s]) {
+			f(slot[s]);
+			slot[s] = NULL;
+		} else {
+			slot[s] = a(8 + ((seed >> 16) % 248));
+		}
+		dt = RLIC_CyclesGet() - t0;
+
+		total += dt;
+		if (dt > worst)
+			worst = dt;
+	}
+
+	for (uint32_t s = 0; s < RLIC_MEMPOOL_BENCH_SLOTS; s++)
+		f(slot[s]);
+
+	PRINTF("%s: avg %d cycles worst %d cycles\r\n", name,
+			total / RLIC_MEMPOOL_BENCH_OPS, worst);
+}
+
+void RLIC_MemPool_Benchmark(void) {
+	RLIC_CyclesInit();
+	RLIC_MemPool_BenchRun("pool", RLIC_MemPool_Alloc, RLIC_MemPool_Free);
+#if !RLIC_MEMPOOL_MALLOC
+	RLIC_MemPool_BenchRun("heap", malloc, free);
+#endif
+	RLIC_MemPool_PrintStats();
+}
+#else
+void RLIC_MemPool_Benchmark(void) {
+}
+#endif /* RLIC_MEMPOOL_BENCHMARK */
@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_MEMPOOL_H_
+#define RLIC_MEMPOOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "rlic_section.h"
+
+/*
+ * Fixed size-class pool allocator.
+ * Every class is a contiguous block array with its own free list, so
+ * allocate and free are O(1) and never fragment. A request is served from
+ * the smallest class that fits; if that class is exhausted the next larger
+ * one is tried. Requests larger than the biggest class fail.
+ * RLIC_MemPool_AllocAny() is what the allocation hooks use: pool first,
+ * the heap for what the pool cannot serve. tools/rlic_mempool_bench.c
+ * checks the stats on the host and times the pool against malloc/free.
+ */
+
+/*! @brief route operator new/delete, OSA and FatFs allocations to the pool */
+#ifndef RLIC_MEMPOOL_ENABLE
+#define RLIC_MEMPOOL_ENABLE		(1)
+#endif
+
+/*! @brief also replace malloc/free (like CPP_NO_HEAP, no general heap left) */
+#ifndef RLIC_MEMPOOL_MALLOC
+#define RLIC_MEMPOOL_MALLOC		(0)
+#endif
+
+/*! @brief pool storage region, one of RLIC_REGION_xxx */
+#ifndef RLIC_MEMPOOL_REGION
+#define RLIC_MEMPOOL_REGION		RLIC_REGION_DTC
+#endif
+
+/*! @brief run the pool vs heap benchmark from RLIC_MemPool_Benchmark() */
+#ifndef RLIC_MEMPOOL_BENCHMARK
+#define RLIC_MEMPOOL_BENCHMARK	(0)
+#endif
+
+/* block size and count of every class, smallest first, sizes multiple of 8 */
+#ifndef RLIC_MEMPOOL_CLASS_LIST
+#define RLIC_MEMPOOL_CLASS_LIST(X) \
+	X(16, 32) X(32, 16) X(64, 8) X(128, 8) X(256, 4) X(512, 2) X(1024, 2)
+#endif
+
+typedef struct {
+	uint16_t blockSize;
+	uint16_t blocks;
+	uint16_t inUse;
+	uint16_t highWater;
+	uint32_t allocs;
+	uint32_t fails; /* class was empty, spilled to a larger one or failed;
+	 the largest class also counts requests above its size */
+} rlic_mempool_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *RLIC_MemPool_Alloc(size_t size);
+void RLIC_MemPool_Free(void *p);
+void *RLIC_MemPool_AllocAny(size_t size);
+void RLIC_MemPool_FreeAny(void *p);
+bool RLIC_MemPool_Owns(const void *p);
+void RLIC_MemPool_GetStats(uint32_t cls, rlic_mempool_stats_t *stats);
+uint32_t RLIC_MemPool_HeapAllocs(void);
+void RLIC_MemPool_PrintStats(void);
+void RLIC_MemPool_Benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_MEMPOOL_H_ */
@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_QUEUE_H_
+#define RLIC_QUEUE_H_
+
+/*
+ * Allocation free, fixed capacity ring for the hot paths.
+ *
+ * Ring_SPSC    - one producer, one consumer (e.g. ISR -> main loop)
+ *
+ * The capacity must be a power of two. Nothing here allocates or blocks.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Each side owns one index: the producer publishes a filled slot with a
+ * release store of head and the consumer frees one with a release store of
+ * tail, the other side reads that index with an acquire load. On the M7
+ * that is one DMB ahead of each index store and one after each opposing
+ * load, nothing on the host.
+ */
+template<typename T, uint32_t N>
+class Ring_SPSC {
+	static_assert((N != 0) && ((N & (N - 1)) == 0), "N must be power of 2");
+private:
+	T slots[N];
+	uint32_t head = 0; /* written by producer only */
+	uint32_t tail = 0; /* written by consumer only */
+public:
+	bool push(const T &item) {
+		uint32_t h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+
+		if ((h - __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) >= N)
+			return false;
+		slots[h & (N - 1)] = item;
+		__atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+
+	bool pop(T &item) {
+		uint32_t t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+
+		if (t == __atomic_load_n(&head, __ATOMIC_ACQUIRE))
+			return false;
+		item = slots[t & (N - 1)];
+		__atomic_store_n(&tail, t + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+
+	/* peek without consuming, NULL when empty; consumer side only */
+	T* front(void) {
+		uint32_t t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+
+		if (t == __atomic_load_n(&head, __ATOMIC_ACQUIRE))
+			return NULL;
+		return &slots[t & (N - 1)];
+	}
+
+	uint32_t size(void) const {
+		return __atomic_load_n(&head, __ATOMIC_RELAXED)
+				- __atomic_load_n(&tail, __ATOMIC_RELAXED);
+	}
+
+	bool empty(void) const {
+		return size() == 0;
+	}
+
+	bool full(void) const {
+		return size() >= N;
+	}
+
+	static constexpr uint32_t capacity(void) {
+		return N;
+	}
+};
+
+#endif /* RLIC_QUEUE_H_ */
@@ -0,0 +1,319 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <string.h>
+#include "rlic_sd_bench.h"
+#include "diskio.h"
+
+#if defined(__arm__)
+#include "fsl_debug_console.h"
+#include "rlic_section.h"
+#else
+/* host build for tools/, the SDK console is not there */
+#include <stdio.h>
+#define PRINTF printf
+#define RLIC_AT_SDRAM_NOINIT
+#endif
+
+#if !FF_USE_EXPAND
+#error "RLIC_SdBench_Run() reserves its scratch file with f_expand()"
+#endif
+
+#define RLIC_SD_BENCH_SECTOR_SZ		(512)
+#define RLIC_SD_BENCH_SLOT_STRIDE	(4 * 1024) /* RLIC.dat entry */
+#define RLIC_SD_BENCH_SLOT_HDR_SZ	(16) /* sdmmc_entry_hdr_t */
+
+enum {
+	RLIC_SD_BENCH_SEQ = 0, RLIC_SD_BENCH_RAND,
+};
+
+enum {
+	RLIC_SD_BENCH_READ = 0, RLIC_SD_BENCH_WRITE,
+};
+
+typedef struct {
+	const rlic_sd_bench_cfg_t *cfg;
+	FIL fil;
+	LBA_t lba; /* first sector of the scratch file, 0 if not contiguous */
+	uint32_t seed;
+	uint32_t lat[RLIC_SD_BENCH_REPS_MAX]; /* us */
+	uint32_t syncLat[RLIC_SD_BENCH_REPS_MAX];
+	rlic_sd_bench_result_t *results;
+	uint32_t maxResults;
+	uint32_t numResults;
+} rlic_sd_bench_t;
+
+static const uint32_t s_sizes[] = { 512, 4 * 1024, 16 * 1024, 64 * 1024 };
+
+static const char *const s_diskNames[2][2] = {
+	{ "disk seq read", "disk seq write" },
+	{ "disk rand read", "disk rand write" },
+};
+static const char *const s_fileNames[2][2] = {
+	{ "f_read seq", "f_write seq" },
+	{ "f_read rand", "f_write rand" },
+};
+static const char *const s_syncNames[2] = { "f_sync seq", "f_sync rand" };
+static const char *const s_slotNames[2][2] = {
+	{ "slot read seq", "slot write seq" },
+	{ "slot read rand", "slot write rand" },
+};
+
+/* transfer buffer, SDRAM on target as the RLIC.dat mirror */
+RLIC_AT_SDRAM_NOINIT SDK_ALIGN(static uint8_t s_buf[RLIC_SD_BENCH_XFER_MAX],
+		32);
+static rlic_sd_bench_t s_bench;
+
+/* offset of transfer i, aligned to its size, inside the scratch file */
+static uint32_t rlicSdBenchOffset(rlic_sd_bench_t *b, uint32_t pattern,
+		uint32_t size, uint32_t i) {
+	uint32_t blocks = b->cfg->regionSz / size;
+
+	if (pattern == RLIC_SD_BENCH_SEQ)
+		return (i % blocks) * size;
+	b->seed = (b->seed * 1103515245U) + 12345U;
+	return ((b->seed >> 8) % blocks) * size;
+}
+
+static uint32_t rlicSdBenchUS(rlic_sd_bench_t *b, uint32_t t0) {
+	return (b->cfg->now() - t0) / b->cfg->ticksPerUS;
+}
+
+/* percentiles of lat[0..count), sorted in place, printed and kept */
+static void rlicSdBenchReport(rlic_sd_bench_t *b, const char *name,
+		uint32_t size, uint32_t *lat, uint32_t count) {
+	rlic_sd_bench_result_t r;
+	uint64_t sumUS = 0;
+
+	for (uint32_t i = 1; i < count; i++) {
+		uint32_t v = lat[i];
+		uint32_t j = i;
+
+		for (; (j > 0) && (lat[j - 1] > v); j--)
+			lat[j] = lat[j - 1];
+		lat[j] = v;
+	}
+	for (uint32_t i = 0; i < count; i++)
+		sumUS += lat[i];
+
+	r.name = name;
+	r.size = size;
+	r.count = count;
+	r.p50US = lat[((count - 1) * 50) / 100];
+	r.p90US = lat[((count - 1) * 90) / 100];
+	r.p99US = lat[((count - 1) * 99) / 100];
+	r.maxUS = lat[count - 1];
+	r.kbps = sumUS ?
+			(uint32_t) (((uint64_t) size * count * 1000000U) / 1024U / sumUS) :
+			0;
+
+	PRINTF("%-16s %6d B  p50 %6d p90 %6d p99 %6d max %6d us  %6d KB/s\r\n",
+			name, size, r.p50US, r.p90US, r.p99US, r.maxUS, r.kbps);
+	if (b->results && (b->numResults < b->maxResults))
+		b->results[b->numResults++] = r;
+}
+
+/* sectors of the scratch file straight through the disk layer */
+static status_t rlicSdBenchDisk(rlic_sd_bench_t *b, uint32_t pattern,
+		uint32_t dir, uint32_t size) {
+	const rlic_sd_bench_cfg_t *cfg = b->cfg;
+	UINT count = size / RLIC_SD_BENCH_SECTOR_SZ;
+
+	for (uint32_t i = 0; i < cfg->reps; i++) {
+		LBA_t lba = b->lba
+				+ (rlicSdBenchOffset(b, pattern, size, i)
+						/ RLIC_SD_BENCH_SECTOR_SZ);
+		uint32_t t0 = cfg->now();
+		DRESULT res;
+
+		if (dir == RLIC_SD_BENCH_WRITE)
+			res = disk_write(cfg->pdrv, s_buf, lba, count);
+		else
+			res = disk_read(cfg->pdrv, s_buf, lba, count);
+		b->lat[i] = rlicSdBenchUS(b, t0);
+		if (res != RES_OK) {
+			PRINTF("SD bench: disk error %d at sector %d\r\n", res, lba);
+			return kStatus_Fail;
+		}
+	}
+
+	rlicSdBenchReport(b, s_diskNames[pattern][dir], size, b->lat, cfg->reps);
+	return kStatus_Success;
+}
+
+/* through FatFs, seek included as SDMMC_Simple seeks for every access */
+static status_t rlicSdBenchFile(rlic_sd_bench_t *b, uint32_t pattern,
+		uint32_t dir, uint32_t size) {
+	const rlic_sd_bench_cfg_t *cfg = b->cfg;
+	UINT done;
+
+	for (uint32_t i = 0; i < cfg->reps; i++) {
+		uint32_t t0 = cfg->now();
+		FRESULT res = f_lseek(&b->fil,
+				rlicSdBenchOffset(b, pattern, size, i));
+
+		if (res == FR_OK) {
+			if (dir == RLIC_SD_BENCH_WRITE)
+				res = f_write(&b->fil, s_buf, size, &done);
+			else
+				res = f_read(&b->fil, s_buf, size, &done);
+		}
+		b->lat[i] = rlicSdBenchUS(b, t0);
+		if ((res == FR_OK) && (dir == RLIC_SD_BENCH_WRITE)) {
+			t0 = cfg->now();
+			res = f_sync(&b->fil);
+			b->syncLat[i] = rlicSdBenchUS(b, t0);
+		}
+		if ((res != FR_OK) || (done != size)) {
+			PRINTF("SD bench: file error %d\r\n", res);
+			return kStatus_Fail;
+		}
+	}
+
+	rlicSdBenchReport(b, s_fileNames[pattern][dir], size, b->lat, cfg->reps);
+	if (dir == RLIC_SD_BENCH_WRITE)
+		rlicSdBenchReport(b, s_syncNames[pattern], size, b->syncLat,
+				cfg->reps);
+	return kStatus_Success;
+}
+
+/* one RLIC.dat entry as SDMMC_Simple does it: header, payload, sync */
+static status_t rlicSdBenchSlot(rlic_sd_bench_t *b, uint32_t pattern,
+		uint32_t dir) {
+	const rlic_sd_bench_cfg_t *cfg = b->cfg;
+	uint32_t size = RLIC_SD_BENCH_SLOT_HDR_SZ + cfg->slotSz;
+	UINT done;
+
+	for (uint32_t i = 0; i < cfg->reps; i++) {
+		uint32_t off = rlicSdBenchOffset(b, pattern, RLIC_SD_BENCH_SLOT_STRIDE,
+				i);
+		uint32_t t0 = cfg->now();
+		FRESULT res = f_lseek(&b->fil, off);
+
+		for (uint32_t part = 0; (part < 2) && (res == FR_OK); part++) {
+			uint32_t len = part ? cfg->slotSz : RLIC_SD_BENCH_SLOT_HDR_SZ;
+
+			if (part)
+				res = f_lseek(&b->fil, off + RLIC_SD_BENCH_SLOT_HDR_SZ);
+			if ((res == FR_OK) && (dir == RLIC_SD_BENCH_WRITE))
+				res = f_write(&b->fil, s_buf, len, &done);
+			else if (res == FR_OK)
+				res = f_read(&b->fil, s_buf, len, &done);
+			if ((res == FR_OK) && (done != len))
+				res = FR_DISK_ERR;
+		}
+		if ((res == FR_OK) && (dir == RLIC_SD_BENCH_WRITE))
+			res = f_sync(&b->fil);
+		b->lat[i] = rlicSdBenchUS(b, t0);
+		if (res != FR_OK) {
+			PRINTF("SD bench: slot error %d\r\n", res);
+			return kStatus_Fail;
+		}
+	}
+
+	rlicSdBenchReport(b, s_slotNames[pattern][dir], size, b->lat, cfg->reps);
+	return kStatus_Success;
+}
+
+static status_t rlicSdBenchAll(rlic_sd_bench_t *b) {
+	const rlic_sd_bench_cfg_t *cfg = b->cfg;
+	status_t status = kStatus_Success;
+
+	for (uint32_t s = 0; s < (sizeof(s_sizes) / sizeof(s_sizes[0])); s++) {
+		if (s_sizes[s] > (cfg->regionSz / 2))
+			break;
+		for (uint32_t p = RLIC_SD_BENCH_SEQ; p <= RLIC_SD_BENCH_RAND; p++) {
+			for (uint32_t d = RLIC_SD_BENCH_READ; d <= RLIC_SD_BENCH_WRITE;
+					d++) {
+				if (b->lba && (status == kStatus_Success))
+					status = rlicSdBenchDisk(b, p, d, s_sizes[s]);
+				if (status == kStatus_Success)
+					status = rlicSdBenchFile(b, p, d, s_sizes[s]);
+			}
+		}
+	}
+
+	if ((RLIC_SD_BENCH_SLOT_HDR_SZ + cfg->slotSz) > RLIC_SD_BENCH_SLOT_STRIDE)
+		return status;
+	for (uint32_t p = RLIC_SD_BENCH_SEQ; p <= RLIC_SD_BENCH_RAND; p++) {
+		for (uint32_t d = RLIC_SD_BENCH_READ; d <= RLIC_SD_BENCH_WRITE; d++) {
+			if (status == kStatus_Success)
+				status = rlicSdBenchSlot(b, p, d);
+		}
+	}
+	return status;
+}
+
+status_t RLIC_SdBench_Run(const rlic_sd_bench_cfg_t *cfg,
+		rlic_sd_bench_result_t *results, uint32_t maxResults,
+		uint32_t *numResults) {
+	rlic_sd_bench_t *b = &s_bench;
+	rlic_sd_bench_cfg_t c = *cfg;
+	status_t status;
+	FATFS *fs;
+
+	if (c.reps > RLIC_SD_BENCH_REPS_MAX)
+		c.reps = RLIC_SD_BENCH_REPS_MAX;
+	if (!c.reps || !c.ticksPerUS
+			|| (c.regionSz < (2 * RLIC_SD_BENCH_SLOT_STRIDE)))
+		return kStatus_InvalidArgument;
+
+	memset(b, 0, sizeof(*b));
+	b->cfg = &c;
+	b->seed = 1;
+	b->results = results;
+	b->maxResults = maxResults;
+	for (uint32_t i = 0; i < sizeof(s_buf); i++)
+		s_buf[i] = (uint8_t) (i * 7);
+
+	if (f_open(&b->fil, c.path, FA_READ | FA_WRITE | FA_CREATE_ALWAYS)
+			!= FR_OK) {
+		PRINTF("SD bench: cannot create %s\r\n", c.path);
+		return kStatus_Fail;
+	}
+
+	/* contiguous, so its sectors can be addressed without FatFs */
+	if (f_expand(&b->fil, c.regionSz, 1) == FR_OK) {
+		fs = b->fil.obj.fs;
+		b->lba = fs->database + ((LBA_t) fs->csize * (b->fil.obj.sclust - 2));
+	} else if ((f_lseek(&b->fil, c.regionSz) != FR_OK)
+			|| (f_sync(&b->fil) != FR_OK)) {
+		PRINTF("SD bench: no room for %d KB\r\n", c.regionSz / 1024);
+		f_close(&b->fil);
+		f_unlink(c.path);
+		return kStatus_Fail;
+	} else {
+		PRINTF("SD bench: scratch file fragmented, no disk level tests\r\n");
+	}
+
+	PRINTF("SD bench: %d KB scratch, %d transfers per test\r\n",
+			c.regionSz / 1024, c.reps);
+	status = rlicSdBenchAll(b);
+
+	if ((f_close(&b->fil) != FR_OK) || (f_unlink(c.path) != FR_OK))
+		PRINTF("SD bench: %s not removed\r\n", c.path);
+	if (numResults)
+		*numResults = b->numResults;
+	return status;
+}
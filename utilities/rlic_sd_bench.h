@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_SD_BENCH_H_
+#define RLIC_SD_BENCH_H_
+
+#include <stdint.h>
+#include "fsl_common.h"
+#include "ff.h"
+
+/*
+ * Storage benchmark on a scratch file of a mounted FatFs volume: latency
+ * percentiles and throughput per transfer size, sequential and random,
+ * at the disk_*() level (inside the file's clusters, so nothing else is
+ * touched) and through f_read/f_write/f_sync, then the RLIC.dat slot
+ * access (entry header and Q table payload at a 4 KB stride, synced).
+ *
+ * Portable C, time comes from cfg->now so tools/sd_bench_host.c runs the
+ * same code on a RAM disk or a card model with injected latency.
+ */
+#define RLIC_SD_BENCH_XFER_MAX		(64 * 1024)
+#define RLIC_SD_BENCH_REPS_MAX		(128)
+#define RLIC_SD_BENCH_RESULTS_MAX	(48)
+
+typedef struct {
+	uint32_t (*now)(void); /* free running ticks */
+	uint32_t ticksPerUS;
+	uint8_t pdrv; /* drive of the volume, for the disk_*() tests */
+	const TCHAR *path; /* scratch file, removed at the end */
+	uint32_t regionSz; /* scratch file size */
+	uint32_t reps; /* transfers per test */
+	uint32_t slotSz; /* payload of one RLIC.dat entry */
+} rlic_sd_bench_cfg_t;
+
+typedef struct {
+	const char *name;
+	uint32_t size; /* bytes per transfer */
+	uint32_t count;
+	uint32_t p50US;
+	uint32_t p90US;
+	uint32_t p99US;
+	uint32_t maxUS;
+	uint32_t kbps; /* KB/s over all transfers of the test */
+} rlic_sd_bench_result_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* results may be NULL, every test is printed either way */
+status_t RLIC_SdBench_Run(const rlic_sd_bench_cfg_t *cfg,
+		rlic_sd_bench_result_t *results, uint32_t maxResults,
+		uint32_t *numResults);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_SD_BENCH_H_ */
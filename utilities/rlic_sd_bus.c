@@ -0,0 +1,150 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include "rlic_sd_bus.h"
+#if defined(__arm__)
+#include "fsl_debug_console.h"
+#else
+/* host build for tools/, the SDK console is not there */
+#include <stdio.h>
+#define PRINTF printf
+#endif
+
+static const rlic_sd_bus_limit_t s_limits[RLIC_SD_BUS_MODES] = {
+	[RLIC_SD_BUS_SDR104] = { RLIC_SD_BUS_TIMING_SDR104, 208000000U, true },
+	[RLIC_SD_BUS_SDR50] = { RLIC_SD_BUS_TIMING_SDR50, 100000000U, true },
+	[RLIC_SD_BUS_HIGH_SPEED] = { RLIC_SD_BUS_TIMING_SDR25, 50000000U, false },
+	[RLIC_SD_BUS_DEFAULT] = { RLIC_SD_BUS_TIMING_SDR12, 25000000U, false },
+};
+
+static const char *const s_modeNames[RLIC_SD_BUS_MODES] = { "SDR104", "SDR50",
+		"high speed", "default speed" };
+static const char *const s_timingNames[] = { "SDR12", "SDR25", "SDR50",
+		"SDR104", "DDR50" };
+
+/*
+ * Mode a negotiated bus belongs to, the card may settle below the cap
+ * (no 1.8 V, no UHS-I, the SDK fell through its own timing list). A 1.8 V
+ * bus at any timing counts as SDR50 so the next step goes back to 3.3 V.
+ */
+static uint32_t rlicSdBusModeOf(const rlic_sd_bus_info_t *info) {
+	if (info->timing == RLIC_SD_BUS_TIMING_SDR104)
+		return RLIC_SD_BUS_SDR104;
+	if (info->is1V8)
+		return RLIC_SD_BUS_SDR50;
+	if (info->clockHz > s_limits[RLIC_SD_BUS_DEFAULT].maxHz)
+		return RLIC_SD_BUS_HIGH_SPEED;
+	return RLIC_SD_BUS_DEFAULT;
+}
+
+/* bring the card up in mode 'from' or the first slower one that works */
+static status_t rlicSdBusStartFrom(rlic_sd_bus_t *bus, uint32_t from) {
+	for (uint32_t m = from; m < RLIC_SD_BUS_MODES; m++) {
+		rlic_sd_bus_limit_t limit = s_limits[m];
+		uint32_t mode;
+
+		if (limit.maxHz > bus->maxHz)
+			limit.maxHz = bus->maxHz;
+		if (bus->ops->init(bus->ctx, &limit) != kStatus_Success) {
+			PRINTF("SD bus: %s failed\r\n", s_modeNames[m]);
+			if (!bus->ops->present(bus->ctx))
+				break;
+			continue;
+		}
+
+		bus->ops->getInfo(bus->ctx, &bus->info);
+		mode = rlicSdBusModeOf(&bus->info);
+		bus->mode = (mode > m) ? mode : m;
+		bus->tries = 0;
+		RLIC_SdBus_Print(bus);
+		return kStatus_Success;
+	}
+
+	bus->mode = RLIC_SD_BUS_MODES;
+	return kStatus_Fail;
+}
+
+void RLIC_SdBus_Init(rlic_sd_bus_t *bus, const rlic_sd_bus_ops_t *ops,
+		void *ctx, uint32_t top, uint32_t maxHz) {
+	bus->ops = ops;
+	bus->ctx = ctx;
+	bus->top = (top < RLIC_SD_BUS_MODES) ? top : RLIC_SD_BUS_DEFAULT;
+	bus->maxHz = maxHz;
+	bus->mode = RLIC_SD_BUS_MODES;
+	bus->tries = 0;
+	bus->errors = 0;
+	bus->fallbacks = 0;
+	bus->info.timing = RLIC_SD_BUS_TIMING_SDR12;
+	bus->info.clockHz = 0;
+	bus->info.width = 0;
+	bus->info.is1V8 = false;
+}
+
+/* card identification, from the top mode down */
+status_t RLIC_SdBus_Start(rlic_sd_bus_t *bus) {
+	return rlicSdBusStartFrom(bus, bus->top);
+}
+
+/*
+ * Called with the status of every transfer, true means try it again. A
+ * failed transfer is tried again as is, RLIC_SD_BUS_RETRIES failures in a
+ * row step the bus down one mode first. Nothing is retried when the card
+ * is gone or no slower mode is left.
+ */
+bool RLIC_SdBus_Retry(rlic_sd_bus_t *bus, status_t status) {
+	if (status == kStatus_Success) {
+		bus->tries = 0;
+		return false;
+	}
+
+	bus->errors++;
+	if ((bus->mode >= RLIC_SD_BUS_MODES) || !bus->ops->present(bus->ctx)) {
+		bus->tries = 0;
+		return false;
+	}
+	if (++bus->tries < RLIC_SD_BUS_RETRIES)
+		return true;
+
+	bus->tries = 0;
+	if ((bus->mode + 1) >= RLIC_SD_BUS_MODES)
+		return false;
+	PRINTF("SD bus: %d failed tries in %s, stepping down\r\n",
+			RLIC_SD_BUS_RETRIES, s_modeNames[bus->mode]);
+	bus->fallbacks++;
+	return rlicSdBusStartFrom(bus, bus->mode + 1) == kStatus_Success;
+}
+
+void RLIC_SdBus_Print(const rlic_sd_bus_t *bus) {
+	const rlic_sd_bus_info_t *info = &bus->info;
+
+	if (bus->mode >= RLIC_SD_BUS_MODES) {
+		PRINTF("SD bus: down, %d errors\r\n", bus->errors);
+		return;
+	}
+	PRINTF("SD bus: %s, %d bit %s %d kHz %s, %d step downs %d errors\r\n",
+			s_modeNames[bus->mode], info->width,
+			(info->timing < (sizeof(s_timingNames) / sizeof(s_timingNames[0]))) ?
+					s_timingNames[info->timing] : "?", info->clockHz / 1000U,
+			info->is1V8 ? "1.8 V" : "3.3 V", bus->fallbacks, bus->errors);
+}
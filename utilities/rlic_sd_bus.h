@@ -0,0 +1,112 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_SD_BUS_H_
+#define RLIC_SD_BUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fsl_common.h"
+
+/*
+ * SD bus mode ladder. The card is brought up in the fastest mode the board
+ * allows and stepped down a mode at a time when that fails: at bring up
+ * (no 1.8 V, tuning fails) or later when transfers keep failing (CRC or
+ * timeout errors from a marginal slot or adapter). Each mode caps what the
+ * SDK negotiates in SD_CardInit(): highest timing, bus clock and whether
+ * the card may switch to 1.8 V signalling. What the card settled on is
+ * kept in rlic_sd_bus_info_t and printed.
+ *
+ * Portable C, the card is reached through rlic_sd_bus_ops_t so the host
+ * test in tools/ runs the same state machine against a fake controller.
+ */
+#define RLIC_SD_BUS_SDR104		(0) /* 1.8 V, tuned, up to 208 MHz */
+#define RLIC_SD_BUS_SDR50		(1) /* 1.8 V, tuned, up to 100 MHz */
+#define RLIC_SD_BUS_HIGH_SPEED	(2) /* 3.3 V SDR25, 50 MHz */
+#define RLIC_SD_BUS_DEFAULT		(3) /* 3.3 V SDR12, 25 MHz */
+#define RLIC_SD_BUS_MODES		(4)
+
+/* fastest mode tried, the board's IO voltage control can lower it */
+#ifndef RLIC_SD_BUS_TOP
+#define RLIC_SD_BUS_TOP			(RLIC_SD_BUS_SDR50)
+#endif
+/* failed tries of one transfer before the bus is stepped down */
+#ifndef RLIC_SD_BUS_RETRIES
+#define RLIC_SD_BUS_RETRIES		(2)
+#endif
+
+/* sd_timing_mode_t numbering */
+#define RLIC_SD_BUS_TIMING_SDR12	(0)
+#define RLIC_SD_BUS_TIMING_SDR25	(1)
+#define RLIC_SD_BUS_TIMING_SDR50	(2)
+#define RLIC_SD_BUS_TIMING_SDR104	(3)
+#define RLIC_SD_BUS_TIMING_DDR50	(4)
+
+typedef struct {
+	uint32_t timing; /* highest timing to select */
+	uint32_t maxHz; /* bus clock cap */
+	bool allow1V8;
+} rlic_sd_bus_limit_t;
+
+typedef struct {
+	uint32_t timing; /* selected, sd_timing_mode_t */
+	uint32_t clockHz;
+	uint32_t width; /* data lines */
+	bool is1V8;
+} rlic_sd_bus_info_t;
+
+typedef struct {
+	/* power cycle and identify the card within limit */
+	status_t (*init)(void *ctx, const rlic_sd_bus_limit_t *limit);
+	void (*getInfo)(void *ctx, rlic_sd_bus_info_t *info);
+	bool (*present)(void *ctx);
+} rlic_sd_bus_ops_t;
+
+typedef struct {
+	const rlic_sd_bus_ops_t *ops;
+	void *ctx;
+	uint32_t top; /* first mode tried */
+	uint32_t maxHz; /* board limit */
+	uint32_t mode; /* current, RLIC_SD_BUS_MODES before bring up */
+	uint32_t tries; /* failed tries of the current transfer */
+	uint32_t errors; /* failed transfers, summed */
+	uint32_t fallbacks;
+	rlic_sd_bus_info_t info;
+} rlic_sd_bus_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void RLIC_SdBus_Init(rlic_sd_bus_t *bus, const rlic_sd_bus_ops_t *ops,
+		void *ctx, uint32_t top, uint32_t maxHz);
+status_t RLIC_SdBus_Start(rlic_sd_bus_t *bus);
+bool RLIC_SdBus_Retry(rlic_sd_bus_t *bus, status_t status);
+void RLIC_SdBus_Print(const rlic_sd_bus_t *bus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_SD_BUS_H_ */
@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_SECTION_H_
+#define RLIC_SECTION_H_
+
+/*
+ * Linker region placement for the MCUXpresso managed linker script.
+ * The managed script routes ".bss.$<MEMORY>" / ".data.$<MEMORY>" /
+ * ".ramfunc.$<MEMORY>" input sections to the named memory. With other
+ * toolchains the attributes expand to nothing and placement falls back to
+ * the default regions.
+ *
+ * RT1021 memories (see BOARD_ConfigMPU):
+ *   SRAM_ITC    0x00000000  ITCM, zero wait state, not cached
+ *   SRAM_DTC    0x20000000  DTCM, zero wait state, not cached
+ *   SRAM_OC     0x20200000  OCRAM, cached write back (MPU region 7)
+ *   BOARD_SDRAM 0x80000000  SEMC SDRAM, cached write back (MPU region 8)
+ *   NCACHE_REGION           OCRAM/SDRAM slice made non-cacheable (MPU region 9)
+ */
+
+#if defined(__MCUXPRESSO)
+#define RLIC_BSS_SECTION(mem)		__attribute__((section(".bss.$" #mem)))
+#define RLIC_DATA_SECTION(mem)		__attribute__((section(".data.$" #mem)))
+#define RLIC_RAMFUNC_SECTION(mem)	__attribute__((section(".ramfunc.$" #mem), noinline))
+#define RLIC_NOINIT_SECTION(mem)	__attribute__((section(".noinit.$" #mem)))
+#else
+#define RLIC_BSS_SECTION(mem)
+#define RLIC_DATA_SECTION(mem)
+#define RLIC_RAMFUNC_SECTION(mem)
+#define RLIC_NOINIT_SECTION(mem)
+#endif
+
+/* region selectors for configurable placement */
+#define RLIC_REGION_DEFAULT		(0)
+#define RLIC_REGION_DTC			(1)
+#define RLIC_REGION_OC			(2)
+#define RLIC_REGION_SDRAM		(3)
+#define RLIC_REGION_NCACHE		(4)
+
+#define RLIC_AT_DTC_BSS			RLIC_BSS_SECTION(SRAM_DTC)
+#define RLIC_AT_OC_BSS			RLIC_BSS_SECTION(SRAM_OC)
+#define RLIC_AT_SDRAM_BSS		RLIC_BSS_SECTION(BOARD_SDRAM)
+/* not zeroed by the startup code, which may run before SEMC is configured */
+#define RLIC_AT_SDRAM_NOINIT	RLIC_NOINIT_SECTION(BOARD_SDRAM)
+/* kept across a warm (watchdog or software) reset, garbage after power up */
+#define RLIC_AT_DTC_NOINIT		RLIC_NOINIT_SECTION(SRAM_DTC)
+#define RLIC_AT_NCACHE_BSS		RLIC_BSS_SECTION(NCACHE_REGION)
+#define RLIC_AT_ITC_CODE		RLIC_RAMFUNC_SECTION(SRAM_ITC)
+
+/*
+ * Hot path placement map, RLIC_PLACE_HOT selects it:
+ *   RLIC_HOT_CODE  - control step and its ISRs, ITCM (no XIP/I-cache misses)
+ *   RLIC_HOT_DATA  - Q table working set, DTCM (also reachable by uSDHC DMA,
+ *                    never cached so it needs no maintenance)
+ *   RLIC_DMA_BSS   - other DMA buffers, non-cacheable OCRAM (MPU region 9)
+ */
+#ifndef RLIC_PLACE_HOT
+#define RLIC_PLACE_HOT			(1)
+#endif
+
+#if RLIC_PLACE_HOT
+#define RLIC_HOT_CODE			RLIC_AT_ITC_CODE
+#define RLIC_HOT_DATA			RLIC_AT_DTC_BSS
+#else
+#define RLIC_HOT_CODE
+#define RLIC_HOT_DATA
+#endif
+#define RLIC_DMA_BSS			RLIC_AT_NCACHE_BSS
+
+#endif /* RLIC_SECTION_H_ */
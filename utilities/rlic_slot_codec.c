@@ -0,0 +1,158 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <string.h>
+#include "rlic_slot_codec.h"
+#include "rlic_section.h"
+
+#define RLIC_SLOT_CODEC_ZEROS		(0x00)
+#define RLIC_SLOT_CODEC_NIBBLES		(0x40)
+#define RLIC_SLOT_CODEC_BYTES		(0x80)
+#define RLIC_SLOT_CODEC_ZEROS_LONG	(0xC0)
+#define RLIC_SLOT_CODEC_KIND_MASK	(0xC0)
+#define RLIC_SLOT_CODEC_NIBBLE_MAX	(15)
+/* zeros inside a nibble run cost half a byte each, a zero run one byte */
+#define RLIC_SLOT_CODEC_ZERO_BREAK	(4)
+
+/* zeros at p, at most max, a word at a time while it can */
+static inline size_t RLIC_SlotCodec_Zeros(const uint8_t *p, size_t max) {
+	size_t n = 0;
+	uint32_t w;
+
+	while ((n + sizeof(w)) <= max) {
+		memcpy(&w, &p[n], sizeof(w));
+		if (w)
+			break;
+		n += sizeof(w);
+	}
+	while ((n < max) && !p[n])
+		n++;
+	return n;
+}
+
+RLIC_HOT_CODE size_t RLIC_SlotCodec_Encode(const uint8_t *src, size_t len,
+		uint8_t *dst, size_t cap) {
+	size_t i = 0, o = 0;
+
+	while (i < len) {
+		size_t left = len - i;
+		size_t n = RLIC_SlotCodec_Zeros(&src[i],
+				(left < RLIC_SLOT_CODEC_ZEROS_MAX) ?
+						left : RLIC_SLOT_CODEC_ZEROS_MAX);
+
+		if ((n >= RLIC_SLOT_CODEC_ZERO_BREAK) || (n == left)) {
+			if (n <= RLIC_SLOT_CODEC_RUN_MAX) {
+				if ((o + 1) > cap)
+					return 0;
+				dst[o++] = RLIC_SLOT_CODEC_ZEROS | (uint8_t) (n - 1);
+			} else {
+				if ((o + 2) > cap)
+					return 0;
+				dst[o++] = RLIC_SLOT_CODEC_ZEROS_LONG
+						| (uint8_t) ((n - 1) >> 8);
+				dst[o++] = (uint8_t) (n - 1);
+			}
+			i += n;
+			continue;
+		}
+
+		n = 1;
+		if (src[i] <= RLIC_SLOT_CODEC_NIBBLE_MAX) {
+			while ((n < left) && (n < RLIC_SLOT_CODEC_RUN_MAX)
+					&& (src[i + n] <= RLIC_SLOT_CODEC_NIBBLE_MAX)
+					&& (src[i + n]
+							|| (RLIC_SlotCodec_Zeros(&src[i + n],
+									((left - n) < RLIC_SLOT_CODEC_ZERO_BREAK) ?
+											(left - n) :
+											RLIC_SLOT_CODEC_ZERO_BREAK)
+									< RLIC_SLOT_CODEC_ZERO_BREAK)))
+				n++;
+			if ((o + 1 + ((n + 1) / 2)) > cap)
+				return 0;
+			dst[o++] = RLIC_SLOT_CODEC_NIBBLES | (uint8_t) (n - 1);
+			for (size_t k = 0; k < n; k += 2) {
+				uint8_t hi = ((k + 1) < n) ? src[i + k + 1] : 0;
+
+				dst[o++] = (uint8_t) (src[i + k] | (hi << 4));
+			}
+		} else {
+			while ((n < left) && (n < RLIC_SLOT_CODEC_RUN_MAX)
+					&& (src[i + n] > RLIC_SLOT_CODEC_NIBBLE_MAX))
+				n++;
+			if ((o + 1 + n) > cap)
+				return 0;
+			dst[o++] = RLIC_SLOT_CODEC_BYTES | (uint8_t) (n - 1);
+			memcpy(&dst[o], &src[i], n);
+			o += n;
+		}
+		i += n;
+	}
+
+	return o;
+}
+
+RLIC_HOT_CODE size_t RLIC_SlotCodec_Decode(const uint8_t *src, size_t len,
+		uint8_t *dst, size_t cap) {
+	size_t i = 0, o = 0;
+
+	while (i < len) {
+		uint8_t kind = src[i] & RLIC_SLOT_CODEC_KIND_MASK;
+		size_t n = (size_t) (src[i++] & ~RLIC_SLOT_CODEC_KIND_MASK) + 1;
+
+		if (kind == RLIC_SLOT_CODEC_ZEROS_LONG) {
+			if (i >= len)
+				return 0;
+			n = ((n - 1) << 8) + src[i++] + 1;
+		}
+		if (n > (cap - o))
+			return 0;
+
+		switch (kind) {
+		case RLIC_SLOT_CODEC_ZEROS:
+		case RLIC_SLOT_CODEC_ZEROS_LONG:
+			memset(&dst[o], 0, n);
+			break;
+		case RLIC_SLOT_CODEC_NIBBLES:
+			if (((n + 1) / 2) > (len - i))
+				return 0;
+			for (size_t k = 0; k < n; k += 2) {
+				uint8_t b = src[i++];
+
+				dst[o + k] = b & 0x0F;
+				if ((k + 1) < n)
+					dst[o + k + 1] = b >> 4;
+			}
+			break;
+		default:
+			if (n > (len - i))
+				return 0;
+			memcpy(&dst[o], &src[i], n);
+			i += n;
+			break;
+		}
+		o += n;
+	}
+
+	return o;
+}
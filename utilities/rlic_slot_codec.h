@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_SLOT_CODEC_H_
+#define RLIC_SLOT_CODEC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Allocation free codec for RLIC.dat entries. A Q table slot is mostly
+ * zero and the rest small: expected rewards stay at or below 10 and the
+ * pruning counters at 3, so zero runs and values that fit a nibble carry
+ * almost all of it. The stream is a list of runs, each led by one byte:
+ *
+ *   00nnnnnn           n + 1 zeros
+ *   11nnnnnn nnnnnnnn  n + 1 zeros, 14 bit n
+ *   01nnnnnn           n + 1 values below 16 follow, two per byte, low
+ *                      nibble first
+ *   10nnnnnn           n + 1 bytes follow as they are
+ *
+ * Encoding is one pass with no look back, decoding writes straight into
+ * the caller's buffer.
+ */
+#define RLIC_SLOT_CODEC_RUN_MAX		(64)
+#define RLIC_SLOT_CODEC_ZEROS_MAX	(16 * 1024)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* encoded size, 0 when it does not fit cap bytes */
+size_t RLIC_SlotCodec_Encode(const uint8_t *src, size_t len, uint8_t *dst,
+		size_t cap);
+/* decoded size, 0 on a stream that is cut short or overflows cap */
+size_t RLIC_SlotCodec_Decode(const uint8_t *src, size_t len, uint8_t *dst,
+		size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_SLOT_CODEC_H_ */
@@ -0,0 +1,195 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <string.h>
+#include "rlic_tiles.h"
+
+#if defined(__arm__)
+#include "rlic_section.h"
+#else
+#define RLIC_HOT_CODE
+#endif
+
+/*
+ * Grid k is shifted by k * disp / TILINGS of a tile along each input, the
+ * odd displacements (1, 3, 5) keep the grids from lining up diagonally.
+ */
+#define RLIC_TILES_DISP_TIME	(1)
+#define RLIC_TILES_DISP_LEDS	(3)
+#define RLIC_TILES_DISP_DUTY	(5)
+/* update step: half way to the target, as the table does */
+#define RLIC_TILES_STEP_SHIFT	(1)
+
+static uint8_t rlicTilesTile(uint32_t x, uint32_t values, uint32_t tiles,
+		uint32_t disp, uint32_t k) {
+	/* x in 1/TILINGS tile units, plus the grid's offset */
+	uint32_t pos = (x * tiles * RLIC_TILES_TILINGS) / values;
+
+	return (uint8_t) ((pos + ((k * disp) % RLIC_TILES_TILINGS))
+			/ RLIC_TILES_TILINGS);
+}
+
+/* every weight the same, actions start at initValue reward units */
+void RLIC_Tiles_Init(rlic_tiles_t *tiles, uint8_t initValue) {
+	int16_t *w = &tiles->w[0][0][0][0];
+	int16_t init = (int16_t) ((initValue * RLIC_TILES_ONE)
+			/ RLIC_TILES_TILINGS);
+
+	for (uint32_t i = 0; i < (sizeof(tiles->w) / sizeof(*w)); i++)
+		w[i] = init;
+	RLIC_Tiles_WeightsChanged(tiles);
+}
+
+/* weights loaded or set from outside, rebuild the lookups and the plane */
+void RLIC_Tiles_WeightsChanged(rlic_tiles_t *tiles) {
+	for (uint32_t k = 0; k < RLIC_TILES_TILINGS; k++) {
+		for (uint32_t l = 0; l < RLIC_TILES_LED_VALUES; l++)
+			tiles->ledTile[k][l] = rlicTilesTile(l, RLIC_TILES_LED_VALUES,
+					RLIC_TILES_LEDS, RLIC_TILES_DISP_LEDS, k);
+		for (uint32_t d = 0; d < RLIC_TILES_DUTY_VALUES; d++)
+			tiles->dutyTile[k][d] = rlicTilesTile(d, RLIC_TILES_DUTY_VALUES,
+					RLIC_TILES_DUTY, RLIC_TILES_DISP_DUTY, k);
+	}
+	tiles->planeValid = false;
+	tiles->best = RLIC_TILES_ACTIONS;
+}
+
+/* action values at a time slot, rebuilt only when a time tile changes */
+RLIC_HOT_CODE void RLIC_Tiles_SetTime(rlic_tiles_t *tiles, uint32_t time) {
+	uint8_t tt[RLIC_TILES_TILINGS];
+	bool same = tiles->planeValid;
+
+	if (time >= RLIC_TILES_TIME_VALUES)
+		time = RLIC_TILES_TIME_VALUES - 1;
+	for (uint32_t k = 0; k < RLIC_TILES_TILINGS; k++) {
+		tt[k] = rlicTilesTile(time, RLIC_TILES_TIME_VALUES, RLIC_TILES_TIME,
+				RLIC_TILES_DISP_TIME, k);
+		same = same && (tt[k] == tiles->timeTile[k]);
+	}
+	tiles->time = time;
+	if (same)
+		return;
+
+	memcpy(tiles->timeTile, tt, sizeof(tt));
+	memset(tiles->plane, 0, sizeof(tiles->plane));
+	for (uint32_t k = 0; k < RLIC_TILES_TILINGS; k++) {
+		const int16_t (*w)[RLIC_TILES_DUTY + 1] = tiles->w[k][tt[k]];
+
+		for (uint32_t l = 0; l < RLIC_TILES_LED_VALUES; l++) {
+			const int16_t *row = w[tiles->ledTile[k][l]];
+
+			for (uint32_t d = 0; d < RLIC_TILES_DUTY_VALUES; d++)
+				tiles->plane[l][d] += row[tiles->dutyTile[k][d]];
+		}
+	}
+	tiles->planeValid = true;
+	tiles->best = RLIC_TILES_ACTIONS;
+}
+
+int32_t RLIC_Tiles_Value(const rlic_tiles_t *tiles, uint32_t leds,
+		uint32_t duty) {
+	return tiles->plane[leds][duty];
+}
+
+/*
+ * Move the action half way to target (reward units). Each grid's weight
+ * takes its share, the plane is patched for every action in the same tile
+ * and the arg max follows: a gain can only make the action the best, a loss
+ * only matters when it was.
+ */
+RLIC_HOT_CODE void RLIC_Tiles_Update(rlic_tiles_t *tiles, uint32_t leds,
+		uint32_t duty, uint8_t target) {
+	int32_t err = (int32_t) target * RLIC_TILES_ONE - tiles->plane[leds][duty];
+	int32_t delta = err / (RLIC_TILES_TILINGS << RLIC_TILES_STEP_SHIFT);
+
+	if (!delta || !tiles->planeValid)
+		return;
+
+	for (uint32_t k = 0; k < RLIC_TILES_TILINGS; k++) {
+		uint8_t lt = tiles->ledTile[k][leds];
+		uint8_t dt = tiles->dutyTile[k][duty];
+
+		tiles->w[k][tiles->timeTile[k]][lt][dt] += (int16_t) delta;
+		for (uint32_t l = 0; l < RLIC_TILES_LED_VALUES; l++) {
+			if (tiles->ledTile[k][l] != lt)
+				continue;
+			for (uint32_t d = 0; d < RLIC_TILES_DUTY_VALUES; d++) {
+				if (tiles->dutyTile[k][d] == dt)
+					tiles->plane[l][d] += (int16_t) delta;
+			}
+		}
+	}
+
+	if (tiles->best == RLIC_TILES_ACTIONS)
+		return;
+	if (delta < 0) {
+		/* the best lost value only if it shares a tile with the action */
+		uint32_t bl = tiles->best / RLIC_TILES_DUTY_VALUES;
+		uint32_t bd = tiles->best % RLIC_TILES_DUTY_VALUES;
+
+		for (uint32_t k = 0; k < RLIC_TILES_TILINGS; k++) {
+			if ((tiles->ledTile[k][bl] == tiles->ledTile[k][leds])
+					&& (tiles->dutyTile[k][bd] == tiles->dutyTile[k][duty])) {
+				tiles->best = RLIC_TILES_ACTIONS;
+				break;
+			}
+		}
+		return;
+	}
+
+	/* only actions sharing a tile gained, check the updated one's tiles */
+	for (uint32_t k = 0; k < RLIC_TILES_TILINGS; k++) {
+		uint8_t lt = tiles->ledTile[k][leds];
+		uint8_t dt = tiles->dutyTile[k][duty];
+
+		for (uint32_t l = 0; l < RLIC_TILES_LED_VALUES; l++) {
+			if (tiles->ledTile[k][l] != lt)
+				continue;
+			for (uint32_t d = 0; d < RLIC_TILES_DUTY_VALUES; d++) {
+				uint32_t i = (l * RLIC_TILES_DUTY_VALUES) + d;
+				int16_t v = tiles->plane[l][d];
+				int16_t b = (&tiles->plane[0][0])[tiles->best];
+
+				if ((tiles->dutyTile[k][d] == dt)
+						&& ((v > b) || ((v == b) && (i < tiles->best))))
+					tiles->best = i;
+			}
+		}
+	}
+}
+
+/* best action at the plane's time, first index wins on ties */
+RLIC_HOT_CODE uint32_t RLIC_Tiles_ArgMax(rlic_tiles_t *tiles) {
+	const int16_t *q = &tiles->plane[0][0];
+
+	if (tiles->best < RLIC_TILES_ACTIONS)
+		return tiles->best;
+
+	tiles->best = 0;
+	for (uint32_t i = 1; i < RLIC_TILES_ACTIONS; i++) {
+		if (q[i] > q[tiles->best])
+			tiles->best = i;
+	}
+	return tiles->best;
+}
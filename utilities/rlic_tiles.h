@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_TILES_H_
+#define RLIC_TILES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Tile coded action values over (time slot, LEDs on, duty).
+ *
+ * RLIC_TILES_TILINGS grids, each offset by a fraction of a tile, cover the
+ * three inputs; the value of an action is the sum of the one weight it hits
+ * in every grid. An update moves those weights and so every action sharing
+ * a tile with it, which is what lets a few thousand weights stand in for a
+ * table per time slot.
+ *
+ * The values of all actions at the current time are kept in 'plane' and
+ * patched on update, the arg max is kept with them and only rescanned when
+ * the best action loses value. Weights and plane are Q8.8 reward units.
+ */
+#ifndef RLIC_TILES_TILINGS
+#define RLIC_TILES_TILINGS		(8)
+#endif
+#define RLIC_TILES_TIME			(8) /* tiles per grid along each input */
+#define RLIC_TILES_LEDS			(8)
+#define RLIC_TILES_DUTY			(4)
+
+/* input ranges, those of the Q table */
+#ifndef RLIC_TILES_TIME_VALUES
+#define RLIC_TILES_TIME_VALUES	(1001)
+#endif
+#define RLIC_TILES_LED_VALUES	(65)
+#define RLIC_TILES_DUTY_VALUES	(16)
+#define RLIC_TILES_ACTIONS		(RLIC_TILES_LED_VALUES * RLIC_TILES_DUTY_VALUES)
+
+#define RLIC_TILES_ONE			(256) /* one reward unit */
+
+/* grids get one extra tile per input for the offsets */
+typedef int16_t rlic_tiles_weights_t[RLIC_TILES_TILINGS][RLIC_TILES_TIME + 1][RLIC_TILES_LEDS
+		+ 1][RLIC_TILES_DUTY + 1];
+
+typedef struct {
+	rlic_tiles_weights_t w;
+	int16_t plane[RLIC_TILES_LED_VALUES][RLIC_TILES_DUTY_VALUES];
+	uint8_t timeTile[RLIC_TILES_TILINGS]; /* tiles of the plane's time */
+	uint8_t ledTile[RLIC_TILES_TILINGS][RLIC_TILES_LED_VALUES];
+	uint8_t dutyTile[RLIC_TILES_TILINGS][RLIC_TILES_DUTY_VALUES];
+	uint32_t time;
+	uint32_t best; /* arg max of plane, RLIC_TILES_ACTIONS when stale */
+	bool planeValid;
+} rlic_tiles_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void RLIC_Tiles_Init(rlic_tiles_t *tiles, uint8_t initValue);
+void RLIC_Tiles_SetTime(rlic_tiles_t *tiles, uint32_t time);
+void RLIC_Tiles_Update(rlic_tiles_t *tiles, uint32_t leds, uint32_t duty,
+		uint8_t target);
+uint32_t RLIC_Tiles_ArgMax(rlic_tiles_t *tiles);
+int32_t RLIC_Tiles_Value(const rlic_tiles_t *tiles, uint32_t leds,
+		uint32_t duty);
+void RLIC_Tiles_WeightsChanged(rlic_tiles_t *tiles);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_TILES_H_ */
@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <string.h>
+#include "rlic_trace.h"
+#include "rlic_section.h"
+
+#define RLIC_TRACE_RECS		(RLIC_TRACE_BLOCKS * RLIC_TRACE_BLOCK_RECS)
+
+/* trace records are 16 bytes, built as C or C++ */
+typedef char rlic_trace_rec_sz_check[((sizeof(rlic_trace_boot_t)
+		== RLIC_TRACE_REC_SZ) && (sizeof(rlic_trace_step_t) == RLIC_TRACE_REC_SZ)
+		&& (sizeof(rlic_trace_gap_t) == RLIC_TRACE_REC_SZ)) ? 1 : -1];
+
+void RLIC_Trace_Init(rlic_trace_t *trace, const rlic_trace_ops_t *ops,
+		void *ctx) {
+	memset(trace, 0, sizeof(*trace));
+	trace->ops = ops;
+	trace->ctx = ctx;
+}
+
+/* records that still fit */
+static inline uint32_t RLIC_Trace_Space(const rlic_trace_t *trace) {
+	return RLIC_TRACE_RECS - (trace->head - trace->tail);
+}
+
+/* next free record, a gap record first when steps were dropped */
+static RLIC_HOT_CODE rlic_trace_rec_t* RLIC_Trace_Reserve(rlic_trace_t *trace) {
+	rlic_trace_rec_t *rec;
+
+	/* all blocks waiting: try the writer once more before dropping */
+	if ((RLIC_Trace_Space(trace) < (trace->gap ? 2U : 1U))
+			&& (RLIC_Trace_Drain(trace) != kStatus_Success))
+		return NULL;
+	if (RLIC_Trace_Space(trace) < (trace->gap ? 2U : 1U))
+		return NULL;
+
+	if (trace->gap) {
+		rec = &trace->recs[trace->head++ % RLIC_TRACE_RECS];
+		memset(rec, 0, sizeof(*rec));
+		rec->gap.type = RLIC_TRACE_GAP;
+		rec->gap.dropped = trace->gap;
+		trace->gap = 0;
+		/* a gap can complete a block too */
+		if (!(trace->head % RLIC_TRACE_BLOCK_RECS))
+			(void) RLIC_Trace_Drain(trace);
+	}
+	return &trace->recs[trace->head % RLIC_TRACE_RECS];
+}
+
+/* record filled in, hand a completed block to the writer */
+static RLIC_HOT_CODE void RLIC_Trace_Commit(rlic_trace_t *trace) {
+	if (!(++trace->head % RLIC_TRACE_BLOCK_RECS))
+		(void) RLIC_Trace_Drain(trace);
+}
+
+void RLIC_Trace_Boot(rlic_trace_t *trace, uint32_t seed, uint32_t config,
+		uint32_t zones) {
+	rlic_trace_rec_t *rec = RLIC_Trace_Reserve(trace);
+
+	if (!rec)
+		return;
+	memset(rec, 0, sizeof(*rec));
+	rec->boot.type = RLIC_TRACE_BOOT;
+	rec->boot.version = RLIC_TRACE_VERSION;
+	rec->boot.zones = (uint8_t) zones;
+	rec->boot.magic = RLIC_TRACE_MAGIC;
+	rec->boot.seed = seed;
+	rec->boot.config = config;
+	RLIC_Trace_Commit(trace);
+}
+
+RLIC_HOT_CODE void RLIC_Trace_Step(rlic_trace_t *trace,
+		const rlic_trace_step_t *step) {
+	rlic_trace_rec_t *rec = RLIC_Trace_Reserve(trace);
+
+	trace->steps++;
+	if (!rec) {
+		trace->gap++;
+		trace->dropped++;
+		return;
+	}
+	rec->step = *step;
+	rec->step.type = RLIC_TRACE_STEP;
+	RLIC_Trace_Commit(trace);
+}
+
+/* write the completed blocks, in one call up to the end of the ring */
+status_t RLIC_Trace_Drain(rlic_trace_t *trace) {
+	uint32_t end = trace->head - (trace->head % RLIC_TRACE_BLOCK_RECS);
+
+	while (trace->tail != end) {
+		uint32_t at = trace->tail % RLIC_TRACE_RECS;
+		uint32_t n = end - trace->tail;
+
+		if (n > (RLIC_TRACE_RECS - at))
+			n = RLIC_TRACE_RECS - at;
+		if (trace->ops->write(trace->ctx, &trace->recs[at],
+				n * RLIC_TRACE_REC_SZ) != kStatus_Success)
+			return kStatus_Fail;
+		trace->tail += n;
+		trace->blocks += n / RLIC_TRACE_BLOCK_RECS;
+	}
+	return kStatus_Success;
+}
+
+/* pad the block being filled and write everything, on close */
+status_t RLIC_Trace_Flush(rlic_trace_t *trace) {
+	uint32_t fill = trace->head % RLIC_TRACE_BLOCK_RECS;
+
+	if (fill) {
+		memset(&trace->recs[trace->head % RLIC_TRACE_RECS], 0,
+				(RLIC_TRACE_BLOCK_RECS - fill) * RLIC_TRACE_REC_SZ);
+		trace->head += RLIC_TRACE_BLOCK_RECS - fill;
+	}
+	return RLIC_Trace_Drain(trace);
+}
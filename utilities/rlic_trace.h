@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_TRACE_H_
+#define RLIC_TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fsl_common.h"
+
+/*
+ * Step trace: what the learner saw and did each step, as fixed 16 byte
+ * records, so a run can be fed back through QLearning on a host (see
+ * tools/trace_replay.cpp). Each boot starts with a boot record holding the
+ * learner's random seed and build flags, then one step record per control
+ * step, in the order the steps finished.
+ *
+ * Records are gathered in RAM in 512 byte blocks and handed to the writer
+ * a whole number of blocks at a time, so a file made of them only grows
+ * by whole sectors. A writer that fails (card not up yet) keeps the blocks
+ * for later; when all RLIC_TRACE_BLOCKS are waiting, steps are dropped and
+ * a gap record with their count goes in ahead of the next one kept.
+ *
+ * Portable C, the writer is reached through rlic_trace_ops_t so the host
+ * programs in tools/ record and read the same format.
+ */
+#ifndef RLIC_TRACE
+#define RLIC_TRACE				(0)
+#endif
+
+#define RLIC_TRACE_MAGIC		(0x52544C52) /* "RLTR" */
+#define RLIC_TRACE_VERSION		(1)
+#define RLIC_TRACE_BLOCK_SZ		(512)
+#ifndef RLIC_TRACE_BLOCKS
+#define RLIC_TRACE_BLOCKS		(8) /* 256 steps */
+#endif
+
+enum rlic_trace_type_t {
+	RLIC_TRACE_PAD = 0, /* fills the last block on close */
+	RLIC_TRACE_BOOT,
+	RLIC_TRACE_STEP,
+	RLIC_TRACE_GAP,
+};
+
+/* step flags */
+#define RLIC_TRACE_EXPLORE		(1U << 0) /* random action */
+#define RLIC_TRACE_CARD_BEGIN	(1U << 1) /* RLIC.dat up when the action was picked */
+#define RLIC_TRACE_CARD			(1U << 2) /* RLIC.dat up when it was learned */
+
+typedef struct {
+	uint8_t type; /* RLIC_TRACE_BOOT */
+	uint8_t version;
+	uint8_t zones;
+	uint8_t reserved;
+	uint32_t magic;
+	uint32_t seed; /* QLearning::getRandomSeed() */
+	uint32_t config; /* QLEARN_BUILD_FLAGS */
+} rlic_trace_boot_t;
+
+typedef struct {
+	uint8_t type; /* RLIC_TRACE_STEP */
+	uint8_t flags;
+	uint8_t zone;
+	uint8_t reward;
+	uint32_t dayTimeMS; /* when the action was picked */
+	uint32_t lux;
+	uint16_t slot;
+	uint8_t numOnLeds;
+	uint8_t duty;
+} rlic_trace_step_t;
+
+typedef struct {
+	uint8_t type; /* RLIC_TRACE_GAP */
+	uint8_t reserved[3];
+	uint32_t dropped; /* steps not recorded */
+	uint32_t reserved2[2];
+} rlic_trace_gap_t;
+
+typedef union {
+	uint8_t type;
+	rlic_trace_boot_t boot;
+	rlic_trace_step_t step;
+	rlic_trace_gap_t gap;
+} rlic_trace_rec_t;
+
+#define RLIC_TRACE_REC_SZ		(16)
+#define RLIC_TRACE_BLOCK_RECS	(RLIC_TRACE_BLOCK_SZ / RLIC_TRACE_REC_SZ)
+
+typedef struct {
+	/* append len bytes, a multiple of RLIC_TRACE_BLOCK_SZ */
+	status_t (*write)(void *ctx, const void *data, uint32_t len);
+} rlic_trace_ops_t;
+
+typedef struct {
+	rlic_trace_rec_t recs[RLIC_TRACE_BLOCKS * RLIC_TRACE_BLOCK_RECS];
+	const rlic_trace_ops_t *ops;
+	void *ctx;
+	uint32_t head; /* records filled */
+	uint32_t tail; /* records written */
+	uint32_t gap; /* dropped since the last record kept */
+	uint32_t steps;
+	uint32_t dropped;
+	uint32_t blocks; /* written */
+} rlic_trace_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void RLIC_Trace_Init(rlic_trace_t *trace, const rlic_trace_ops_t *ops,
+		void *ctx);
+void RLIC_Trace_Boot(rlic_trace_t *trace, uint32_t seed, uint32_t config,
+		uint32_t zones);
+void RLIC_Trace_Step(rlic_trace_t *trace, const rlic_trace_step_t *step);
+status_t RLIC_Trace_Drain(rlic_trace_t *trace);
+status_t RLIC_Trace_Flush(rlic_trace_t *trace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_TRACE_H_ */
@@ -0,0 +1,210 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#include <string.h>
+#include "rlic_zone_sched.h"
+
+#if defined(__arm__)
+#include "fsl_debug_console.h"
+#else
+/* host build for tools/, the SDK console is not there */
+#include <stdio.h>
+#define PRINTF printf
+#endif
+
+/* wrap safe: has the clock reached t */
+#define RLIC_ZONE_REACHED(now, t)	((int32_t) ((now) - (t)) >= 0)
+
+void RLIC_ZoneSched_Init(rlic_zone_sched_t *sched, uint32_t mode,
+		uint32_t (*clockMS)(void)) {
+	memset(sched, 0, sizeof(*sched));
+	sched->mode = mode;
+	sched->clockMS = clockMS;
+	sched->startMS = clockMS();
+}
+
+status_t RLIC_ZoneSched_Add(rlic_zone_sched_t *sched, rlic_zone_t *zone,
+		const char *name, const rlic_zone_ops_t *ops, void *ctx) {
+	if (sched->numZones >= RLIC_ZONES_MAX)
+		return kStatus_Fail;
+
+	memset(zone, 0, sizeof(*zone));
+	zone->name = name;
+	zone->ops = ops;
+	zone->ctx = ctx;
+	sched->zones[sched->numZones++] = zone;
+	return kStatus_Success;
+}
+
+/* finish the step of a zone whose sample is due */
+static status_t RLIC_ZoneSched_Finish(rlic_zone_sched_t *sched,
+		rlic_zone_t *zone, uint32_t now) {
+	uint32_t waitMS = 0;
+	status_t status = zone->ops->finish(zone->ctx, &waitMS);
+	uint32_t end = sched->clockMS();
+
+	sched->busyMS += end - now;
+	if (status != kStatus_Success) {
+		zone->errors++;
+		zone->state = RLIC_ZONE_IDLE;
+		return status;
+	}
+
+	if (waitMS) {
+		zone->resamples++;
+		zone->readyMS = end + waitMS;
+		return kStatus_Success;
+	}
+
+	zone->steps++;
+	zone->stepMS += end - zone->beginMS;
+	zone->state = RLIC_ZONE_IDLE;
+	sched->steps++;
+	return kStatus_Success;
+}
+
+static status_t RLIC_ZoneSched_Begin(rlic_zone_sched_t *sched,
+		rlic_zone_t *zone, uint32_t now) {
+	uint32_t waitMS = 0;
+	status_t status = zone->ops->begin(zone->ctx, &waitMS);
+	uint32_t end = sched->clockMS();
+
+	sched->busyMS += end - now;
+	if (status != kStatus_Success) {
+		zone->errors++;
+		return status;
+	}
+
+	zone->beginMS = now;
+	zone->readyMS = end + waitMS;
+	zone->state = RLIC_ZONE_SENSING;
+	return kStatus_Success;
+}
+
+/*
+ * One pass over the zones, starting at the round robin position: finish the
+ * steps that are due, begin new ones. *waitMS is the time until the next
+ * sample is due, the caller may sleep that long. Errors are returned as
+ * soon as they happen, the zone is left idle and retried on the next pass.
+ */
+status_t RLIC_ZoneSched_Run(rlic_zone_sched_t *sched, uint32_t *waitMS) {
+	uint32_t n = sched->numZones;
+	uint32_t sensing = 0;
+	uint32_t now;
+	bool due = false;
+
+	*waitMS = 0;
+	if (!n)
+		return kStatus_Success;
+
+	for (uint32_t i = 0; i < n; i++) {
+		rlic_zone_t *zone = sched->zones[(sched->next + i) % n];
+		status_t status;
+
+		now = sched->clockMS();
+		if ((zone->state == RLIC_ZONE_SENSING)
+				&& RLIC_ZONE_REACHED(now, zone->readyMS)) {
+			status = RLIC_ZoneSched_Finish(sched, zone, now);
+			if (status != kStatus_Success)
+				return status;
+			if ((zone->state == RLIC_ZONE_IDLE)
+					&& (sched->mode == RLIC_ZONE_SEQUENTIAL)) {
+				/* next zone's turn */
+				sched->next = (sched->next + 1) % n;
+				due = true;
+				break;
+			}
+		}
+		if (zone->state == RLIC_ZONE_SENSING) {
+			sensing++;
+			continue;
+		}
+		if ((sched->mode == RLIC_ZONE_SEQUENTIAL)
+				&& ((zone != sched->zones[sched->next]) || sensing))
+			continue;
+
+		status = RLIC_ZoneSched_Begin(sched, zone, sched->clockMS());
+		if (status != kStatus_Success)
+			return status;
+		sensing++;
+	}
+
+	if (due)
+		return kStatus_Success;
+	if (sched->mode == RLIC_ZONE_PIPELINED)
+		sched->next = (sched->next + 1) % n;
+
+	/* time to the earliest due sample */
+	now = sched->clockMS();
+	*waitMS = UINT32_MAX;
+	for (uint32_t i = 0; i < n; i++) {
+		rlic_zone_t *zone = sched->zones[i];
+		uint32_t left;
+
+		if (zone->state != RLIC_ZONE_SENSING)
+			continue;
+		left = RLIC_ZONE_REACHED(now, zone->readyMS) ?
+				0 : zone->readyMS - now;
+		if (left < *waitMS)
+			*waitMS = left;
+	}
+	if (*waitMS == UINT32_MAX)
+		*waitMS = 0;
+
+	return kStatus_Success;
+}
+
+void RLIC_ZoneSched_ResetStats(rlic_zone_sched_t *sched) {
+	for (uint32_t i = 0; i < sched->numZones; i++) {
+		rlic_zone_t *zone = sched->zones[i];
+
+		zone->steps = zone->resamples = zone->errors = 0;
+		zone->stepMS = 0;
+	}
+	sched->startMS = sched->clockMS();
+	sched->busyMS = 0;
+	sched->steps = 0;
+}
+
+void RLIC_ZoneSched_PrintStats(const rlic_zone_sched_t *sched) {
+	uint32_t elapsedMS = sched->clockMS() - sched->startMS;
+	uint32_t rate = 0, busy = 0; /* steps/s x 100, percent */
+
+	if (elapsedMS) {
+		rate = (uint32_t) (((uint64_t) sched->steps * 100000) / elapsedMS);
+		busy = (uint32_t) (((uint64_t) sched->busyMS * 100) / elapsedMS);
+	}
+	PRINTF("zones: %d %s, %d steps in %d ms, %d.%02d steps/s, busy %d%%\r\n",
+			sched->numZones,
+			(sched->mode == RLIC_ZONE_PIPELINED) ? "pipelined" : "sequential",
+			sched->steps, elapsedMS, rate / 100, rate % 100, busy);
+	for (uint32_t i = 0; i < sched->numZones; i++) {
+		const rlic_zone_t *zone = sched->zones[i];
+
+		PRINTF("  %-8s %d steps, %d ms/step, %d resamples, %d errors\r\n",
+				zone->name, zone->steps,
+				zone->steps ? (uint32_t) (zone->stepMS / zone->steps) : 0,
+				zone->resamples, zone->errors);
+	}
+}
@@ -0,0 +1,107 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 Subhasish Ghosh
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*! @file */
+#ifndef RLIC_ZONE_SCHED_H_
+#define RLIC_ZONE_SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fsl_common.h"
+
+/*
+ * Zone scheduler. A zone is one luminaire with its sensor and learner; a
+ * step picks and applies a brightness, waits for the sensor and learns from
+ * the reading. The wait is most of a step, so in pipelined mode every zone
+ * starts its step as soon as it can and the waits overlap: one zone is
+ * actuated or learns while the others integrate. Sequential mode runs one
+ * step at a time, round robin, as a single zone build does.
+ *
+ * Portable C, the zone work is done through rlic_zone_ops_t so the host
+ * simulator in tools/ drives the same code.
+ */
+#ifndef RLIC_ZONES_MAX
+#define RLIC_ZONES_MAX			(8)
+#endif
+
+enum rlic_zone_mode_t {
+	RLIC_ZONE_SEQUENTIAL = 0,
+	RLIC_ZONE_PIPELINED,
+};
+
+enum rlic_zone_state_t {
+	RLIC_ZONE_IDLE = 0, /* next step not started */
+	RLIC_ZONE_SENSING, /* waiting for the sensor until readyMS */
+};
+
+typedef struct {
+	/* apply the next brightness and start sensing, *waitMS until readable */
+	status_t (*begin)(void *ctx, uint32_t *waitMS);
+	/*
+	 * read the sensor and learn. *waitMS 0 ends the step, non zero means
+	 * the sample was started again (auto range) and is read that much later
+	 */
+	status_t (*finish)(void *ctx, uint32_t *waitMS);
+} rlic_zone_ops_t;
+
+typedef struct {
+	const char *name;
+	const rlic_zone_ops_t *ops;
+	void *ctx;
+	uint32_t state;
+	uint32_t readyMS;
+	uint32_t beginMS;
+	uint32_t steps;
+	uint32_t resamples; /* sensor started again within a step */
+	uint32_t errors;
+	uint64_t stepMS; /* begin to end of step, summed */
+} rlic_zone_t;
+
+typedef struct {
+	rlic_zone_t *zones[RLIC_ZONES_MAX];
+	uint32_t numZones;
+	uint32_t mode;
+	uint32_t next; /* round robin position */
+	uint32_t (*clockMS)(void);
+	uint32_t startMS;
+	uint32_t busyMS; /* spent inside begin/finish */
+	uint32_t steps;
+} rlic_zone_sched_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void RLIC_ZoneSched_Init(rlic_zone_sched_t *sched, uint32_t mode,
+		uint32_t (*clockMS)(void));
+status_t RLIC_ZoneSched_Add(rlic_zone_sched_t *sched, rlic_zone_t *zone,
+		const char *name, const rlic_zone_ops_t *ops, void *ctx);
+status_t RLIC_ZoneSched_Run(rlic_zone_sched_t *sched, uint32_t *waitMS);
+void RLIC_ZoneSched_ResetStats(rlic_zone_sched_t *sched);
+void RLIC_ZoneSched_PrintStats(const rlic_zone_sched_t *sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RLIC_ZONE_SCHED_H_ */
@@ -23,11 +23,21 @@
  */
 /*! @file */
 #include "systick_delay.h"
+#include "rlic_section.h"
+#if RLIC_IDLE
+#include "fsl_clock.h"
+#include "fsl_gpt.h"
+#include "clock_config.h"
+#endif
 
 static uint32_t g_systickCounter_DelayTicks = 0;
 static uint32_t g_systickCounter_Uptime = UINT32_MAX;
 
-void SysTick_Handler(void) {
+#if RLIC_IDLE
+static void SysTick_IdleInit(void);
+#endif
+
+RLIC_HOT_CODE void SysTick_Handler(void) {
 	if (g_systickCounter_DelayTicks != 0U) {
 		g_systickCounter_DelayTicks--;
 	}
@@ -44,6 +54,9 @@ void SysTick_Init() {
 		while (1) {
 		}
 	}
+#if RLIC_IDLE
+	SysTick_IdleInit();
+#endif
 }
 
 /* delay ticks */
@@ -54,7 +67,143 @@ void SysTick_DelayTicksMS(uint32_t n) {
 }
 
 /* current time stamp */
-uint32_t SysTick_UptimeMS(void) {
+RLIC_HOT_CODE uint32_t SysTick_UptimeMS(void) {
 	return UINT32_MAX - g_systickCounter_Uptime;
 }
 
+#if RLIC_IDLE
+/*
+ * Reference clock: GPT1 free running at 1 MHz from the 24 MHz oscillator,
+ * whatever the core clock. The idle core clock is AHB divided down; IPG is
+ * divided by as much less at the same time, so IPG, PERCLK and the timers
+ * on them (TMR2 day cycle, GPT) keep their boot rates. SysTick runs on the
+ * core clock and is reloaded on every change.
+ */
+#define SYSTICK_REF_GPT			GPT1
+#define SYSTICK_REF_OSC_DIV		(8U) /* 24 MHz / 8 / 3 */
+#define SYSTICK_REF_DIV			(3U)
+#define SYSTICK_IPG_DIV			(BOARD_BOOTCLOCKRUN_AHB_CLK_ROOT \
+		/ BOARD_BOOTCLOCKRUN_IPG_CLK_ROOT)
+
+static_assert((SYSTICK_IPG_DIV % RLIC_IDLE_SCALE_DIV) == 0,
+		"RLIC_IDLE_SCALE_DIV must divide the boot AHB / IPG ratio");
+
+static rlic_idle_t s_idle;
+static uint32_t s_coreDiv = 1;
+
+RLIC_HOT_CODE uint32_t SysTick_ReferenceUS(void) {
+	return GPT_GetCurrentTimerCount(SYSTICK_REF_GPT);
+}
+
+RLIC_HOT_CODE static void SysTick_Sleep(void) {
+	__DSB();
+	__WFI();
+	__ISB();
+}
+
+/*
+ * Core clock divided by div. Done just after a tick so reloading SysTick
+ * loses a few us of the ms being counted, not up to a whole one.
+ */
+RLIC_HOT_CODE static void SysTick_ScaleCore(uint32_t div) {
+	uint32_t ms = SysTick_UptimeMS();
+	uint32_t primask;
+
+	if (div == s_coreDiv)
+		return;
+	while (SysTick_UptimeMS() == ms)
+		SysTick_Sleep();
+
+	primask = DisableGlobalIRQ();
+	if (div > s_coreDiv) {
+		/* slower: AHB first, IPG back up after */
+		CLOCK_SetDiv(kCLOCK_AhbDiv, div - 1U);
+		CLOCK_SetDiv(kCLOCK_IpgDiv, (SYSTICK_IPG_DIV / div) - 1U);
+	} else {
+		/* faster: IPG down first so it never runs over */
+		CLOCK_SetDiv(kCLOCK_IpgDiv, (SYSTICK_IPG_DIV / div) - 1U);
+		CLOCK_SetDiv(kCLOCK_AhbDiv, div - 1U);
+	}
+	SysTick->LOAD = ((BOARD_BOOTCLOCKRUN_CORE_CLOCK / div) / 1000U) - 1U;
+	SysTick->VAL = 0U;
+	s_coreDiv = div;
+	EnableGlobalIRQ(primask);
+}
+
+static const rlic_idle_ops_t s_idleOps = { SysTick_ReferenceUS,
+		SysTick_UptimeMS, SysTick_Sleep, SysTick_ScaleCore };
+
+static void SysTick_IdleInit(void) {
+	gpt_config_t config;
+
+	GPT_GetDefaultConfig(&config);
+	config.clockSource = kGPT_ClockSource_Osc;
+	config.divider = SYSTICK_REF_DIV;
+	config.enableFreeRun = true;
+	config.enableRunInWait = true;
+	config.enableRunInStop = true;
+	GPT_Init(SYSTICK_REF_GPT, &config);
+	GPT_SetOscClockDivider(SYSTICK_REF_GPT, SYSTICK_REF_OSC_DIV);
+	GPT_StartTimer(SYSTICK_REF_GPT);
+
+	RLIC_Idle_Init(&s_idle, &s_idleOps, RLIC_IDLE_SCALE_DIV);
+}
+
+/* the next step is ms away */
+RLIC_HOT_CODE void SysTick_IdleMS(uint32_t ms) {
+	RLIC_Idle_WaitMS(&s_idle, ms);
+}
+
+/* one sleep in a loop waiting for a transfer's interrupt */
+RLIC_HOT_CODE void SysTick_IdleWait(uint32_t reason) {
+	if (s_idle.ops != NULL) /* busy waits until SysTick_Init() */
+		RLIC_Idle_Sleep(&s_idle, reason);
+}
+
+RLIC_HOT_CODE void SysTick_IdleDecision(void) {
+	RLIC_Idle_Decision(&s_idle);
+}
+
+/* power states and energy per decision every RLIC_IDLE_REPORT_MS */
+void SysTick_IdleReport(void) {
+#if RLIC_IDLE_REPORT_MS
+	if ((SysTick_UptimeMS() - s_idle.startMS) >= RLIC_IDLE_REPORT_MS) {
+		RLIC_Idle_PrintStats(&s_idle);
+		RLIC_Idle_ResetStats(&s_idle);
+	}
+#endif
+}
+
+void SysTick_IdlePrintStats(void) {
+	RLIC_Idle_PrintStats(&s_idle);
+}
+
+/* SD transfers wait here, see fsl_sdmmc_osa.c */
+extern "C" void SDMMC_OSAIdle(void) {
+	SysTick_IdleWait(RLIC_IDLE_SD);
+}
+#else
+void SysTick_IdleMS(uint32_t ms) {
+	SysTick_DelayTicksMS(ms);
+}
+
+void SysTick_IdleWait(uint32_t reason) {
+	(void) reason;
+}
+
+uint32_t SysTick_ReferenceUS(void) {
+	return SysTick_UptimeMS() * 1000U;
+}
+
+void SysTick_IdleDecision(void) {
+
+}
+
+void SysTick_IdleReport(void) {
+
+}
+
+void SysTick_IdlePrintStats(void) {
+
+}
+#endif
@@ -27,6 +27,7 @@
 
 #include <stdio.h>
 #include "fsl_debug_console.h"
+#include "rlic_idle.h"
 
 /* Since this is a c++ project, this is required
  * to override the default handler.
@@ -37,6 +38,17 @@ extern "C" {
 
 extern void SysTick_Handler(void);
 
+/*
+ * Idle waits, see rlic_idle.h, set up by SysTick_Init(). With RLIC_IDLE 0
+ * SysTick_IdleMS() is SysTick_DelayTicksMS() and the rest do nothing.
+ */
+extern void SysTick_IdleMS(uint32_t ms);
+extern void SysTick_IdleWait(uint32_t reason);
+extern uint32_t SysTick_ReferenceUS(void);
+extern void SysTick_IdleDecision(void);
+extern void SysTick_IdleReport(void);
+extern void SysTick_IdlePrintStats(void);
+
 #ifdef __cplusplus
 }
 #endif